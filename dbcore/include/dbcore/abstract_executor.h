@@ -0,0 +1,63 @@
+#pragma once
+
+#include <dbcore/schema.h>
+#include <dbcore/tuple_view.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dbcore
+{
+
+class ExecutorContext;
+
+/**
+ * AbstractExecutor is the operator of the query plan. The operators make up the tree
+ * and the rows are pulled from the root (Volcano model), but they are passed between
+ * the operators in batches of tuple views, so the cost of the (virtual) call and of
+ * the per-call bookkeeping is paid once per batch, and the rows are not copied
+ * unless the operator makes the new ones (e.g. the projection).
+ *
+ * The batch is valid until the next call of Next() (or Init()) of the executor which produced it:
+ * the views might refer to the pages which are latched by the scan only till then.
+ * Therefore the consumer must not modify the pages read by its child while the batch is alive
+ * (see InsertExecutor), and it copies the rows it keeps longer.
+*/
+class AbstractExecutor
+{
+    AbstractExecutor(const AbstractExecutor&) = delete;
+    AbstractExecutor& operator=(const AbstractExecutor&) = delete;
+
+public:
+    /** The number of rows in a batch the executors aim at (the scans produce a page at a time) */
+    static constexpr uint32_t BATCH_SIZE = 256;
+
+    AbstractExecutor() = default;
+    virtual ~AbstractExecutor() = default;
+
+    /**
+     * Prepare the executor (and its children) to produce the rows from the beginning.
+    */
+    virtual void Init() = 0;
+
+    /**
+     * Produce the next batch of rows.
+     * @param[out] batch the rows (never empty when true is returned)
+     * @return false when there are no more rows
+    */
+    virtual bool Next(std::vector<TupleView>& batch) = 0;
+
+    /**
+     * @return the schema of the produced rows
+    */
+    virtual const Schema& GetOutputSchema() const = 0;
+
+    /**
+     * @return true if the executor (or its child) stopped producing the rows because of an error
+     * (e.g. there was no free page to spill the rows), so the rows produced since the last Init()
+     * are incomplete. Next() returns false once the error occurs.
+    */
+    virtual bool HasFailed() const { return false; }
+};
+
+}
@@ -3,15 +3,19 @@
 #include <dbcore/coretypes.h>
 #include <dbcore/page_guard.h>
 
-#include <list>
+#include <functional>
+#include <mutex>
 #include <shared_mutex>
+#include <vector>
 
 #include <iostream>
 
 namespace dbcore
 {
 
+class LogManager;
 class PagesManager;
+class PageChangeLog;
 class RID;
 class TupleCompare;
 
@@ -19,6 +23,17 @@ class BPlusTreePage;
 class BPlusTreeLeafPage;
 class BPlusTreeInternalPage;
 
+/**
+ * B+ tree with page-level latching (latch crabbing).
+ * Lookups latch pages for read top-down releasing the parent as soon as the child is latched.
+ * Insert and Remove at first latch the internal pages for read and only the leaf for write.
+ * When the leaf should be split or merged, they start over latching pages for write and
+ * keeping latched only those pages which might be changed by the split/merge.
+ * The root page never moves: when it's split its items move to the new leftmost child,
+ * when only one child of it remains the child's items move up into the root.
+ * The changes of pages are logged (see PageChangeLog) while the pages are latched,
+ * one record per insert or remove, so the split or merge is redone as a whole.
+*/
 class BPlusTree final
 {
     BPlusTree(const BPlusTree&) = delete;
@@ -36,14 +51,19 @@ public:
         // Iterator& operator=(Iterator&& other);
 
     private:
-        Iterator(PagesManager& pages_manager, page_id_t start_page_id);
-        Iterator(PagesManager& pages_manager, page_id_t start_page_id, uint16_t start_pos);
+        explicit Iterator(PagesManager& pages_manager);
+        Iterator(PagesManager& pages_manager, ReadPageGuard&& page_guard, uint16_t start_pos);
 
     public:
         bool IsEnd() const;
 
         RID operator*() const;
 
+        /**
+         * @return the key of the current key/value pair (valid while the iterator stays at it)
+        */
+        const char* GetKey() const;
+
         Iterator& operator++();
 
         bool operator==(const Iterator& other) const;
@@ -60,8 +80,15 @@ public:
     };
 
 public:
+    /**
+     * Create the empty tree or open the existing one.
+     * @param root_page_id the root page of the existing tree, INVALID_PAGE_ID to create the new one
+     * @param log_manager the write-ahead log of the page changes, nullptr when they are not logged
+     * @param index_oid the OID of the index in the log records
+    */
     BPlusTree(PagesManager& pages_manager, const TupleCompare& tuple_compare, uint32_t key_size, 
-            uint16_t leaf_max_size = 0, uint16_t internal_max_size = 0);
+            uint16_t leaf_max_size = 0, uint16_t internal_max_size = 0, page_id_t root_page_id = INVALID_PAGE_ID,
+            LogManager* log_manager = nullptr, index_oid_t index_oid = INVALID_INDEX_OID);
 
     ~BPlusTree();
 
@@ -80,9 +107,62 @@ public:
     */
     bool GetValue(const char* key, RID& rid) const;
 
+    /**
+     * Search the values associated with a batch of keys. The keys are probed in ascending
+     * order, so the probes which fall into the same leaf share one root-to-leaf descent and
+     * one latch of the leaf. The probe which falls into the next leaf moves along the sibling
+     * link, only the probes beyond it descend from the root again.
+     * @param keys the keys to search, laid out one after another (in any order)
+     * @param count the number of keys
+     * @param[out] rids the values associated with the keys (assigned only to the found ones)
+     * @param[out] found whether each key is found
+     * @return the number of keys found
+    */
+    size_t MultiGetValue(const char* keys, size_t count, RID rids[], bool found[]) const;
+
+    /**
+     * The source of the bulk load: it gives the next key/value pair and returns true,
+     * or returns false when there are no more pairs. The key stays valid until the next call.
+    */
+    using BulkLoadSource = std::function<bool(const char*& key, RID& rid)>;
+
+    /**
+     * Build the tree bottom-up from the key/value pairs sorted by key, as they come from the source
+     * (e.g. the merge of the sorted runs), without keeping all of them in memory. The leaves are
+     * filled one after another up to the given fraction of their capacity, the items of the last
+     * two leaves are spread between them evenly (or written into one leaf when two would underflow).
+     * Then each level of internal pages is built over the level below, so every page is written only once.
+     * The new pages are logged one by one and the root page is filled last, so the tree
+     * remains empty until the whole of it is built.
+     * @param next the source of the key/value pairs in strictly ascending order of keys
+     * @param fill_factor the fraction of page capacity to fill (it is clamped to [0.5, 1])
+     * @return true on success; false if the tree is not empty, the keys are not strictly
+     * ascending or there are no free pages (the tree remains empty then)
+    */
+    bool BulkLoad(const BulkLoadSource& next, float fill_factor = 1.0f);
+
+    /**
+     * Build the tree bottom-up from the key/value pairs sorted by key (see the BulkLoad above).
+     * @param keys the keys in strictly ascending order, laid out one after another
+     * @param rids the values matching the keys
+     * @param count the number of key/value pairs
+     * @param fill_factor the fraction of page capacity to fill (it is clamped to [0.5, 1])
+    */
+    bool BulkLoad(const char* keys, const RID rids[], size_t count, float fill_factor = 1.0f);
+
+    /**
+     * Give back all of the pages of the tree, the root page included (e.g. when the index could not be built).
+     * Nobody else must use the tree, it's only destroyed after the call.
+    */
+    void GiveBackPages();
 
     void PrintTree(std::ostream& os) const;
 
+    /**
+     * @return the root page of the tree (it never changes, so it's persisted once)
+    */
+    page_id_t GetRootPageId() const;
+
     /**
      * Return iterator at the beginning of the tree.
     */
@@ -94,12 +174,19 @@ public:
     */
     Iterator Begin(const char* key) const;
 
+    /**
+     * Return iterator at the first key/value pair which key is not less than the given one.
+     * When there is no such key, return iterator at the end of the tree.
+    */
+    Iterator LowerBound(const char* key) const;
+
     /**
      * Return iterator at the end of the tree.
     */
     Iterator End() const;
 
 private:
+    struct Context;
 
     /**
      * Insert a key-value pair into leaf node (The caller is responsible that it would be leaf node).
@@ -108,52 +195,101 @@ private:
      * @param leaf the pointer to leaf at which key-value pair inserted
      * @param key the key to insert into leaf
      * @param rid the value matching the key
+     * @param changes the log of the page changes, the right sibling is latched by it until it's appended
      * @param right_sibling the pointer where page_id of the right sibling will be written in case of split, INVALID_PAGE_ID otherwise
      * @return true when pair was inserted, false when pair with such key is already exist.
     */
-    bool InsertIntoLeaf(BPlusTreeLeafPage* leaf, const char* key, const RID& rid, page_id_t* right_sibling);
+    bool InsertIntoLeaf(BPlusTreeLeafPage* leaf, const char* key, const RID& rid, PageChangeLog& changes,
+                        page_id_t* right_sibling);
+
+    /**
+     * Insert a link to the right sibling of the page which was split into its parent. The parent is split
+     * when it is full and so on up to the root. When the root is split, its items move to the new page
+     * which becomes the left child of the root.
+     * @param ctx the write-latched pages on the path from the topmost unsafe page down to the split one
+     * @param key the lowest key of the right sibling
+     * @param right_sibling_id the page id of the right sibling
+    */
+    void InsertIntoParent(Context& ctx, const char* key, page_id_t right_sibling_id);
+
+    /**
+     * Insert a key-value pair, holding write latches on all pages which might be split.
+    */
+    bool InsertPessimistic(const char* key, const RID& rid);
+
+    /**
+     * Remove a key, holding write latches on all pages which might be merged.
+    */
+    void RemovePessimistic(const char* key);
 
     /**
-     * Helper method to insert key/value pair. When the first argument is leaf page, insert key/value into it. If leaf is split,
-     * insert a link into parent page (always internal page). In case when parent is split, pass the page id of its right sibling
-     * to the caller via the @ref parent_right_sibling argument. When the first argument is internal page, lookup the link to the
-     * children matching the key and invoke itself recursively.
-     * @param page the page where insert the key/value pair or lookup the link to traverse down
-     * @param parent the parent of the @ref page (always internal page, because leaf can't be parent)
-     * @param key the key to insert
-     * @param rid the value to insert
-     * @param parent_right_sibling the page_id of the parent's right sibling will be written here in case of parent split
-     * @return true when the pair was inserted, false when the pair with such key already exist.
+     * Fix the underflow of the pages on the path (from the bottom up) merging them with
+     * or borrowing items from their siblings.
+     * @param ctx the write-latched pages on the path from the topmost unsafe page down to the leaf
+     * @param left_leaf_guard the write-latched left sibling of the leaf (if any)
     */
-    bool Insert(BPlusTreePage* page, BPlusTreeInternalPage* parent, const char* key, const RID& rid, page_id_t* parent_right_sibling);
+    void RebalanceAfterRemove(Context& ctx, WritePageGuard& left_leaf_guard);
 
     /**
-     * Helper method to remove key/value pair.
-     * @param page the page where remove the key/value pair or lookup the link to traverse down
-     * @param key the key to remove
+     * Traverse down following the links matching the key (or the leftmost links when key is nullptr)
+     * latching pages for read. The parent is released when the child is latched.
+     * @return the read-latched leaf page
     */
-    void Remove(BPlusTreePage* page, const char* key);
+    ReadPageGuard FindLeafRead(const char* key) const;
 
     /**
-     * Traverse down following the leftmost children. When the next children is leaf, returns its ID
+     * Traverse down latching internal pages for read and the leaf for write.
+     * @param root_lock the shared lock of the root page id, remains locked when the root is leaf
+     * @param parent_guard the read-latched parent of the leaf (if leaf is not root)
+     * (the root leaf can't be split while the root lock is held, the other leaf - while its parent is latched)
+     * @return the write-latched leaf page
     */
-    page_id_t FindTheLeftmostChild(const BPlusTreePage* page);
+    WritePageGuard FindLeafOptimistic(const char* key, std::shared_lock<std::shared_mutex>& root_lock,
+                                    ReadPageGuard& parent_guard);
+
+    /**
+     * Log the page just allocated and filled entirely (by bulk load or on the creation of the tree).
+    */
+    void LogNewPage(WritePageGuard&& guard);
+
+    /** @return true if one more item could be inserted into the page without split */
+    static bool IsInsertSafe(const BPlusTreePage* page);
+
+    /** @return true if one item could be removed from the page without merge */
+    static bool IsRemoveSafe(const BPlusTreePage* page, bool is_root);
+
+    /** @return true if the page has too few items and should be merged or borrow items */
+    static bool IsUnderflow(const BPlusTreePage* page);
+
+    void InitLeafPage(BPlusTreeLeafPage* page) const;
+    void InitInternalPage(BPlusTreeInternalPage* page) const;
+    uint16_t GetInternalMaxSize() const;
 
 private:
     void PrintTree(std::ostream& os, const BPlusTreePage* page, page_id_t page_id) const;
 
-    void GiveBackDroppedPages();
+    /**
+     * Give back the pages dropped by the structure change along with those dropped earlier
+     * which were still pinned then. The pages which are pinned yet are kept for the next call.
+    */
+    void GiveBackDroppedPages(const std::vector<page_id_t>& dropped_pages);
 
 
 private:
     PagesManager& _pages_manager;
     const TupleCompare& _key_compare;
     uint32_t _key_size{0};
+    /** The latch of the root, it's held until the root page is latched
+     * (exclusively - when the root might be split or collapsed) */
+    mutable std::shared_mutex _root_latch;
     page_id_t _root_page_id{INVALID_PAGE_ID};
     uint16_t _leaf_max_size{0};
     uint16_t _internal_max_size{0};
-    mutable std::shared_mutex _mutex;
-    std::list<page_id_t> _dropped_pages;  // removed pages pending to give back to pages manager
+    LogManager* _log_manager{nullptr};
+    index_oid_t _index_oid{INVALID_INDEX_OID};
+    /** The pages dropped from the tree which couldn't be given back yet (still pinned by readers) */
+    std::vector<page_id_t> _dropped_pages;
+    std::mutex _dropped_pages_mutex;
 };
 
 }
@@ -1,21 +1,39 @@
 #pragma once
 
 #include <dbcore/b_plus_tree.h>
+#include <dbcore/index_iterator.h>
+#include <dbcore/key_encoder.h>
+#include <dbcore/row_spill.h>
+#include <dbcore/tuple.h>
+#include <dbcore/tuple_compare.h>
+#include <dbcore/tuple_view.h>
+
+#include <vector>
 
 namespace dbcore
 {
 
-class Tuple;
+class LogManager;
 class PagesManager;
-class TupleCompare;
 
+/**
+ * The index based on B+ tree. The keys are stored in the tree in normalized
+ * form (see KeyEncoder), so the tree pages compare them with memcmp.
+*/
 class BPlusTreeIndex final
 {
 public:
     BPlusTreeIndex(const BPlusTreeIndex&) = delete;
     BPlusTreeIndex& operator=(const BPlusTreeIndex&) = delete;
 
-    BPlusTreeIndex(PagesManager& pages_manager, const TupleCompare& key_compare, uint32_t key_size);
+    /**
+     * Create the empty index or open the existing one.
+     * @param root_page_id the root page of the existing tree, INVALID_PAGE_ID to create the new one
+     * @param log_manager the write-ahead log of the page changes, nullptr when they are not logged
+     * @param index_oid the OID of the index in the log records
+    */
+    BPlusTreeIndex(PagesManager& pages_manager, const Schema& key_schema, page_id_t root_page_id = INVALID_PAGE_ID,
+                    LogManager* log_manager = nullptr, index_oid_t index_oid = INVALID_INDEX_OID);
 
 public:
     /** Insert entry into the index
@@ -40,7 +58,93 @@ public:
     */
     bool SearchEntry(const Tuple& key, RID* result) const;
 
+    /**
+     * Search the index for a batch of keys (see BPlusTree::MultiGetValue)
+     * @param normalized_keys The normalized keys (see EncodeKey) laid out one after another
+     * @param count The number of keys
+     * @param rids The RIDs associated with the found keys
+     * @param found Whether each key is found
+     * @return the number of keys found
+    */
+    size_t MultiSearchEntry(const char* normalized_keys, size_t count, RID rids[], bool found[]) const
+    {
+        return _bplus_tree.MultiGetValue(normalized_keys, count, rids, found);
+    }
+
+    /**
+     * Scan the range of keys in ascending order.
+     * @param lo_key The lower bound of the range, nullptr when the range is not bounded below
+     * @param lo_inclusive Whether the lower bound is included into the range
+     * @param hi_key The upper bound of the range, nullptr when the range is not bounded above
+     * @param hi_inclusive Whether the upper bound is included into the range
+     * @return the iterator over the RIDs of the range
+    */
+    IndexIterator ScanRange(const Tuple* lo_key, bool lo_inclusive, const Tuple* hi_key, bool hi_inclusive) const;
+
+    /**
+     * @return the current root page of the tree
+    */
+    page_id_t GetRootPageId() const { return _bplus_tree.GetRootPageId(); }
+
+    /**
+     * Give back all of the pages of the index (see BPlusTree::GiveBackPages)
+    */
+    void GiveBackPages() { _bplus_tree.GiveBackPages(); }
+
+    /**
+     * @return the size of the normalized key
+    */
+    uint32_t GetKeySize() const { return _key_encoder.GetKeySize(); }
+
+    /**
+     * Encode the key into the normalized form in which it is stored in the index.
+     * @param key The index key
+     * @param normalized_key The buffer of GetKeySize() bytes where to write the normalized key
+    */
+    void EncodeKey(const Tuple& key, char* normalized_key) const { _key_encoder.Encode(key.GetData(), normalized_key); }
+
+    /**
+     * Encode the key attributes of the table tuple into normalized form (without building the key tuple).
+     * @param tuple The view of the table tuple
+     * @param tuple_schema The table schema
+     * @param key_attrs The positions of key attributes in the table tuple
+     * @param normalized_key The buffer of GetKeySize() bytes where to write the normalized key
+    */
+    void EncodeKey(const TupleView& tuple, const Schema& tuple_schema, const uint32_t key_attrs[], char* normalized_key) const
+    {
+        _key_encoder.Encode(tuple.GetData(), tuple_schema, key_attrs, normalized_key);
+    }
+
+    /**
+     * Sort the entries by key (the equal keys keep their order) and spill them as the new run
+     * of the bulk load (the rows of the run are the normalized keys), the entries are cleared then.
+     * It's called by a number of threads at once, each one fills its own runs.
+     * @param normalized_keys The normalized keys (see EncodeKey) laid out one after another
+     * @param rids The RIDs associated with the keys
+     * @param runs The runs where to append the new one
+     * @return false if there is no free page to spill the entries
+    */
+    bool SpillRun(std::vector<char>& normalized_keys, std::vector<RID>& rids, std::vector<RowSpill>& runs) const;
+
+    /**
+     * Build the empty index from the sorted runs (see SpillRun). The runs are merged by RunMerge
+     * (up to MAX_MERGE_FAN_IN runs at once, the more runs are merged in a number of passes),
+     * the merged entries stream into the tree which is built bottom-up in one pass.
+     * When the key is duplicated, only its first entry is indexed (as if the entries were inserted
+     * one by one, the run after run).
+     * @param runs The sorted runs, they are cleared by the merge passes
+     * @return whether all of the entries are indexed
+    */
+    bool BulkLoad(std::vector<RowSpill>& runs);
+
+public:
+    static constexpr uint32_t MAX_MERGE_FAN_IN = 16;
+
 private:
+    PagesManager& _pages_manager;
+    KeyEncoder _key_encoder;
+    /** the tree keeps the reference to comparator, so the index owns it */
+    TupleCompare _key_compare;
     BPlusTree _bplus_tree;
 };
 
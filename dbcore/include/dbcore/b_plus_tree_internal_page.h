@@ -124,12 +124,14 @@ public:
     */
     void MergeLeft(const BPlusTreeInternalPage* left_sibling);
 
+    /**
+     * @return the number of keys which fit into the page with the given key size
+    */
+    static uint32_t MaxNumItems(uint32_t key_size);
 
 private:
     uint16_t bsearch(const char* key, const TupleCompare& key_cmp) const;
 
-    static uint32_t MaxNumItems(uint32_t key_size);
-
     static constexpr uint32_t BPLUS_INTERNAL_PAGE_HEADER_SIZE = sizeof(BPlusTreePage);
     static constexpr uint32_t BPLUS_INTERNAL_PAGE_DATA_SIZE = (PAGE_SIZE - BPLUS_INTERNAL_PAGE_HEADER_SIZE);
 
@@ -44,6 +44,28 @@ protected:
     void Init(BPlusTreePageType page_type, uint32_t max_size, uint32_t key_size);
     uint32_t GetKeySize() const { return _key_size; }
 
+    /**
+     * @return true if the keys of given size are searched by SearchIntegerKeys
+    */
+    static bool IsIntegerKeySize(uint32_t key_size) { return key_size == 4 || key_size == 8; }
+
+    /**
+     * Count the sorted normalized keys (see KeyEncoder) of 4 or 8 bytes which are less than
+     * (or, when @p inclusive is set, not greater than) the given key. The keys are loaded as
+     * big-endian unsigned integers, so each probe is a single integer comparison. The search
+     * halves the range without branches and finishes with a linear probe of the last few keys,
+     * which compares them at once by AVX2 or SSE4.2 when the CPU supports it.
+     * @param keys the address of the first key
+     * @param count the number of keys
+     * @param stride the distance between adjacent keys in bytes
+     * @param key_size the size of key (4 or 8 bytes)
+     * @param key the key to search
+     * @param inclusive whether to count the keys equal to the searched one
+     * @return the number of keys less (or not greater) than the given one
+    */
+    static uint32_t SearchIntegerKeys(const char* keys, uint32_t count, uint32_t stride,
+                                    uint32_t key_size, const char* key, bool inclusive);
+
 private:
     BPlusTreePageType _page_type{BPlusTreePageType::INVALID_TYPE};
     /** the number of items in the node */
@@ -4,8 +4,11 @@
 #include <dbcore/index.h>
 
 #include <unordered_map>
-#include <string>
+#include <string_view>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace dbcore
 {
@@ -14,15 +17,28 @@ class TableInfo;
 class IndexInfo;
 class Schema;
 class PagesManager;
+class LogManager;
 
 /**
- * The Catalog class represents non-persistent catalog.
- * It handles table creation, table lookup, index creation, index lookup.
+ * The Catalog class handles table creation, table lookup, index creation, index lookup.
+ * The metadata of tables and indexes (schemas, first and last pages of tables, root pages
+ * of indexes) is kept in the chain of catalog pages, so the database is opened by reading
+ * the catalog only. The indexes are opened by their root pages (the root never moves).
+ * When the catalog was not closed cleanly (some pages might not be flushed), the write-ahead log
+ * is redone (see LogRecovery) before the tables and indexes are opened. The catalog pages are not
+ * logged: the catalog is written after the log is durable up to the changes it refers to.
+ *
+ * The lookups don't take any lock and don't allocate memory: the maps of tables and indexes
+ * make up an immutable snapshot, the readers load the raw pointer to the current one atomically
+ * and look up the names by std::string_view (the keys refer to the names kept by TableInfo/IndexInfo).
+ * While reading, the reader is counted in one of the reader slots (chosen per thread, each slot
+ * on its own cache line), so the readers of different threads rarely write the same memory.
+ * The DDL operations are serialized: they copy the snapshot, change the copy and publish it.
+ * The replaced snapshots are retired and freed by the DDL operation which finds all of the reader
+ * slots drained (or by the destructor): the readers coming after the publication see the new snapshot.
  * TO DO: 
- *        1. think about persistency (how to store/load catalog on the page and/or on the RAMCloud). 
- *        2. go away from STL-containers and string.
- *        3. current implementaion is not thread-safe.
- *        4. think how to avoid raw pointers, use wrappers with reference counting, something else.
+ *        1. keep the catalog on the RAMCloud.
+ *        2. think how to avoid raw pointers, use wrappers with reference counting, something else.
 */
 class Catalog final
 {
@@ -31,12 +47,44 @@ class Catalog final
 
 public:
     /**
-     * Create a new catalog.
+     * Create a new catalog. The first catalog page is allocated, so in a new database
+     * created by the catalog at first it is the page 0.
+     * @param pages_manager the pages manager to keep the tables and indexes
+     * @param log_manager the write-ahead log where the tables and indexes log their changes (if any)
     */
-    explicit Catalog(PagesManager* pages_manager);
+    explicit Catalog(PagesManager* pages_manager, LogManager* log_manager = nullptr);
 
+    /**
+     * Open the existing catalog, the log is redone when the catalog was not closed cleanly.
+     * @param pages_manager the pages manager which keeps the tables and indexes
+     * @param catalog_page_id the first page of the catalog (see GetCatalogPageId)
+     * @param log_manager the write-ahead log where the tables and indexes log their changes (if any)
+    */
+    Catalog(PagesManager* pages_manager, page_id_t catalog_page_id, LogManager* log_manager = nullptr);
+
+    /**
+     * Close the catalog: the pages are flushed and synced, then the catalog is marked as closed cleanly.
+     * When some page could not be written, the catalog stays unclean, so the log is redone on open.
+    */
     ~Catalog();
 
+    /**
+     * @return true if the catalog is created or opened successfully
+    */
+    bool IsOpen() const { return _catalog_page_id != INVALID_PAGE_ID; }
+
+    /**
+     * @return the first page of the catalog
+    */
+    page_id_t GetCatalogPageId() const { return _catalog_page_id; }
+
+    /**
+     * Save the current metadata (e.g. the last pages of tables and the root pages of indexes)
+     * into the catalog pages and flush them onto the storage (if any).
+     * @return false if the catalog pages could not be written
+    */
+    bool Flush();
+
     /**
      * Create a new table and return pointer to table's metadata.
      * @param table_name the name of the new table
@@ -57,7 +105,7 @@ public:
      * @param name The name of the table to query
      * @return A (non owning) pointer to the table's info 
     */
-    TableInfo* GetTable(const char* name) const;
+    TableInfo* GetTable(std::string_view name) const;
 
 
     /**
@@ -69,10 +117,14 @@ public:
      * @param key_attrbiutes The mapping of the table schema into key schema
      * @param num_of_key_attributes The number of attributes in the index key
      * @param index_type The type of the index
-     * @return A (non owning) pointer to the index's info
+     * @param num_threads The number of threads which populate the index (see Index::Populate)
+     * @param memory_budget The memory for the keys while the index is populated (see Index::Populate)
+     * @return A (non owning) pointer to the index's info, nullptr when the index could not be populated
+     * (e.g. the key is duplicated or the keys could not be spilled), its pages are given back then
     */
     IndexInfo* CreateIndex(const char* index_name, const char* table_name, const Schema& tbl_schema,
-                        uint32_t key_attributes[], uint32_t num_of_key_attributes, IndexType index_type);
+                        uint32_t key_attributes[], uint32_t num_of_key_attributes, IndexType index_type,
+                        uint32_t num_threads = 1, size_t memory_budget = Index::DEFAULT_POPULATE_MEMORY_BUDGET);
 
     /**
      * Get the index by its name and the table name.
@@ -80,7 +132,7 @@ public:
      * @param table_name The name of the table on which index is built 
      * @return A (non owning) pointer to the index's info
     */
-    IndexInfo* GetIndex(const char* index_name, const char* table_name);
+    IndexInfo* GetIndex(std::string_view index_name, std::string_view table_name) const;
 
     /**
      * Get the index by its name and the table name.
@@ -88,44 +140,130 @@ public:
      * @param table_oid The OID of the table on which index is built 
      * @return A (non owning) pointer to the index's info
     */
-    IndexInfo* GetIndex(const char* index_name, table_oid_t table_oid);
+    IndexInfo* GetIndex(std::string_view index_name, table_oid_t table_oid) const;
 
     /**
      * Get the index by its OID.
      * @param index_oid The OID of the required index
      * @return A (non owning) pointer to the index's info
     */
-    IndexInfo* GetIndex(index_oid_t index_oid);
+    IndexInfo* GetIndex(index_oid_t index_oid) const;
+
+    /**
+     * Get all of the indexes of the table.
+     * @param table_name The name of the table
+     * @return The (non owning) pointers to the indexes' info, empty when the table has no indexes
+    */
+    std::vector<IndexInfo*> GetTableIndexes(std::string_view table_name) const;
 
 
 private:
-    PagesManager* _pages_manager{nullptr};
+    /**
+     * The immutable maps of tables and indexes. The name keys refer to the names
+     * kept by the TableInfo/IndexInfo objects, which live as long as the catalog.
+    */
+    struct Snapshot
+    {
+        /** Map table identifier -> table metadata */
+        std::unordered_map<table_oid_t, TableInfo *> tables;
+        /** Map table name -> table metadata */
+        std::unordered_map<std::string_view, TableInfo *> table_names;
+        /** Map index identifier -> index metadata */
+        std::unordered_map<index_oid_t, IndexInfo *> indexes;
+        /** Map table name -> index names -> index metadata */
+        std::unordered_map<std::string_view, std::unordered_map<std::string_view, IndexInfo *>> index_names;
+    };
 
-    /** The next table identifier to be used */
-    std::atomic<table_oid_t> _next_table_oid{0};
+    /**
+     * The reference to the current snapshot: the reader is counted in its slot while the reference
+     * exists, so the snapshot isn't freed even if it's replaced meanwhile.
+    */
+    class SnapshotRef final
+    {
+        SnapshotRef(const SnapshotRef&) = delete;
+        SnapshotRef& operator=(const SnapshotRef&) = delete;
 
-    /** Map table identifier -> table metadata.
-     * The catalog is the owber of the TableInfo objects
-     * and responsible for their destruction.
+    public:
+        explicit SnapshotRef(const Catalog& catalog);
+        ~SnapshotRef();
+
+        const Snapshot& operator*() const { return *_snapshot; }
+        const Snapshot* operator->() const { return _snapshot; }
+
+    private:
+        std::atomic<uint32_t>& _num_readers;
+        const Snapshot* _snapshot{nullptr};
+    };
+
+    /** @return the reference to the current snapshot, it keeps the snapshot alive */
+    SnapshotRef GetSnapshot() const { return SnapshotRef(*this); }
+
+    /** Publish the new snapshot and retire the replaced one, the DDL mutex must be held */
+    void Publish(std::unique_ptr<Snapshot> snapshot);
+
+    /** Free the retired snapshots when no reader is counted in any slot, the DDL mutex must be held */
+    void ReclaimSnapshots();
+
+    /**
+     * Serialize the metadata into the chain of catalog pages (it's extended when needed)
+     * and flush the pages onto the storage (if any). The log is flushed at first.
+     * @param is_clean whether all of the tables and indexes pages are on the storage
+    */
+    bool Persist(bool is_clean);
+
+    /**
+     * Read the metadata from the chain of catalog pages, redo the log after unclean shutdown,
+     * open the tables and indexes.
+     * @return false if the catalog pages are broken or the log could not be redone
+    */
+    bool Load();
+
+    /**
+     * Register the created (or opened) table in the snapshot being built.
     */
-    std::unordered_map<table_oid_t, TableInfo *> _tables;
+    TableInfo* AddTable(Snapshot& snapshot, const char* table_name, const Schema& schema,
+                        TableHeap* table_heap, table_oid_t table_oid);
 
     /**
-     * Map table name -> table identifier
+     * Register the created (or opened) index in the snapshot being built.
     */
-    std::unordered_map<std::string, table_oid_t> _table_names;
+    IndexInfo* AddIndex(Snapshot& snapshot, const char* index_name, const TableInfo* table_info,
+                        const Schema& key_schema, Index* index, index_oid_t index_oid);
+
+private:
+    PagesManager* _pages_manager{nullptr};
+    LogManager* _log_manager{nullptr};
+
+    /** The first page of the catalog */
+    page_id_t _catalog_page_id{INVALID_PAGE_ID};
+    /** The pages of the catalog in order of the chain */
+    std::vector<page_id_t> _catalog_pages;
+
+    /** The next table identifier to be used */
+    std::atomic<table_oid_t> _next_table_oid{0};
 
     /** The next index identifier to be used */
     std::atomic<index_oid_t> _next_index_oid{0};
 
-    /** Map index identifier -> index metadata.
-     * The catalog is the owner of the IndexInfo objects 
+    /** The current snapshot of tables and indexes (owned by the catalog).
+     * The catalog is the owner of the TableInfo and IndexInfo objects
      * and responsible for their destruction.
-     */
-    std::unordered_map<index_oid_t, IndexInfo *> _indexes;
+    */
+    std::atomic<Snapshot *> _snapshot{nullptr};
+
+    /** The replaced snapshots which might be still read */
+    std::vector<std::unique_ptr<Snapshot>> _retired_snapshots;
+
+    /** The number of readers of the snapshots, per slot */
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint32_t> num_readers{0};
+    };
+    static constexpr uint32_t NUM_READER_SLOTS = 64;
+    mutable ReaderSlot _reader_slots[NUM_READER_SLOTS];
 
-    /** Map table name -> index names -> index identifiers */
-    std::unordered_map<std::string, std::unordered_map<std::string, index_oid_t>> _index_names;
+    /** The mutex serializes DDL operations and writing of the catalog pages */
+    std::mutex _ddl_mutex;
 };
 
 }
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+
+#include <cstdint>
+
+namespace dbcore
+{
+
+/**
+ * The page of the catalog. The catalog metadata is serialized into the chain of pages,
+ * each page keeps the next part of the serialized catalog.
+ *
+ * Page format:
+ * --------------------------------------------------
+ * | NEXT_PAGE_ID(4) | DATA_SIZE(4) | DATA(DATA_SIZE) |
+ * --------------------------------------------------
+*/
+class CatalogPage final
+{
+    CatalogPage(const CatalogPage&) = delete;
+    CatalogPage& operator=(const CatalogPage&) = delete;
+
+public:
+    /**
+     * Initialize the catalog page header.
+    */
+    void Init();
+
+    /**
+     * @return the page ID of the next catalog's page
+    */
+    page_id_t GetNextPageId() const { return _next_page_id; }
+
+    /** set the page ID of the next catalog's page */
+    void SetNextPageId(page_id_t next_page_id) { _next_page_id = next_page_id; }
+
+    /**
+     * @return the part of the serialized catalog kept by the page
+    */
+    const char* GetData() const { return _data; }
+    uint32_t GetDataSize() const { return _data_size; }
+
+    /**
+     * Copy the next part of the serialized catalog into the page.
+     * @param data the data to copy
+     * @param size the size of data
+     * @return the number of bytes copied (no more than CATALOG_PAGE_CAPACITY)
+    */
+    uint32_t SetData(const char* data, size_t size);
+
+    static constexpr uint32_t CATALOG_PAGE_HEADER_SIZE = sizeof(page_id_t) + sizeof(uint32_t);
+    static constexpr uint32_t CATALOG_PAGE_CAPACITY = PAGE_SIZE - CATALOG_PAGE_HEADER_SIZE;
+
+private:
+    page_id_t _next_page_id{INVALID_PAGE_ID};
+    uint32_t _data_size{0};
+    char _data[0];
+};
+
+}
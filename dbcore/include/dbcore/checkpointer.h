@@ -0,0 +1,66 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace dbcore
+{
+
+class PagesManager;
+
+/**
+ * Checkpointer runs the fuzzy checkpoints of the pages manager periodically in the background
+ * thread (see PagesManager::Checkpoint). The dirty pages are written while the users keep
+ * reading and modifying them, so the writes are spread over time instead of stalling at
+ * shutdown, and the recovery redoes only the part of the log after the last checkpoint.
+*/
+class Checkpointer final
+{
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+public:
+    /**
+     * Start the checkpointer thread.
+     * @param pages_manager the pages manager whose pages are checkpointed (must be backed by storage)
+     * @param interval_ms the period of checkpoints
+    */
+    explicit Checkpointer(PagesManager& pages_manager, uint32_t interval_ms = 1000);
+
+    /**
+     * Stop the checkpointer thread, the running checkpoint is completed.
+    */
+    ~Checkpointer();
+
+    /**
+     * @return the number of completed checkpoints
+    */
+    uint64_t GetNumCheckpoints() const;
+
+    /**
+     * @return the LSN of the last completed checkpoint
+    */
+    lsn_t GetCheckpointLSN() const;
+
+private:
+    /** The checkpointer thread routine */
+    void CheckpointLoop();
+
+private:
+    PagesManager& _pages_manager;
+    const uint32_t _interval_ms;
+
+    /** The mutex protects the fields below */
+    mutable std::mutex _mutex;
+    std::condition_variable _stop_cv;
+    uint64_t _num_checkpoints{0};
+    lsn_t _checkpoint_lsn{INVALID_LSN};
+    bool _stop{false};
+
+    std::thread _thread;
+};
+
+}
@@ -39,6 +39,11 @@ public:
    */
   Column(const char *name, TypeId type, uint32_t length);
 
+  /**
+   * @return column name
+  */
+  const char* GetName() const { return _name; }
+
   /**
    * @return column length
   */
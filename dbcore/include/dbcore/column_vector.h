@@ -0,0 +1,92 @@
+#pragma once
+
+#include <dbcore/column.h>
+#include <dbcore/selection_bitmap.h>
+#include <dbcore/tuple_view.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace dbcore
+{
+
+/**
+ * ColumnVector holds the values of one fixed-width column of a batch of rows
+ * as the dense array of native values (int8_t, int16_t, int32_t, int64_t or uint64_t,
+ * the same ones TupleCompare uses), so the kernels process them without Value objects.
+ * The values are decoded straight from the tuples' data at the column's offset.
+ * The storage is reused from batch to batch.
+*/
+class ColumnVector final
+{
+    ColumnVector(const ColumnVector&) = delete;
+    ColumnVector& operator=(const ColumnVector&) = delete;
+
+public:
+    ColumnVector() = default;
+    ColumnVector(ColumnVector&&) = default;
+    ColumnVector& operator=(ColumnVector&&) = default;
+
+    /**
+     * @return true if the values of the column can be decoded into the vector
+    */
+    static bool IsSupported(const Column& column) { return column.IsInlined() && column.GetType() != TypeId::INVALID; }
+
+    /**
+     * Decode the column of all of the rows.
+     * @param column the column (of the rows' schema) to decode
+     * @param rows the rows
+     * @param num_rows the number of rows
+    */
+    void Load(const Column& column, const TupleView rows[], uint32_t num_rows);
+
+    /**
+     * Decode the column of the selected rows only (they are packed densely in order).
+     * @param column the column (of the rows' schema) to decode
+     * @param rows the rows
+     * @param selection the selected rows
+    */
+    void Gather(const Column& column, const TupleView rows[], const SelectionBitmap& selection);
+
+    TypeId GetType() const { return _type; }
+
+    /**
+     * @return the number of values
+    */
+    uint32_t GetSize() const { return _size; }
+
+    /**
+     * @return the values as the array of native type T (it has to match the column type)
+    */
+    template <typename T>
+    const T* GetData() const
+    {
+        assert(sizeof(T) == _value_size);
+        return reinterpret_cast<const T*>(_data.data());
+    }
+
+    /**
+     * @return the bytes of values (GetSize() values of the column's storage size each)
+    */
+    const char* GetRawData() const { return reinterpret_cast<const char*>(_data.data()); }
+
+private:
+    /** Set the type and make the room for the given number of values */
+    void Prepare(const Column& column, uint32_t num_values);
+
+    template <typename T>
+    void Decode(uint32_t offset, const TupleView rows[], uint32_t num_rows);
+
+    template <typename T>
+    void DecodeSelected(uint32_t offset, const TupleView rows[], const SelectionBitmap& selection);
+
+private:
+    TypeId _type{TypeId::INVALID};
+    uint32_t _value_size{0};
+    uint32_t _size{0};
+    /** The values (the storage is aligned for the widest native type) */
+    std::vector<uint64_t> _data;
+};
+
+}
@@ -14,11 +14,21 @@ using page_id_t = int32_t;
 
 static constexpr page_id_t INVALID_PAGE_ID = -1;
 
+using frame_id_t = int32_t;
+
+static constexpr frame_id_t INVALID_FRAME_ID = -1;
+
 static constexpr uint32_t PAGE_SIZE = 16384;
 
 static constexpr uint32_t MAX_COLUMN_COUNT = 32;
 
 
+/** The log sequence number: the offset in the log file just past the end of the log record */
+using lsn_t = uint64_t;
+
+static constexpr lsn_t INVALID_LSN = 0;
+
+
 using slot_offset_t = uint16_t;
 
 static constexpr slot_offset_t INVALID_SLOT_OFFSET = std::numeric_limits<slot_offset_t>::max();
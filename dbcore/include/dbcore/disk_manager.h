@@ -0,0 +1,81 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+
+namespace dbcore
+{
+
+/**
+ * DiskManager takes care of reading and writing pages to/from a database file.
+ * Page with ID `n` is stored at the offset `n * PAGE_SIZE` of the file.
+ * The reads/writes are positional, so the single instance can be shared between threads.
+*/
+class DiskManager final
+{
+    DiskManager(const DiskManager&) = delete;
+    DiskManager& operator=(const DiskManager&) = delete;
+
+public:
+    /**
+     * Open (or create when it doesn't exist) the database file.
+     * @param file_name the name of database file
+    */
+    explicit DiskManager(const char* file_name);
+
+    ~DiskManager();
+
+    /**
+     * @return true if the database file is opened successfully
+    */
+    bool IsOpen() const { return _fd != -1; }
+
+    /**
+     * Read the content of a page from the database file.
+     * The part of the page which is beyond the end of file is filled with zeroes.
+     * @param page_id id of the page to read
+     * @param[out] data the buffer of PAGE_SIZE bytes where to write the page content
+     * @return true if the page is read successfully, false otherwise
+    */
+    bool ReadPage(page_id_t page_id, char* data);
+
+    /**
+     * Write the content of a page into the database file.
+     * @param page_id id of the page to write
+     * @param data the buffer of PAGE_SIZE bytes with the page content
+     * @return true if the page is written successfully, false otherwise
+    */
+    bool WritePage(page_id_t page_id, const char* data);
+
+    /**
+     * Write the content of adjacent pages into the database file by the single write.
+     * @param first_page_id id of the first page to write
+     * @param data the buffer of num_pages * PAGE_SIZE bytes with the pages content
+     * @param num_pages the number of pages to write
+     * @return true if the pages are written successfully, false otherwise
+    */
+    bool WritePages(page_id_t first_page_id, const char* data, uint32_t num_pages);
+
+    /**
+     * Flush the written data onto the storage device.
+     * @return true on success, false otherwise
+    */
+    bool Sync();
+
+    /**
+     * Advise the OS to read the page ahead, so the following ReadPage doesn't wait for the device.
+     * @param page_id the ID of the page
+     * @return false if the advice is not accepted
+    */
+    bool Prefetch(page_id_t page_id);
+
+    /**
+     * @return the number of pages stored in the database file
+    */
+    uint32_t GetNumPages() const;
+
+private:
+    /** The descriptor of the database file */
+    int _fd{-1};
+};
+
+}
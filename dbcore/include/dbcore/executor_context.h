@@ -0,0 +1,40 @@
+#pragma once
+
+#include <dbcore/catalog.h>
+
+namespace dbcore
+{
+
+class PagesManager;
+
+/**
+ * ExecutorContext is the state shared by the executors of a query, e.g. the catalog
+ * by which they find the tables and indexes and the pages manager where they spill
+ * the data which doesn't fit into their memory budget.
+*/
+class ExecutorContext final
+{
+    ExecutorContext(const ExecutorContext&) = delete;
+    ExecutorContext& operator=(const ExecutorContext&) = delete;
+
+public:
+    /**
+     * @param catalog the catalog of the tables and indexes
+     * @param pages_manager the pages manager for the temporary pages, nullptr when the executors don't spill
+    */
+    explicit ExecutorContext(Catalog& catalog, PagesManager* pages_manager = nullptr)
+        : _catalog(catalog)
+        , _pages_manager(pages_manager)
+    {
+    }
+
+    Catalog& GetCatalog() { return _catalog; }
+
+    PagesManager* GetPagesManager() { return _pages_manager; }
+
+private:
+    Catalog& _catalog;
+    PagesManager* _pages_manager{nullptr};
+};
+
+}
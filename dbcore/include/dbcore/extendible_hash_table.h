@@ -2,12 +2,12 @@
 
 #include <dbcore/coretypes.h>
 
-#include <shared_mutex>
-
 namespace dbcore
 {
 
+class LogManager;
 class PagesManager;
+class PageChangeLog;
 class TupleCompare;
 class TupleHash;
 class RID;
@@ -20,6 +20,11 @@ class ExtendibleHTableBucketPage;
  * Implementation of extendible hash table whichis backed by pages manager.
  * Non-unique keys are not supported. Support insert and delete. The table 
  * grows/shrinks dynamically as buckets become full/empty.
+ * The pages are latched in order header -> directory -> bucket. Point operations latch
+ * the directory for read and only the bucket for write (or read). The directory is
+ * latched for write only when a bucket is created, split or merged.
+ * The changes of pages are logged (see PageChangeLog) while the pages are latched,
+ * one record per insert or remove, so the split of a bucket is redone as a whole.
 */
 class ExtendibleHashTable final
 {
@@ -36,10 +41,15 @@ public:
      * @param header_max_depth the maximal depth allowed for the header page (0 means that page will be initialized with its default value)
      * @param directory_max_depth the maximal depth allowed for the directory page (0 means that page will be initialized with its default value)
      * @param bucket_max_size the maximal size allowed for the bucket page array (0 means that page will be initialized with its default value)
+     * @param header_page_id the header page of the existing table, INVALID_PAGE_ID to create the new one
+     * @param log_manager the write-ahead log of the page changes, nullptr when they are not logged
+     * @param index_oid the OID of the index in the log records
     */
     ExtendibleHashTable(PagesManager& pages_manager, const TupleCompare& tuple_compare, 
                         const TupleHash& tuple_hash, const uint32_t key_size, 
-                        uint32_t header_max_depth = 0, uint32_t directory_max_depth = 0, uint32_t bucket_max_size = 0);
+                        uint32_t header_max_depth = 0, uint32_t directory_max_depth = 0, uint32_t bucket_max_size = 0,
+                        page_id_t header_page_id = INVALID_PAGE_ID,
+                        LogManager* log_manager = nullptr, index_oid_t index_oid = INVALID_INDEX_OID);
 
     ~ExtendibleHashTable();
 
@@ -65,6 +75,19 @@ public:
      * @return true if the key was found and value assigned, false otherwise
     */
     bool GetValue(const char* key, RID& rid) const;
+
+    /**
+     * Get the values associated with a batch of keys. The header page is latched once
+     * for the whole batch, the probes are grouped by directory page and then by bucket page,
+     * so each page is latched once per batch. The next bucket page is latched and prefetched
+     * while the keys of the current one are looked up.
+     * @param keys the keys to look up, laid out one after another (in any order)
+     * @param count the number of keys
+     * @param[out] rids the values associated with the keys (assigned only to the found ones)
+     * @param[out] found whether each key is found
+     * @return the number of keys found
+    */
+    size_t MultiGetValue(const char* keys, size_t count, RID rids[], bool found[]) const;
     
     /**
      * Helper function to verify integrity of the extendible hash table directory
@@ -72,18 +95,43 @@ public:
     */
     bool VerifyIntegrity() const;
 
+    /**
+     * Give back all of the pages of the table, the header page included (e.g. when the index could not be built).
+     * Nobody else must use the table, it's only destroyed after the call.
+    */
+    void GiveBackPages();
+
+    /**
+     * @return the header page of the table (it's never changed)
+    */
+    page_id_t GetHeaderPageId() const { return _header_page_id; }
+
 private:
-    bool InsertToNewDirectory(ExtendibleHTableHeaderPage *header, uint32_t directory_idx,
-                            uint32_t hash, const char* key, const RID& rid);
-    
+    /**
+     * Lookup the directory page matching the hash, the header page is latched for read only.
+     * @return the directory page id or INVALID_PAGE_ID when there is no directory yet
+    */
+    page_id_t FindDirectoryPageId(uint32_t hash) const;
+
+    /**
+     * Lookup the directory page matching the hash. When there is no directory yet,
+     * the header page is latched for write and the directory is created.
+     * @return the directory page id
+    */
+    page_id_t FindOrCreateDirectoryPageId(uint32_t hash);
+
+    /**
+     * Insert into bucket. The directory page should be latched for write by the caller.
+     * @param changes the log of the page changes, it keeps the buckets latched until it's appended
+    */
     bool InsertToNewBucket(ExtendibleHTableDirectoryPage *directory, uint32_t bucket_idx,
-                            const char* key, const RID& rid);
+                            const char* key, const RID& rid, PageChangeLog& changes);
 
     void UpdateDirectoryMapping(ExtendibleHTableDirectoryPage *directory, uint32_t new_bucket_idx,
                                 page_id_t new_bucket_page_id, uint32_t new_local_depth);
 
     bool InsertToBucket(ExtendibleHTableBucketPage *bucket, ExtendibleHTableDirectoryPage *directory,
-                        uint32_t bucket_idx, const char* key, const RID& rid);
+                        uint32_t bucket_idx, const char* key, const RID& rid, PageChangeLog& changes);
 
 
 private:
@@ -95,7 +143,8 @@ private:
     uint32_t _directory_max_depth{0};
     uint32_t _bucket_max_size{0};
     page_id_t _header_page_id{INVALID_PAGE_ID};
-    mutable std::shared_mutex _mutex;
+    LogManager* _log_manager{nullptr};
+    index_oid_t _index_oid{INVALID_INDEX_OID};
 };
 
 }
@@ -1,14 +1,14 @@
 #pragma once
 
 #include <dbcore/extendible_hash_table.h>
+#include <dbcore/tuple_compare.h>
+#include <dbcore/tuple_hash.h>
 
 namespace dbcore
 {
 
 class Tuple;
 class PagesManager;
-class TupleCompare;
-class TupleHash;
 
 class ExtendibleHashTableIndex final
 {
@@ -16,8 +16,15 @@ public:
     ExtendibleHashTableIndex(const ExtendibleHashTableIndex&) = delete;
     ExtendibleHashTableIndex& operator=(const ExtendibleHashTableIndex&) = delete;
 
+    /**
+     * Create the empty index or open the existing one.
+     * @param header_page_id the header page of the existing table, INVALID_PAGE_ID to create the new one
+     * @param log_manager the write-ahead log of the page changes, nullptr when they are not logged
+     * @param index_oid the OID of the index in the log records
+    */
     ExtendibleHashTableIndex(PagesManager& pages_manager, const TupleCompare& key_compare, 
-                            const TupleHash& key_hash, uint32_t key_size);
+                            const TupleHash& key_hash, uint32_t key_size, page_id_t header_page_id = INVALID_PAGE_ID,
+                            LogManager* log_manager = nullptr, index_oid_t index_oid = INVALID_INDEX_OID);
 
 public:
     /** Insert entry into the index
@@ -42,7 +49,33 @@ public:
     */
     bool SearchEntry(const Tuple& key, RID* result) const;
 
+    /**
+     * Search the index for a batch of keys (see ExtendibleHashTable::MultiGetValue)
+     * @param keys The data of index keys laid out one after another
+     * @param count The number of keys
+     * @param rids The RIDs associated with the found keys
+     * @param found Whether each key is found
+     * @return the number of keys found
+    */
+    size_t MultiSearchEntry(const char* keys, size_t count, RID rids[], bool found[]) const
+    {
+        return _hash_table.MultiGetValue(keys, count, rids, found);
+    }
+
+    /**
+     * @return the header page of the hash table
+    */
+    page_id_t GetHeaderPageId() const { return _hash_table.GetHeaderPageId(); }
+
+    /**
+     * Give back all of the pages of the index (see ExtendibleHashTable::GiveBackPages)
+    */
+    void GiveBackPages() { _hash_table.GiveBackPages(); }
+
 private:
+    /** the table keeps the references to comparator and hash function, so the index owns them */
+    TupleCompare _key_compare;
+    TupleHash _key_hash;
     ExtendibleHashTable _hash_table;
 };
 
@@ -21,7 +21,7 @@ public:
 
     /**
      * Initialize a new directory page after creation with pages manger.
-     * @param max_depth the max depth of the directory page
+     * @param max_depth the max depth of the directory page (0 means the default HTABLE_DIRECTORY_MAX_DEPTH)
     */
     void Init(uint32_t max_depth);
 
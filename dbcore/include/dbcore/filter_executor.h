@@ -0,0 +1,38 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+#include <dbcore/selection_bitmap.h>
+#include <dbcore/vector_predicate.h>
+
+#include <memory>
+
+namespace dbcore
+{
+
+/**
+ * FilterExecutor produces the rows of the child which satisfy the predicate.
+ * The predicate is evaluated over the whole batch of the child (see VectorPredicate),
+ * the selected views are passed on, the batches which have no selected rows are skipped.
+*/
+class FilterExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * @param child the executor which produces the rows to filter
+     * @param predicate the predicate over the rows of the child's schema
+    */
+    FilterExecutor(std::unique_ptr<AbstractExecutor> child, std::unique_ptr<VectorPredicate> predicate);
+
+    void Init() override;
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override { return _child->GetOutputSchema(); }
+    bool HasFailed() const override { return _child->HasFailed(); }
+
+private:
+    std::unique_ptr<AbstractExecutor> _child;
+    std::unique_ptr<VectorPredicate> _predicate;
+    std::vector<TupleView> _child_batch;
+    SelectionBitmap _selection;
+};
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dbcore
+{
+
+/**
+ * FreeSpaceMap keeps track of the table pages which have free space for the new tuples.
+ * The pages are grouped into buckets by the amount of free space, so the page which fits
+ * the tuple is found without looking at the pages. The map is a hint: it's kept in memory
+ * (and filled again after the table is opened, see TableHeap::CollectFreeSpace),
+ * the page itself decides whether the tuple fits.
+ * The inserters of different threads are given the different pages (when there are several
+ * suitable ones), so they don't contend for the same page.
+*/
+class FreeSpaceMap final
+{
+    FreeSpaceMap(const FreeSpaceMap&) = delete;
+    FreeSpaceMap& operator=(const FreeSpaceMap&) = delete;
+
+public:
+    FreeSpaceMap();
+
+    /**
+     * Set the free space of the page (the page is added to the map when it isn't there yet).
+     * @param page_id the ID of the table page
+     * @param free_space the size of the largest tuple which can be inserted into the page
+    */
+    void Update(page_id_t page_id, uint32_t free_space);
+
+    /**
+     * Find the page which has the free space for the tuple.
+     * @param size the size of the tuple
+     * @param hint the value which spreads the callers across the suitable pages (e.g. thread ID hash)
+     * @return the ID of the page or INVALID_PAGE_ID when there is no such page
+    */
+    page_id_t FindPage(uint32_t size, size_t hint) const;
+
+    /**
+     * @return the number of pages in the map
+    */
+    size_t GetNumPages() const;
+
+public:
+    static constexpr uint32_t FSM_NUM_BUCKETS = 64;
+    /** The bucket N keeps the pages which have at least N * FSM_BUCKET_SIZE bytes of free space */
+    static constexpr uint32_t FSM_BUCKET_SIZE = PAGE_SIZE / FSM_NUM_BUCKETS;
+
+private:
+    /** The position of the page in the map */
+    struct PageEntry
+    {
+        uint32_t _bucket;
+        uint32_t _index;
+    };
+
+    /** The mutex protects the fields below */
+    mutable std::mutex _mutex;
+    std::vector<std::vector<page_id_t>> _buckets;
+    std::unordered_map<page_id_t, PageEntry> _pages;
+};
+
+}
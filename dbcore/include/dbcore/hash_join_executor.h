@@ -0,0 +1,124 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+#include <dbcore/join_hash_table.h>
+#include <dbcore/join_row_builder.h>
+#include <dbcore/key_encoder.h>
+#include <dbcore/row_spill.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace dbcore
+{
+
+/**
+ * HashJoinExecutor produces the rows of the inner equi-join of two children:
+ * the columns of the build (left) row followed by the columns of the probe (right) row.
+ * The join keys are normalized (see KeyEncoder), so the key columns of both sides must have
+ * the same types. VARCHAR keys are hashed and compared by the prefix of declared length, as in the indexes,
+ * so the VARCHAR key columns of the found rows are compared by their full values (see Tuple::CompareKeys).
+ *
+ * The build child is drained into the JoinHashTable (radix-partitioned, open addressing),
+ * then the probe child is pulled batch by batch: the keys and hashes of the whole batch are computed,
+ * the slots are prefetched, then the rows are probed.
+ *
+ * When the build side exceeds the memory budget, the join becomes the grace hash join:
+ * both sides are partitioned by the hash into the spills (see RowSpill) in the pages of
+ * the PagesManager, then each pair of partitions is joined in memory. The partitions are
+ * assumed to fit into the budget (they are not partitioned recursively).
+ * Without the pages manager (see ExecutorContext) the join is always in memory.
+ * When there is no free page to spill the rows, the join fails (see HasFailed) and produces no rows.
+*/
+class HashJoinExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * @param context the context of the query
+     * @param build the executor of the build (left) side, it should be the smaller one
+     * @param probe the executor of the probe (right) side
+     * @param build_key_attrs the key columns of the build side's schema
+     * @param probe_key_attrs the key columns of the probe side's schema
+     * @param num_keys the number of key columns
+     * @param memory_budget the memory for the build side, it spills when the budget is exceeded
+    */
+    HashJoinExecutor(ExecutorContext& context, std::unique_ptr<AbstractExecutor> build, std::unique_ptr<AbstractExecutor> probe,
+                     const uint32_t build_key_attrs[], const uint32_t probe_key_attrs[], uint32_t num_keys,
+                     size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+
+    /**
+     * @return true if the key columns of both sides can be joined
+    */
+    static bool IsSupported(const Schema& build_schema, const uint32_t build_key_attrs[],
+                            const Schema& probe_schema, const uint32_t probe_key_attrs[], uint32_t num_keys);
+
+    void Init() override;
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override { return _row_builder.GetOutputSchema(); }
+    bool HasFailed() const override { return _failed || _build->HasFailed() || _probe->HasFailed(); }
+
+    /**
+     * @return true if the build side was spilled (by the last Init)
+    */
+    bool IsSpilled() const { return !_build_spills.empty(); }
+
+public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+    static constexpr uint32_t GRACE_PARTITION_BITS = 5;
+
+private:
+    /** Drain the build child into the table (or into the spills), false if the rows could not be spilled */
+    bool BuildSide();
+
+    /** Move the rows of the table into the spills (the join becomes the grace hash join), false on failure */
+    bool Spill();
+
+    /** Partition the probe child into the spills, false if the rows could not be spilled */
+    bool SpillProbeSide();
+
+    /** Join the probe rows with the table, the joined rows are appended to the row builder */
+    void ProbeBatch(const std::vector<TupleView>& rows);
+
+    /** Load the next pair of partitions of the grace hash join, false when there are no more */
+    bool NextPartition();
+
+    /** @return the hash of the normalized key */
+    uint32_t HashKey(const char* key) const;
+
+    static uint32_t GracePartition(uint32_t hash) { return (hash * 0x9E3779B1u) >> (32 - GRACE_PARTITION_BITS); }
+
+private:
+    ExecutorContext& _context;
+    std::unique_ptr<AbstractExecutor> _build;
+    std::unique_ptr<AbstractExecutor> _probe;
+    std::array<uint32_t, MAX_COLUMN_COUNT> _build_key_attrs;
+    std::array<uint32_t, MAX_COLUMN_COUNT> _probe_key_attrs;
+    /** The VARCHAR key columns of both sides, which are rechecked on match */
+    std::array<uint32_t, MAX_COLUMN_COUNT> _build_varchar_attrs;
+    std::array<uint32_t, MAX_COLUMN_COUNT> _probe_varchar_attrs;
+    uint32_t _num_varchar_keys{0};
+    KeyEncoder _build_encoder;
+    KeyEncoder _probe_encoder;
+    const size_t _memory_budget;
+
+    JoinHashTable _table;
+    JoinRowBuilder _row_builder;
+    std::vector<TupleView> _child_batch;
+    /** The keys and hashes of the probe batch */
+    std::vector<char> _probe_keys;
+    std::vector<uint32_t> _probe_hashes;
+
+    /** The partitions of the grace hash join (empty when the join is in memory) */
+    std::vector<RowSpill> _build_spills;
+    std::vector<RowSpill> _probe_spills;
+    /** The partition being joined (if any) and the next page of its probe spill */
+    uint32_t _partition{0};
+    bool _has_partition{false};
+    /** Whether the rows could not be spilled (by the last Init) */
+    bool _failed{false};
+    size_t _probe_page{0};
+    ReadPageGuard _probe_page_guard;
+};
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <dbcore/coretypes.h>
+#include <dbcore/index_iterator.h>
 #include <dbcore/schema.h>
 
 #include <array>
@@ -12,6 +13,9 @@ namespace dbcore
 class Tuple;
 class RID;
 class PagesManager;
+class TableHeap;
+class TupleView;
+class LogManager;
 
 enum class IndexType { BPlusTreeIndex, HashTableIndex };
 
@@ -55,7 +59,18 @@ class Index
     Index& operator=(const Index&) = delete;
 
 public:
-    Index(IndexType type, const IndexMetadata& metadata, PagesManager& pages_manager);
+    /**
+     * Create the index.
+     * @param type The type of the index
+     * @param metadata The index metadata
+     * @param pages_manager The pages manager to keep the index pages
+     * @param log_manager The write-ahead log where to log the index changes, nullptr when they are not logged
+     * @param index_oid The OID of the index which identifies it in the log records
+     * @param root_page_id The root page of the existing index (see GetRootPageId), INVALID_PAGE_ID to create the new one
+    */
+    Index(IndexType type, const IndexMetadata& metadata, PagesManager& pages_manager,
+        LogManager* log_manager = nullptr, index_oid_t index_oid = INVALID_INDEX_OID,
+        page_id_t root_page_id = INVALID_PAGE_ID);
 
     ~Index();
 
@@ -81,13 +96,94 @@ public:
     */
     bool SearchEntry(const Tuple& tuple, RID* result) const;
 
-    /* TO DO: 
-      implement ScanKey method which will populate the provided 
-      array of RID, if more than one is matching a given key.
-      instead of ScanKey (or in additional) implement methods
-      to iterate from the begining/from the given RID to the end 
-      of index, will require design and implementation IndexIterator.
+    /**
+     * @return the size of the search key (see MakeSearchKey)
+    */
+    uint32_t GetSearchKeySize() const;
+
+    /**
+     * Make the key to search by the tuple of any schema (e.g. the row of the other table in the join).
+     * The key is written into the given buffer, so the buffer can be reused from key to key.
+     * The key attributes must have the types of the index key schema (see IsSearchKeySupported).
+     * @param tuple The view of the tuple
+     * @param tuple_schema The schema of the tuple
+     * @param key_attrs The positions of the key attributes in the tuple
+     * @param key The buffer of GetSearchKeySize() bytes where to write the key
+    */
+    void MakeSearchKey(const TupleView& tuple, const Schema& tuple_schema, const uint32_t key_attrs[], char* key) const;
+
+    /**
+     * @return whether the search key can be made of the given attributes of the tuple schema
+    */
+    bool IsSearchKeySupported(const Schema& tuple_schema, const uint32_t key_attrs[], uint32_t key_attr_count) const;
+
+    /**
+     * Search the index for a batch of keys. The B+ tree index probes the keys in ascending order,
+     * so the keys of the same leaf (e.g. the sorted ones) share one descent and one latch of the leaf.
+     * The hash table index latches each of its pages once per batch.
+     * VARCHAR keys are compared by the prefix of declared length (see KeyEncoder).
+     * @param keys The search keys (see MakeSearchKey) laid out one after another
+     * @param count The number of keys
+     * @param rids The RIDs associated with the found keys
+     * @param found Whether each key is found
+     * @return the number of keys found
+    */
+    size_t MultiSearchEntry(const char* keys, size_t count, RID rids[], bool found[]) const;
+
+    /**
+     * Populate the empty index with the entries of all tuples of the table.
+     * The table is split into ranges of pages, each range is scanned by its own thread.
+     * The B+ tree index collects the keys of each range, sorts and spills them into the pages
+     * (see RowSpill) when the range's share of the memory budget is exceeded, so the table might be
+     * larger than the memory. The sorted runs are merged and the tree is built bottom-up from
+     * the merged keys as they come. The other indexes insert the entries concurrently.
+     * The changes of the index pages are logged as those of any other insert.
+     * @param table_heap The table on which the index is built
+     * @param num_threads The number of threads which build the index
+     * @param memory_budget The memory for the keys of the B+ tree index, they are spilled when it's exceeded
+     * @return whether all of the entries are indexed (e.g. the keys are unique and the runs are spilled)
+    */
+    bool Populate(TableHeap& table_heap, uint32_t num_threads = 1, size_t memory_budget = DEFAULT_POPULATE_MEMORY_BUDGET);
+
+    /**
+     * Scan the range of keys in ascending order. The bounds are given by the tuples of
+     * the table (as for the other methods), the key is made of them by the key attributes.
+     * The RIDs are read from the returned iterator one by one or in batches (IndexIterator::Next).
+     * Only B+ tree index supports range scan, for the other indexes the range is empty.
+     * VARCHAR keys are compared by the prefix of declared length (see KeyEncoder),
+     * so the caller should recheck the bounds of such keys on the tuples.
+     * @param lo The lower bound of the range, nullptr when the range is not bounded below
+     * @param lo_inclusive Whether the lower bound is included into the range
+     * @param hi The upper bound of the range, nullptr when the range is not bounded above
+     * @param hi_inclusive Whether the upper bound is included into the range
+     * @return the iterator over the RIDs of the range
     */
+    IndexIterator ScanRange(const Tuple* lo, bool lo_inclusive, const Tuple* hi, bool hi_inclusive) const;
+
+    /**
+     * @return whether the index supports range scan (see ScanRange)
+    */
+    bool SupportsRangeScan() const { return _type == IndexType::BPlusTreeIndex; }
+
+    /**
+     * @return the page by which the index is opened again: the root page of B+ tree
+     * or the header page of hash table (both of them never change)
+    */
+    page_id_t GetRootPageId() const;
+
+    /**
+     * Give back all of the pages of the index, e.g. when it could not be populated.
+     * Nobody else must use the index, it's only destroyed after the call.
+    */
+    void GiveBackPages();
+
+    /**
+     * @return the index metadata
+    */
+    const IndexMetadata& GetMetadata() const { return _metadata; }
+
+public:
+    static constexpr size_t DEFAULT_POPULATE_MEMORY_BUDGET = 64 * 1024 * 1024;
 
 public:
     /** The type of the index */
@@ -102,6 +198,12 @@ public:
      * to avoid virtual functions and dynamic polymorphism.
     */
     void *_pimpl{nullptr};
+
+    /** The write-ahead log (non owning pointer), nullptr when the changes are not logged */
+    LogManager *_log_manager{nullptr};
+
+    /** The OID of the index in the log records */
+    index_oid_t _index_oid{INVALID_INDEX_OID};
 };
 
 }
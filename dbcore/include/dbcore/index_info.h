@@ -20,6 +20,16 @@ public:
 
     ~IndexInfo();
 
+    const char* GetName() const { return _name; }
+
+    const char* GetTableName() const { return _table_name; }
+
+    const Schema& GetKeySchema() const { return _schema; }
+
+    index_oid_t GetIndexOid() const { return _index_oid; }
+
+    Index* GetIndex() { return _index; }
+
 private:
     /** The schema for the index key */
     Schema _schema;
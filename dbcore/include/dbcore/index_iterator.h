@@ -1,25 +1,67 @@
 #pragma once
 
+#include <dbcore/b_plus_tree.h>
+#include <dbcore/key_encoder.h>
 #include <dbcore/rid.h>
 
+#include <array>
+#include <cstddef>
+#include <optional>
+
 namespace dbcore
 {
 
+/**
+ * The iterator over the RIDs of an index range scan (see Index::ScanRange).
+ * The iterator walks the leaves of B+ tree by sibling links and stops at the upper
+ * bound of the range. The leaf which is currently scanned is latched for read,
+ * so the iterator should not be kept longer than needed.
+ * The default constructed iterator is at the end (the range is empty).
+*/
 class IndexIterator final
 {
+    IndexIterator(const IndexIterator&) = delete;
+    IndexIterator& operator=(const IndexIterator&) = delete;
+
 public:
     IndexIterator() = default;
     ~IndexIterator() = default;
 
+    IndexIterator(IndexIterator&& other) = default;
+
+    /**
+     * Construct the iterator of B+ tree range.
+     * @param itr the iterator at the first key of the range (the lower bound is already applied)
+     * @param hi_key the normalized upper bound of the range, nullptr when the range is not bounded above
+     * @param key_size the size of normalized key
+     * @param hi_inclusive whether the upper bound is included into the range
+    */
+    IndexIterator(BPlusTree::Iterator&& itr, const char* hi_key, uint32_t key_size, bool hi_inclusive);
+
     bool IsEnd() const;
 
-    const RID& operator*() const;
+    RID operator*() const;
 
     IndexIterator& operator++();
 
-    bool operator==(const IndexIterator& other) const;
-    bool operator!=(const IndexIterator& other) const;
+    /**
+     * Write RIDs of the range into the caller's buffer and advance the iterator past them.
+     * @param rids the buffer where to write RIDs
+     * @param max_count the capacity of the buffer
+     * @return the number of RIDs written, less than max_count only when the end of range is reached
+    */
+    size_t Next(RID rids[], size_t max_count);
+
+private:
+    /** Move to the end when the current key is beyond the upper bound */
+    void CheckUpperBound();
 
+private:
+    std::optional<BPlusTree::Iterator> _itr;
+    std::array<char, MAX_NORMALIZED_KEY_SIZE> _hi_key;
+    uint32_t _key_size{0};
+    bool _has_hi_key{false};
+    bool _hi_inclusive{false};
 };
 
 }
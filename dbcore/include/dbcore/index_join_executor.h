@@ -0,0 +1,74 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+#include <dbcore/coretypes.h>
+#include <dbcore/join_row_builder.h>
+#include <dbcore/rid.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace dbcore
+{
+
+class IndexInfo;
+class TableInfo;
+
+/**
+ * IndexJoinExecutor (the index nested-loop join) produces the rows of the inner equi-join
+ * of the outer child with the table of the index: the columns of the outer row followed by
+ * the columns of the table row. The index keys are unique, so each outer row has one match at most.
+ *
+ * The outer child is pulled batch by batch. The search keys of the whole batch are made into
+ * the buffer which is reused from batch to batch, then the index is searched for all of them
+ * at once (see Index::MultiSearchEntry): the B+ tree shares the leaves among the keys of the batch,
+ * so the outer rows sorted by key descend to each leaf about once. The found rows are fetched
+ * from the table, the consecutive rows of the same page share the page latch.
+ * The index compares VARCHAR keys by the prefix of declared length (see KeyEncoder), so the VARCHAR
+ * key columns of the found rows are compared with the outer rows by their full values (see Tuple::CompareKeys).
+*/
+class IndexJoinExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * @param context the context of the query
+     * @param outer the executor of the outer side
+     * @param index_oid the OID of the index to search
+     * @param outer_key_attrs the columns of the outer schema which make the index key
+     * @param num_keys the number of key columns (the same as the index has)
+    */
+    IndexJoinExecutor(ExecutorContext& context, std::unique_ptr<AbstractExecutor> outer, index_oid_t index_oid,
+                      const uint32_t outer_key_attrs[], uint32_t num_keys);
+
+    void Init() override;
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override { return _row_builder.GetOutputSchema(); }
+    bool HasFailed() const override { return _outer->HasFailed(); }
+
+private:
+    /** Join the outer rows with the table, the joined rows are appended to the row builder */
+    void ProbeBatch(const std::vector<TupleView>& rows);
+
+private:
+    std::unique_ptr<AbstractExecutor> _outer;
+    IndexInfo* _index_info{nullptr};
+    TableInfo* _table_info{nullptr};
+    std::array<uint32_t, MAX_COLUMN_COUNT> _key_attrs;
+    /** The VARCHAR key columns of the outer rows and of the table rows, which are rechecked on match */
+    std::array<uint32_t, MAX_COLUMN_COUNT> _outer_varchar_attrs;
+    std::array<uint32_t, MAX_COLUMN_COUNT> _table_varchar_attrs;
+    uint32_t _num_varchar_keys{0};
+    uint32_t _key_size{0};
+    JoinRowBuilder _row_builder;
+
+    /** The rows of the outer child */
+    std::vector<TupleView> _outer_batch;
+    /** The search keys of the batch, the found RIDs and whether each key is found */
+    std::vector<char> _keys;
+    std::vector<RID> _rids;
+    std::unique_ptr<bool[]> _found;
+    size_t _found_capacity{0};
+};
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+#include <dbcore/coretypes.h>
+#include <dbcore/index_iterator.h>
+#include <dbcore/rid.h>
+#include <dbcore/tuple.h>
+
+#include <optional>
+
+namespace dbcore
+{
+
+class IndexInfo;
+class TableInfo;
+
+/**
+ * IndexScanExecutor produces the rows of the table found by the index: the rows of the key range
+ * in ascending order of keys (B+ tree index only) or the row of the key (any index).
+ * The RIDs are read from the index in batches, then the rows are fetched from the table
+ * (the consecutive RIDs of the same page share the page latch). The rows are spread over
+ * the pages, so they are copied into the buffer of the executor, which is reused from batch to batch.
+ * Like Index::ScanRange the bounds are given by the tuples of the table.
+ * The index compares VARCHAR keys by the prefix of declared length, so the rows of such keys
+ * are rechecked against the bounds (or the looked up key) by their full values.
+*/
+class IndexScanExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * Scan the range of keys.
+     * @param context the context of the query
+     * @param index_oid the OID of the index to scan
+     * @param lo the lower bound of the range, nullptr when the range is not bounded below
+     * @param lo_inclusive whether the lower bound is included into the range
+     * @param hi the upper bound of the range, nullptr when the range is not bounded above
+     * @param hi_inclusive whether the upper bound is included into the range
+    */
+    IndexScanExecutor(ExecutorContext& context, index_oid_t index_oid,
+                      const Tuple* lo, bool lo_inclusive, const Tuple* hi, bool hi_inclusive);
+
+    /**
+     * Look up the key.
+     * @param context the context of the query
+     * @param index_oid the OID of the index to search
+     * @param key the tuple which has the key to search
+    */
+    IndexScanExecutor(ExecutorContext& context, index_oid_t index_oid, const Tuple& key);
+
+    void Init() override;
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override;
+
+private:
+    /** @return whether the key of the row is within the bounds by its full value (see Tuple::CompareKeys) */
+    bool IsInRange(const char* row) const;
+
+private:
+    IndexInfo* _index_info{nullptr};
+    TableInfo* _table_info{nullptr};
+    std::optional<Tuple> _lo;
+    std::optional<Tuple> _hi;
+    bool _lo_inclusive{false};
+    bool _hi_inclusive{false};
+    /** Whether the key is looked up rather than the range is scanned */
+    bool _is_lookup{false};
+    /** Whether the key has VARCHAR attributes, so the rows are rechecked against the bounds */
+    bool _recheck{false};
+
+    std::optional<IndexIterator> _itr;
+    /** Whether the key has been looked up (for the lookup) */
+    bool _done{false};
+    /** The RIDs read from the index */
+    std::vector<RID> _rids;
+    /** The data of the rows of the batch, their offsets and RIDs */
+    std::vector<char> _buffer;
+    std::vector<uint32_t> _offsets;
+    std::vector<RID> _row_rids;
+};
+
+}
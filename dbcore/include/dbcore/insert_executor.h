@@ -0,0 +1,52 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+#include <dbcore/coretypes.h>
+#include <dbcore/tuple.h>
+
+#include <memory>
+#include <optional>
+
+namespace dbcore
+{
+
+class IndexInfo;
+class TableInfo;
+
+/**
+ * InsertExecutor inserts the rows of the child into the table and into all of its indexes.
+ * It produces the single row of the number of inserted rows (the INTEGER column "count").
+ * The child is drained into the copies of its rows before the first row is inserted:
+ * the child might scan the same table (INSERT ... SELECT), and its batch keeps the page latched
+ * while the insert would latch the page for write, besides the scan must not see the inserted rows.
+ * The row whose key is already in some index (the keys are unique) is not inserted:
+ * it's deleted from the table and from the indexes it has been inserted into.
+ * When the child fails (see HasFailed), nothing is inserted and no row is produced.
+*/
+class InsertExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * @param context the context of the query
+     * @param table_oid the OID of the table where to insert
+     * @param child the executor which produces the rows to insert (of the table's schema)
+    */
+    InsertExecutor(ExecutorContext& context, table_oid_t table_oid, std::unique_ptr<AbstractExecutor> child);
+
+    void Init() override;
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override { return _output_schema; }
+    bool HasFailed() const override { return _child->HasFailed(); }
+
+private:
+    TableInfo* _table_info{nullptr};
+    std::vector<IndexInfo*> _indexes;
+    std::unique_ptr<AbstractExecutor> _child;
+    Schema _output_schema;
+    /** Whether the rows have been inserted */
+    bool _done{false};
+    /** The row of the number of inserted rows */
+    std::optional<Tuple> _result;
+};
+
+}
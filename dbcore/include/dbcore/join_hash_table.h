@@ -0,0 +1,140 @@
+#pragma once
+
+#include <dbcore/rid.h>
+#include <dbcore/tuple_view.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace dbcore
+{
+
+/**
+ * JoinHashTable is the build side of the hash join. The rows are copied into the table
+ * together with their (normalized, see KeyEncoder) join keys and hashes, then the table is built:
+ * the rows are radix-partitioned by the high bits of the hash, so the hash table of each partition
+ * fits into L2 cache, and each partition gets its own open-addressing (linear probing) table.
+ * The slot of the table is compact: the hash, the index of the row and the key, so the probe
+ * compares the keys without touching the rows. The rows with equal keys are all kept.
+*/
+class JoinHashTable final
+{
+    JoinHashTable(const JoinHashTable&) = delete;
+    JoinHashTable& operator=(const JoinHashTable&) = delete;
+
+public:
+    /**
+     * @param key_size the size of normalized key
+    */
+    explicit JoinHashTable(uint32_t key_size);
+
+    /**
+     * Drop all of the rows.
+    */
+    void Clear();
+
+    /**
+     * Add the row (before the table is built).
+     * @param row the row to copy into the table
+     * @param key the normalized key of the row
+     * @param hash the hash of the key
+    */
+    void Insert(const TupleView& row, const char* key, uint32_t hash);
+
+    size_t GetNumRows() const { return _rids.size(); }
+
+    /**
+     * @return the row added by Insert()
+    */
+    TupleView GetRow(size_t idx) const
+    {
+        return TupleView{_rows.data() + _row_offsets[idx], static_cast<uint32_t>(_row_offsets[idx + 1] - _row_offsets[idx]), _rids[idx]};
+    }
+
+    const char* GetKey(size_t idx) const { return _keys.data() + idx * _key_size; }
+    uint32_t GetHash(size_t idx) const { return _hashes[idx]; }
+
+    /**
+     * @return the memory taken by the rows and (when built) by the table
+    */
+    size_t GetMemoryUsage() const;
+
+    /**
+     * Partition the rows and build the hash tables of partitions.
+    */
+    void Build();
+
+    /**
+     * @return the number of partitions of the built table
+    */
+    uint32_t GetNumPartitions() const { return 1u << _radix_bits; }
+
+    /**
+     * Prefetch the slot where the probe of the hash starts.
+    */
+    void Prefetch(uint32_t hash) const { __builtin_prefetch(_slots.data() + SlotIndex(hash) * _slot_size); }
+
+    /**
+     * Find the rows which have the key.
+     * @param key the normalized key
+     * @param hash the hash of the key
+     * @param func the function called with each found row
+    */
+    template <typename Func>
+    void Probe(const char* key, uint32_t hash, Func&& func) const
+    {
+        const uint32_t partition = Partition(hash);
+        const size_t begin = _partition_begin[partition];
+        const uint32_t mask = _partition_mask[partition];
+        for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+            const char* slot = _slots.data() + (begin + i) * _slot_size;
+            uint32_t slot_hash = 0, row = 0;
+            ::memcpy(&slot_hash, slot, sizeof(uint32_t));
+            ::memcpy(&row, slot + sizeof(uint32_t), sizeof(uint32_t));
+            if (row == EMPTY_SLOT) {
+                return;
+            }
+            if (slot_hash == hash && ::memcmp(slot + SLOT_HEADER_SIZE, key, _key_size) == 0) {
+                func(GetRow(row));
+            }
+        }
+    }
+
+public:
+    /** The size of L2 cache which the table of a partition is fit into */
+    static constexpr size_t L2_CACHE_SIZE = 256 * 1024;
+    static constexpr uint32_t MAX_RADIX_BITS = 12;
+
+private:
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+    static constexpr uint32_t SLOT_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+    uint32_t Partition(uint32_t hash) const { return _radix_bits == 0 ? 0 : hash >> (32 - _radix_bits); }
+
+    size_t SlotIndex(uint32_t hash) const
+    {
+        const uint32_t partition = Partition(hash);
+        return _partition_begin[partition] + (hash & _partition_mask[partition]);
+    }
+
+private:
+    const uint32_t _key_size;
+    /** The size of slot: the hash, the row index and the key (aligned to 4 bytes) */
+    const uint32_t _slot_size;
+
+    /** The rows, _row_offsets has the end offset of the last row as well */
+    std::vector<char> _rows;
+    std::vector<size_t> _row_offsets;
+    std::vector<RID> _rids;
+    std::vector<char> _keys;
+    std::vector<uint32_t> _hashes;
+
+    uint32_t _radix_bits{0};
+    /** The first slot and the mask of slot index of each partition's table */
+    std::vector<size_t> _partition_begin;
+    std::vector<uint32_t> _partition_mask;
+    std::vector<char> _slots;
+};
+
+}
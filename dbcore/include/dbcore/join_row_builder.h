@@ -0,0 +1,66 @@
+#pragma once
+
+#include <dbcore/schema.h>
+#include <dbcore/tuple_view.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dbcore
+{
+
+/**
+ * JoinRowBuilder makes the rows of the join: the columns of the left row followed by
+ * the columns of the right one. The inlined parts of both rows are copied as they are
+ * (the offsets of the right columns are shifted by the size of the left part), only the
+ * offsets of VARCHAR columns are rewritten, so no Value objects are built.
+ * The rows are packed into the buffer, which is reused from batch to batch.
+*/
+class JoinRowBuilder final
+{
+    JoinRowBuilder(const JoinRowBuilder&) = delete;
+    JoinRowBuilder& operator=(const JoinRowBuilder&) = delete;
+
+public:
+    JoinRowBuilder(const Schema& left_schema, const Schema& right_schema);
+
+    /**
+     * @return the schema of the joined rows
+    */
+    const Schema& GetOutputSchema() const { return _output_schema; }
+
+    /**
+     * Drop the rows of the previous batch.
+    */
+    void Clear();
+
+    /**
+     * Append the joined row (it has the RID of the left row).
+    */
+    void Append(const TupleView& left, const TupleView& right);
+
+    /**
+     * @return the number of rows appended since the last Clear()
+    */
+    size_t GetNumRows() const { return _rids.size(); }
+
+    /**
+     * Make the views of the appended rows.
+     * @param[out] rows the views, valid until the next Clear() (or Append())
+    */
+    void GetRows(std::vector<TupleView>& rows) const;
+
+private:
+    /** Append the VARCHAR values of the row and write their new offsets */
+    void AppendVarchars(const TupleView& row, const Schema& schema, uint32_t column_offset, size_t row_offset);
+
+private:
+    Schema _left_schema;
+    Schema _right_schema;
+    Schema _output_schema;
+    std::vector<char> _buffer;
+    std::vector<size_t> _offsets;
+    std::vector<RID> _rids;
+};
+
+}
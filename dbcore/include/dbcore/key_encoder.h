@@ -0,0 +1,78 @@
+#pragma once
+
+#include <dbcore/schema.h>
+
+#include <array>
+
+namespace dbcore
+{
+
+/** The maximal size of normalized key (the index keys are encoded into buffer on the stack) */
+static constexpr uint32_t MAX_NORMALIZED_KEY_SIZE = 512;
+
+/**
+ * The encoder of index keys into order-preserving (normalized) binary form.
+ * Two normalized keys compare with memcmp the same way as the source tuples
+ * compare column by column, so the index pages never decode keys through Value.
+ * The columns are encoded one after another, each one into fixed-width slot:
+ * - signed integers (BOOLEAN, TINYINT, SMALLINT, INTEGER, BIGINT) are written
+ *   in big-endian byte order with the sign bit flipped;
+ * - DECIMAL is stored as 64-bit integer, so it is encoded like BIGINT;
+ * - TIMESTAMP (unsigned) is written in big-endian byte order;
+ * - VARCHAR is written as the prefix of the column's declared length padded
+ *   (terminated) with zero bytes, so the strings which differ beyond the prefix
+ *   are encoded into equal keys.
+*/
+class KeyEncoder final
+{
+
+public:
+    explicit KeyEncoder(const Schema& key_schema);
+
+    /**
+     * @return the size of normalized key in bytes
+    */
+    uint32_t GetKeySize() const { return _key_size; }
+
+    /**
+     * @return the schema of the source (not normalized) key
+    */
+    const Schema& GetSchema() const { return _schema; }
+
+    /**
+     * Encode the key tuple into normalized form.
+     * @param tuple_data the data of tuple based on the key schema
+     * @param[out] key the buffer of GetKeySize() bytes where to write the normalized key
+    */
+    void Encode(const char* tuple_data, char* key) const;
+
+    /**
+     * Encode the key attributes of the table tuple into normalized form
+     * (without building the key tuple, see Tuple::KeyFromTuple).
+     * @param tuple_data the data of tuple based on the table schema
+     * @param tuple_schema the table schema
+     * @param key_attrs the positions of key attributes in the table tuple
+     * @param[out] key the buffer of GetKeySize() bytes where to write the normalized key
+    */
+    void Encode(const char* tuple_data, const Schema& tuple_schema, const uint32_t key_attrs[], char* key) const;
+
+private:
+    /** Encode the column of the tuple into its slot of normalized key */
+    static void EncodeColumn(const Column& column, const char* tuple_data, char* dst);
+
+    /** Write the unsigned value in big-endian byte order */
+    template <typename T>
+    static void EncodeBigEndian(T value, char* dst);
+
+    /** Read the signed native value of type T, flip the sign bit and write it in big-endian byte order */
+    template <typename T>
+    static void EncodeSigned(const char* src, char* dst);
+
+private:
+    Schema _schema;
+    uint32_t _key_size{0};
+    /** The offset of each column within the normalized key */
+    std::array<uint32_t, MAX_COLUMN_COUNT> _key_offsets;
+};
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+
+#include <memory>
+
+namespace dbcore
+{
+
+/**
+ * LimitExecutor produces at most the given number of the child's rows,
+ * the child is not asked for more rows once the limit is reached.
+*/
+class LimitExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * @param child the executor which produces the rows
+     * @param limit the maximum number of rows to produce
+    */
+    LimitExecutor(std::unique_ptr<AbstractExecutor> child, uint64_t limit);
+
+    void Init() override;
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override { return _child->GetOutputSchema(); }
+    bool HasFailed() const override { return _child->HasFailed(); }
+
+private:
+    std::unique_ptr<AbstractExecutor> _child;
+    const uint64_t _limit;
+    /** The number of rows produced so far */
+    uint64_t _num_produced{0};
+};
+
+}
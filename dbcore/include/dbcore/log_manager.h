@@ -0,0 +1,163 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dbcore
+{
+
+class LogRecord;
+
+/**
+ * LogManager maintains the write-ahead log. The records are appended into the in-memory
+ * buffer and written into the log file by the background flusher thread.
+ * The flusher implements group commit: while it writes and syncs one batch of records,
+ * the next records are appended into the other buffer, so all the threads which are waiting
+ * for durability meanwhile are served by the next single fdatasync.
+ * The LSN of a record is the offset in the log file just past its end.
+ * The log file starts with the header which keeps the LSN of the last checkpoint: the log
+ * is read from it, the space of the records before it is given back to the file system
+ * (the offsets of the records don't change, so the file becomes sparse).
+*/
+class LogManager final
+{
+    LogManager(const LogManager&) = delete;
+    LogManager& operator=(const LogManager&) = delete;
+
+public:
+    /**
+     * Open (or create when it doesn't exist) the log file and start the flusher.
+     * The records are appended after the last valid record of the file,
+     * the torn record at the end (if any) is truncated. The log is not opened
+     * when the header of the file is not valid.
+     * @param file_name the name of log file
+     * @param flush_interval_ms the period of flushing when nobody waits for durability
+    */
+    explicit LogManager(const char* file_name, uint32_t flush_interval_ms = 10);
+
+    /**
+     * Flush the appended records and stop the flusher.
+    */
+    ~LogManager();
+
+    /**
+     * @return true if the log file is opened successfully
+    */
+    bool IsOpen() const { return _fd != -1; }
+
+    /**
+     * Append the record to the log.
+     * @param record the record to append
+     * @return the LSN of the record
+    */
+    lsn_t Append(const LogRecord& record);
+
+    /**
+     * Wait until the log is durable up to the given LSN.
+     * @param lsn the LSN to wait for (INVALID_LSN returns immediately)
+     * @return false if the log could not be written
+    */
+    bool Flush(lsn_t lsn);
+
+    /**
+     * Wait until all of the records appended so far are durable (commit).
+     * @return false if the log could not be written
+    */
+    bool Flush();
+
+    /**
+     * @return the LSN of the last appended record (durable or not)
+    */
+    lsn_t GetAppendedLSN() const;
+
+    /**
+     * @return the LSN up to which the log is durable
+    */
+    lsn_t GetDurableLSN() const;
+
+    /**
+     * @return the number of fdatasync calls made by the flusher
+    */
+    uint64_t GetNumSyncs() const;
+
+    /**
+     * @return the LSN of the last checkpoint (see Truncate), INVALID_LSN when there is none
+    */
+    lsn_t GetCheckpointLSN() const;
+
+    /**
+     * Discard the records up to the checkpoint LSN: all of the changes logged by them are on
+     * the storage. The LSN is written into the header of the log, so the log is read from it
+     * from now on, then the space of the discarded records is given back to the file system.
+     * @param checkpoint_lsn the LSN up to which the logged changes are on the storage
+     * @return false if the header could not be written
+    */
+    bool Truncate(lsn_t checkpoint_lsn);
+
+    /**
+     * Read the durable records of the log after the last checkpoint one after another.
+     * The log file is read by chunks, so it's never loaded into memory entirely.
+     * @param callback the function called for each record
+     * @return false if the log could not be read
+    */
+    bool ReadLog(const std::function<void(const LogRecord&)>& callback) const;
+
+private:
+    /** The flusher thread routine */
+    void FlushLoop();
+
+    /**
+     * Find the end of the last valid record in the log file.
+     * @return the offset just past the last valid record
+    */
+    lsn_t FindLogEnd() const;
+
+    /**
+     * Read the header of the log file or write it when the file is empty.
+     * @return false if the header is not valid or could not be written
+    */
+    bool OpenHeader();
+
+    /** Write the header keeping the given checkpoint LSN and sync it */
+    bool WriteHeader(lsn_t checkpoint_lsn);
+
+    /** @return the LSN from which the log is read */
+    lsn_t GetStartLSN() const;
+
+private:
+    /** The descriptor of the log file */
+    int _fd{-1};
+    const uint32_t _flush_interval_ms;
+
+    /** Serializes the writes of the header */
+    std::mutex _header_mutex;
+
+    /** The mutex protects the fields below */
+    mutable std::mutex _mutex;
+    /** Notifies the flusher that somebody waits for durability */
+    std::condition_variable _flush_cv;
+    /** Notifies the waiters that the durable LSN advanced */
+    std::condition_variable _durable_cv;
+    /** The records which are appended but not written yet */
+    std::vector<char> _buffer;
+    /** The LSN of the next record (the end of the appended records) */
+    lsn_t _next_lsn{INVALID_LSN};
+    /** The LSN up to which the log is written and synced */
+    lsn_t _durable_lsn{INVALID_LSN};
+    /** The number of waiters for durability */
+    uint32_t _num_waiters{0};
+    uint64_t _num_syncs{0};
+    /** The LSN of the last checkpoint, the records up to it are discarded */
+    lsn_t _checkpoint_lsn{INVALID_LSN};
+    bool _io_error{false};
+    bool _stop{false};
+
+    std::thread _flusher;
+};
+
+}
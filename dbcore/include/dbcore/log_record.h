@@ -0,0 +1,149 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+#include <dbcore/rid.h>
+#include <dbcore/tuple.h>
+
+#include <vector>
+
+namespace dbcore
+{
+
+enum class LogRecordType : uint16_t
+{
+    INVALID = 0,
+    /** The table page is initialized (the page data is not needed to redo it) */
+    TABLE_PAGE_INIT,
+    /** The table page is linked to the next one */
+    TABLE_PAGE_LINK,
+    /** The tuple is inserted into the table page */
+    TABLE_INSERT,
+    /** The pages changed up to the checkpoint LSN are on the storage (the log is read from it) */
+    CHECKPOINT,
+    /** The tuple is marked as deleted in the table page */
+    TABLE_DELETE,
+    /** The tuple is replaced in the table page (keeping its slot) */
+    TABLE_UPDATE,
+    /** The ranges of the index pages changed by one operation of the index */
+    INDEX_PAGES,
+    /** The slot of the deleted tuple is released for reuse in the table page */
+    TABLE_RELEASE_SLOT
+};
+
+/**
+ * The record of the write-ahead log.
+ * The table heap changes are logged physically (by page and slot), so they are redone
+ * into the pages of the table only when the page LSN is older than the record.
+ * The index changes are logged as the changed ranges of the index pages (the index pages
+ * don't keep LSN), all of the ranges changed by one operation are in one record.
+ *
+ * The record format in the log file:
+ * ----------------------------------------------------------------------------------------------
+ * | SIZE(4) | CHECKSUM(4) | LSN(8) | TYPE(2) | PAGE_ID(4) | NEXT_PAGE_ID(4) | RID | META | ... |
+ * ----------------------------------------------------------------------------------------------
+ * ... | INDEX_OID(4) | DATA_SIZE(4) | DATA(DATA_SIZE) |
+ * ---------------------------------------------------
+ * The checksum covers everything after itself, so the torn record at the end of the log is detected.
+ * The data of INDEX_PAGES is the sequence of the page ranges:
+ * ------------------------------------------------------------------------------
+ * | PAGE_ID(4) | IS_NEW(2) | OFFSET(2) | SIZE(2) | BYTES(SIZE) | PAGE_ID(4) | ...
+ * ------------------------------------------------------------------------------
+ * The page just allocated (IS_NEW) is zeroed before its range is written.
+*/
+class LogRecord final
+{
+public:
+    /**
+     * The changed range of the index page (see INDEX_PAGES)
+    */
+    struct PageChange
+    {
+        page_id_t page_id{INVALID_PAGE_ID};
+        /** whether the page is just allocated, the rest of the page is zeroed then */
+        bool is_new{false};
+        uint16_t offset{0};
+        uint16_t size{0};
+        /** the bytes of the range, they refer to the data of the record */
+        const char* data{nullptr};
+    };
+
+    LogRecord() = default;
+
+    static LogRecord TablePageInit(page_id_t page_id);
+    static LogRecord TablePageLink(page_id_t page_id, page_id_t next_page_id);
+    static LogRecord TableInsert(const RID& rid, const TupleMeta& meta, const Tuple& tuple);
+    static LogRecord TableDelete(const RID& rid);
+    static LogRecord TableUpdate(const RID& rid, const TupleMeta& meta, const Tuple& tuple);
+    static LogRecord TableReleaseSlot(const RID& rid);
+    static LogRecord IndexPages(index_oid_t index_oid);
+    static LogRecord Checkpoint(lsn_t checkpoint_lsn);
+
+    LogRecordType GetType() const { return _type; }
+    lsn_t GetLSN() const { return _lsn; }
+    page_id_t GetPageId() const { return _page_id; }
+    page_id_t GetNextPageId() const { return _next_page_id; }
+    const RID& GetRID() const { return _rid; }
+    const TupleMeta& GetTupleMeta() const { return _meta; }
+    index_oid_t GetIndexOid() const { return _index_oid; }
+
+    /**
+     * @return the LSN up to which the table pages changes are on the storage (for CHECKPOINT)
+    */
+    lsn_t GetCheckpointLSN() const;
+
+    /**
+     * Add the changed range of the index page (for INDEX_PAGES).
+    */
+    void AddPageChange(const PageChange& change);
+
+    /**
+     * Read the changed ranges of the index pages (for INDEX_PAGES).
+     * @param[out] changes the ranges in the order they were added
+     * @return false if the data of the record is broken
+    */
+    bool GetPageChanges(std::vector<PageChange>& changes) const;
+
+    /**
+     * @return the tuple (for TABLE_INSERT and TABLE_UPDATE) or the page ranges (for INDEX_PAGES)
+    */
+    const char* GetData() const { return _data.data(); }
+    uint32_t GetDataSize() const { return static_cast<uint32_t>(_data.size()); }
+
+    /**
+     * @return the size of serialized record
+    */
+    uint32_t GetSize() const { return HEADER_SIZE + GetDataSize(); }
+
+    /**
+     * Serialize the record with the given LSN.
+     * @param lsn the LSN of the record (the offset just past its end in the log)
+     * @param[out] dst the buffer of GetSize() bytes
+    */
+    void Serialize(lsn_t lsn, char* dst) const;
+
+    /**
+     * Deserialize the record.
+     * @param src the bytes of the log starting at the record
+     * @param size the number of bytes available
+     * @param[out] record the deserialized record
+     * @return the size of the record or 0 when it is incomplete or corrupted
+    */
+    static uint32_t Deserialize(const char* src, size_t size, LogRecord& record);
+
+public:
+    static constexpr uint32_t HEADER_SIZE = 2 * sizeof(uint32_t) + sizeof(lsn_t) + sizeof(LogRecordType)
+                                            + 2 * sizeof(page_id_t) + sizeof(RID) + sizeof(TupleMeta)
+                                            + sizeof(index_oid_t) + sizeof(uint32_t);
+
+private:
+    LogRecordType _type{LogRecordType::INVALID};
+    lsn_t _lsn{INVALID_LSN};
+    page_id_t _page_id{INVALID_PAGE_ID};
+    page_id_t _next_page_id{INVALID_PAGE_ID};
+    RID _rid;
+    TupleMeta _meta;
+    index_oid_t _index_oid{INVALID_INDEX_OID};
+    std::vector<char> _data;
+};
+
+}
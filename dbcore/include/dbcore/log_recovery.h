@@ -0,0 +1,73 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+
+namespace dbcore
+{
+
+class LogManager;
+class LogRecord;
+class PagesManager;
+
+/**
+ * LogRecovery redoes the write-ahead log on startup, before the tables and indexes are used.
+ * The table pages changes are redone into the pages manager when the page LSN is older
+ * than the record, so the pages which reached the storage before the crash are not changed twice.
+ * The log is read once from the last checkpoint: the changes logged before it are on
+ * the storage already and the log is truncated up to it (see LogManager::Truncate).
+ * The index pages changes (see PageChangeLog) are redone physically: each changed range
+ * is copied into the page whatever its LSN is. Every change of the page after the checkpoint
+ * is logged, so the page gets the same bytes as before the crash when all of them are
+ * copied in order. The initialization of a table page is redone the same way, since
+ * the page might have been the index page before.
+*/
+class LogRecovery final
+{
+    LogRecovery(const LogRecovery&) = delete;
+    LogRecovery& operator=(const LogRecovery&) = delete;
+
+public:
+    /**
+     * @param log_manager the write-ahead log to redo
+     * @param pages_manager the pages manager where to redo the pages changes
+    */
+    LogRecovery(const LogManager& log_manager, PagesManager& pages_manager);
+
+    /**
+     * Redo the durable records of the log after the last checkpoint. The indexes are opened after that
+     * by their root pages (see Index::GetRootPageId).
+     * @return false if the log could not be read or a page could not be redone
+    */
+    bool Redo();
+
+    /**
+     * @return the number of records redone by the last call of Redo
+    */
+    uint64_t GetNumRedone() const { return _num_redone; }
+
+    /**
+     * @return the number of records skipped by the last call of Redo (already applied)
+    */
+    uint64_t GetNumSkipped() const { return _num_skipped; }
+
+    /**
+     * @return the LSN of the checkpoint from which the last call of Redo started (INVALID_LSN when there is none)
+    */
+    lsn_t GetCheckpointLSN() const { return _checkpoint_lsn; }
+
+private:
+    /** Redo the change of the table page, @return false if the page is not available */
+    bool RedoTablePage(const LogRecord& record);
+
+    /** Redo the changes of the index pages, @return false if a page is not available */
+    bool RedoIndexPages(const LogRecord& record);
+
+private:
+    const LogManager& _log_manager;
+    PagesManager& _pages_manager;
+    uint64_t _num_redone{0};
+    uint64_t _num_skipped{0};
+    lsn_t _checkpoint_lsn{INVALID_LSN};
+};
+
+}
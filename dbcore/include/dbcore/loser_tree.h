@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dbcore
+{
+
+/**
+ * LoserTree selects the smallest of the current items of k sorted sources (the k-way merge).
+ * Each inner node keeps the source which lost the match at the node, the winner goes up,
+ * so when the winner's source advances only the path from its leaf to the root is replayed:
+ * log2(k) comparisons with the stored losers and no comparisons with the siblings.
+ * The tree keeps only the indices of the sources, the items are compared by the given function
+ * less(a, b) of two source indices; the exhausted source should be greater than any other one.
+ * The equal items are taken in order of the sources, so the merge is stable.
+*/
+class LoserTree final
+{
+public:
+    /**
+     * Play the tournament of the current items of the sources.
+     * @param num_sources the number of sources (at least one)
+     * @param less the comparison of the current items of two sources
+    */
+    template <typename Less>
+    void Init(uint32_t num_sources, Less&& less)
+    {
+        _num_sources = num_sources;
+        _losers.assign(num_sources, 0);
+        _winner = Play(1, less);
+    }
+
+    /**
+     * @return the source of the smallest current item
+    */
+    uint32_t Top() const { return _winner; }
+
+    /**
+     * Replay the path of the winner after its source has advanced.
+     * @param less the comparison of the current items of two sources
+    */
+    template <typename Less>
+    void Replay(Less&& less)
+    {
+        uint32_t winner = _winner;
+        for (uint32_t node = (winner + _num_sources) / 2; node > 0; node /= 2) {
+            if (Beats(_losers[node], winner, less)) {
+                std::swap(_losers[node], winner);
+            }
+        }
+        _winner = winner;
+    }
+
+private:
+    /** The leaves are the nodes [k, 2k) (the source of leaf n is n - k), the inner nodes are [1, k) */
+    template <typename Less>
+    uint32_t Play(uint32_t node, Less& less)
+    {
+        if (node >= _num_sources) {
+            return node - _num_sources;
+        }
+        const uint32_t left = Play(2 * node, less);
+        const uint32_t right = Play(2 * node + 1, less);
+        const bool left_wins = Beats(left, right, less);
+        _losers[node] = left_wins ? right : left;
+        return left_wins ? left : right;
+    }
+
+    template <typename Less>
+    static bool Beats(uint32_t lhs, uint32_t rhs, Less& less)
+    {
+        return less(lhs, rhs) || (!less(rhs, lhs) && lhs < rhs);
+    }
+
+private:
+    uint32_t _num_sources{0};
+    uint32_t _winner{0};
+    std::vector<uint32_t> _losers;
+};
+
+}
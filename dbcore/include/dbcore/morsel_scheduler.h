@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace dbcore
+{
+
+/**
+ * MorselScheduler hands out the morsels (the small units of work, e.g. the runs of table pages)
+ * to the workers of parallel scan. Initially each worker owns the contiguous range of morsels
+ * and takes them from its front one by one. The worker which runs out of its own morsels steals
+ * the back half of the range of another worker, so the workers finish at about the same time
+ * even if some of them are slow (e.g. their pages are not in memory).
+ * Each range is kept in the single atomic word, so the morsels are taken and stolen without locks.
+*/
+class MorselScheduler final
+{
+    MorselScheduler(const MorselScheduler&) = delete;
+    MorselScheduler& operator=(const MorselScheduler&) = delete;
+
+public:
+    /**
+     * @param num_morsels the number of morsels (they are identified by the numbers [0, num_morsels))
+     * @param num_workers the number of workers
+    */
+    MorselScheduler(uint32_t num_morsels, uint32_t num_workers);
+
+    /**
+     * Get the next morsel of the worker.
+     * @param worker_id the worker identifier in range [0, num_workers)
+     * @param[out] morsel the morsel to process
+     * @return false when there are no more morsels
+    */
+    bool Next(uint32_t worker_id, uint32_t* morsel);
+
+    /**
+     * @return the number of steals happened
+    */
+    uint32_t GetNumSteals() const { return _num_steals.load(std::memory_order_relaxed); }
+
+private:
+    /** Take the back half of the range of some other worker, return the first stolen morsel */
+    bool Steal(uint32_t worker_id, uint32_t* morsel);
+
+    static uint64_t Pack(uint32_t begin, uint32_t end) { return (static_cast<uint64_t>(begin) << 32) | end; }
+    static uint32_t Begin(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+    static uint32_t End(uint64_t range) { return static_cast<uint32_t>(range); }
+
+private:
+    /** The range [begin, end) of morsels owned by the worker, each one in its own cache line */
+    struct alignas(64) Range
+    {
+        std::atomic<uint64_t> _range{0};
+    };
+
+    const uint32_t _num_workers;
+    std::unique_ptr<Range[]> _ranges;
+    std::atomic<uint32_t> _num_steals{0};
+};
+
+}
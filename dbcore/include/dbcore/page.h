@@ -3,6 +3,8 @@
 #include <dbcore/coretypes.h>
 #include <dbcore/rwlatch.h>
 
+#include <atomic>
+
 namespace dbcore
 {
 
@@ -36,13 +38,29 @@ public:
    /**
     * @return the page id of the page
    */
-   page_id_t GetPageId() const { return _page_id; }
+   page_id_t GetPageId() const { return _page_id.load(std::memory_order_relaxed); }
 
    /**
     * @return the pin count of the page
    */
-   uint32_t GetPinCount() const { return _pin_count; }
+   uint32_t GetPinCount() const { return _state.load(std::memory_order_relaxed) & PIN_COUNT_MASK; }
+
+   /**
+    * @return true if the page is dirty
+   */
+   bool IsDirty() const { return (_state.load(std::memory_order_relaxed) & STATE_DIRTY) != 0; }
+
+
+   /**
+    * @return the LSN of the latest logged change of the page,
+    * the page must not be written onto storage before the log is flushed up to it
+   */
+   lsn_t GetLSN() const { return _lsn.load(std::memory_order_acquire); }
 
+   /**
+    * Set the LSN of the latest logged change of the page.
+   */
+   void SetLSN(lsn_t lsn) { _lsn.store(lsn, std::memory_order_release); }
 
    /**
     * Acquire the page read latch.
@@ -67,19 +85,45 @@ public:
 private:
     void ResetData();
 
+    /**
+     * Set the dirty flag while the page is latched for writing, so the checkpoint
+     * doesn't take the page for clean before it's unpinned.
+    */
+    void MarkDirty() { _state.fetch_or(STATE_DIRTY, std::memory_order_acq_rel); }
+
+    /**
+     * The state word layout:
+     * -------------------------------------------------------------------------------------
+     * | unused(3) | LOADING(1) | REFERENCED(1) | EVICTING(1) | FREE(1) | DIRTY(1) | PIN(24) |
+     * -------------------------------------------------------------------------------------
+     * PIN - the pin count of the page
+     * DIRTY - the page content is different from its corresponding page on storage
+     * FREE - the frame doesn't hold any page (it is in the free frames stack)
+     * EVICTING - the frame is exclusively owned by the thread which evicts/releases the page
+     * REFERENCED - the reference bit used by the CLOCK replacement policy
+     * LOADING - the page content is being read from storage
+    */
+    static constexpr uint32_t PIN_COUNT_MASK = (1u << 24) - 1;
+    static constexpr uint32_t STATE_DIRTY = 1u << 24;
+    static constexpr uint32_t STATE_FREE = 1u << 25;
+    static constexpr uint32_t STATE_EVICTING = 1u << 26;
+    static constexpr uint32_t STATE_REFERENCED = 1u << 27;
+    static constexpr uint32_t STATE_LOADING = 1u << 28;
+
     /** The actual data that is stored within a page. */
     char _data[PAGE_SIZE];
     /** The ID of the page. */
-    page_id_t _page_id{INVALID_PAGE_ID};
-    /** The pin count of the page. */
-    uint32_t _pin_count{0}; // TO DO: it should be atomic<uint32_t> 
-    /** True if the page is dirty, i.e. its content is different 
-     * from its corresponding page on storage (disk or something else). */
-    bool _is_dirty{false};
+    std::atomic<page_id_t> _page_id{INVALID_PAGE_ID};
+    /** The pin count and the flags of the page, see the layout above. */
+    std::atomic<uint32_t> _state{STATE_FREE};
+    /** The LSN of the latest logged change of the page (not stored with the page) */
+    std::atomic<lsn_t> _lsn{INVALID_LSN};
     /** Page latch */
     ReaderWriterLatch _latch;
 
     friend class PagesManager;
+    friend class WritePageGuard;
+    friend class PageChangeLog;
 };
 
 }
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+#include <dbcore/page_guard.h>
+
+#include <memory>
+#include <vector>
+
+namespace dbcore
+{
+
+class LogManager;
+class Page;
+
+/**
+ * PageChangeLog logs the changes which one operation of an index makes in its pages
+ * by a single record (see LogRecordType::INDEX_PAGES), so a split or a merge is redone
+ * entirely or not at all.
+ * The pages are tracked while they are write-latched, before they are changed: the images
+ * of the pages are kept to find the changed range of each one. The record is appended while
+ * the pages are still latched, so the records of a page follow in the order of its changes,
+ * and the LSN of the record is set to the pages (the pages manager writes a page only
+ * when the log is durable up to its LSN).
+ * The pages just allocated are logged entirely, so the older records of the same page ids
+ * (e.g. of the pages which were given back) don't matter after them.
+ * When the changes are not logged (there is no log manager), nothing is tracked,
+ * but the guards given to the log are still held until Append.
+*/
+class PageChangeLog final
+{
+    PageChangeLog(const PageChangeLog&) = delete;
+    PageChangeLog& operator=(const PageChangeLog&) = delete;
+
+public:
+    /**
+     * @param log_manager the write-ahead log, nullptr when the changes are not logged
+     * @param index_oid the OID of the index which changes the pages
+    */
+    PageChangeLog(LogManager* log_manager, index_oid_t index_oid);
+
+    /**
+     * Track the write-latched page before it's changed (the page tracked already is skipped).
+     * The caller keeps the page latched until Append.
+    */
+    void Track(WritePageGuard& guard);
+
+    /**
+     * Track the write-latched page before it's changed, the log keeps it latched until Append.
+    */
+    void Track(WritePageGuard&& guard);
+
+    /**
+     * Track the page just allocated, the log keeps it latched until Append.
+     * The page is logged entirely, whatever it was before.
+    */
+    void TrackNew(WritePageGuard&& guard);
+
+    /**
+     * Append the record of the changed pages and set its LSN to them, then release the pages
+     * held by the log. It must be called before the tracked pages are unlatched.
+     * @return the LSN of the record, INVALID_LSN when nothing is changed (or the changes are not logged)
+    */
+    lsn_t Append();
+
+private:
+    void TrackPage(Page* page, bool is_new);
+
+private:
+    struct TrackedPage
+    {
+        Page* page;
+        /** the image of the page before the changes, nullptr for the page just allocated */
+        std::unique_ptr<char[]> image;
+    };
+
+    LogManager* _log_manager{nullptr};
+    index_oid_t _index_oid{INVALID_INDEX_OID};
+    std::vector<TrackedPage> _pages;
+    /** the pages kept latched by the log */
+    std::vector<WritePageGuard> _guards;
+};
+
+}
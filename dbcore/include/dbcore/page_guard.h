@@ -62,6 +62,7 @@ private:
 
     friend class ReadPageGuard;
     friend class WritePageGuard;
+    friend class PageChangeLog;
 };
 
 
@@ -92,6 +93,8 @@ public:
 private:
     PageGuard _page_guard;
     unsigned _counter{0};
+
+    friend class PageGuard;
 };
 
 
@@ -119,14 +122,27 @@ public:
     template <typename T>
     const T* As() const { return _page_guard.As<T>(); }
 
-    char* GetDataMut() { return _page_guard.GetDataMut(); }
+    char* GetDataMut() { 
+        _page_guard._is_dirty = true;
+        return _page_guard.GetDataMut(); 
+    }
 
     template <typename T>
     T* AsMut() { return _page_guard.AsMut<T>(); }
 
+    /**
+     * Set the LSN of the log record which describes the change of the page.
+     * The pages manager flushes the log up to this LSN before the page is written.
+     * The page becomes dirty at once, not when the guard is dropped.
+    */
+    void SetLSN(lsn_t lsn);
+
 private:
     PageGuard _page_guard;
     unsigned _counter{0};
+
+    friend class PageGuard;
+    friend class PageChangeLog;
 };
 
 }
@@ -4,16 +4,29 @@
 #include <dbcore/page.h>
 #include <dbcore/page_guard.h>
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <list>
 #include <unordered_set>
+#include <vector>
 
 namespace dbcore
 {
 
+class DiskManager;
+class LogManager;
+
 /**
  * The class provides the pages management: allocation, fetching, flushing etc. 
- * In fact all of the pages are kept in a pool of a fixed size. 
+ * The pages are cached in a pool of frames of a fixed size. When the pool is backed
+ * by the DiskManager, unpinned pages are evicted (following the CLOCK replacement policy)
+ * to make room for requested ones, dirty pages are written back before eviction.
+ * Without DiskManager nothing could be evicted, so the number of pages is limited by the pool size.
+ * 
+ * Fetching of a page which is already in memory is lock-free: the page table is a two-level
+ * array of atomic frame ids and the pin count is a part of the atomic state word of the frame.
+ * The mutex is taken only to allocate/give back page ids.
 */
 class PagesManager final
 {
@@ -24,8 +37,11 @@ public:
     /**
      * @brief Create a new PagesManager.
      * @param num_of_pages the number of pages kept in memory
+     * @param disk_manager the (non owning) pointer to the backing storage or nullptr when pages are kept in memory only
+     * @param log_manager the (non owning) pointer to the write-ahead log or nullptr when changes are not logged.
+     * The page is written onto the storage only after the log is flushed up to the page LSN.
     */
-    explicit PagesManager(uint32_t num_of_pages);
+    explicit PagesManager(uint32_t num_of_pages, DiskManager* disk_manager = nullptr, LogManager* log_manager = nullptr);
 
     ~PagesManager();
 
@@ -34,7 +50,7 @@ public:
      * @attention Dont't use this method directly!
      * Leave it for unit-test only. Use @ref NextFreePageGuarded instead.
      * @param[out] page_id id of returned page
-     * @return pointer to the page or nullptr if no more pages available
+     * @return pointer to the page or nullptr if no more pages available (all frames are pinned)
     */
     Page* NextFreePage(page_id_t *page_id);
 
@@ -108,20 +124,151 @@ public:
      * true when page is freed successfully
     */
     bool GiveBackPage(page_id_t page_id);
-    
 
+    /**
+     * @brief get the page to redo the logged changes into it (used by the recovery only).
+     * When the page has never reached the storage, it is allocated with the given id and zeroed content.
+     * @param page_id id of the page
+     * @return PageGuard instance, which holds the requested page (empty when no frame available)
+    */
+    PageGuard RecoverPageGuarded(page_id_t page_id);
+
+    /**
+     * @brief write the page onto the backing storage (if any) regardless of dirty flag.
+     * @param page_id id of the page
+     * @return false if the page is not in memory or write failed, true otherwise
+    */
+    bool FlushPage(page_id_t page_id);
+
+    /**
+     * @brief write all dirty pages onto the backing storage (if any).
+     * @return false if some dirty page could not be written, true otherwise
+    */
+    bool FlushAllPages();
+
+    /**
+     * @brief make the pages written so far durable on the backing storage (if any).
+     * @return false if the storage could not be synced, true otherwise
+    */
+    bool Sync();
+
+    /**
+     * @brief start reading the page from the backing storage in background (when it isn't in memory),
+     * so the following fetch of the page waits less. The page is not pinned.
+     * @param page_id id of the page
+    */
+    void PrefetchPage(page_id_t page_id);
+
+    /**
+     * @return true if the pages are backed by the storage
+    */
+    bool HasStorage() const { return _disk_manager != nullptr; }
+
+    /**
+     * @brief write the dirty pages onto the backing storage without stopping the users of pages (fuzzy checkpoint).
+     * The pages are written in order of page ids, the runs of adjacent pages are written by single write.
+     * Each page is latched for reading only while it's copied into the write buffer. When the changes
+     * are logged, the checkpoint LSN is appended to the log and the log is truncated up to it
+     * (see LogManager::Truncate), so the recovery starts redoing the pages after it.
+     * @param[out] checkpoint_lsn the LSN up to which all of the logged changes are on the storage (may be nullptr)
+     * @return false if there is no backing storage or some page could not be written
+    */
+    bool Checkpoint(lsn_t* checkpoint_lsn = nullptr);
 
 private:
+    /**
+     * Pin the page, read it from the backing storage when it isn't in memory.
+     * @return pointer to the page or nullptr when the page_id is invalid or no frame available
+    */
+    Page* FetchPage(page_id_t page_id);
+
+    /**
+     * Pin the page if it's in memory, wait while it's being evicted.
+     * @return pointer to the page or nullptr when the page isn't in memory or is being loaded
+    */
+    Page* PinResidentPage(page_id_t page_id);
+
+    /**
+     * Increment the pin count unless the frame is free or being evicted.
+     * @return true if the page is pinned
+    */
+    static bool TryPin(Page* page);
+
+    /**
+     * Decrement the pin count, set the dirty flag if requested.
+     * @return false if the pin count is already 0, true otherwise
+    */
+    static bool Unpin(Page* page, bool is_dirty);
+
+    /**
+     * @return true if the page id is allocated (and not given back)
+    */
+    bool IsAllocated(page_id_t page_id);
+
+    /**
+     * @return id of the frame where the page is kept or INVALID_FRAME_ID when the page isn't in memory
+    */
+    frame_id_t LookupFrame(page_id_t page_id) const;
+
+    /**
+     * @return the page table entry of the page, the second level of the table is allocated when needed
+    */
+    std::atomic<frame_id_t>& PageTableEntry(page_id_t page_id);
+
+    /**
+     * Find a frame to place a page: take it from the free frames stack or evict some unpinned page.
+     * The returned frame is exclusively owned by the caller.
+     * @return id of the frame or INVALID_FRAME_ID when all frames are pinned
+    */
+    frame_id_t AcquireFrame();
+
+    /**
+     * Write the page onto the backing storage, the log is flushed up to the page LSN at first.
+     * @return true if the page is written
+    */
+    bool WritePage(Page* page);
+
+    /**
+     * Choose a victim frame following the CLOCK policy, write back the page if dirty.
+     * @return id of the evicted frame or INVALID_FRAME_ID when all frames are pinned
+    */
+    frame_id_t EvictFrame();
+
+    void PushFreeFrame(frame_id_t frame_id);
+    frame_id_t PopFreeFrame();
+
+private:
+    static constexpr uint32_t PAGE_TABLE_CHUNK_BITS = 16;
+    static constexpr uint32_t PAGE_TABLE_CHUNK_SIZE = 1u << PAGE_TABLE_CHUNK_BITS;
+    static constexpr uint32_t PAGE_TABLE_NUM_CHUNKS = (1u << 31) >> PAGE_TABLE_CHUNK_BITS;
+
     /** The number of pages */
     const uint32_t _num_of_pages;
     /** Array of managed pages */
     Page *_pages{nullptr};
+    /** The backing storage (non owning pointer), nullptr when pages are kept in memory only */
+    DiskManager *_disk_manager{nullptr};
+    /** The write-ahead log (non owning pointer), nullptr when changes are not logged */
+    LogManager *_log_manager{nullptr};
+    /** Map page id -> frame id, for pages kept in memory.
+     * The chunks of the second level are allocated on demand and released in d-tor only. */
+    std::unique_ptr<std::atomic<std::atomic<frame_id_t>*>[]> _page_table;
+    /** The head of the free frames stack: ABA tag (upper 32 bits) and frame id (lower 32 bits) */
+    std::atomic<uint64_t> _free_frames_head;
+    /** The links of the free frames stack */
+    std::unique_ptr<std::atomic<frame_id_t>[]> _free_frames_next;
+    /** The clock hand of the replacement policy */
+    std::atomic<uint32_t> _clock_hand{0};
+    /** The next page id to be allocated */
+    page_id_t _next_page_id{0};
     /** The catalog of free pages */
     std::unordered_set<page_id_t> _free_pages;
     /** The free pages list */ 
     std::list<page_id_t> _free_pages_list;
-    /** The mutex to ensure exclusive access to internal data */
+    /** The mutex to ensure exclusive access to page ids allocation */
     std::mutex _mutex;
+    /** The mutex to run the checkpoints one at a time */
+    std::mutex _checkpoint_mutex;
 };
 
 
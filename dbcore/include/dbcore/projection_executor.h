@@ -0,0 +1,49 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+#include <dbcore/selection_bitmap.h>
+#include <dbcore/tuple.h>
+#include <dbcore/vector_projection.h>
+
+#include <array>
+#include <memory>
+#include <optional>
+
+namespace dbcore
+{
+
+/**
+ * ProjectionExecutor produces the rows made of the given columns of the child's rows.
+ * When all of the columns are fixed-width, the batch is projected by VectorProjection
+ * (the columns are gathered and packed into the rows of the output schema), otherwise
+ * the rows are made of the values one by one. The rows are kept until the next batch.
+*/
+class ProjectionExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * @param child the executor which produces the rows
+     * @param attrs the indexes of the columns of the child's schema to project
+     * @param num_attrs the number of columns to project
+    */
+    ProjectionExecutor(std::unique_ptr<AbstractExecutor> child, const uint32_t attrs[], uint32_t num_attrs);
+
+    void Init() override { _child->Init(); }
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override { return _output_schema; }
+    bool HasFailed() const override { return _child->HasFailed(); }
+
+private:
+    std::unique_ptr<AbstractExecutor> _child;
+    std::array<uint32_t, MAX_COLUMN_COUNT> _attrs;
+    uint32_t _num_attrs{0};
+    Schema _output_schema;
+    std::vector<TupleView> _child_batch;
+    /** The vectorized projection (when the columns are fixed-width) */
+    std::optional<VectorProjection> _projection;
+    SelectionBitmap _selection;
+    /** The rows made of values (when some column is not fixed-width) */
+    std::vector<Tuple> _tuples;
+};
+
+}
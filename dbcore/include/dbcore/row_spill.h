@@ -0,0 +1,89 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+#include <dbcore/page_guard.h>
+#include <dbcore/rid.h>
+#include <dbcore/tuple_view.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dbcore
+{
+
+class PagesManager;
+
+/**
+ * RowSpill keeps the rows which don't fit into the memory of an operator (e.g. the partition
+ * of the hash join) in the temporary pages of the PagesManager, so they are evicted onto the storage
+ * under the memory pressure like the other pages. The rows are appended into the page-sized buffer,
+ * which is copied into the new page when it's full, so the page is pinned only while it's written
+ * (many spills are filled at once, e.g. one per partition). The rows are read back a page at a time.
+ * The pages are given back when the spill is cleared or destroyed.
+ *
+ * The page format:
+ * ---------------------------------------------------------------
+ * | USED_SIZE(4) | LENGTH(4) | RID(8) | DATA(LENGTH) | ... |
+ * ---------------------------------------------------------------
+*/
+class RowSpill final
+{
+    RowSpill(const RowSpill&) = delete;
+    RowSpill& operator=(const RowSpill&) = delete;
+
+public:
+    explicit RowSpill(PagesManager& pages_manager);
+    RowSpill(RowSpill&& other) = default;
+
+    ~RowSpill();
+
+    /**
+     * Append the row.
+     * @param row the row to append
+     * @return false if there is no free page (or the row doesn't fit into a page)
+    */
+    bool Append(const TupleView& row);
+
+    /**
+     * @return the number of appended rows
+    */
+    uint64_t GetNumRows() const { return _num_rows; }
+
+    /**
+     * @return the number of pages of the spill
+    */
+    size_t GetNumPages() const { return _pages.size(); }
+
+    /**
+     * Write the buffered rows into the page, so all of the rows can be read.
+     * @return false if there is no free page
+    */
+    bool Finish();
+
+    /**
+     * Read the rows of the page (the spill has to be finished).
+     * @param idx the index of the page of the spill
+     * @param[out] page_guard the guard of the page, the views are valid while it's held
+     * @param[out] rows the rows of the page in order they were appended
+    */
+    void ReadPage(size_t idx, ReadPageGuard& page_guard, std::vector<TupleView>& rows) const;
+
+    /**
+     * Give back the pages, the spill becomes empty.
+    */
+    void Clear();
+
+public:
+    static constexpr uint32_t PAGE_HEADER_SIZE = sizeof(uint32_t);
+    static constexpr uint32_t ROW_HEADER_SIZE = sizeof(uint32_t) + sizeof(RID);
+
+private:
+    PagesManager* _pages_manager{nullptr};
+    std::vector<page_id_t> _pages;
+    /** The rows which are not written into the page yet (in the page format) */
+    std::vector<char> _buffer;
+    uint32_t _buffer_size{0};
+    uint64_t _num_rows{0};
+};
+
+}
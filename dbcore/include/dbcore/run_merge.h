@@ -0,0 +1,108 @@
+#pragma once
+
+#include <dbcore/loser_tree.h>
+#include <dbcore/page_guard.h>
+#include <dbcore/row_spill.h>
+#include <dbcore/tuple_view.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace dbcore
+{
+
+class PagesManager;
+
+/**
+ * RunMerge merges the sorted runs spilled into the pages (see RowSpill) by the loser tree,
+ * e.g. the runs of the external sort or those of the index bulk load. The rows are compared
+ * by their normalized keys with memcmp (see KeyEncoder): the key is extracted from the row
+ * by the given function when the cursor moves onto the row, or the row itself is the key
+ * when there is no such function. The rows may be compared by the given function instead
+ * (e.g. when the keys keep only the prefixes of VARCHAR values). The equal keys come in order of the runs.
+ * Each run is read a page at a time, only the current page of each run is pinned.
+ * The runs which are more than the fan-in are merged in a number of passes (see Reduce).
+*/
+class RunMerge final
+{
+    RunMerge(const RunMerge&) = delete;
+    RunMerge& operator=(const RunMerge&) = delete;
+
+public:
+    /** Write the normalized key of the row into the buffer of the key size */
+    using KeyExtractor = std::function<void(const TupleView& row, char* key)>;
+    /** Whether the row lhs (with its normalized key) goes before the row rhs */
+    using RowLess = std::function<bool(const char* lhs_key, const TupleView& lhs, const char* rhs_key, const TupleView& rhs)>;
+
+    /**
+     * @param key_size the size of the normalized key
+     * @param extract_key the extraction of the key from the row, empty when the row is the key
+     * @param less the comparison of the rows, empty when they are compared by memcmp of their keys
+    */
+    RunMerge(uint32_t key_size, KeyExtractor extract_key = {}, RowLess less = {});
+
+    /**
+     * Open the cursors over the runs [begin, end) and play the loser tree.
+     * The runs must live and not change until the merge is closed (or opened again).
+    */
+    void Open(const std::vector<RowSpill>& runs, size_t begin, size_t end);
+
+    /**
+     * Release the pages of the runs held by the cursors.
+    */
+    void Close();
+
+    /**
+     * @return the smallest current row of the merge, nullptr when all of the runs are exhausted
+     * (the row is valid until the next Pop)
+    */
+    const TupleView* Top() const;
+
+    /**
+     * Advance the cursor of the smallest row and replay the loser tree.
+    */
+    void Pop();
+
+    /**
+     * Merge the runs in passes until there are at most max_fan_in of them (each pass merges
+     * the groups of max_fan_in adjacent runs, so the order of the equal keys is kept).
+     * The merged runs are cleared as soon as their merge is spilled. The merge is closed then.
+     * @param runs the sorted runs, they are replaced by the merged ones
+     * @param pages_manager the pages manager to spill the merged runs
+     * @param max_fan_in the max number of runs merged at once (at least two)
+     * @return false if there is no free page to spill the merged run
+    */
+    bool Reduce(std::vector<RowSpill>& runs, PagesManager& pages_manager, uint32_t max_fan_in);
+
+private:
+    /** The position in the run, the rows are empty when the run is exhausted */
+    struct RunCursor
+    {
+        const RowSpill* _run{nullptr};
+        size_t _page{0};
+        ReadPageGuard _page_guard;
+        std::vector<TupleView> _rows;
+        size_t _pos{0};
+        /** The key of the current row (when it's extracted) */
+        std::vector<char> _key;
+    };
+
+    /** Move the cursor to the next row of its run */
+    void Advance(RunCursor& cursor) const;
+
+    /** @return the normalized key of the current row of the cursor */
+    const char* GetKey(const RunCursor& cursor) const;
+
+    /** Compare the current rows of two cursors, the exhausted cursor is greater than any other one */
+    bool CursorLess(uint32_t lhs, uint32_t rhs) const;
+
+private:
+    uint32_t _key_size{0};
+    KeyExtractor _extract_key;
+    RowLess _less;
+    std::vector<RunCursor> _cursors;
+    LoserTree _loser_tree;
+};
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace dbcore
+{
+
+/**
+ * SelectionBitmap marks the rows of a batch which passed the filter, one bit per row.
+ * The bits are packed into 64-bit words, so the compare kernels produce (and combine)
+ * the selection of 64 rows at a time and the selected rows are enumerated by scanning the set bits.
+ * The bits past the number of rows are always zero.
+*/
+class SelectionBitmap final
+{
+    SelectionBitmap(const SelectionBitmap&) = delete;
+    SelectionBitmap& operator=(const SelectionBitmap&) = delete;
+
+public:
+    SelectionBitmap() = default;
+    SelectionBitmap(SelectionBitmap&&) = default;
+    SelectionBitmap& operator=(SelectionBitmap&&) = default;
+
+    /**
+     * Resize the bitmap and select all (or none) of the rows.
+     * @param num_rows the number of rows in the batch
+     * @param selected whether the rows are selected
+    */
+    void Reset(uint32_t num_rows, bool selected);
+
+    /**
+     * @return the number of rows in the batch
+    */
+    uint32_t GetNumRows() const { return _num_rows; }
+
+    bool IsSelected(uint32_t row) const
+    {
+        assert(row < _num_rows);
+        return (_words[row / 64] >> (row % 64)) & 1;
+    }
+
+    void Select(uint32_t row, bool selected);
+
+    /**
+     * @return the number of selected rows
+    */
+    uint32_t CountSelected() const;
+
+    /**
+     * @return true if no row is selected
+    */
+    bool IsEmpty() const;
+
+    /**
+     * Call the function for each selected row in ascending order.
+     * @param func the function of the row number
+    */
+    template <typename Func>
+    void ForEachSelected(Func&& func) const
+    {
+        for (uint32_t w = 0; w < _words.size(); w++) {
+            for (uint64_t word = _words[w]; word != 0; word &= word - 1) {
+                func(w * 64 + static_cast<uint32_t>(__builtin_ctzll(word)));
+            }
+        }
+    }
+
+    /**
+     * @return the words of the bitmap (the row i is the bit i % 64 of the word i / 64)
+    */
+    uint64_t* GetWords() { return _words.data(); }
+    const uint64_t* GetWords() const { return _words.data(); }
+    uint32_t GetNumWords() const { return static_cast<uint32_t>(_words.size()); }
+
+private:
+    std::vector<uint64_t> _words;
+    uint32_t _num_rows{0};
+};
+
+}
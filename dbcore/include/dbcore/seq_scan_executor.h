@@ -0,0 +1,40 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+#include <dbcore/coretypes.h>
+#include <dbcore/table_batch_iterator.h>
+
+#include <optional>
+
+namespace dbcore
+{
+
+class TableInfo;
+
+/**
+ * SeqScanExecutor produces the live rows of the table a page at a time (see TableBatchIterator),
+ * the views refer to the page, which stays latched until the next batch is requested.
+*/
+class SeqScanExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * @param context the context of the query
+     * @param table_oid the OID of the table to scan
+     * @param prefetch whether to prefetch the next page while the batch is processed
+    */
+    SeqScanExecutor(ExecutorContext& context, table_oid_t table_oid, bool prefetch = false);
+
+    void Init() override;
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override;
+
+private:
+    TableInfo* _table_info{nullptr};
+    bool _prefetch{false};
+    std::optional<TableBatchIterator> _itr;
+    /** Whether the current page of the iterator has been produced */
+    bool _produced{false};
+};
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+#include <dbcore/key_encoder.h>
+#include <dbcore/loser_tree.h>
+#include <dbcore/row_spill.h>
+#include <dbcore/run_merge.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace dbcore
+{
+
+/**
+ * SortExecutor produces the rows of the child in ascending order of the key columns
+ * (ORDER BY, the input of the merge join), the rows of equal keys keep the order of the child.
+ * The keys are normalized (see KeyEncoder), so they are compared with memcmp.
+ * The normalized VARCHAR keys keep the prefix of declared length only (as in the indexes),
+ * so when the key has VARCHAR columns and the normalized keys are equal up to the end of
+ * the first VARCHAR column, the rows are compared by their full values (see Tuple::CompareKeys).
+ *
+ * The rows of the child are copied into the memory along with their normalized keys.
+ * The rows are sorted by the runs which fit into L2: the keys up to 8 bytes (the integer keys)
+ * without VARCHAR columns are sorted by LSD radix sort, the others by comparison. The runs are merged by the loser tree.
+ *
+ * When the rows exceed the memory budget, the sorted rows are spilled into the pages of
+ * the PagesManager (see RowSpill) as one run, and the memory is reused for the next rows.
+ * The spilled runs are merged by RunMerge (up to MAX_MERGE_FAN_IN runs at once,
+ * the more runs are merged in a number of passes). Without the pages manager (see ExecutorContext)
+ * the sort is always in memory.
+ * When there is no free page to spill the rows, the sort fails (see HasFailed) and produces no rows.
+*/
+class SortExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * @param context the context of the query
+     * @param child the executor which produces the rows to sort
+     * @param key_attrs the key columns of the child's schema
+     * @param num_keys the number of key columns
+     * @param memory_budget the memory for the rows, they are spilled when the budget is exceeded
+    */
+    SortExecutor(ExecutorContext& context, std::unique_ptr<AbstractExecutor> child,
+                 const uint32_t key_attrs[], uint32_t num_keys, size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+
+    void Init() override;
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override { return _child->GetOutputSchema(); }
+    bool HasFailed() const override { return _failed || _child->HasFailed(); }
+
+    /**
+     * @return the number of runs spilled (by the last Init), 0 when the sort is in memory
+    */
+    size_t GetNumSpilledRuns() const { return _num_spilled_runs; }
+
+public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+    static constexpr uint32_t MAX_MERGE_FAN_IN = 16;
+    static constexpr size_t L2_CACHE_SIZE = 256 * 1024;
+
+private:
+    /** Copy the row and its key into the memory */
+    void AppendRow(const TupleView& row);
+
+    /** @return the memory used by the rows, their keys and the order */
+    size_t GetMemoryUsage() const;
+
+    /** Sort the rows in the memory, _order becomes the indices of the rows in ascending order */
+    void SortRows();
+
+    /** Sort the rows [begin, end) by the keys (the run of SortRows), write their indices into _order */
+    void SortRun(uint32_t begin, uint32_t end);
+
+    /** Sort the rows in the memory and spill them as the new run (the memory is cleared), false on failure */
+    bool SpillRows();
+
+    /** Whether the row lhs (with its normalized key) goes before the row rhs */
+    bool RowLess(const char* lhs_key, const char* lhs_data, const char* rhs_key, const char* rhs_data) const;
+
+    /** Compare the rows in the memory */
+    bool RowLess(uint32_t lhs, uint32_t rhs) const
+    {
+        return RowLess(GetKey(lhs), _data.data() + _offsets[lhs], GetKey(rhs), _data.data() + _offsets[rhs]);
+    }
+
+    const char* GetKey(uint32_t row) const { return _keys.data() + static_cast<size_t>(row) * _key_size; }
+    TupleView GetRow(uint32_t row) const;
+
+private:
+    ExecutorContext& _context;
+    std::unique_ptr<AbstractExecutor> _child;
+    std::array<uint32_t, MAX_COLUMN_COUNT> _key_attrs;
+    KeyEncoder _key_encoder;
+    uint32_t _key_size{0};
+    /** Whether the key has VARCHAR columns, which are compared by their full values on ties */
+    bool _has_varchar_keys{false};
+    /** The part of the normalized key which compares as the full values (up to the end of the first VARCHAR) */
+    uint32_t _exact_key_size{0};
+    size_t _memory_budget{0};
+
+    /** The rows in the memory: the data, the offsets (one more than the rows) and RIDs */
+    std::vector<char> _data;
+    std::vector<uint32_t> _offsets;
+    std::vector<RID> _rids;
+    /** The normalized keys of the rows */
+    std::vector<char> _keys;
+    /** The indices of the rows in the sorted order, the next one to produce */
+    std::vector<uint32_t> _order;
+    size_t _next{0};
+
+    /** The merge of the runs in the memory */
+    LoserTree _loser_tree;
+
+    /** The spilled runs and the merge of them */
+    std::vector<RowSpill> _runs;
+    size_t _num_spilled_runs{0};
+    RunMerge _merge;
+    /** The merged rows of the batch are copied, the cursors release their pages */
+    std::vector<char> _buffer;
+    std::vector<uint32_t> _buffer_offsets;
+    std::vector<RID> _buffer_rids;
+    /** Whether the rows could not be spilled (by the last Init) */
+    bool _failed{false};
+
+    std::vector<TupleView> _child_batch;
+};
+
+}
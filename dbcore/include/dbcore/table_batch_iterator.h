@@ -0,0 +1,67 @@
+#pragma once
+
+#include <dbcore/coretypes.h>
+#include <dbcore/page_guard.h>
+#include <dbcore/rid.h>
+#include <dbcore/tuple_view.h>
+
+#include <vector>
+
+namespace dbcore
+{
+
+class TableHeap;
+
+/**
+ * TableBatchIterator scans a TableHeap page by page. Each page is pinned and read-latched once,
+ * the views of all of its live tuples are collected into the batch, so the per-row cost of scan
+ * is the access to the view only. The batch (and the views) are valid until the iterator is moved.
+ * Optionally the next page of the chain is prefetched from the storage while the current batch is processed.
+ * Like @ref TableIterator the caller must not modify the current page in the same thread.
+*/
+class TableBatchIterator final
+{
+    TableBatchIterator(const TableBatchIterator&) = delete;
+    TableBatchIterator& operator=(const TableBatchIterator&) = delete;
+
+public:
+    /**
+     * @param table_heap the table to scan
+     * @param page_id the first page of the range to scan
+     * @param stop_at_rid the RID just past the range (the tuples of the pages appended later are not scanned)
+     * @param prefetch whether to prefetch the next page
+    */
+    TableBatchIterator(TableHeap &table_heap, page_id_t page_id, const RID& stop_at_rid, bool prefetch = false);
+    TableBatchIterator(TableBatchIterator&&) = default;
+
+    bool IsEnd() const { return _page_guard.PageId() == INVALID_PAGE_ID; }
+
+    /**
+     * @return the ID of the current page
+    */
+    page_id_t GetPageId() const { return _page_guard.PageId(); }
+
+    /**
+     * @return the views of the live tuples of the current page in order of their slots (never empty until the end)
+    */
+    const std::vector<TupleView>& GetBatch() const { return _batch; }
+
+    /**
+     * Move to the next page which has the live tuples.
+    */
+    void Next();
+
+private:
+    /** Load the batch of the page or of the next one (when it has no live tuples in the range) */
+    void LoadPage(page_id_t page_id);
+
+private:
+    TableHeap& _table_heap;
+    RID _stop_at_rid;
+    bool _prefetch{false};
+    ReadPageGuard _page_guard;
+    /** The views of tuples of the current page, the vector is reused for all of the pages */
+    std::vector<TupleView> _batch;
+};
+
+}
@@ -1,16 +1,24 @@
 #pragma once
 
 #include <dbcore/coretypes.h>
+#include <dbcore/free_space_map.h>
 #include <dbcore/tuple.h>
+#include <dbcore/tuple_view.h>
 #include <dbcore/rid.h>
 #include <dbcore/pages_manager.h>
 #include <dbcore/table_iterator.h>
+#include <dbcore/table_batch_iterator.h>
 
+#include <functional>
 #include <mutex>
+#include <vector>
 
 namespace dbcore
 {
 
+class LogManager;
+class LogRecord;
+
 /**
  * TableHeap represents a table on some kind of storage (memory, disk, etc)
 */
@@ -22,17 +30,68 @@ class TableHeap final
 public:
     /**
      * Create a table heap.
+     * @param pages_manager the pages manager to keep the table pages
+     * @param log_manager the write-ahead log where to log the changes, nullptr when they are not logged
+    */
+    explicit TableHeap(PagesManager& pages_manager, LogManager* log_manager = nullptr);
+
+    /**
+     * Open the existing table heap (e.g. after recovery).
+     * @param pages_manager the pages manager which keeps the table pages
+     * @param first_page_id the ID of the first page of the table
+     * @param log_manager the write-ahead log where to log the changes, nullptr when they are not logged
+     * @param last_page_id the last page of the table known so far (e.g. kept by the catalog),
+     * the chain is followed from it (or from the first page when it's INVALID_PAGE_ID) up to the actual end.
+     * The free space of the pages before it is collected lazily by the inserts (see CollectFreeSpace).
     */
-    explicit TableHeap(PagesManager& pages_manager);
+    TableHeap(PagesManager& pages_manager, page_id_t first_page_id, LogManager* log_manager = nullptr,
+            page_id_t last_page_id = INVALID_PAGE_ID);
+
+    /**
+     * @return the ID of the first page of the table
+    */
+    page_id_t GetFirstPageId() const { return _first_page_id; }
+
+    /**
+     * @return the ID of the last page of the table (where the new tuples are inserted)
+    */
+    page_id_t GetLastPageId();
 
     /**
      * Insert a tuple into the table. If the tuple is too large (>= page_size), return invalid RID.
+     * The tuple is inserted into some page which has the free space (see @ref FreeSpaceMap),
+     * the new page is appended to the table when there is no such page.
      * @param meta tuple meta
      * @param tuple tuple to insert
      * @return rid of the inserted tuple
     */
     RID InsertTuple(const TupleMeta &meta, const Tuple &tuple);
 
+    /**
+     * Mark the tuple as deleted. Its space is reclaimed by the page compaction,
+     * its RID is not reused until the slot is released (see @ref ReleaseSlot).
+     * @param rid the ID of the tuple to delete
+     * @return false if there is no such tuple (or it's already deleted)
+    */
+    bool MarkDelete(const RID& rid);
+
+    /**
+     * Release the slot of the deleted tuple, so its RID is reused by the next tuple inserted into the page.
+     * @attention The index entries of the tuple must be removed before, otherwise they would refer to another tuple.
+     * @param rid the ID of the deleted tuple
+     * @return false if there is no such tuple, it's not deleted or its slot is already released
+    */
+    bool ReleaseSlot(const RID& rid);
+
+    /**
+     * Replace the tuple keeping its RID.
+     * @param meta the new meta of the tuple
+     * @param tuple the new tuple data
+     * @param rid the ID of the tuple to update
+     * @return false if there is no such tuple or the new data can't fit in the tuple's page
+    */
+    bool UpdateTupleInPlace(const TupleMeta &meta, const Tuple &tuple, const RID& rid);
+
     /**
      * Create a table iterator instance.
      * When the iterator is created it will bounded at the end by 
@@ -43,6 +102,49 @@ public:
     // TableIterator MakeIterator() const;
     TableIterator MakeIterator();
 
+    /**
+     * Split the table into ranges of adjacent pages to scan them in parallel.
+     * Like @ref MakeIterator the ranges are bounded by the last tuple at the moment of call.
+     * @param max_partitions the maximal number of ranges (the table might have fewer pages)
+     * @return the iterators over the ranges, which together cover the whole table in its order
+    */
+    std::vector<TableIterator> MakePartitionedIterators(uint32_t max_partitions);
+
+    /**
+     * Create an iterator which scans the table page by page (see @ref TableBatchIterator).
+     * Like @ref MakeIterator it's bounded by the last tuple at the moment of call.
+     * @param prefetch whether to prefetch the next page while the current one is processed
+     * @return the batch iterator of the table
+    */
+    TableBatchIterator MakeBatchIterator(bool prefetch = false);
+
+    /**
+     * The callback of parallel scan, it's called with the batch of tuples of one page.
+     * @param worker_id the identifier of the worker in range [0, num_threads)
+     * @param batch the views of the live tuples of the page (valid during the call only)
+    */
+    using ScanCallback = std::function<void(uint32_t worker_id, const std::vector<TupleView>& batch)>;
+
+    /**
+     * Scan the table by the number of threads (the calling one is the first of them).
+     * The chain of pages is split into the morsels of adjacent pages, which are handed out
+     * to the workers by the work-stealing @ref MorselScheduler. Each worker scans its morsels
+     * by @ref TableBatchIterator (with prefetch), so the pages are not processed in the table order.
+     * Like @ref MakeIterator the scan is bounded by the last tuple at the moment of call.
+     * @param num_threads the number of threads to scan
+     * @param callback the function called for each page batch, it's called concurrently by the workers
+     * @param morsel_size the number of pages in a morsel
+    */
+    void ParallelScan(uint32_t num_threads, const ScanCallback& callback, uint32_t morsel_size = SCAN_MORSEL_SIZE);
+
+    /**
+     * Find the tuples which satisfy the predicate by the parallel scan (see @ref ParallelScan).
+     * @param num_threads the number of threads to scan
+     * @param predicate the filter, it's called concurrently by the workers
+     * @return the RIDs of found tuples (in no particular order)
+    */
+    std::vector<RID> ParallelFilter(uint32_t num_threads, const std::function<bool(const TupleView&)>& predicate);
+
     /**
      * Read a tuple from the table.
      * @param rid the ID of required tuple
@@ -50,15 +152,70 @@ public:
     */
     std::pair<TupleMeta, Tuple> GetTuple(const RID& rid) const;
 
+    /**
+     * Get the view of a tuple of the table (without copying its data).
+     * @param rid the ID of required tuple
+     * @param[out] page_guard the guard of tuple's page, the view is valid while it's held
+     * (the guard which already holds the tuple's page is reused, e.g. for the lookups of RIDs of the same page)
+     * @return the meta and view, the view is empty when rid is not valid or the tuple is deleted
+    */
+    std::pair<TupleMeta, TupleView> GetTupleView(const RID& rid, ReadPageGuard& page_guard) const;
+
+public:
+    /** The default number of pages in a morsel of parallel scan */
+    static constexpr uint32_t SCAN_MORSEL_SIZE = 16;
+
+private:
+    /**
+     * Collect the IDs of pages up to the last one at the moment of call.
+     * @param[out] stop_at_rid the RID just past the last tuple
+    */
+    std::vector<page_id_t> CollectPages(RID* stop_at_rid);
+
+    /** Append the record to the log and stamp the changed page with its LSN */
+    void LogPageChange(const LogRecord& record, WritePageGuard& page_guard);
+
+    /**
+     * Insert the tuple into the page found by the free space map.
+     * @return the RID of inserted tuple or invalid RID when no page has the space
+    */
+    RID InsertIntoFreePage(const TupleMeta &meta, const Tuple &tuple);
+
+    /**
+     * Insert the tuple into the last page, the new page is appended when the tuple doesn't fit.
+    */
+    RID InsertIntoLastPage(const TupleMeta &meta, const Tuple &tuple);
+
+    /**
+     * Collect the free space of the next FSM_COLLECT_PAGES pages of the chain which are not in
+     * the free space map yet (the pages before the last page known when the table was opened),
+     * so the space left by the deletes before the restart is reused without reading the whole
+     * table on open. Only one inserter collects at a time, the others don't wait for it.
+     * @return false when there was nothing collected (all of the pages are in the map or another inserter collects)
+    */
+    bool CollectFreeSpace();
+
+public:
+    static constexpr uint32_t FSM_COLLECT_PAGES = 16;
+
 private:
     PagesManager& _pages_manager;
+    LogManager* _log_manager{nullptr};
 
     page_id_t _first_page_id{INVALID_PAGE_ID};
     /** The mutex ensure exclusive access to the @ref _last_page_id field */
     std::mutex _mutex;
     page_id_t _last_page_id{INVALID_PAGE_ID};
 
+    /** The pages which have the free space for the new tuples */
+    FreeSpaceMap _free_space_map;
+    /** The mutex protects the range of pages not collected into the map yet: [next, end) */
+    std::mutex _collect_mutex;
+    page_id_t _collect_next_page_id{INVALID_PAGE_ID};
+    page_id_t _collect_end_page_id{INVALID_PAGE_ID};
+
     friend class TableIterator; // friendship to access to _pages_manager field only!
+    friend class TableBatchIterator; // the same as above
 };
 
 
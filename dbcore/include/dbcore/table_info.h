@@ -23,6 +23,10 @@ public:
 
     const char* GetTableName() const { return _table_name; }
 
+    const Schema& GetSchema() const { return _schema; }
+
+    table_oid_t GetTableOid() const { return _table_oid; }
+
     TableHeap* GetTableHeap() { return _table_heap; }
 
 private:
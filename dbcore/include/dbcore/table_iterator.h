@@ -1,17 +1,25 @@
 #pragma once
 
 #include <dbcore/coretypes.h>
+#include <dbcore/page_guard.h>
 #include <dbcore/rid.h>
 #include <dbcore/tuple.h>
+#include <dbcore/tuple_view.h>
 
 namespace dbcore
 {
 
 class TableHeap;
+class TablePage;
 class PagesManager;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ * The deleted tuples are skipped.
+ * The iterator keeps its current page pinned and read-latched (since the first access to its tuple
+ * up to the move to another page), so the tuple views are got without copying and the next tuple
+ * of the same page is found without pinning the page again. The caller must not modify the current page
+ * of the iterator (e.g. delete the current tuple) in the same thread while the iterator is positioned on it.
 */
 class TableIterator final
 {
@@ -23,15 +31,35 @@ public:
     TableIterator(TableHeap &table_heap, const RID& rid, const RID& stop_at_rid);
     TableIterator(TableIterator&&) = default;
 
-    // TO DO: documentation.
+    /**
+     * @return the meta and the copy of the current tuple
+    */
     std::pair<TupleMeta, Tuple> GetTuple() const;
+
+    /**
+     * @return the meta and the view of the current tuple, the view is valid until the iterator is moved
+    */
+    std::pair<TupleMeta, TupleView> GetTupleView() const;
+
     RID GetRID() const { return _rid; }
     bool IsEnd() const { return _rid.GetPageId() == INVALID_PAGE_ID; }
 
     void Next();
 
+private:
+    /**
+     * Move to the first live tuple starting from the given slot (inclusive),
+     * or to the end when the stop-tuple or the end of table is reached.
+    */
+    void SeekLive(page_id_t page_id, slot_id_t slot_id);
+
+    /** @return the current page, it's pinned and latched on the first access */
+    const TablePage* GetPage() const;
+
 private:
     TableHeap& _table_heap;
+    /** The guard of the current page (it's acquired lazily, so the idle iterators don't hold the pages) */
+    mutable ReadPageGuard _page_guard;
     RID _rid;
     /** The ID of the last available record at the moment when iterator created. */
     RID _stop_at_rid;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <dbcore/tuple.h>
+#include <dbcore/tuple_view.h>
 
 #include <cstdint>
 
@@ -9,6 +10,26 @@
 namespace dbcore
 {
 
+/**
+ * TablePage is the slotted page of the table heap.
+ * The slots array grows from the header towards the end of the page,
+ * the tuples data grows from the end of the page towards the slots.
+ * The data of the deleted tuple becomes dead space, which is reclaimed by compaction,
+ * but its slot stays the tombstone: the index entries might still refer to the RID of the tuple,
+ * so the slot is not reused until it's released explicitly (see ReleaseSlot), once the index
+ * entries are gone. The released slots are reused by the next inserts.
+ * The compaction moves the live tuples together at the end of the page,
+ * so the slot IDs (and RIDs) of the live tuples are stable.
+ * The page is compacted by the insert or update which doesn't fit into the contiguous free space,
+ * it's deterministic, so the redo of the logged changes gets the same layout of the page.
+ *
+ * Table page format:
+ * ---------------------------------------------------------------------------------------
+ * | LSN(8) | NEXT_PAGE_ID(4) | NUM_TUPLES(2) | NUM_DELETED(2) | FREE_SPACE_OFFSET(2) | ...
+ * ---------------------------------------------------------------------------------------
+ * ... | DEAD_SIZE(2) | NUM_FREE_SLOTS(2) | RESERVED(2) | SLOT_0 | SLOT_1 | ... | FREE SPACE | ... | TUPLE_1 | TUPLE_0 |
+ * ---------------------------------------------------------------------------------------------
+*/
 class TablePage final
 {
     TablePage(const TablePage&) = delete;
@@ -25,6 +46,29 @@ public:
     */
     uint16_t GetNumTuples() const { return _num_tuples; }
 
+    /**
+     * @return number of deleted tuples (the tombstones and the released slots)
+    */
+    uint16_t GetNumDeletedTuples() const { return _num_deleted_tuples; }
+
+    /**
+     * @return number of the released slots of deleted tuples, which are reused by the inserts
+    */
+    uint16_t GetNumFreeSlots() const { return _num_free_slots; }
+
+    /**
+     * @return the size of the largest tuple which can be inserted into the page (after compaction)
+    */
+    uint32_t GetFreeSpace() const;
+
+    /**
+     * @return the LSN of the latest log record applied to the page
+    */
+    lsn_t GetLSN() const { return _lsn; }
+
+    /** set the LSN of the latest log record applied to the page */
+    void SetLSN(lsn_t lsn) { _lsn = lsn; }
+
     /**
      * @return the page ID of the next table's page
     */
@@ -33,16 +77,54 @@ public:
     /** set the page ID of the next table's page */
     void SetNextPageId(page_id_t next_page_id) { _next_page_id = next_page_id; }
 
-    /** Get the next offset to insert, return INVALID_SLOT_OFFSET if the tuple can't fit in the page */
+    /**
+     * Get the next offset to insert (the page is compacted before insert when the contiguous space is not enough),
+     * return INVALID_SLOT_OFFSET if the tuple can't fit in the page
+    */
     slot_offset_t GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) const;
 
     /**
-     * Insert a tuple into the page.
+     * Insert a tuple into the page. The released slot of the deleted tuple is reused if any.
      * @param tuple tuple to insert
      * @return slot_id if the insert is successfull, INVALID_SLOT_ID otherwise (ex. not enough space)
     */
     slot_id_t InsertTuple(const TupleMeta &meta, const Tuple &tuple);
 
+    /**
+     * Mark the tuple as deleted, its data becomes dead space and its slot becomes the tombstone.
+     * @param slot_id the slot of the tuple to delete
+     * @return false if the slot is out of range or the tuple is already deleted
+    */
+    bool MarkDelete(slot_id_t slot_id);
+
+    /**
+     * Release the slot of the deleted tuple, so it's reused by the next insert.
+     * @param slot_id the slot of the deleted tuple
+     * @return false if the slot is out of range, its tuple is not deleted or the slot is already released
+    */
+    bool ReleaseSlot(slot_id_t slot_id);
+
+    /**
+     * Replace the tuple keeping its slot. The smaller (or the same size) tuple overwrites the old data,
+     * the larger one is placed into the free space (the page is compacted when needed).
+     * @param meta the new meta of the tuple
+     * @param tuple the new tuple data
+     * @param slot_id the slot of the tuple to update
+     * @return false if the tuple is deleted (or doesn't exist) or the new data can't fit in the page
+    */
+    bool UpdateTupleInPlace(const TupleMeta &meta, const Tuple &tuple, slot_id_t slot_id);
+
+    /**
+     * Move the data of the live tuples together to the end of the page
+     * to reclaim the dead space, the slots of the tuples are not changed.
+    */
+    void Compact();
+
+    /**
+     * @return true if the tuple is deleted (or the slot is out of range)
+    */
+    bool IsTupleDeleted(slot_id_t slot_id) const;
+
     /**
      * Read a tuple from the page.
      * @param rid the ID of required tuple
@@ -50,14 +132,36 @@ public:
     */ 
     std::pair<TupleMeta, Tuple> GetTuple(const RID& rid) const;
 
+    /**
+     * Get the view of a tuple on the page (without copying its data).
+     * @param rid the ID of required tuple
+     * @return the meta and view, the view is empty when rid is not valid or the tuple is deleted
+    */
+    std::pair<TupleMeta, TupleView> GetTupleView(const RID& rid) const;
+
+private:
+    /** @return the size of contiguous space between the slots and the tuples data */
+    uint32_t GetContiguousSpace(uint32_t num_slots) const;
+
+    /** @return the size of space (contiguous and dead) which is not used by the slots and the tuples data */
+    uint32_t GetAvailableSpace(uint32_t num_slots) const;
+
 private:
     using TupleInfo = std::tuple<slot_offset_t, uint16_t, TupleMeta>;
     static constexpr size_t TUPLE_INFO_SIZE = sizeof(TupleInfo);
-    static constexpr size_t TABLE_PAGE_HEADER_SIZE = sizeof(page_id_t) + sizeof(uint16_t) + sizeof(uint16_t);
+    static constexpr size_t TABLE_PAGE_HEADER_SIZE = sizeof(lsn_t) + sizeof(page_id_t) + 6 * sizeof(uint16_t);
     char _page_data[0];
+    lsn_t _lsn{INVALID_LSN};
     page_id_t _next_page_id{INVALID_PAGE_ID};
     uint16_t _num_tuples{0};
     uint16_t _num_deleted_tuples{0};
+    /** The beginning of the tuples data */
+    uint16_t _free_space_offset{PAGE_SIZE};
+    /** The size of data which belongs to no tuple (reclaimed by compaction) */
+    uint16_t _dead_size{0};
+    /** The number of released slots (the offset of released slot is INVALID_SLOT_OFFSET) */
+    uint16_t _num_free_slots{0};
+    uint16_t _reserved{0};
     TupleInfo _tuple_info[0];
 };
 
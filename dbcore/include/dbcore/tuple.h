@@ -77,6 +77,11 @@ public:
    */
    uint32_t GetLength() const { return _length; }
 
+   /**
+    * Get the record ID of the tuple
+   */
+   const RID& GetRID() const { return _rid; }
+
    /**
     * Generates a key tuple (subset of tuple's fields)
     * @param schema - the tuple's schema
@@ -88,6 +93,35 @@ public:
    Tuple KeyFromTuple(const Schema& schema, const Schema& key_schema,
             std::array<uint32_t, MAX_COLUMN_COUNT> key_attrs, uint32_t key_attr_count) const;
 
+   /**
+    * Writes the data of key tuple into the given buffer (the key tuple is not allocated),
+    * so the buffer can be reused from key to key. The key attributes must be inlined.
+    * @param data - the tuple's data
+    * @param schema - the tuple's schema
+    * @param key_schema - the key's schema
+    * @param key_attrs - the array of positions of key's attributes in tuple
+    * @param key_attr_count - the number of key attributes
+    * @param key - the buffer of key_schema.GetInlinedStorageSize() bytes
+   */
+   static void KeyFromTuple(const char* data, const Schema& schema, const Schema& key_schema,
+            const uint32_t key_attrs[], uint32_t key_attr_count, char* key);
+
+   /**
+    * Compares the key attributes of two tuples by their full values, VARCHAR values included
+    * (unlike the normalized keys of the indexes, see KeyEncoder, which keep their prefixes only).
+    * The tuples may have different schemas, the key attributes must have the same types.
+    * @param lhs - the first tuple's data
+    * @param lhs_schema - the first tuple's schema
+    * @param lhs_attrs - the positions of key attributes in the first tuple
+    * @param rhs - the second tuple's data
+    * @param rhs_schema - the second tuple's schema
+    * @param rhs_attrs - the positions of key attributes in the second tuple
+    * @param key_attr_count - the number of key attributes
+    * @return -1 when lhs key is less than rhs key, 1 when it is greater, 0 when they are equal
+   */
+   static int CompareKeys(const char* lhs, const Schema& lhs_schema, const uint32_t lhs_attrs[],
+            const char* rhs, const Schema& rhs_schema, const uint32_t rhs_attrs[], uint32_t key_attr_count);
+
 
     /**
      * Get value of attribute (field) at specified position using a given scheme and tuple's data.
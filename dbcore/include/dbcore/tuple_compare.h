@@ -6,9 +6,18 @@ namespace dbcore
 {
 
 class Tuple;
+class KeyEncoder;
 
 /**
  * The class comparator for tuples. 
+ * The comparison routine is selected once by schema at construction:
+ * - the key of single integer column is compared as native integer;
+ * - the key of several fixed-width columns is compared column by column 
+ *   reading native values at precomputed offsets;
+ * - otherwise (e.g. there are variable-length columns) the values are compared
+ *   via Value objects.
+ * None of the routines for fixed-width keys allocates memory.
+ * The comparator of normalized keys (see KeyEncoder) compares them with memcmp.
 */
 class TupleCompare final
 {
@@ -16,16 +25,64 @@ class TupleCompare final
 public:
     explicit TupleCompare(const Schema& schema);
 
+    /**
+     * Create the comparator of keys normalized by the given encoder.
+     * @param key_encoder the encoder which produces the keys to compare
+    */
+    explicit TupleCompare(const KeyEncoder& key_encoder);
+
+    /**
+     * @return true if the comparator compares normalized keys (i.e. with memcmp)
+    */
+    bool IsNormalized() const { return _normalized_key_size != 0; }
+
+    /**
+     * @return the size of normalized keys or 0 if the comparator is not for normalized keys
+    */
+    uint32_t GetNormalizedKeySize() const { return _normalized_key_size; }
+
     /**
      * Compare two tuples. Both tuples have to be based on the same schema.
      * @param lhs the first tuple's data to compare
      * @param rhs the second tuple's data to compare
-     * @return 
+     * @return -1 when lhs is less than rhs, 1 when lhs is greater than rhs, 0 when they are equal
     */
-    int operator()(const char* lhs, const char* rhs) const;
+    int operator()(const char* lhs, const char* rhs) const { return _compare(*this, lhs, rhs); }
+
+private:
+    using compare_function_t = int (*)(const TupleCompare&, const char*, const char*);
+    using column_compare_function_t = int (*)(const char*, const char*);
+
+    /** Compare native values of type T at the given addresses */
+    template <typename T>
+    static int CompareNative(const char* lhs, const char* rhs);
+
+    /** Compare the keys which consist of the single fixed-width column of type T */
+    template <typename T>
+    static int CompareSingleColumn(const TupleCompare& self, const char* lhs, const char* rhs);
+
+    /** Compare the keys which consist of several fixed-width columns */
+    static int CompareFixedWidth(const TupleCompare& self, const char* lhs, const char* rhs);
+
+    /** Compare the normalized keys byte by byte */
+    static int CompareNormalized(const TupleCompare& self, const char* lhs, const char* rhs);
+
+    /** Compare the keys via Value objects (the generic and slow way) */
+    static int CompareGeneric(const TupleCompare& self, const char* lhs, const char* rhs);
+
+    /** @return the comparator of native values of the given type or nullptr if type is not fixed-width */
+    static column_compare_function_t ColumnCompareFunction(TypeId type);
 
 private:
     Schema _schema;
+    compare_function_t _compare{nullptr};
+    /** The offset of the first column within the tuple */
+    uint32_t _offset{0};
+    /** The size of normalized keys (0 when keys are not normalized) */
+    uint32_t _normalized_key_size{0};
+    /** The offsets and comparators of columns (for keys of several fixed-width columns only) */
+    std::array<uint32_t, MAX_COLUMN_COUNT> _column_offsets;
+    std::array<column_compare_function_t, MAX_COLUMN_COUNT> _column_compare;
 };
 
 }
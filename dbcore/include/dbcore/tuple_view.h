@@ -0,0 +1,86 @@
+#pragma once
+
+#include <dbcore/tuple.h>
+
+#include <array>
+#include <cstdint>
+
+namespace dbcore
+{
+
+/**
+ * TupleView refers to the tuple's data without owning it, e.g. to the tuple on the table page.
+ * The view is valid as long as the data is: the view of the tuple on the page is valid
+ * while the page is pinned and latched (the page guard which was used to get the view is alive).
+ * The view is trivially copyable, so the scans pass the rows around without allocations.
+*/
+class TupleView final
+{
+public:
+    /**
+     * default constructor (to create an empty view)
+    */
+    TupleView() = default;
+
+    /**
+     * @param data - the bytes of the tuple as it is stored on the table page
+     * @param size - the length of data
+     * @param rid - the record ID of the tuple
+    */
+    TupleView(const char* data, uint32_t size, const RID& rid)
+        : _rid(rid)
+        , _data(data)
+        , _length(size)
+    {
+    }
+
+    /**
+     * Make the view of the tuple's data.
+     * The view is valid while the tuple exists and isn't changed.
+    */
+    explicit TupleView(const Tuple& tuple)
+        : TupleView(tuple.GetData(), tuple.GetLength(), tuple.GetRID())
+    {
+    }
+
+    /**
+     * Get the tuple's data
+    */
+    const char* GetData() const { return _data; }
+
+    /**
+     * Get length of the tuple
+    */
+    uint32_t GetLength() const { return _length; }
+
+    /**
+     * Get the record ID of the tuple
+    */
+    const RID& GetRID() const { return _rid; }
+
+    /**
+     * Get value of attribute (field) at specified position.
+     * @param schema - schema of tuple
+     * @param idx - position of field in the tuple
+     * @return value of the field at \ref idx
+    */
+    Value GetValue(const Schema& schema, uint32_t idx) const { return Tuple::GetValue(schema, _data, idx); }
+
+    /**
+     * Generates a key tuple (subset of tuple's fields), see Tuple::KeyFromTuple
+    */
+    Tuple KeyFromTuple(const Schema& schema, const Schema& key_schema,
+            const std::array<uint32_t, MAX_COLUMN_COUNT>& key_attrs, uint32_t key_attr_count) const;
+
+    /**
+     * Copy the viewed data into the tuple which owns it (e.g. to keep it after the page is released)
+    */
+    Tuple ToTuple() const { return Tuple{_data, _length, _rid}; }
+
+private:
+    RID _rid{};
+    const char* _data{nullptr};
+    uint32_t _length{0};
+};
+
+}
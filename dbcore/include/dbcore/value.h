@@ -42,6 +42,11 @@ public:
     Value(TypeId type, const char *data, uint32_t len, bool manage_data);
 
 
+    /**
+     * Get the type of the value.
+    */
+    TypeId GetTypeId() const { return _type_id; }
+
     /**
      * Get the length of variable length data.
     */
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <dbcore/abstract_executor.h>
+#include <dbcore/tuple.h>
+
+namespace dbcore
+{
+
+/**
+ * ValuesExecutor produces the given rows (e.g. the rows to insert), BATCH_SIZE at a time.
+*/
+class ValuesExecutor final : public AbstractExecutor
+{
+public:
+    /**
+     * @param schema the schema of the rows
+     * @param tuples the rows to produce
+    */
+    ValuesExecutor(const Schema& schema, std::vector<Tuple> tuples);
+
+    void Init() override { _next = 0; }
+    bool Next(std::vector<TupleView>& batch) override;
+    const Schema& GetOutputSchema() const override { return _schema; }
+
+private:
+    Schema _schema;
+    std::vector<Tuple> _tuples;
+    /** The index of the next row to produce */
+    size_t _next{0};
+};
+
+}
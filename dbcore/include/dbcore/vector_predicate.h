@@ -0,0 +1,89 @@
+#pragma once
+
+#include <dbcore/column_vector.h>
+#include <dbcore/schema.h>
+#include <dbcore/selection_bitmap.h>
+#include <dbcore/tuple_view.h>
+#include <dbcore/value.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dbcore
+{
+
+enum class CompareOp : uint8_t { EQ, NE, LT, LE, GT, GE };
+
+/**
+ * VectorPredicate evaluates the conjunction of comparisons `column <op> constant`
+ * (e.g. `a > 10 AND b = 'x'`) over the batch of rows (e.g. the batch of TableBatchIterator)
+ * without building the Value objects.
+ * The fixed-width column is decoded into the ColumnVector, then the compare kernel turns
+ * each 64 values into the word of the selection bitmap. The comparisons of the kernel are
+ * the tight loops over the dense native arrays, which the optimizer can vectorize (SIMD)
+ * when the library is built with optimization (see CompareKernel), the default build is not optimized.
+ * The VARCHAR column supports EQ and NE only, its values are compared with the constant in place.
+ * The comparisons are applied in the order they were added, the evaluation stops when no row is left.
+*/
+class VectorPredicate final
+{
+    VectorPredicate(const VectorPredicate&) = delete;
+    VectorPredicate& operator=(const VectorPredicate&) = delete;
+
+public:
+    /**
+     * @param schema the schema of the rows to evaluate
+    */
+    explicit VectorPredicate(const Schema& schema);
+
+    /**
+     * Add the comparison to the conjunction.
+     * @param column_idx the index of the column in the schema
+     * @param op the comparison operation
+     * @param constant the value to compare with (it must have the type of the column)
+     * @return false if the comparison is not supported (the predicate is not changed)
+    */
+    bool AddComparison(uint32_t column_idx, CompareOp op, const Value& constant);
+
+    /**
+     * @return the number of comparisons in the conjunction
+    */
+    uint32_t GetNumComparisons() const { return static_cast<uint32_t>(_comparisons.size()); }
+
+    /**
+     * Evaluate the predicate over the rows (the predicate without comparisons selects all of them).
+     * @param rows the rows
+     * @param num_rows the number of rows
+     * @param[out] selection the rows which satisfy the predicate
+    */
+    void Evaluate(const TupleView rows[], uint32_t num_rows, SelectionBitmap* selection);
+
+    void Evaluate(const std::vector<TupleView>& rows, SelectionBitmap* selection)
+    {
+        Evaluate(rows.data(), static_cast<uint32_t>(rows.size()), selection);
+    }
+
+private:
+    struct Comparison
+    {
+        uint32_t _column_idx{0};
+        CompareOp _op{CompareOp::EQ};
+        /** The constant serialized as it is stored in the tuple (the native value or VARCHAR size and bytes) */
+        std::vector<char> _constant;
+    };
+
+    /** Compare the decoded column with the constant, intersect the result with the selection */
+    void CompareColumn(const Comparison& comparison, SelectionBitmap* selection, bool intersect) const;
+
+    /** Compare the VARCHAR column of rows with the constant, intersect the result with the selection */
+    void CompareVarchar(const Comparison& comparison, const TupleView rows[], SelectionBitmap* selection,
+                        bool intersect) const;
+
+private:
+    Schema _schema;
+    std::vector<Comparison> _comparisons;
+    /** The decoded column, it's reused for each comparison */
+    ColumnVector _column;
+};
+
+}
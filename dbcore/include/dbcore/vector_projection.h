@@ -0,0 +1,80 @@
+#pragma once
+
+#include <dbcore/column_vector.h>
+#include <dbcore/schema.h>
+#include <dbcore/selection_bitmap.h>
+#include <dbcore/tuple_view.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace dbcore
+{
+
+/**
+ * VectorProjection gathers the given fixed-width columns of the selected rows of the batch
+ * (e.g. the rows which passed VectorPredicate) into the column vectors, so the rows which
+ * were filtered out are never touched. The projected rows can be materialized as the tuples
+ * of the output schema, they are packed into the buffer which is reused from batch to batch.
+*/
+class VectorProjection final
+{
+    VectorProjection(const VectorProjection&) = delete;
+    VectorProjection& operator=(const VectorProjection&) = delete;
+
+public:
+    /**
+     * @param schema the schema of the rows to project
+     * @param attrs the indexes of columns to project (they must be fixed-width)
+     * @param num_attrs the number of columns to project
+    */
+    VectorProjection(const Schema& schema, const uint32_t attrs[], uint32_t num_attrs);
+
+    /**
+     * @return true if the columns can be projected
+    */
+    static bool IsSupported(const Schema& schema, const uint32_t attrs[], uint32_t num_attrs);
+
+    /**
+     * @return the schema of the projected rows
+    */
+    const Schema& GetOutputSchema() const { return _output_schema; }
+
+    /**
+     * Gather the columns of the selected rows.
+     * @param rows the rows of the batch
+     * @param selection the rows to project
+    */
+    void Project(const TupleView rows[], const SelectionBitmap& selection);
+
+    /**
+     * @return the number of projected rows
+    */
+    uint32_t GetNumRows() const { return _num_rows; }
+
+    /**
+     * @return the values of the projected column (idx is the position in the output schema)
+    */
+    const ColumnVector& GetColumn(uint32_t idx) const { return _columns[idx]; }
+
+    /**
+     * Make the projected rows the tuples of the output schema (with the RIDs of the source rows).
+     * The views are valid until the next projection.
+    */
+    const std::vector<TupleView>& MaterializeRows();
+
+private:
+    std::array<uint32_t, MAX_COLUMN_COUNT> _attrs;
+    uint32_t _num_attrs{0};
+    Schema _schema;
+    Schema _output_schema;
+    std::vector<ColumnVector> _columns;
+    std::vector<RID> _rids;
+    uint32_t _num_rows{0};
+    /** The data of materialized rows */
+    std::vector<char> _buffer;
+    std::vector<TupleView> _rows;
+};
+
+}
@@ -3,17 +3,32 @@
 #include <dbcore/b_plus_tree_page.h>
 #include <dbcore/b_plus_tree_internal_page.h>
 #include <dbcore/b_plus_tree_leaf_page.h>
+#include <dbcore/page_change_log.h>
 
 #include <dbcore/tuple_compare.h>
 #include <dbcore/rid.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <numeric>
+#include <thread>
 
 using namespace dbcore;
 
+namespace
+{
+
+/** @return the number of items in the i-th page when `count` items are spread evenly among `num_pages` pages */
+size_t ItemsInPage(size_t count, size_t num_pages, size_t i)
+{
+    return count / num_pages + (i < count % num_pages ? 1 : 0);
+}
+
+}
+
 
 BPlusTree::Iterator::Iterator(Iterator&& other)
     : _pages_manager(other._pages_manager)
@@ -33,20 +48,30 @@ BPlusTree::Iterator::Iterator(Iterator&& other)
 //     return *this;
 // }
 
-BPlusTree::Iterator::Iterator(PagesManager& pages_manager, page_id_t start_page_id)
-    : Iterator(pages_manager, start_page_id, 0)
+BPlusTree::Iterator::Iterator(PagesManager& pages_manager)
+    : _pages_manager(pages_manager)
+    , _curr_page_id(INVALID_PAGE_ID)
+    , _curr_pos(0)
 {
 }
 
-BPlusTree::Iterator::Iterator(PagesManager& pages_manager, page_id_t start_page_id, uint16_t start_pos)
+BPlusTree::Iterator::Iterator(PagesManager& pages_manager, ReadPageGuard&& page_guard, uint16_t start_pos)
     : _pages_manager(pages_manager)
-    , _curr_page_id(start_page_id)
+    , _curr_page_id(page_guard.PageId())
     , _curr_pos(start_pos)
+    , _page_guard(std::move(page_guard))
 {
-    if (_curr_page_id != INVALID_PAGE_ID) {
+    // the start position is past the last item when the leaf is the root of the empty tree
+    // or when the lower bound of a key is in the next leaf
+    while (_curr_pos >= _page_guard.As<BPlusTreeLeafPage>()->GetSize()) {
+        _curr_pos = 0;
+        _curr_page_id = _page_guard.As<BPlusTreeLeafPage>()->GetNextPageId();
+        if (_curr_page_id == INVALID_PAGE_ID) {
+            _page_guard.Drop();
+            break;
+        }
         _page_guard = _pages_manager.GetPageRead(_curr_page_id);
     }
-    _curr_pos = 0;
 }
 
 bool BPlusTree::Iterator::IsEnd() const
@@ -65,6 +90,12 @@ RID BPlusTree::Iterator::operator*() const
     return RID{};
 }
 
+const char* BPlusTree::Iterator::GetKey() const
+{
+    assert(_curr_page_id != INVALID_PAGE_ID);
+    return _page_guard.As<BPlusTreeLeafPage>()->KeyAt(_curr_pos);
+}
+
 BPlusTree::Iterator& BPlusTree::Iterator::operator++()
 {
     if (_curr_page_id != INVALID_PAGE_ID) {
@@ -75,6 +106,9 @@ BPlusTree::Iterator& BPlusTree::Iterator::operator++()
             _curr_page_id = page->GetNextPageId();
             if (_curr_page_id != INVALID_PAGE_ID) {
                 _page_guard = _pages_manager.GetPageRead(_curr_page_id);
+            } else {
+                // the end is reached, don't keep the last leaf latched
+                _page_guard.Drop();
             }
         }
     }
@@ -93,23 +127,28 @@ bool BPlusTree::Iterator::operator!=(const Iterator& other) const
 
 
 BPlusTree::BPlusTree(PagesManager& pages_manager, const TupleCompare& tuple_compare, uint32_t key_size,
-                    uint16_t leaf_max_size, uint16_t internal_max_size)
+                    uint16_t leaf_max_size, uint16_t internal_max_size, page_id_t root_page_id /* = INVALID_PAGE_ID*/,
+                    LogManager* log_manager /* = nullptr*/, index_oid_t index_oid /* = INVALID_INDEX_OID*/)
     : _pages_manager(pages_manager)
     , _key_compare(tuple_compare)
     , _key_size(key_size)
     , _leaf_max_size(leaf_max_size)
     , _internal_max_size(internal_max_size)
+    , _log_manager(log_manager)
+    , _index_oid(index_oid)
 {
-    page_id_t root_page_id{INVALID_PAGE_ID};
-    auto guard = _pages_manager.NextFreePageGuarded(&root_page_id);
+    if (root_page_id != INVALID_PAGE_ID) {
+        _root_page_id = root_page_id;
+        return;
+    }
+
+    auto guard = _pages_manager.NextFreePageGuarded(&root_page_id).UpgradeWrite();
     assert(root_page_id != INVALID_PAGE_ID);
     
     auto root_page = guard.AsMut<BPlusTreeLeafPage>();
-    if (_leaf_max_size == 0)
-        root_page->Init(key_size);
-    else
-        root_page->Init(key_size, _leaf_max_size);
+    InitLeafPage(root_page);
     _root_page_id = root_page_id;
+    LogNewPage(std::move(guard));
 }
 
 BPlusTree::~BPlusTree()
@@ -119,168 +158,110 @@ BPlusTree::~BPlusTree()
         // TO DO: set the dirty flag if changes are made
         _pages_manager.UnpinPage(_root_page_id, false);
     }
+    GiveBackDroppedPages({});
 }
 
-bool BPlusTree::Insert(const char* key, const RID& rid)
+/**
+ * The pages latched by the pessimistic (i.e. restructuring) insert or remove.
+ * Only the pages which might be modified are kept latched: when a safe page is met
+ * on the way down all latches above it (and the latch of the root page id) are released.
+*/
+struct BPlusTree::Context
 {
-    const uint32_t k = *reinterpret_cast<const uint32_t *>(key);
-    
-    // lock the whole tree now.
-    // TO DO: think about locking with page granularity
-    std::unique_lock lock(_mutex);
-
-    assert(_root_page_id != INVALID_PAGE_ID);
-    auto guard = _pages_manager.GetPageGuarded(_root_page_id);
-
-    auto bplus_tree_page = guard.As<BPlusTreePage>();
-    const bool is_leaf = bplus_tree_page->IsLeafPage();
+    Context(std::shared_mutex& root_latch, LogManager* log_manager, index_oid_t index_oid)
+        : root_lock(root_latch)
+        , changes(log_manager, index_oid)
+    {
+        path.reserve(8);
+        positions.reserve(8);
+    }
 
-    if (is_leaf) {
-        /* when the root node is leaf, just insert key/value pair
-         in case when split is happened, create a new root */
-        auto bplus_leaf_page = guard.AsMut<BPlusTreeLeafPage>();
+    /** @return true if the first page on the path is the root page */
+    bool IsRootLatched() const { return root_lock.owns_lock(); }
 
-        page_id_t right_sibling_id{INVALID_PAGE_ID};
-        if (!InsertIntoLeaf(bplus_leaf_page, key, rid, &right_sibling_id)) {
-            return false;
+    void ReleaseAncestors()
+    {
+        if (root_lock.owns_lock()) {
+            root_lock.unlock();
         }
-
-        // no split happened
-        if (right_sibling_id == INVALID_PAGE_ID) {
-            return true;
+        if (path.size() > 1) {
+            path.erase(path.begin(), path.end() - 1);
+            positions.clear();
         }
+    }
 
-        // otherwise, create new root
-        page_id_t root_page_id{INVALID_PAGE_ID};
-        auto guard = _pages_manager.NextFreePageGuarded(&root_page_id);
-        assert(root_page_id != INVALID_PAGE_ID);
-        
-        auto root_page = guard.AsMut<BPlusTreeInternalPage>();
-        if (_internal_max_size == 0)
-            root_page->Init(_key_size);
-        else
-            root_page->Init(_key_size, _internal_max_size);
-        // initial root page becomes the leftmost children
-        const page_id_t left_page_id{_root_page_id};
-        _root_page_id = root_page_id;
+    std::unique_lock<std::shared_mutex> root_lock;
+    /** the write-latched pages from the topmost unsafe one down to the current one */
+    std::vector<WritePageGuard> path;
+    /** positions[i] is the position of link to path[i + 1] within path[i] */
+    std::vector<uint16_t> positions;
+    /** the pages released by merge, they are given back when all latches are released */
+    std::vector<page_id_t> dropped_pages;
+    /** the changes of the latched pages, they are appended to the log before the pages are released */
+    PageChangeLog changes;
+};
 
-        root_page->SetValueAt(0, left_page_id);
-        {
-            auto right_page_guard = _pages_manager.GetPageGuarded(right_sibling_id);
-            auto right_page = right_page_guard.As<BPlusTreeLeafPage>();
-            root_page->InsertAt(1, right_page->KeyAt(0), right_sibling_id);
-        }
-        return true;
-    } else {
-        /* when the root node is internal node, find the link to the children matching the key 
-         and invoke helper method (which recursively traverse down to the lowest level)
-        */
-        auto bplus_internal_page = guard.AsMut<BPlusTreeInternalPage>();
-        auto pos = bplus_internal_page->FindItem(key, _key_compare);
-        auto child_page_id = bplus_internal_page->GetValueAt(pos);
-        auto child_guard = _pages_manager.GetPageGuarded(child_page_id);
-        auto child_page = child_guard.AsMut<BPlusTreeInternalPage>();
-
-        page_id_t right_sibling_id{INVALID_PAGE_ID};
-        if (!Insert(child_page, bplus_internal_page, key, rid, &right_sibling_id)) {
+
+bool BPlusTree::Insert(const char* key, const RID& rid)
+{
+    {
+        /* optimistic attempt: internal pages are latched for read,
+         only the leaf is latched for write. It's succeeded when the leaf
+         has a room for the new item, which is the most common case */
+        std::shared_lock<std::shared_mutex> root_lock;
+        ReadPageGuard parent_guard;
+        WritePageGuard leaf_guard = FindLeafOptimistic(key, root_lock, parent_guard);
+
+        auto leaf = leaf_guard.As<BPlusTreeLeafPage>();
+        auto find_result = leaf->FindItem(key, _key_compare);
+        // the key already present
+        if (find_result.first) {
             return false;
         }
 
-        // no split happened
-        if (right_sibling_id == INVALID_PAGE_ID) {
+        if (!leaf->IsFull()) {
+            PageChangeLog changes(_log_manager, _index_oid);
+            changes.Track(leaf_guard);
+            leaf_guard.AsMut<BPlusTreeLeafPage>()->InsertAt(find_result.second, key, rid);
+            changes.Append();
             return true;
         }
-
-        // otherwise, create new root
-        page_id_t root_page_id{INVALID_PAGE_ID};
-        auto guard = _pages_manager.NextFreePageGuarded(&root_page_id);
-        assert(root_page_id != INVALID_PAGE_ID);
-        
-        auto root_page = guard.AsMut<BPlusTreeInternalPage>();
-        if (_internal_max_size == 0)
-            root_page->Init(_key_size);
-        else
-            root_page->Init(_key_size, _internal_max_size);
-        // initial root page becomes the leftmost children
-        const page_id_t left_page_id{_root_page_id};
-        _root_page_id = root_page_id;
-
-        root_page->SetValueAt(0, left_page_id);
-        {
-            auto right_page_guard = _pages_manager.GetPageGuarded(right_sibling_id);
-            auto right_page = right_page_guard.As<BPlusTreeInternalPage>();
-            root_page->InsertAt(1, right_page->KeyAt(0), right_sibling_id);
-        }
-
-        return true;
     }
 
-    // should be unreachable
-    assert(false);
-    return false;
+    // the leaf should be split, start over and latch all pages which might be changed
+    return InsertPessimistic(key, rid);
 }
 
 void BPlusTree::Remove(const char* key)
 {
-    const uint32_t k = *reinterpret_cast<const uint32_t *>(key);
-
-    // lock the whole tree now
-    std::unique_lock lock(_mutex);
-
-    if (_root_page_id == INVALID_PAGE_ID) {
-        return;
-    }
-
-    // const uint64_t k = *reinterpret_cast<const uint64_t *>(key);
-
-    auto guard = _pages_manager.GetPageGuarded(_root_page_id);
-
-    auto bplus_tree_page = guard.As<BPlusTreePage>();
-    const bool is_leaf = bplus_tree_page->IsLeafPage();
-    if (is_leaf) {
-        // when the root node is leaf, just remove key/value pair
-        auto bplus_leaf_page = guard.AsMut<BPlusTreeLeafPage>();
-        auto find_result = bplus_leaf_page->FindItem(key, _key_compare);
+    {
+        // optimistic attempt, see Insert
+        std::shared_lock<std::shared_mutex> root_lock;
+        ReadPageGuard parent_guard;
+        WritePageGuard leaf_guard = FindLeafOptimistic(key, root_lock, parent_guard);
+
+        auto leaf = leaf_guard.As<BPlusTreeLeafPage>();
+        auto find_result = leaf->FindItem(key, _key_compare);
         if (!find_result.first) {
             return;
         }
-        bplus_leaf_page->RemoveAt(find_result.second);
-    } else {
-        auto bplus_internal_page = guard.AsMut<BPlusTreeInternalPage>();
-        Remove(bplus_internal_page, key);
-        // the children were merged and only one remained (when internal node is zero size 
-        // it means that it has only single value and no keys, if the tree in valid state)
-        if (bplus_internal_page->GetSize() == 0) {
-            const page_id_t child_id = bplus_internal_page->GetValueAt(0);
-            assert(child_id != INVALID_PAGE_ID);
-            _root_page_id = child_id;
+
+        if (IsRemoveSafe(leaf, root_lock.owns_lock())) {
+            PageChangeLog changes(_log_manager, _index_oid);
+            changes.Track(leaf_guard);
+            leaf_guard.AsMut<BPlusTreeLeafPage>()->RemoveAt(find_result.second);
+            changes.Append();
+            return;
         }
     }
 
-    GiveBackDroppedPages();
+    // the leaf might be merged, start over and latch all pages which might be changed
+    RemovePessimistic(key);
 }
 
 bool BPlusTree::GetValue(const char* key, RID& value) const
 {
-    // lock the whole tree now.
-    // TO DO: think about locking with page granularity
-    std::shared_lock lock(_mutex);
-
-    if (_root_page_id == INVALID_PAGE_ID) {
-        return false;
-    }
-
-    page_id_t page_id = _root_page_id;
-    auto guard = _pages_manager.GetPageGuarded(page_id);
-    auto bplus_tree_page = guard.As<BPlusTreePage>();
-    while (!bplus_tree_page->IsLeafPage()) {
-        auto bplus_internal_page = guard.As<BPlusTreeInternalPage>();
-        const uint16_t pos = bplus_internal_page->FindItem(key, _key_compare);
-        page_id = bplus_internal_page->GetValueAt(pos);
-        guard = _pages_manager.GetPageGuarded(page_id);
-        bplus_tree_page = guard.As<BPlusTreePage>();
-    }
-
+    auto guard = FindLeafRead(key);
     auto bplus_leaf_page = guard.As<BPlusTreeLeafPage>();
     auto find_result = bplus_leaf_page->FindItem(key, _key_compare);
 
@@ -291,58 +272,237 @@ bool BPlusTree::GetValue(const char* key, RID& value) const
     return false;
 }
 
-BPlusTree::Iterator BPlusTree::Begin() const
+size_t BPlusTree::MultiGetValue(const char* keys, size_t count, RID rids[], bool found[]) const
 {
-    // ATTENTION!!
-    // the implementation is not thread safe.
-    // it is possible to acquire a lock of a whole tree, 
-    // but iterator goes along the leaf pages which can only be protected individually
-    assert(_root_page_id != INVALID_PAGE_ID);
-    page_id_t page_id = _root_page_id;    
-    auto read_guard = _pages_manager.GetPageRead(page_id);
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this, keys](size_t lhs, size_t rhs) {
+        return _key_compare(keys + lhs * _key_size, keys + rhs * _key_size) < 0;
+    });
+
+    size_t num_found = 0;
+    ReadPageGuard guard;
+    for (const size_t i : order) {
+        const char* key = keys + i * _key_size;
+        const BPlusTreeLeafPage* leaf = guard.As<BPlusTreeLeafPage>();
+        if (leaf == nullptr) {
+            guard = FindLeafRead(key);
+        } else if (leaf->GetSize() != 0 && _key_compare(key, leaf->KeyAt(leaf->GetSize() - 1)) > 0
+                    && leaf->GetNextPageId() != INVALID_PAGE_ID) {
+            // the key is beyond the current leaf, the sibling is latched before the leaf is released
+            ReadPageGuard sibling_guard = _pages_manager.GetPageRead(leaf->GetNextPageId());
+            const BPlusTreeLeafPage* sibling = sibling_guard.As<BPlusTreeLeafPage>();
+            if (sibling->GetSize() != 0 && _key_compare(key, sibling->KeyAt(sibling->GetSize() - 1)) > 0) {
+                // the pages are latched top-down, so both leaves are released before the descent
+                sibling_guard.Drop();
+                guard.Drop();
+                guard = FindLeafRead(key);
+            } else {
+                guard = std::move(sibling_guard);
+            }
+        }
 
-    auto bplus_tree_page = read_guard.As<BPlusTreePage>();
-    while (!bplus_tree_page->IsLeafPage()) {
-        auto bplus_internal_page = read_guard.As<BPlusTreeInternalPage>();
-        page_id = bplus_internal_page->GetValueAt(0);
-        read_guard = _pages_manager.GetPageRead(page_id);
-        bplus_tree_page = read_guard.As<BPlusTreePage>();
+        leaf = guard.As<BPlusTreeLeafPage>();
+        const auto find_result = leaf->FindItem(key, _key_compare);
+        found[i] = find_result.first;
+        if (find_result.first) {
+            rids[i] = leaf->GetValueAt(find_result.second);
+            num_found++;
+        }
     }
+    return num_found;
+}
 
-    return std::move(Iterator(_pages_manager, page_id));    
+bool BPlusTree::BulkLoad(const char* keys, const RID rids[], size_t count, float fill_factor)
+{
+    size_t pos = 0;
+    return BulkLoad([&](const char*& key, RID& rid) {
+        if (pos == count) {
+            return false;
+        }
+        key = keys + pos * _key_size;
+        rid = rids[pos++];
+        return true;
+    }, fill_factor);
 }
 
-BPlusTree::Iterator BPlusTree::Begin(const char* key) const
+bool BPlusTree::BulkLoad(const BulkLoadSource& next, float fill_factor)
 {
-    assert(_root_page_id != INVALID_PAGE_ID);
-    page_id_t page_id = _root_page_id;    
-    auto read_guard = _pages_manager.GetPageRead(page_id);
+    fill_factor = std::min(std::max(fill_factor, 0.5f), 1.0f);
 
-    auto bplus_tree_page = read_guard.As<BPlusTreePage>();
-    while (!bplus_tree_page->IsLeafPage()) {
-        auto bplus_internal_page = read_guard.As<BPlusTreeInternalPage>();
-        const uint16_t pos = bplus_internal_page->FindItem(key, _key_compare);
-        page_id = bplus_internal_page->GetValueAt(pos);
-        read_guard = _pages_manager.GetPageRead(page_id);
-        bplus_tree_page = read_guard.As<BPlusTreePage>();
+    std::unique_lock root_lock(_root_latch);
+    WritePageGuard root_guard = _pages_manager.GetPageWrite(_root_page_id);
+    if (!root_guard.As<BPlusTreePage>()->IsLeafPage() || root_guard.As<BPlusTreePage>()->GetSize() != 0) {
+        return false;
+    }
+
+    /* the root page is filled last: it's the only leaf when all items fit into one,
+     otherwise it's the topmost internal page. So the tree remains empty until the new
+     pages are logged and linked to the root */
+    PageChangeLog root_changes(_log_manager, _index_oid);
+    root_changes.Track(root_guard);
+    std::vector<page_id_t> allocated_pages;
+
+    // the pages of the level being built and their lowest keys
+    std::vector<page_id_t> level_pages;
+    std::vector<char> level_keys;
+
+    const uint16_t leaf_max_size = root_guard.As<BPlusTreeLeafPage>()->GetMaxSize();
+    const size_t leaf_capacity = std::max<size_t>(1, leaf_max_size * fill_factor);
+
+    /* the items are buffered up to two leaves: the leaf is written when the items of the next one
+     are buffered already, so the items of the last two leaves are spread between them evenly */
+    std::vector<char> buffered_keys;
+    std::vector<RID> buffered_rids;
+    buffered_keys.reserve((2 * leaf_capacity + 1) * _key_size);
+    buffered_rids.reserve(2 * leaf_capacity + 1);
+
+    // the previous leaf is complete when it's linked to the next one
+    WritePageGuard prev_guard;
+    auto abort = [&]() {
+        prev_guard.Drop();
+        GiveBackDroppedPages(allocated_pages);
+        return false;
+    };
+    auto write_leaf = [&](size_t num_items, bool is_root) {
+        page_id_t page_id{_root_page_id};
+        BPlusTreeLeafPage* leaf = root_guard.AsMut<BPlusTreeLeafPage>();
+        WritePageGuard guard;
+        if (!is_root) {
+            guard = _pages_manager.NextFreePageGuarded(&page_id).UpgradeWrite();
+            if (page_id == INVALID_PAGE_ID) {
+                return false;
+            }
+            allocated_pages.push_back(page_id);
+            leaf = guard.AsMut<BPlusTreeLeafPage>();
+            InitLeafPage(leaf);
+            if (prev_guard.PageId() != INVALID_PAGE_ID) {
+                prev_guard.AsMut<BPlusTreeLeafPage>()->SetNextPageId(page_id);
+                LogNewPage(std::move(prev_guard));
+            }
+        }
+
+        level_pages.push_back(page_id);
+        level_keys.insert(level_keys.end(), buffered_keys.cbegin(), buffered_keys.cbegin() + _key_size);
+        for (uint16_t j = 0; j < num_items; j++) {
+            leaf->InsertAt(j, buffered_keys.data() + j * _key_size, buffered_rids[j]);
+        }
+        buffered_keys.erase(buffered_keys.cbegin(), buffered_keys.cbegin() + num_items * _key_size);
+        buffered_rids.erase(buffered_rids.cbegin(), buffered_rids.cbegin() + num_items);
+        prev_guard = std::move(guard);
+        return true;
+    };
+
+    const char* key = nullptr;
+    RID rid;
+    while (next(key, rid)) {
+        if (!buffered_rids.empty() && _key_compare(buffered_keys.data() + buffered_keys.size() - _key_size, key) != -1) {
+            return abort();
+        }
+        if (buffered_rids.size() == 2 * leaf_capacity && !write_leaf(leaf_capacity, false)) {
+            return abort();
+        }
+        buffered_keys.insert(buffered_keys.end(), key, key + _key_size);
+        buffered_rids.push_back(rid);
+    }
+
+    // the rest is written into one leaf when two of them would underflow
+    const size_t count = buffered_rids.size();
+    if (count == 0 && level_pages.empty()) {
+        return true;
+    }
+    const size_t num_leaves = count > leaf_capacity && count / 2 >= leaf_max_size / 2 ? 2 : 1;
+    for (size_t i = 0; i < num_leaves; i++) {
+        if (!write_leaf(ItemsInPage(count, num_leaves, i), level_pages.empty() && num_leaves == 1)) {
+            return abort();
+        }
+    }
+    if (prev_guard.PageId() != INVALID_PAGE_ID) {
+        LogNewPage(std::move(prev_guard));
+    }
+
+    // build the internal levels until the single page (the root) is left
+    while (level_pages.size() > 1) {
+        const size_t num_children = level_pages.size();
+        // at least 3 children per page, so spreading evenly leaves none with a single child
+        const size_t capacity = std::max<size_t>(3, GetInternalMaxSize() * fill_factor + 1);
+        const size_t num_nodes = (num_children + capacity - 1) / capacity;
+        std::vector<page_id_t> upper_pages;
+        std::vector<char> upper_keys;
+
+        size_t child = 0;
+        for (size_t i = 0; i < num_nodes; i++) {
+            page_id_t page_id{_root_page_id};
+            BPlusTreeInternalPage* node = nullptr;
+            WritePageGuard guard;
+            if (num_nodes == 1) {
+                // the topmost level is built in the root page
+                node = root_guard.AsMut<BPlusTreeInternalPage>();
+            } else {
+                guard = _pages_manager.NextFreePageGuarded(&page_id).UpgradeWrite();
+                if (page_id == INVALID_PAGE_ID) {
+                    return abort();
+                }
+                allocated_pages.push_back(page_id);
+                node = guard.AsMut<BPlusTreeInternalPage>();
+            }
+            InitInternalPage(node);
+
+            const size_t num_items = ItemsInPage(num_children, num_nodes, i);
+            node->SetValueAt(0, level_pages[child]);
+            for (uint16_t j = 1; j < num_items; j++) {
+                node->InsertAt(j, level_keys.data() + (child + j) * _key_size, level_pages[child + j]);
+            }
+            upper_pages.push_back(page_id);
+            upper_keys.insert(upper_keys.end(), level_keys.cbegin() + child * _key_size,
+                            level_keys.cbegin() + (child + 1) * _key_size);
+            child += num_items;
+            if (num_nodes > 1) {
+                LogNewPage(std::move(guard));
+            }
+        }
+
+        level_pages.swap(upper_pages);
+        level_keys.swap(upper_keys);
     }
 
+    root_changes.Append();
+    return true;
+}
+
+BPlusTree::Iterator BPlusTree::Begin() const
+{
+    return Iterator(_pages_manager, FindLeafRead(nullptr), 0);
+}
+
+BPlusTree::Iterator BPlusTree::Begin(const char* key) const
+{
+    auto read_guard = FindLeafRead(key);
     auto bplus_leaf_page = read_guard.As<BPlusTreeLeafPage>();
     auto find_result = bplus_leaf_page->FindItem(key, _key_compare);
     if (find_result.first) {
-        return std::move(Iterator(_pages_manager, page_id, find_result.second));        
+        return Iterator(_pages_manager, std::move(read_guard), find_result.second);
     }
 
-    return std::move(Iterator(_pages_manager, INVALID_PAGE_ID));
+    return Iterator(_pages_manager);
+}
+
+BPlusTree::Iterator BPlusTree::LowerBound(const char* key) const
+{
+    auto read_guard = FindLeafRead(key);
+    auto bplus_leaf_page = read_guard.As<BPlusTreeLeafPage>();
+    const uint16_t pos = bplus_leaf_page->FindItem(key, _key_compare).second;
+    return Iterator(_pages_manager, std::move(read_guard), pos);
 }
 
 BPlusTree::Iterator BPlusTree::End() const
 {
-    return std::move(Iterator(_pages_manager, INVALID_PAGE_ID));
+    return Iterator(_pages_manager);
 }
 
 
-bool BPlusTree::InsertIntoLeaf(BPlusTreeLeafPage* leaf, const char* key, const RID& rid, page_id_t* right_sibling)
+bool BPlusTree::InsertIntoLeaf(BPlusTreeLeafPage* leaf, const char* key, const RID& rid, PageChangeLog& changes,
+                                page_id_t* right_sibling)
 {
     assert(leaf != nullptr);
     assert(right_sibling != nullptr);
@@ -361,14 +521,12 @@ bool BPlusTree::InsertIntoLeaf(BPlusTreeLeafPage* leaf, const char* key, const R
 
     // split leaf in the middle
     page_id_t right_page_id{INVALID_PAGE_ID};
-    auto guard = _pages_manager.NextFreePageGuarded(&right_page_id);
+    auto guard = _pages_manager.NextFreePageGuarded(&right_page_id).UpgradeWrite();
     assert(right_page_id != INVALID_PAGE_ID);
     
     auto right_page = guard.AsMut<BPlusTreeLeafPage>();
-    if (_leaf_max_size == 0)
-        right_page->Init(_key_size);
-    else
-        right_page->Init(_key_size, _leaf_max_size);
+    InitLeafPage(right_page);
+    changes.TrackNew(std::move(guard));
 
     if (leaf->GetSize() == 2) {
         const char* key1 = leaf->KeyAt(1);
@@ -414,148 +572,378 @@ bool BPlusTree::InsertIntoLeaf(BPlusTreeLeafPage* leaf, const char* key, const R
     return true;
 }
 
-bool BPlusTree::Insert(BPlusTreePage* page, BPlusTreeInternalPage* parent, const char* key, const RID& rid, page_id_t* parent_right_sibling)
+bool BPlusTree::InsertPessimistic(const char* key, const RID& rid)
 {
-    if (page->IsLeafPage()) {
-        auto bplus_leaf_page = static_cast<BPlusTreeLeafPage *>(page);
-        page_id_t right_sibling_id{INVALID_PAGE_ID};
-        if (!InsertIntoLeaf(bplus_leaf_page, key, rid, &right_sibling_id)) {
-            return false;
+    Context ctx(_root_latch, _log_manager, _index_oid);
+    assert(_root_page_id != INVALID_PAGE_ID);
+    ctx.path.push_back(_pages_manager.GetPageWrite(_root_page_id));
+
+    while (true) {
+        auto page = ctx.path.back().As<BPlusTreePage>();
+        if (IsInsertSafe(page)) {
+            ctx.ReleaseAncestors();
+        }
+        if (page->IsLeafPage()) {
+            break;
         }
+        auto bplus_internal_page = ctx.path.back().As<BPlusTreeInternalPage>();
+        const uint16_t pos = bplus_internal_page->FindItem(key, _key_compare);
+        ctx.positions.push_back(pos);
+        ctx.path.push_back(_pages_manager.GetPageWrite(bplus_internal_page->GetValueAt(pos)));
+    }
 
-        // no split happened
-        if (right_sibling_id == INVALID_PAGE_ID) {
-            return true;
+    ctx.changes.Track(ctx.path.back());
+    auto bplus_leaf_page = ctx.path.back().AsMut<BPlusTreeLeafPage>();
+    page_id_t right_sibling_id{INVALID_PAGE_ID};
+    const bool inserted = InsertIntoLeaf(bplus_leaf_page, key, rid, ctx.changes, &right_sibling_id);
+
+    // no split happened when the leaf was split concurrently by someone else
+    if (inserted && right_sibling_id != INVALID_PAGE_ID) {
+        // the right sibling is latched by the change log until the link is inserted into parent
+        auto right_page_guard = _pages_manager.GetPageGuarded(right_sibling_id);
+        auto right_page = right_page_guard.As<BPlusTreeLeafPage>();
+        InsertIntoParent(ctx, right_page->KeyAt(0), right_sibling_id);
+    }
+    ctx.changes.Append();
+    return inserted;
+}
+
+void BPlusTree::InsertIntoParent(Context& ctx, const char* key, page_id_t right_sibling_id)
+{
+    // the key is owned by the right sibling of the page which was split, it's latched by the change log
+    for (size_t level = ctx.path.size() - 1; ; level--) {
+        if (level == 0) {
+            /* the page which was split is the root (a safe page is never split). The root page stays
+             in place: its items move to the new page which becomes the leftmost child */
+            assert(ctx.IsRootLatched());
+            WritePageGuard& root_guard = ctx.path[0];
+            assert(root_guard.PageId() == _root_page_id);
+            ctx.changes.Track(root_guard);
+
+            page_id_t left_page_id{INVALID_PAGE_ID};
+            auto guard = _pages_manager.NextFreePageGuarded(&left_page_id).UpgradeWrite();
+            assert(left_page_id != INVALID_PAGE_ID);
+            ::memcpy(guard.GetDataMut(), root_guard.GetData(), PAGE_SIZE);
+            ctx.changes.TrackNew(std::move(guard));
+
+            auto root_page = root_guard.AsMut<BPlusTreeInternalPage>();
+            InitInternalPage(root_page);
+            root_page->SetValueAt(0, left_page_id);
+            root_page->InsertAt(1, key, right_sibling_id);
+            return;
         }
 
-        // otherwise, try to insert link into the parent. if parent is full - split it.
+        const uint16_t pos = ctx.positions[level - 1];
+        ctx.changes.Track(ctx.path[level - 1]);
+        auto parent = ctx.path[level - 1].AsMut<BPlusTreeInternalPage>();
         if (!parent->IsFull()) {
-            auto right_page_guard = _pages_manager.GetPageGuarded(right_sibling_id);
-            auto right_page = right_page_guard.As<BPlusTreeLeafPage>();
-            const char* rkey0 = right_page->KeyAt(0);
-            const uint16_t pos = parent->FindItem(rkey0, _key_compare);
-            parent->InsertAt(pos + 1, rkey0, right_sibling_id);
-            return true;
+            parent->InsertAt(pos + 1, key, right_sibling_id);
+            return;
         }
 
+        // split parent in the middle
         page_id_t parent_right_sibling_id{INVALID_PAGE_ID};
-        auto guard = _pages_manager.NextFreePageGuarded(&parent_right_sibling_id);
+        auto guard = _pages_manager.NextFreePageGuarded(&parent_right_sibling_id).UpgradeWrite();
         assert(parent_right_sibling_id != INVALID_PAGE_ID);
 
-        auto right_page = guard.AsMut<BPlusTreeInternalPage>();
-        if (_internal_max_size == 0)
-            right_page->Init(_key_size);
-        else
-            right_page->Init(_key_size, _internal_max_size);
-
-        const uint16_t midpos = parent->GetSize() / 2;
-        right_page->CopyFrom(parent, midpos + 1);
-        parent->SetSize(midpos);
-
-        {
-            auto right_sibling_guard = _pages_manager.GetPageGuarded(right_sibling_id);
-            auto right_sibling = right_sibling_guard.As<BPlusTreeLeafPage>();
-            const char* leaf_rkey0 = right_sibling->KeyAt(0);
-            const char* rkey0 = right_page->KeyAt(0);
-            /* insert key/value into the left half of parent when key is strictly less
-             than key at splitpoint, otherwise - insert into the right half */
-            if (_key_compare(leaf_rkey0, rkey0) == -1) {
-                parent->Insert(leaf_rkey0, right_sibling_id, _key_compare);
-            } else {
-                right_page->Insert(leaf_rkey0, right_sibling_id, _key_compare);
-            }
+        auto parent_right_sibling = guard.AsMut<BPlusTreeInternalPage>();
+        InitInternalPage(parent_right_sibling);
+        ctx.changes.TrackNew(std::move(guard));
+
+        const uint16_t mid_pos = parent->GetSize() / 2;
+        parent_right_sibling->CopyFrom(parent, mid_pos + 1);
+        parent->SetSize(mid_pos);
+
+        /* the key at position 0 of the right sibling is the one pushed up to the parent,
+         insert key/value into the left part when key is strictly less than that one */
+        if (_key_compare(key, parent_right_sibling->KeyAt(0)) == -1) {
+            parent->Insert(key, right_sibling_id, _key_compare);
+        } else {
+            parent_right_sibling->Insert(key, right_sibling_id, _key_compare);
         }
-       
-        assert(parent_right_sibling);
-        *parent_right_sibling = parent_right_sibling_id;
-        return true;
-    } else {
-        auto bplus_internal_page = static_cast<BPlusTreeInternalPage *>(page);
-        const uint16_t pos = bplus_internal_page->FindItem(key, _key_compare);
-        const page_id_t page_id = bplus_internal_page->GetValueAt(pos);
 
-        auto child_page_guard = _pages_manager.GetPageGuarded(page_id);
-        auto child_page = child_page_guard.AsMut<BPlusTreePage>();
-        
-        page_id_t right_sibling_id{INVALID_PAGE_ID};
-        if (!Insert(child_page, bplus_internal_page, key, rid, &right_sibling_id)) {
-            return false;
+        // go to the upper level
+        key = parent_right_sibling->KeyAt(0);
+        right_sibling_id = parent_right_sibling_id;
+    }
+}
+
+void BPlusTree::RemovePessimistic(const char* key)
+{
+    Context ctx(_root_latch, _log_manager, _index_oid);
+    assert(_root_page_id != INVALID_PAGE_ID);
+    ctx.path.push_back(_pages_manager.GetPageWrite(_root_page_id));
+
+    /* Iterators go along the leaves from left to right latching the next leaf before
+     release the current one. To avoid deadlock the left sibling of the leaf is latched
+     before the leaf itself. Other siblings are latched while their parent is write-latched,
+     so nobody else is able to latch them in another order. */
+    WritePageGuard left_leaf_guard;
+
+    while (true) {
+        auto page = ctx.path.back().As<BPlusTreePage>();
+        if (IsRemoveSafe(page, ctx.IsRootLatched() && ctx.path.size() == 1)) {
+            ctx.ReleaseAncestors();
+        }
+        if (page->IsLeafPage()) {
+            break;
         }
 
-        if (right_sibling_id == INVALID_PAGE_ID) {
-            return true;
+        auto bplus_internal_page = ctx.path.back().As<BPlusTreeInternalPage>();
+        const uint16_t pos = bplus_internal_page->FindItem(key, _key_compare);
+        const page_id_t child_page_id = bplus_internal_page->GetValueAt(pos);
+        auto child_guard = _pages_manager.GetPageWrite(child_page_id);
+        auto child_page = child_guard.As<BPlusTreePage>();
+        if (child_page->IsLeafPage() && pos > 0 && !IsRemoveSafe(child_page, false)) {
+            // the parent is latched for write, so nothing could happen with the leaf meanwhile
+            child_guard.Drop();
+            left_leaf_guard = _pages_manager.GetPageWrite(bplus_internal_page->GetValueAt(pos - 1));
+            child_guard = _pages_manager.GetPageWrite(child_page_id);
         }
+        ctx.positions.push_back(pos);
+        ctx.path.push_back(std::move(child_guard));
+    }
 
-        // the current page was split, try to insert link into parent.
-        // when parent is full, also split it.
-        if (!parent->IsFull()) {
-            auto right_page_guard = _pages_manager.GetPageGuarded(right_sibling_id);
-            auto right_page = right_page_guard.As<BPlusTreeInternalPage>();
-            const char* rkey0 = right_page->KeyAt(0);
-            const uint16_t pos = parent->FindItem(rkey0, _key_compare);
-            parent->InsertAt(pos + 1, rkey0, right_sibling_id);
-            return true;
-        }        
+    auto bplus_leaf_page = ctx.path.back().AsMut<BPlusTreeLeafPage>();
+    auto find_result = bplus_leaf_page->FindItem(key, _key_compare);
+    if (find_result.first) {
+        ctx.changes.Track(ctx.path.back());
+        bplus_leaf_page->RemoveAt(find_result.second);
+        RebalanceAfterRemove(ctx, left_leaf_guard);
+        ctx.changes.Append();
+    }
 
-        page_id_t parent_right_sibling_id{INVALID_PAGE_ID};
-        auto guard = _pages_manager.NextFreePageGuarded(&parent_right_sibling_id);
-        assert(parent_right_sibling_id != INVALID_PAGE_ID);
+    left_leaf_guard.Drop();
+    ctx.path.clear();
+    if (ctx.root_lock.owns_lock()) {
+        ctx.root_lock.unlock();
+    }
+    GiveBackDroppedPages(ctx.dropped_pages);
+}
+
+void BPlusTree::RebalanceAfterRemove(Context& ctx, WritePageGuard& left_leaf_guard)
+{
+    for (size_t level = ctx.path.size() - 1; level > 0; level--) {
+        auto page = ctx.path[level].AsMut<BPlusTreePage>();
+        if (!IsUnderflow(page)) {
+            return;
+        }
 
-        auto right_page = guard.AsMut<BPlusTreeInternalPage>();
-        if (_internal_max_size == 0)
-            right_page->Init(_key_size);
-        else
-            right_page->Init(_key_size, _internal_max_size);
-
-        const uint16_t midpos = parent->GetSize() / 2;
-        right_page->CopyFrom(parent, midpos + 1);
-        parent->SetSize(midpos);
-
-        {
-            auto right_sibling_guard = _pages_manager.GetPageGuarded(right_sibling_id);
-            auto right_sibling = right_sibling_guard.As<BPlusTreeInternalPage>();
-            const char* child_rkey0 = right_sibling->KeyAt(0);
-            const char* rkey0 = right_page->KeyAt(0);
-            /* insert key/value into the left half of parent when key is strictly less
-             than key at splitpoint, otherwise - insert into the right half */
-            if (_key_compare(child_rkey0, rkey0) == -1) {
-                parent->Insert(child_rkey0, right_sibling_id, _key_compare);
+        ctx.changes.Track(ctx.path[level]);
+        ctx.changes.Track(ctx.path[level - 1]);
+        auto parent = ctx.path[level - 1].AsMut<BPlusTreeInternalPage>();
+        const uint16_t pos = ctx.positions[level - 1];
+        assert(parent->GetSize() > 0);
+        // the page which remains after merge (the siblings are latched by the change log till the end)
+        const char* merged_data = nullptr;
+
+        if (page->IsLeafPage()) {
+            auto leaf = static_cast<BPlusTreeLeafPage *>(page);
+            if (pos > 0) {
+                ctx.changes.Track(left_leaf_guard);
+                auto left_sibling = left_leaf_guard.AsMut<BPlusTreeLeafPage>();
+                if (left_sibling->GetSize() + leaf->GetSize() <= left_sibling->GetMaxSize()) {
+                    left_sibling->MergeRight(leaf);
+                    parent->RemoveAt(pos);
+                    ctx.dropped_pages.push_back(ctx.path[level].PageId());
+                    merged_data = left_leaf_guard.GetData();
+                } else {
+                    // borrow the last item of the left sibling
+                    const uint16_t last_pos = left_sibling->GetSize() - 1;
+                    leaf->InsertAt(0, left_sibling->KeyAt(last_pos), left_sibling->GetValueAt(last_pos));
+                    left_sibling->RemoveAt(last_pos);
+                    parent->UpdateKeyAt(pos, leaf->KeyAt(0));
+                }
             } else {
-                right_page->Insert(child_rkey0, right_sibling_id, _key_compare);
+                const page_id_t right_sibling_id = parent->GetValueAt(1);
+                auto right_guard = _pages_manager.GetPageWrite(right_sibling_id);
+                auto right_sibling = right_guard.AsMut<BPlusTreeLeafPage>();
+                ctx.changes.Track(std::move(right_guard));
+                if (leaf->GetSize() + right_sibling->GetSize() <= leaf->GetMaxSize()) {
+                    leaf->MergeRight(right_sibling);
+                    parent->RemoveAt(1);
+                    ctx.dropped_pages.push_back(right_sibling_id);
+                    merged_data = ctx.path[level].GetData();
+                } else {
+                    // borrow the first item of the right sibling
+                    leaf->InsertAt(leaf->GetSize(), right_sibling->KeyAt(0), right_sibling->GetValueAt(0));
+                    right_sibling->RemoveAt(0);
+                    parent->UpdateKeyAt(1, right_sibling->KeyAt(0));
+                }
+            }
+        } else {
+            auto internal = static_cast<BPlusTreeInternalPage *>(page);
+            if (pos > 0) {
+                auto left_guard = _pages_manager.GetPageWrite(parent->GetValueAt(pos - 1));
+                auto left_sibling = left_guard.AsMut<BPlusTreeInternalPage>();
+                ctx.changes.Track(std::move(left_guard));
+                if (left_sibling->GetSize() + internal->GetSize() + 1 <= left_sibling->GetMaxSize()) {
+                    left_sibling->MergeRight(internal, parent->KeyAt(pos));
+                    parent->RemoveAt(pos);
+                    ctx.dropped_pages.push_back(ctx.path[level].PageId());
+                    merged_data = reinterpret_cast<const char *>(left_sibling);
+                } else {
+                    internal->MoveFromLeft(left_sibling, 1, parent->KeyAt(pos));
+                    parent->UpdateKeyAt(pos, internal->KeyAt(0));
+                }
+            } else {
+                const page_id_t right_sibling_id = parent->GetValueAt(1);
+                auto right_guard = _pages_manager.GetPageWrite(right_sibling_id);
+                auto right_sibling = right_guard.AsMut<BPlusTreeInternalPage>();
+                ctx.changes.Track(std::move(right_guard));
+                if (internal->GetSize() + right_sibling->GetSize() + 1 <= internal->GetMaxSize()) {
+                    internal->MergeRight(right_sibling, parent->KeyAt(1));
+                    parent->RemoveAt(1);
+                    ctx.dropped_pages.push_back(right_sibling_id);
+                    merged_data = ctx.path[level].GetData();
+                } else {
+                    internal->MoveFromRight(right_sibling, 1, parent->KeyAt(1));
+                    parent->UpdateKeyAt(1, right_sibling->KeyAt(0));
+                }
             }
         }
-       
-        assert(parent_right_sibling);
-        *parent_right_sibling = parent_right_sibling_id;
 
-        return true;
+        if (level == 1 && ctx.IsRootLatched() && parent->GetSize() == 0) {
+            /* the children of root were merged and only one remained. The root page stays
+             in place: the items of the child move up into it and the child is dropped */
+            assert(merged_data != nullptr);
+            ctx.dropped_pages.push_back(parent->GetValueAt(0));
+            ::memcpy(ctx.path[0].GetDataMut(), merged_data, PAGE_SIZE);
+            return;
+        }
     }
-    // should be unreachable
-    assert(false);
-    return false;
 }
 
-page_id_t BPlusTree::FindTheLeftmostChild(const BPlusTreePage* page)
+ReadPageGuard BPlusTree::FindLeafRead(const char* key) const
 {
-    if (page->IsLeafPage())
-        return INVALID_PAGE_ID;
+    std::shared_lock lock(_root_latch);
+    assert(_root_page_id != INVALID_PAGE_ID);
+    auto guard = _pages_manager.GetPageRead(_root_page_id);
+    lock.unlock();
 
-    auto internal_page = static_cast<const BPlusTreeInternalPage *>(page);
-    page_id_t child_id = internal_page->GetValueAt(0);
-    while (1) {
-        auto guard = _pages_manager.GetPageGuarded(child_id);
-        const BPlusTreePage* child = guard.As<BPlusTreePage>();
-        if (child->IsLeafPage())
-            return child_id;
-        internal_page = guard.As<BPlusTreeInternalPage>();
-        child_id = internal_page->GetValueAt(0);
+    while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+        auto bplus_internal_page = guard.As<BPlusTreeInternalPage>();
+        const uint16_t pos = key ? bplus_internal_page->FindItem(key, _key_compare) : 0;
+        // the child is latched before the parent is released
+        guard = _pages_manager.GetPageRead(bplus_internal_page->GetValueAt(pos));
     }
-    // shold be unreachable
-    assert(false);
+    return guard;
+}
+
+WritePageGuard BPlusTree::FindLeafOptimistic(const char* key, std::shared_lock<std::shared_mutex>& root_lock,
+                                            ReadPageGuard& parent_guard)
+{
+    root_lock = std::shared_lock(_root_latch);
+    assert(_root_page_id != INVALID_PAGE_ID);
+    const page_id_t root_page_id = _root_page_id;
+    auto guard = _pages_manager.GetPageRead(root_page_id);
+    if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+        // the root leaf can't be split while the root is locked
+        guard.Drop();
+        return _pages_manager.GetPageWrite(root_page_id);
+    }
+    root_lock.unlock();
+
+    while (true) {
+        auto bplus_internal_page = guard.As<BPlusTreeInternalPage>();
+        const uint16_t pos = bplus_internal_page->FindItem(key, _key_compare);
+        const page_id_t child_page_id = bplus_internal_page->GetValueAt(pos);
+        auto child_guard = _pages_manager.GetPageRead(child_page_id);
+        if (child_guard.As<BPlusTreePage>()->IsLeafPage()) {
+            // the leaf can't be split or merged while its parent is latched
+            child_guard.Drop();
+            parent_guard = std::move(guard);
+            return _pages_manager.GetPageWrite(child_page_id);
+        }
+        guard = std::move(child_guard);
+    }
+}
+
+bool BPlusTree::IsInsertSafe(const BPlusTreePage* page)
+{
+    return page->GetSize() < page->GetMaxSize();
+}
+
+bool BPlusTree::IsRemoveSafe(const BPlusTreePage* page, bool is_root)
+{
+    if (is_root) {
+        // the root leaf might be empty, the root internal page should have at least two children
+        return page->IsLeafPage() || page->GetSize() > 1;
+    }
+    return page->GetSize() > page->GetMaxSize() / 2;
+}
+
+bool BPlusTree::IsUnderflow(const BPlusTreePage* page)
+{
+    return page->GetSize() < page->GetMaxSize() / 2 || page->GetSize() == 0;
+}
+
+void BPlusTree::InitLeafPage(BPlusTreeLeafPage* page) const
+{
+    if (_leaf_max_size == 0)
+        page->Init(_key_size);
+    else
+        page->Init(_key_size, _leaf_max_size);
+}
+
+void BPlusTree::InitInternalPage(BPlusTreeInternalPage* page) const
+{
+    if (_internal_max_size == 0)
+        page->Init(_key_size);
+    else
+        page->Init(_key_size, _internal_max_size);
+}
+
+uint16_t BPlusTree::GetInternalMaxSize() const
+{
+    return _internal_max_size == 0 ? BPlusTreeInternalPage::MaxNumItems(_key_size) : _internal_max_size;
+}
+
+void BPlusTree::LogNewPage(WritePageGuard&& guard)
+{
+    PageChangeLog changes(_log_manager, _index_oid);
+    changes.TrackNew(std::move(guard));
+    changes.Append();
+}
+
+page_id_t BPlusTree::GetRootPageId() const
+{
+    std::shared_lock lock(_root_latch);
+    return _root_page_id;
+}
+
+void BPlusTree::GiveBackPages()
+{
+    std::vector<page_id_t> pages;
+    {
+        std::unique_lock lock(_root_latch);
+        if (_root_page_id == INVALID_PAGE_ID) {
+            return;
+        }
+
+        std::vector<page_id_t> pending{_root_page_id};
+        while (!pending.empty()) {
+            const page_id_t page_id = pending.back();
+            pending.pop_back();
+            pages.push_back(page_id);
+
+            auto guard = _pages_manager.GetPageRead(page_id);
+            const BPlusTreePage* page = guard.As<BPlusTreePage>();
+            if (!page->IsLeafPage()) {
+                const BPlusTreeInternalPage* internal = static_cast<const BPlusTreeInternalPage *>(page);
+                for (uint16_t i = 0; i < internal->GetSize() + 1; i++) {
+                    pending.push_back(internal->GetValueAt(i));
+                }
+            }
+        }
+        _root_page_id = INVALID_PAGE_ID;
+    }
+    GiveBackDroppedPages(pages);
 }
 
 void BPlusTree::PrintTree(std::ostream& os) const
 {
+    std::shared_lock lock(_root_latch);
     os << " BPlusTree: "
         << " internal max size = " << _internal_max_size
         << " leaf max size = " << _leaf_max_size
@@ -606,198 +994,14 @@ void BPlusTree::PrintTree(std::ostream& os, const BPlusTreePage* page, page_id_t
     }
 }
 
-void BPlusTree::GiveBackDroppedPages()
+void BPlusTree::GiveBackDroppedPages(const std::vector<page_id_t>& dropped_pages)
 {
-    for (const auto page_id : _dropped_pages) {
-        if (!_pages_manager.GiveBackPage(page_id)) {
-            std::cout << " give back page id " << page_id << " failed !" << std::endl;
-        }
-    }
-    _dropped_pages.clear();
-}
-
-void BPlusTree::Remove(BPlusTreePage* page, const char* key)
-{
-    assert(!page->IsLeafPage());
-
-    /* find the link to the children matching the key 
-      and recursivelly traverse down to the lowest level
-    */
-    auto bplus_internal_page = static_cast<BPlusTreeInternalPage *>(page);
-    const uint16_t pos = bplus_internal_page->FindItem(key, _key_compare);
-    if (pos > bplus_internal_page->GetSize()) {
-        return;
-    }
-
-    const page_id_t child_page_id = bplus_internal_page->GetValueAt(pos);
-    auto child_guard = _pages_manager.GetPageGuarded(child_page_id);
-    auto child_page = child_guard.AsMut<BPlusTreePage>();
-
-    if (child_page->IsLeafPage()) {
-        auto leaf_page = child_guard.AsMut<BPlusTreeLeafPage>();
-
-        auto find_result = leaf_page->FindItem(key, _key_compare);
-        if (!find_result.first) {
-            return;
-        }
-
-        leaf_page->RemoveAt(find_result.second);
-        // leaf is empty - adjust sibling links and remove link to it from the parent
-        if (leaf_page->GetSize() == 0) {
-            if (pos > 0) {
-                const uint16_t left_pos = pos - 1;
-                const page_id_t left_page_id = bplus_internal_page->GetValueAt(left_pos);
-                auto left_guard = _pages_manager.GetPageGuarded(left_page_id);
-                auto left_page = left_guard.AsMut<BPlusTreeLeafPage>();
-                left_page->SetNextPageId(leaf_page->GetNextPageId());
-            } else {
-
-                page_id_t page_id = _root_page_id;
-                auto guard = _pages_manager.GetPageGuarded(page_id);
-                auto root_page = guard.As<BPlusTreePage>();
-                page_id = FindTheLeftmostChild(root_page);
-
-                if (page_id != child_page_id) {
-                    while (1) {
-                        guard = _pages_manager.GetPageGuarded(page_id);
-                        auto page = guard.AsMut<BPlusTreeLeafPage>();
-                        if (page->GetNextPageId() == child_page_id) {
-                            page->SetNextPageId(leaf_page->GetNextPageId());
-                            break;
-                        }
-                        page_id = page->GetNextPageId();
-                    }
-                }
-            }
-            bplus_internal_page->RemoveAt(pos);
-            _dropped_pages.push_back(child_page_id);
-            return;
-        }
-
-        // update key in the internal page when the leftmost key has gone
-        if (find_result.second == 0) {
-            bplus_internal_page->UpdateKeyAt(pos, leaf_page->KeyAt(0));
-        }
-
-        // merge with left or right sibling if possible
-        if (leaf_page->GetSize() <= (leaf_page->GetMaxSize() / 2)) {
-            const uint16_t right_pos = pos + 1;
-            if (right_pos < bplus_internal_page->GetSize()) {
-                const page_id_t right_page_id = bplus_internal_page->GetValueAt(right_pos);
-                assert(right_page_id != INVALID_PAGE_ID);
-                auto right_guard = _pages_manager.GetPageGuarded(right_page_id);
-                auto right_page = right_guard.As<BPlusTreeLeafPage>();
-                if (right_page->GetSize() <= (right_page->GetMaxSize() / 2)) {
-                    leaf_page->MergeRight(right_page);
-                    bplus_internal_page->RemoveAt(right_pos);
-                    _dropped_pages.push_back(right_page_id);
-                    return;
-                }
-            }
-
-            if (pos > 0) {
-                const uint16_t left_pos = pos - 1;
-                const page_id_t left_page_id = bplus_internal_page->GetValueAt(left_pos);
-                assert(left_page_id != INVALID_PAGE_ID);
-                auto left_guard = _pages_manager.GetPageGuarded(left_page_id);
-                auto left_page = left_guard.AsMut<BPlusTreeLeafPage>();
-                if (left_page->GetSize() <= (left_page->GetMaxSize() / 2)) {
-                    left_page->MergeRight(leaf_page);
-                    bplus_internal_page->RemoveAt(pos);
-                    _dropped_pages.push_back(child_page_id);
-                    return;
-                }
-            }
-        }
-
-    } else {
-        auto internal_page = child_guard.AsMut<BPlusTreeInternalPage>();
-        Remove(internal_page, key);
-
-        if (internal_page->GetSize() < (internal_page->GetMaxSize() / 2)) {
-            // merge with left or right sibling
-            const uint16_t right_pos = pos + 1;
-            if (right_pos <= bplus_internal_page->GetSize()) {
-                const page_id_t right_page_id = bplus_internal_page->GetValueAt(right_pos);
-                assert(right_page_id != INVALID_PAGE_ID);
-                auto right_guard = _pages_manager.GetPageGuarded(right_page_id);
-                auto right_page = right_guard.AsMut<BPlusTreeInternalPage>();
-                if ((right_page->GetSize() + internal_page->GetSize()) < internal_page->GetMaxSize()) {
-                    // when merge, need to insert a key between. 
-                    // it has to be the lowest key of the leftmostleaf of the sibling merged right     
-                    const page_id_t lefmost_child_id = FindTheLeftmostChild(right_page);
-                    assert(lefmost_child_id != INVALID_PAGE_ID);
-                    auto leftmost_child_guard = _pages_manager.GetPageGuarded(lefmost_child_id);
-                    auto leftmost_child = leftmost_child_guard.As<BPlusTreeLeafPage>();
-                    // merge and update the key at the merge point
-                    internal_page->MergeRight(right_page, leftmost_child->KeyAt(0));
-                    bplus_internal_page->RemoveAt(right_pos);
-                    _dropped_pages.push_back(right_page_id);
-                    return;
-                } else {
-                    const uint16_t num_items_to_move = ((internal_page->GetMaxSize() / 2) - internal_page->GetSize());
-                    if (num_items_to_move < right_page->GetSize() && (num_items_to_move <= right_page->GetMaxSize() / 2)) {
-                        page_id_t lefmost_child_id = FindTheLeftmostChild(right_page);
-                        assert(lefmost_child_id != INVALID_PAGE_ID);
-                        auto leftmost_child_guard = _pages_manager.GetPageGuarded(lefmost_child_id);
-                        auto leftmost_child = leftmost_child_guard.As<BPlusTreeLeafPage>();
-                        internal_page->MoveFromRight(right_page, num_items_to_move, leftmost_child->KeyAt(0));
-
-                        lefmost_child_id = FindTheLeftmostChild(right_page);
-                        assert(lefmost_child_id != INVALID_PAGE_ID);
-                        leftmost_child_guard = _pages_manager.GetPageGuarded(lefmost_child_id);
-                        leftmost_child = leftmost_child_guard.As<BPlusTreeLeafPage>();
-                        bplus_internal_page->UpdateKeyAt(right_pos, leftmost_child->KeyAt(0));
-                        return;
-                    }
-                }
-            }
-
-            if (pos > 0) {
-                const uint16_t left_pos = pos - 1;
-                const page_id_t left_page_id = bplus_internal_page->GetValueAt(left_pos);
-                assert(left_page_id != INVALID_PAGE_ID);
-                auto left_guard = _pages_manager.GetPageGuarded(left_page_id);
-                auto left_page = left_guard.AsMut<BPlusTreeInternalPage>();
-                if ((left_page->GetSize() + internal_page->GetSize()) < left_page->GetMaxSize()) {
-                    // when merge, need to insert a key between. 
-                    // it has to be the lowest key of the leftmostleaf of the sibling merged right     
-                    const page_id_t lefmost_child_id = FindTheLeftmostChild(internal_page);
-                    assert(lefmost_child_id != INVALID_PAGE_ID);
-                    auto leftmost_child_guard = _pages_manager.GetPageGuarded(lefmost_child_id);
-                    auto leftmost_child = leftmost_child_guard.As<BPlusTreeLeafPage>();
-                    // merge and update the key at the merge point
-                    left_page->MergeRight(internal_page, leftmost_child->KeyAt(0));
-                    bplus_internal_page->RemoveAt(pos);
-                    _dropped_pages.push_back(child_page_id);
-                    return;
-                } else {
-                    const uint16_t num_items_to_move = ((internal_page->GetMaxSize() / 2) - internal_page->GetSize());
-                    if (num_items_to_move < left_page->GetSize() && (num_items_to_move <= left_page->GetMaxSize() / 2)) {
-                        page_id_t leftmost_child_id = FindTheLeftmostChild(internal_page);
-                        assert(leftmost_child_id != INVALID_PAGE_ID);
-                        auto leftmost_child_guard = _pages_manager.GetPageGuarded(leftmost_child_id);
-                        auto leftmost_child = leftmost_child_guard.As<BPlusTreeLeafPage>();
-                        internal_page->MoveFromLeft(left_page, num_items_to_move, leftmost_child->KeyAt(0));
-
-                        leftmost_child_id = FindTheLeftmostChild(internal_page);
-                        assert(leftmost_child_id != INVALID_PAGE_ID);
-                        leftmost_child_guard = _pages_manager.GetPageGuarded(leftmost_child_id);
-                        leftmost_child = leftmost_child_guard.As<BPlusTreeLeafPage>();
-                        bplus_internal_page->UpdateKeyAt(pos, leftmost_child->KeyAt(0));
-                        return;                        
-                    }
-                }
-            }
-
-            if (internal_page->GetSize() == 0) {
-                const uint64_t k = *reinterpret_cast<const uint64_t *>(key);
-                std::cout << " ---- internal page size: " << internal_page->GetSize() 
-                    << " page id = " << child_page_id << " pos = " << pos 
-                    << " removed key = " << k << std::endl;
-                // PrintTree(std::cout);
-                assert(false);
-            }
-        }
-    }
+    /* the page isn't reachable anymore, but the thread which has just released the latch
+     of the page might not have unpinned it yet: such page is kept until the next structure
+     change (or the destruction of the tree) and given back then */
+    std::lock_guard lg(_dropped_pages_mutex);
+    _dropped_pages.insert(_dropped_pages.end(), dropped_pages.cbegin(), dropped_pages.cend());
+    auto itr = std::remove_if(_dropped_pages.begin(), _dropped_pages.end(),
+                            [this](page_id_t page_id) { return _pages_manager.GiveBackPage(page_id); });
+    _dropped_pages.erase(itr, _dropped_pages.end());
 }
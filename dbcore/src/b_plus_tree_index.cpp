@@ -1,29 +1,132 @@
 #include <dbcore/b_plus_tree_index.h>
 #include <dbcore/b_plus_tree.h>
+#include <dbcore/run_merge.h>
 #include <dbcore/tuple.h>
+#include <dbcore/rid.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <numeric>
 
 using namespace dbcore;
 
-BPlusTreeIndex::BPlusTreeIndex(PagesManager& pages_manager, const TupleCompare& key_compare, uint32_t key_size)
-    : _bplus_tree(pages_manager, key_compare, key_size)
+BPlusTreeIndex::BPlusTreeIndex(PagesManager& pages_manager, const Schema& key_schema,
+                            page_id_t root_page_id /* = INVALID_PAGE_ID*/,
+                            LogManager* log_manager /* = nullptr*/, index_oid_t index_oid /* = INVALID_INDEX_OID*/)
+    : _pages_manager(pages_manager)
+    , _key_encoder(key_schema)
+    , _key_compare(_key_encoder)
+    , _bplus_tree(pages_manager, _key_compare, _key_encoder.GetKeySize(), 0, 0, root_page_id, log_manager, index_oid)
 {
 
 }
 
 bool BPlusTreeIndex::InsertEntry(const Tuple& key, const RID& rid)
 {
-    return _bplus_tree.Insert(key.GetData(), rid);
+    char normalized_key[MAX_NORMALIZED_KEY_SIZE];
+    _key_encoder.Encode(key.GetData(), normalized_key);
+    return _bplus_tree.Insert(normalized_key, rid);
 }
 
 void BPlusTreeIndex::DeleteEntry(const Tuple& key)
 {
-    _bplus_tree.Remove(key.GetData());
+    char normalized_key[MAX_NORMALIZED_KEY_SIZE];
+    _key_encoder.Encode(key.GetData(), normalized_key);
+    _bplus_tree.Remove(normalized_key);
 }
 
 bool BPlusTreeIndex::SearchEntry(const Tuple& key, RID* result) const
 {
     assert(result);
-    return _bplus_tree.GetValue(key.GetData(), *result);
+    char normalized_key[MAX_NORMALIZED_KEY_SIZE];
+    _key_encoder.Encode(key.GetData(), normalized_key);
+    return _bplus_tree.GetValue(normalized_key, *result);
+}
+
+IndexIterator BPlusTreeIndex::ScanRange(const Tuple* lo_key, bool lo_inclusive, const Tuple* hi_key, bool hi_inclusive) const
+{
+    const uint32_t key_size = GetKeySize();
+    char normalized_hi_key[MAX_NORMALIZED_KEY_SIZE];
+    if (hi_key) {
+        _key_encoder.Encode(hi_key->GetData(), normalized_hi_key);
+    }
+
+    if (!lo_key) {
+        return IndexIterator(_bplus_tree.Begin(), hi_key ? normalized_hi_key : nullptr, key_size, hi_inclusive);
+    }
+
+    char normalized_lo_key[MAX_NORMALIZED_KEY_SIZE];
+    _key_encoder.Encode(lo_key->GetData(), normalized_lo_key);
+    BPlusTree::Iterator itr = _bplus_tree.LowerBound(normalized_lo_key);
+    // the keys are unique, so at most one key equals to the lower bound
+    if (!lo_inclusive && !itr.IsEnd() && ::memcmp(itr.GetKey(), normalized_lo_key, key_size) == 0) {
+        ++itr;
+    }
+    return IndexIterator(std::move(itr), hi_key ? normalized_hi_key : nullptr, key_size, hi_inclusive);
+}
+
+bool BPlusTreeIndex::SpillRun(std::vector<char>& normalized_keys, std::vector<RID>& rids, std::vector<RowSpill>& runs) const
+{
+    const uint32_t key_size = GetKeySize();
+    const char* keys = normalized_keys.data();
+    assert(normalized_keys.size() == rids.size() * key_size);
+
+    // the stable sort keeps the first entry of the same key first
+    std::vector<size_t> order(rids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [keys, key_size](size_t lhs, size_t rhs) {
+        return ::memcmp(keys + lhs * key_size, keys + rhs * key_size, key_size) < 0;
+    });
+
+    RowSpill run(_pages_manager);
+    for (const size_t pos : order) {
+        if (!run.Append(TupleView{keys + pos * key_size, key_size, rids[pos]})) {
+            return false;
+        }
+    }
+    if (!run.Finish()) {
+        return false;
+    }
+    runs.push_back(std::move(run));
+
+    normalized_keys.clear();
+    rids.clear();
+    return true;
+}
+
+bool BPlusTreeIndex::BulkLoad(std::vector<RowSpill>& runs)
+{
+    const uint32_t key_size = GetKeySize();
+    uint64_t count = 0;
+    for (const RowSpill& run : runs) {
+        count += run.GetNumRows();
+    }
+
+    // the rows of the runs are the normalized keys
+    RunMerge merge(key_size);
+    if (!merge.Reduce(runs, _pages_manager, MAX_MERGE_FAN_IN)) {
+        return false;
+    }
+
+    // the equal keys come in order of the runs, the first one is indexed.
+    // the key given to the tree is copied, the page of its run might be released by the next pop
+    merge.Open(runs, 0, runs.size());
+    std::vector<char> last_key(key_size);
+    uint64_t num_loaded = 0;
+    const bool loaded = _bplus_tree.BulkLoad([&](const char*& key, RID& rid) {
+        for (const TupleView* row = nullptr; (row = merge.Top()) != nullptr; merge.Pop()) {
+            if (num_loaded > 0 && ::memcmp(row->GetData(), last_key.data(), key_size) == 0) {
+                continue;
+            }
+            ::memcpy(last_key.data(), row->GetData(), key_size);
+            key = last_key.data();
+            rid = row->GetRID();
+            merge.Pop();
+            num_loaded++;
+            return true;
+        }
+        return false;
+    });
+    return loaded && num_loaded == count;
 }
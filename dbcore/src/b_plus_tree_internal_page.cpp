@@ -29,7 +29,8 @@ void BPlusTreeInternalPage::Init(uint32_t key_size, uint16_t max_size)
 
 uint32_t BPlusTreeInternalPage::MaxNumItems(uint32_t key_size)
 {
-    return (BPLUS_INTERNAL_PAGE_DATA_SIZE / (key_size + BPLUS_INTERNAL_PAGE_VALUE_SIZE));
+    // the page keeps one more child than the number of keys
+    return (BPLUS_INTERNAL_PAGE_DATA_SIZE / (key_size + BPLUS_INTERNAL_PAGE_VALUE_SIZE)) - 1;
 }
 
 page_id_t BPlusTreeInternalPage::GetValueAt(uint32_t pos) const
@@ -276,17 +277,17 @@ void BPlusTreeInternalPage::MergeLeft(const BPlusTreeInternalPage* left_sibling)
 
 uint16_t BPlusTreeInternalPage::bsearch(const char* key, const TupleCompare& key_cmp) const
 {
+    const uint32_t key_size = GetKeySize();
+    if (key_cmp.IsNormalized() && IsIntegerKeySize(key_size)) {
+        // the position of the last key (starting from 1) which is not greater than the given one,
+        // or 0 when all keys are greater
+        const uint32_t item_size = key_size + BPLUS_INTERNAL_PAGE_VALUE_SIZE;
+        return SearchIntegerKeys(_data + item_size, GetSize(), item_size, key_size, key, true);
+    }
+
     if (GetSize() == 1) {
         const char *key1 = KeyAt(1);
-        if (key_cmp(key1, key) == 0) {
-            return 1;
-        }
-
-        if (key_cmp(key1, key) == 1) {
-            return 0;
-        } else {
-            return 1;
-        }
+        return key_cmp(key1, key) == 1 ? 0 : 1;
     }
 
     uint16_t start = 1;
@@ -297,10 +298,11 @@ uint16_t BPlusTreeInternalPage::bsearch(const char* key, const TupleCompare& key
         // if (mid == end)
         //     return mid;
         const char *mkey = KeyAt(mid);
-        if (key_cmp(mkey, key) == 0) {
+        const int result = key_cmp(mkey, key);
+        if (result == 0) {
             return mid;
         }
-        if (key_cmp(mkey, key) == -1) {
+        if (result == -1) {
             start = mid + 1;
         } else {
             end = mid - 1;
@@ -22,6 +22,7 @@ void BPlusTreeLeafPage::Init(uint32_t key_size)
 {
     const uint32_t max_num_items = MaxNumItems(key_size);
     BPlusTreePage::Init(BPlusTreePageType::LEAF_PAGE_TYPE, max_num_items, key_size);
+    _next_page_id = INVALID_PAGE_ID;
     ::memset(_data, 0, BPLUS_LEAF_PAGE_DATA_SIZE);
 }
 
@@ -168,17 +169,15 @@ const char* BPlusTreeLeafPage::KeyAt(uint16_t pos) const
 
 uint16_t BPlusTreeLeafPage::bsearch(const char* key, const TupleCompare& key_cmp) const
 {
+    const uint32_t key_size = GetKeySize();
+    if (key_cmp.IsNormalized() && IsIntegerKeySize(key_size)) {
+        // the position of the first key which is not less than the given one
+        return SearchIntegerKeys(_data, GetSize(), key_size + BPLUS_LEAF_PAGE_VALUE_SIZE, key_size, key, false);
+    }
+
     if (GetSize() == 1) {
         const char *key0 = KeyAt(0);
-        if (key_cmp(key0, key) == 0) {
-            return 0;
-        }
-
-        if (key_cmp(key0, key) == 1) {
-            return 0;
-        } else {
-            return 1;
-        }
+        return key_cmp(key0, key) >= 0 ? 0 : 1;
     }
 
     uint16_t start = 0;
@@ -186,10 +185,11 @@ uint16_t BPlusTreeLeafPage::bsearch(const char* key, const TupleCompare& key_cmp
     while (start <= end) {
         const uint16_t mid = (start + end) / 2;
         const char *mkey = KeyAt(mid);
-        if (key_cmp(mkey, key) == 0) {
+        const int result = key_cmp(mkey, key);
+        if (result == 0) {
             return mid;
         }
-        if (key_cmp(mkey, key) == -1) {
+        if (result == -1) {
             start = mid + 1;
         } else {
             if (mid == 0)
@@ -205,7 +205,7 @@ void BPlusTreeLeafPage::MergeRight(const BPlusTreeLeafPage* right_sibling)
     const uint16_t size = GetSize();
     const uint16_t right_size = right_sibling->GetSize();
     // sanity check
-    if ((size > (GetMaxSize() / 2)) || (right_size > (right_sibling->GetMaxSize() / 2)))
+    if (size + right_size > GetMaxSize())
     {
         return;
     }
@@ -1,10 +1,203 @@
 #include <dbcore/b_plus_tree_page.h>
 
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 using namespace dbcore;
 
+namespace
+{
+
+/** The number of keys at the end of search which are probed one by one */
+constexpr uint32_t LINEAR_PROBE_SIZE = 8;
+
+inline uint32_t LoadBigEndian(const char* src, uint32_t)
+{
+    uint32_t value;
+    ::memcpy(&value, src, sizeof(value));
+    return __builtin_bswap32(value);
+}
+
+inline uint64_t LoadBigEndian(const char* src, uint64_t)
+{
+    uint64_t value;
+    ::memcpy(&value, src, sizeof(value));
+    return __builtin_bswap64(value);
+}
+
+/** Count the first `len` keys which precede the searched one, one key at a time */
+template <typename T, bool inclusive>
+uint32_t ProbeKeysScalar(const char* keys, uint32_t len, uint32_t stride, T key_value)
+{
+    uint32_t num_before = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        const T value = LoadBigEndian(keys + i * stride, T{});
+        num_before += inclusive ? value <= key_value : value < key_value;
+    }
+    return num_before;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * The probes of the last LINEAR_PROBE_SIZE keys compare all of them at once. The keys are
+ * interleaved with the values, so they are gathered (AVX2) or inserted one by one (SSE4.2)
+ * into the vector, the lanes past `len` are masked out. The keys are unsigned, so their
+ * sign bits are flipped before the signed comparison.
+*/
+template <bool inclusive>
+__attribute__((target("avx2")))
+uint32_t ProbeKeysAvx2(const char* keys, uint32_t len, uint32_t stride, uint32_t key_value)
+{
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(len)), lanes);
+    const __m256i offsets = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(static_cast<int32_t>(stride)));
+    __m256i values = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int*>(keys),
+                                                offsets, mask, 1);
+    const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i sign = _mm256_set1_epi32(std::numeric_limits<int32_t>::min());
+    values = _mm256_xor_si256(_mm256_shuffle_epi8(values, bswap), sign);
+    const __m256i key = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(key_value)), sign);
+    const __m256i before = inclusive ? _mm256_andnot_si256(_mm256_cmpgt_epi32(values, key), mask)
+                                    : _mm256_and_si256(_mm256_cmpgt_epi32(key, values), mask);
+    return __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(before)));
+}
+
+template <bool inclusive>
+__attribute__((target("avx2")))
+uint32_t ProbeKeysAvx2(const char* keys, uint32_t len, uint32_t stride, uint64_t key_value)
+{
+    const __m256i bswap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                           7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m256i sign = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+    const __m256i key = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(key_value)), sign);
+    uint32_t num_before = 0;
+    for (uint32_t first = 0; first < len; first += 4) {
+        const __m256i lanes = _mm256_setr_epi64x(first, first + 1, first + 2, first + 3);
+        const __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(len), lanes);
+        const __m128i offsets = _mm_mullo_epi32(_mm_setr_epi32(first, first + 1, first + 2, first + 3),
+                                                _mm_set1_epi32(static_cast<int32_t>(stride)));
+        __m256i values = _mm256_mask_i32gather_epi64(_mm256_setzero_si256(), reinterpret_cast<const long long*>(keys),
+                                                    offsets, mask, 1);
+        values = _mm256_xor_si256(_mm256_shuffle_epi8(values, bswap), sign);
+        const __m256i before = inclusive ? _mm256_andnot_si256(_mm256_cmpgt_epi64(values, key), mask)
+                                        : _mm256_and_si256(_mm256_cmpgt_epi64(key, values), mask);
+        num_before += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(before)));
+    }
+    return num_before;
+}
+
+template <bool inclusive>
+__attribute__((target("sse4.2")))
+uint32_t ProbeKeysSse42(const char* keys, uint32_t len, uint32_t stride, uint32_t key_value)
+{
+    const __m128i bswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128i sign = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+    const __m128i key = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(key_value)), sign);
+    uint32_t num_before = 0;
+    for (uint32_t first = 0; first < len; first += 4) {
+        int32_t raw[4] = {0, 0, 0, 0};
+        for (uint32_t i = first; i < len && i < first + 4; i++) {
+            ::memcpy(&raw[i - first], keys + i * stride, sizeof(int32_t));
+        }
+        const __m128i lanes = _mm_setr_epi32(first, first + 1, first + 2, first + 3);
+        const __m128i mask = _mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int32_t>(len)), lanes);
+        const __m128i values = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(raw)), bswap), sign);
+        const __m128i before = inclusive ? _mm_andnot_si128(_mm_cmpgt_epi32(values, key), mask)
+                                        : _mm_and_si128(_mm_cmpgt_epi32(key, values), mask);
+        num_before += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(before)));
+    }
+    return num_before;
+}
+
+template <bool inclusive>
+__attribute__((target("sse4.2")))
+uint32_t ProbeKeysSse42(const char* keys, uint32_t len, uint32_t stride, uint64_t key_value)
+{
+    const __m128i bswap = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m128i sign = _mm_set1_epi64x(std::numeric_limits<int64_t>::min());
+    const __m128i key = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(key_value)), sign);
+    uint32_t num_before = 0;
+    for (uint32_t first = 0; first < len; first += 2) {
+        int64_t raw[2] = {0, 0};
+        for (uint32_t i = first; i < len && i < first + 2; i++) {
+            ::memcpy(&raw[i - first], keys + i * stride, sizeof(int64_t));
+        }
+        const __m128i mask = _mm_cmpgt_epi64(_mm_set1_epi64x(len), _mm_set_epi64x(first + 1, first));
+        const __m128i values = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(raw)), bswap), sign);
+        const __m128i before = inclusive ? _mm_andnot_si128(_mm_cmpgt_epi64(values, key), mask)
+                                        : _mm_and_si128(_mm_cmpgt_epi64(key, values), mask);
+        num_before += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(before)));
+    }
+    return num_before;
+}
+
+#endif
+
+/** The probe of the last keys, chosen once by the instruction sets of the CPU */
+template <typename T>
+using ProbeKeysFn = uint32_t (*)(const char* keys, uint32_t len, uint32_t stride, T key_value);
+
+template <typename T, bool inclusive>
+ProbeKeysFn<T> SelectProbeKeys()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return ProbeKeysAvx2<inclusive>;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return ProbeKeysSse42<inclusive>;
+    }
+#endif
+    return ProbeKeysScalar<T, inclusive>;
+}
+
+template <typename T, bool inclusive>
+uint32_t SearchIntegerKeysImpl(const char* keys, uint32_t count, uint32_t stride, const char* key)
+{
+    static const ProbeKeysFn<T> probe_keys = SelectProbeKeys<T, inclusive>();
+
+    const T key_value = LoadBigEndian(key, T{});
+    auto is_before = [key_value](T value) { return inclusive ? value <= key_value : value < key_value; };
+
+    // the keys before `base` precede the searched key, the keys from `base + len` don't
+    uint32_t base = 0;
+    uint32_t len = count;
+    while (len > LINEAR_PROBE_SIZE) {
+        const uint32_t half = len / 2;
+        const T value = LoadBigEndian(keys + (base + half - 1) * stride, T{});
+        base = is_before(value) ? base + half : base;
+        len -= half;
+    }
+
+    return base + probe_keys(keys + base * stride, len, stride, key_value);
+}
+
+}
+
 void BPlusTreePage::Init(BPlusTreePageType page_type, uint32_t max_size, uint32_t key_size)
 {
     _page_type = page_type;
+    _size = 0;
     _max_size = max_size;
     _key_size = key_size;
 }
+
+uint32_t BPlusTreePage::SearchIntegerKeys(const char* keys, uint32_t count, uint32_t stride,
+                                        uint32_t key_size, const char* key, bool inclusive)
+{
+    assert(IsIntegerKeySize(key_size));
+    if (key_size == sizeof(uint32_t)) {
+        return inclusive ? SearchIntegerKeysImpl<uint32_t, true>(keys, count, stride, key)
+                        : SearchIntegerKeysImpl<uint32_t, false>(keys, count, stride, key);
+    }
+    return inclusive ? SearchIntegerKeysImpl<uint64_t, true>(keys, count, stride, key)
+                    : SearchIntegerKeysImpl<uint64_t, false>(keys, count, stride, key);
+}
@@ -1,105 +1,504 @@
 #include <dbcore/catalog.h>
+#include <dbcore/catalog_page.h>
+#include <dbcore/pages_manager.h>
 #include <dbcore/table_heap.h>
 #include <dbcore/table_info.h>
 #include <dbcore/index.h>
 #include <dbcore/index_info.h>
+#include <dbcore/log_manager.h>
+#include <dbcore/log_recovery.h>
 
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 
 using namespace dbcore;
 
-Catalog::Catalog(PagesManager* pages_manager)
+namespace
+{
+
+/** @return the sequence number of the calling thread, it chooses the reader slot of the thread */
+uint32_t ThreadSequenceNumber()
+{
+    static std::atomic<uint32_t> next_number{0};
+    thread_local const uint32_t number = next_number.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+/** The first bytes of the serialized catalog */
+constexpr uint32_t CATALOG_MAGIC = 0x54414344;   // "DCAT"
+
+/**
+ * The serialized catalog:
+ * | MAGIC(4) | IS_CLEAN(1) | NEXT_TABLE_OID(4) | NEXT_INDEX_OID(4) | NUM_TABLES(4) | TABLES | NUM_INDEXES(4) | INDEXES |
+ * the table:
+ * | OID(4) | NAME | FIRST_PAGE_ID(4) | LAST_PAGE_ID(4) | NUM_COLUMNS(4) | COLUMNS: NAME | TYPE(4) | LENGTH(4) |
+ * the index:
+ * | OID(4) | NAME | TABLE_OID(4) | TYPE(4) | ROOT_PAGE_ID(4) | NUM_KEY_ATTRS(4) | KEY_ATTRS(4 * NUM_KEY_ATTRS) |
+ * the name is written as its length (4) and characters.
+*/
+class CatalogWriter final
+{
+public:
+    template <typename T>
+    void Write(const T& value)
+    {
+        const char* p = reinterpret_cast<const char*>(&value);
+        _data.insert(_data.end(), p, p + sizeof(T));
+    }
+
+    void WriteName(const char* name, size_t max_size)
+    {
+        const uint32_t size = static_cast<uint32_t>(::strnlen(name, max_size));
+        Write(size);
+        _data.insert(_data.end(), name, name + size);
+    }
+
+    const std::vector<char>& GetData() const { return _data; }
+
+private:
+    std::vector<char> _data;
+};
+
+class CatalogReader final
+{
+public:
+    explicit CatalogReader(const std::vector<char>& data) : _data(data) {}
+
+    template <typename T>
+    bool Read(T& value)
+    {
+        if (_offset + sizeof(T) > _data.size()) {
+            return false;
+        }
+        ::memcpy(&value, _data.data() + _offset, sizeof(T));
+        _offset += sizeof(T);
+        return true;
+    }
+
+    /** Read the name into the buffer of max_size + 1 bytes */
+    bool ReadName(char* name, size_t max_size)
+    {
+        uint32_t size = 0;
+        if (!Read(size) || size > max_size || _offset + size > _data.size()) {
+            return false;
+        }
+        ::memcpy(name, _data.data() + _offset, size);
+        name[size] = '\0';
+        _offset += size;
+        return true;
+    }
+
+private:
+    const std::vector<char>& _data;
+    size_t _offset{0};
+};
+
+}
+
+Catalog::Catalog(PagesManager* pages_manager, LogManager* log_manager /* = nullptr*/)
     : _pages_manager(pages_manager)
+    , _log_manager(log_manager)
+    , _snapshot(new Snapshot())
 {
+    page_id_t page_id = INVALID_PAGE_ID;
+    auto page_guard = _pages_manager->NextFreePageGuarded(&page_id);
+    if (page_id == INVALID_PAGE_ID) {
+        return;
+    }
+    page_guard.AsMut<CatalogPage>()->Init();
+    page_guard.Drop();
+
+    _catalog_page_id = page_id;
+    _catalog_pages.push_back(page_id);
+    if (!Persist(false)) {
+        _catalog_page_id = INVALID_PAGE_ID;
+    }
+}
 
+Catalog::Catalog(PagesManager* pages_manager, page_id_t catalog_page_id, LogManager* log_manager /* = nullptr*/)
+    : _pages_manager(pages_manager)
+    , _log_manager(log_manager)
+    , _catalog_page_id(catalog_page_id)
+    , _snapshot(new Snapshot())
+{
+    // the catalog is marked as not closed cleanly until it's closed
+    if (!Load() || !Persist(false)) {
+        _catalog_page_id = INVALID_PAGE_ID;
+    }
 }
 
 Catalog::~Catalog()
 {
-    for (auto &[_, table] : _tables)
+    if (IsOpen()) {
+        // the log is redone on open unless all of the pages are on the storage:
+        // the clean flag is written after the pages are durable, and is made durable itself
+        if (_pages_manager->FlushAllPages() && _pages_manager->Sync()) {
+            Persist(true);
+        }
+    }
+
+    // nobody reads the catalog anymore, the current snapshot holds all of the tables and indexes
+    _retired_snapshots.clear();
+    const std::unique_ptr<Snapshot> snapshot(_snapshot.load());
+    for (auto &[_, index] : snapshot->indexes)
+    {
+        index->~IndexInfo();
+        ::free(index);
+    }
+
+    for (auto &[_, table] : snapshot->tables)
     {
         table->~TableInfo();
         ::free(table);
     }
 }
 
-TableInfo* Catalog::CreateTable(const char* table_name, const Schema& schema)
+bool Catalog::Flush()
 {
-    const std::string tname(table_name);
-    if (_table_names.count(tname)) {
-        return nullptr;
+    std::lock_guard lg(_ddl_mutex);
+    return IsOpen() && Persist(false);
+}
+
+Catalog::SnapshotRef::SnapshotRef(const Catalog& catalog)
+    : _num_readers(catalog._reader_slots[ThreadSequenceNumber() % NUM_READER_SLOTS].num_readers)
+{
+    /* the reader is counted before the snapshot is loaded (both are sequentially consistent),
+     so the DDL which finds the slot drained after the publication knows that the reader loads the new one */
+    _num_readers.fetch_add(1);
+    _snapshot = catalog._snapshot.load();
+}
+
+Catalog::SnapshotRef::~SnapshotRef()
+{
+    _num_readers.fetch_sub(1, std::memory_order_release);
+}
+
+void Catalog::Publish(std::unique_ptr<Snapshot> snapshot)
+{
+    // the readers of the replaced snapshot keep it alive until they are done
+    _retired_snapshots.emplace_back(_snapshot.exchange(snapshot.release()));
+    ReclaimSnapshots();
+}
+
+void Catalog::ReclaimSnapshots()
+{
+    for (const ReaderSlot& slot : _reader_slots) {
+        if (slot.num_readers.load() != 0) {
+            return;
+        }
     }
+    _retired_snapshots.clear();
+}
 
-    TableHeap* table_heap = static_cast<TableHeap *>(::calloc(1, sizeof(TableHeap)));
-    if (!table_heap) {
-        return nullptr;
+bool Catalog::Persist(bool is_clean)
+{
+    // the catalog refers to the pages whose creation is logged (e.g. the first page of the new table),
+    // so the log must be durable up to them before the catalog is written
+    if (_log_manager != nullptr && !_log_manager->Flush(_log_manager->GetAppendedLSN())) {
+        return false;
+    }
+
+    CatalogWriter writer;
+    writer.Write(CATALOG_MAGIC);
+    writer.Write(static_cast<uint8_t>(is_clean));
+    writer.Write(_next_table_oid.load());
+    writer.Write(_next_index_oid.load());
+
+    const SnapshotRef snapshot = GetSnapshot();
+    writer.Write(static_cast<uint32_t>(snapshot->tables.size()));
+    for (auto &[table_oid, table_info] : snapshot->tables) {
+        TableHeap* table_heap = table_info->GetTableHeap();
+        writer.Write(table_oid);
+        writer.WriteName(table_info->GetTableName(), MAX_TABLE_NAME_SIZE);
+        writer.Write(table_heap->GetFirstPageId());
+        writer.Write(table_heap->GetLastPageId());
+
+        const Schema& schema = table_info->GetSchema();
+        writer.Write(schema.GetColumnCount());
+        for (uint32_t idx = 0; idx < schema.GetColumnCount(); idx++) {
+            const Column& column = schema.GetColumnAt(idx);
+            writer.WriteName(column.GetName(), Column::MAX_NAME_LENGTH);
+            writer.Write(static_cast<uint32_t>(column.GetType()));
+            writer.Write(column.GetStorageSize());
+        }
+    }
+
+    writer.Write(static_cast<uint32_t>(snapshot->indexes.size()));
+    for (auto &[index_oid, index_info] : snapshot->indexes) {
+        const Index* index = index_info->GetIndex();
+        const IndexMetadata& metadata = index->GetMetadata();
+        writer.Write(index_oid);
+        writer.WriteName(index_info->GetName(), MAX_INDEX_NAME_SIZE);
+        writer.Write(snapshot->table_names.at(index_info->GetTableName())->GetTableOid());
+        writer.Write(static_cast<uint32_t>(index->_type));
+        writer.Write(index->GetRootPageId());
+        writer.Write(metadata.GetKeyAttrCount());
+        for (uint32_t idx = 0; idx < metadata.GetKeyAttrCount(); idx++) {
+            writer.Write(metadata.GetKeyAttributes()[idx]);
+        }
+    }
+
+    // the chain is extended when needed, the pages beyond the data are kept empty for the later use
+    const std::vector<char>& data = writer.GetData();
+    const size_t num_pages = (data.size() + CatalogPage::CATALOG_PAGE_CAPACITY - 1) / CatalogPage::CATALOG_PAGE_CAPACITY;
+    while (_catalog_pages.size() < num_pages) {
+        page_id_t page_id = INVALID_PAGE_ID;
+        _pages_manager->NextFreePageGuarded(&page_id);
+        if (page_id == INVALID_PAGE_ID) {
+            return false;
+        }
+        _catalog_pages.push_back(page_id);
+    }
+
+    /* every page is written entirely, links included: the catalog is read before the log is redone,
+     and the redo might overwrite the pages which were the index pages before.
+     The pages are kept pinned until they are flushed, so none of them is evicted in between */
+    std::vector<PageGuard> pinned_pages;
+    pinned_pages.reserve(_catalog_pages.size());
+    size_t offset = 0;
+    for (size_t n = 0; n < _catalog_pages.size(); n++) {
+        pinned_pages.push_back(_pages_manager->GetPageGuarded(_catalog_pages[n]));
+        auto page_guard = _pages_manager->GetPageWrite(_catalog_pages[n]);
+        CatalogPage* page = page_guard.AsMut<CatalogPage>();
+        if (page == nullptr) {
+            return false;
+        }
+        page->Init();
+        page->SetNextPageId(n + 1 < _catalog_pages.size() ? _catalog_pages[n + 1] : INVALID_PAGE_ID);
+        offset += page->SetData(data.data() + offset, data.size() - offset);
+    }
+
+    if (!_pages_manager->HasStorage()) {
+        return true;
+    }
+    for (page_id_t page_id : _catalog_pages) {
+        if (!_pages_manager->FlushPage(page_id)) {
+            return false;
+        }
+    }
+    return _pages_manager->Sync();
+}
+
+bool Catalog::Load()
+{
+    // nobody reads the catalog while it's opened, so the snapshot is built in place
+    Snapshot& snapshot = *_snapshot.load();
+
+    std::vector<char> data;
+    page_id_t page_id = _catalog_page_id;
+    while (page_id != INVALID_PAGE_ID) {
+        auto page_guard = _pages_manager->GetPageRead(page_id);
+        const CatalogPage* page = page_guard.As<CatalogPage>();
+        if (page == nullptr || page->GetDataSize() > CatalogPage::CATALOG_PAGE_CAPACITY) {
+            return false;
+        }
+        data.insert(data.end(), page->GetData(), page->GetData() + page->GetDataSize());
+        _catalog_pages.push_back(page_id);
+        page_id = page->GetNextPageId();
+    }
+
+    CatalogReader reader(data);
+    uint32_t magic = 0;
+    uint8_t is_clean = 0;
+    table_oid_t next_table_oid = INVALID_TABLE_OID;
+    index_oid_t next_index_oid = INVALID_INDEX_OID;
+    if (!reader.Read(magic) || magic != CATALOG_MAGIC || !reader.Read(is_clean) 
+        || !reader.Read(next_table_oid) || !reader.Read(next_index_oid)) {
+        return false;
+    }
+    _next_table_oid = next_table_oid;
+    _next_index_oid = next_index_oid;
+
+    // the pages on the storage might miss the latest changes, they are redone before the tables
+    // and indexes are opened (the catalog itself is not logged, it's read above and written again on open)
+    if (!is_clean && _log_manager != nullptr) {
+        LogRecovery recovery(*_log_manager, *_pages_manager);
+        if (!recovery.Redo()) {
+            return false;
+        }
+    }
+
+    uint32_t num_tables = 0;
+    if (!reader.Read(num_tables)) {
+        return false;
+    }
+    for (uint32_t n = 0; n < num_tables; n++) {
+        table_oid_t table_oid = INVALID_TABLE_OID;
+        char table_name[MAX_TABLE_NAME_SIZE + 1];
+        page_id_t first_page_id = INVALID_PAGE_ID, last_page_id = INVALID_PAGE_ID;
+        uint32_t num_columns = 0;
+        if (!reader.Read(table_oid) || !reader.ReadName(table_name, MAX_TABLE_NAME_SIZE)
+            || !reader.Read(first_page_id) || !reader.Read(last_page_id) 
+            || !reader.Read(num_columns) || num_columns > MAX_COLUMN_COUNT) {
+            return false;
+        }
+
+        Column columns[MAX_COLUMN_COUNT];
+        for (uint32_t idx = 0; idx < num_columns; idx++) {
+            char column_name[Column::MAX_NAME_LENGTH + 1];
+            uint32_t type = 0, length = 0;
+            if (!reader.ReadName(column_name, Column::MAX_NAME_LENGTH) || !reader.Read(type) || !reader.Read(length)) {
+                return false;
+            }
+            const TypeId type_id = static_cast<TypeId>(type);
+            columns[idx] = type_id == TypeId::VARCHAR ? Column{column_name, type_id, length} : Column{column_name, type_id};
+        }
+
+        TableHeap* table_heap = static_cast<TableHeap *>(::calloc(1, sizeof(TableHeap)));
+        if (!table_heap) {
+            return false;
+        }
+        // the last page is only a hint, the pages appended after it are found by the chain
+        new (table_heap)TableHeap(*_pages_manager, first_page_id, _log_manager, last_page_id);
+        if (!AddTable(snapshot, table_name, Schema{columns, num_columns}, table_heap, table_oid)) {
+            table_heap->~TableHeap();
+            ::free(table_heap);
+            return false;
+        }
+    }
+
+    uint32_t num_indexes = 0;
+    if (!reader.Read(num_indexes)) {
+        return false;
+    }
+    for (uint32_t n = 0; n < num_indexes; n++) {
+        index_oid_t index_oid = INVALID_INDEX_OID;
+        char index_name[MAX_INDEX_NAME_SIZE + 1];
+        table_oid_t table_oid = INVALID_TABLE_OID;
+        uint32_t index_type = 0, num_key_attrs = 0;
+        page_id_t root_page_id = INVALID_PAGE_ID;
+        if (!reader.Read(index_oid) || !reader.ReadName(index_name, MAX_INDEX_NAME_SIZE)
+            || !reader.Read(table_oid) || !reader.Read(index_type) || !reader.Read(root_page_id)
+            || !reader.Read(num_key_attrs) || num_key_attrs > MAX_COLUMN_COUNT) {
+            return false;
+        }
+        uint32_t key_attrs[MAX_COLUMN_COUNT];
+        for (uint32_t idx = 0; idx < num_key_attrs; idx++) {
+            if (!reader.Read(key_attrs[idx])) {
+                return false;
+            }
+        }
+
+        const auto it_table = snapshot.tables.find(table_oid);
+        if (it_table == snapshot.tables.cend()) {
+            return false;
+        }
+        TableInfo* table_info = it_table->second;
+        const Schema& tbl_schema = table_info->GetSchema();
+        Schema key_schema{Schema::CopySchema(tbl_schema, key_attrs, num_key_attrs)};
+        IndexMetadata meta(key_attrs, num_key_attrs, key_schema, tbl_schema);
+
+        Index *index = static_cast<Index *>(::malloc(sizeof(Index)));
+        if (!index) {
+            return false;
+        }
+        // the root page of the index never moves, so it's persisted once when the index is created
+        new(index)Index(static_cast<IndexType>(index_type), meta, *_pages_manager, _log_manager, index_oid, root_page_id);
+
+        if (!AddIndex(snapshot, index_name, table_info, key_schema, index, index_oid)) {
+            index->~Index();
+            ::free(index);
+            return false;
+        }
     }
 
+    return true;
+}
+
+TableInfo* Catalog::AddTable(Snapshot& snapshot, const char* table_name, const Schema& schema,
+                            TableHeap* table_heap, table_oid_t table_oid)
+{
     TableInfo* table_info = static_cast<TableInfo *>(::calloc(1, sizeof(TableInfo)));
     if (!table_info) {
-        ::free(table_heap);
         return nullptr;
     }
 
-    new (table_heap)TableHeap(*_pages_manager);
-
-    const auto table_oid = _next_table_oid.fetch_add(1);
-
     new (table_info)TableInfo(schema, table_name, table_heap, table_oid);
 
-    _tables.emplace(table_oid, table_info);
-    _table_names.emplace(tname, table_oid);
-
-    _index_names.emplace(tname, std::unordered_map<std::string, index_oid_t>());
+    // the name keys refer to the name kept by the table info
+    const std::string_view tname(table_info->GetTableName());
+    snapshot.tables.emplace(table_oid, table_info);
+    snapshot.table_names.emplace(tname, table_info);
+    snapshot.index_names.emplace(tname, std::unordered_map<std::string_view, IndexInfo *>());
 
     return table_info;
 }
 
-TableInfo* Catalog::GetTable(table_oid_t oid) const
+IndexInfo* Catalog::AddIndex(Snapshot& snapshot, const char* index_name, const TableInfo* table_info,
+                            const Schema& key_schema, Index* index, index_oid_t index_oid)
 {
-    const auto it = _tables.find(oid);
-    return it != _tables.cend() ? it->second : nullptr;
+    IndexInfo* index_info = static_cast<IndexInfo *>(::malloc(sizeof(IndexInfo)));
+    if (!index_info) {
+        return nullptr;
+    }
+
+    new(index_info)IndexInfo(key_schema, index_name, index, table_info->GetTableName(), index_oid);
+
+    snapshot.indexes.emplace(index_oid, index_info);
+    snapshot.index_names[table_info->GetTableName()].emplace(index_info->GetName(), index_info);
+
+    return index_info;
 }
 
-TableInfo* Catalog::GetTable(const char* name) const
+TableInfo* Catalog::CreateTable(const char* table_name, const Schema& schema)
 {
-    const std::string tname(name);
-    const auto it = _table_names.find(tname);
-    if (it == _table_names.cend()) {
+    std::lock_guard lg(_ddl_mutex);
+    if (GetTable(table_name) != nullptr) {
+        return nullptr;
+    }
+
+    TableHeap* table_heap = static_cast<TableHeap *>(::calloc(1, sizeof(TableHeap)));
+    if (!table_heap) {
         return nullptr;
     }
 
-    const auto it2 = _tables.find(it->second);
-    if (it2 == _tables.cend()) {
-        assert(false);  // broken invariant !
+    new (table_heap)TableHeap(*_pages_manager, _log_manager);
+
+    const auto table_oid = _next_table_oid.fetch_add(1);
+
+    auto snapshot = std::make_unique<Snapshot>(*GetSnapshot());
+    TableInfo* table_info = AddTable(*snapshot, table_name, schema, table_heap, table_oid);
+    if (!table_info) {
+        table_heap->~TableHeap();
+        ::free(table_heap);
         return nullptr;
     }
 
-    return it2->second;
+    Publish(std::move(snapshot));
+    Persist(false);
+    return table_info;
+}
+
+TableInfo* Catalog::GetTable(table_oid_t oid) const
+{
+    const auto snapshot = GetSnapshot();
+    const auto it = snapshot->tables.find(oid);
+    return it != snapshot->tables.cend() ? it->second : nullptr;
+}
+
+TableInfo* Catalog::GetTable(std::string_view name) const
+{
+    const auto snapshot = GetSnapshot();
+    const auto it = snapshot->table_names.find(name);
+    return it != snapshot->table_names.cend() ? it->second : nullptr;
 }
 
 IndexInfo* Catalog::CreateIndex(const char* index_name, const char* table_name, const Schema& tbl_schema,
-                                uint32_t key_attributes[], uint32_t num_of_key_attributes, IndexType index_type)
+                                uint32_t key_attributes[], uint32_t num_of_key_attributes, IndexType index_type,
+                                uint32_t num_threads /* = 1*/,
+                                size_t memory_budget /* = Index::DEFAULT_POPULATE_MEMORY_BUDGET*/)
 {
-    const std::string idx_name(index_name);
-    const std::string tbl_name(table_name);
+    std::lock_guard lg(_ddl_mutex);
 
     // reject creation indexes for nonexistent table
-    if (_table_names.find(tbl_name) == _table_names.cend()) {
-        return nullptr;
-    }
-
-    auto it_indexes = _index_names.find(tbl_name);
-    // if the table exist, an entry for the table should already present
-    if (it_indexes == _index_names.cend()) {
-        assert(false);  // broken invariant !
+    TableInfo* table_info = GetTable(table_name);
+    if (table_info == nullptr) {
         return nullptr;
     }
 
-    auto& table_indexes = it_indexes->second;
     // check if the index with such name is already exist
-    if (table_indexes.find(idx_name) != table_indexes.cend()) {
+    if (GetIndex(index_name, table_name) != nullptr) {
         return nullptr;
     }
 
@@ -111,75 +510,71 @@ IndexInfo* Catalog::CreateIndex(const char* index_name, const char* table_name,
         return nullptr;
     }
 
-    IndexInfo* index_info = static_cast<IndexInfo *>(::malloc(sizeof(IndexInfo)));
-    if (!index_info) {
-        ::free(index);
-        return nullptr;
-    }
-
-    new(index)Index(index_type, meta, *_pages_manager);
-
-
-    TableInfo* table_info = GetTable(table_name);
-    assert(table_info != nullptr);
+    const auto index_oid = _next_index_oid.fetch_add(1);
+    new(index)Index(index_type, meta, *_pages_manager, _log_manager, index_oid);
 
     TableHeap* table_heap = table_info->GetTableHeap();
     assert(table_heap != nullptr);
 
-    auto itr = table_heap->MakeIterator(); 
-    while (!itr.IsEnd()) {
-        const auto [_, tuple] = itr.GetTuple();
-        const RID rid{itr.GetRID()};
-        index->InsertEntry(tuple, rid);
-        itr.Next();
+    // the index which misses some of the rows is not published: its scans would miss them silently
+    if (!index->Populate(*table_heap, num_threads, memory_budget)) {
+        index->GiveBackPages();
+        index->~Index();
+        ::free(index);
+        return nullptr;
     }
 
-    const auto index_oid = _next_index_oid.fetch_add(1);
-
-    new(IndexInfo)(key_schema, index_name, index, table_name, index_oid);
-
-    _indexes.emplace(index_oid, index_info);
-    table_indexes.emplace(index_name, index_oid);
+    auto snapshot = std::make_unique<Snapshot>(*GetSnapshot());
+    IndexInfo* index_info = AddIndex(*snapshot, index_name, table_info, key_schema, index, index_oid);
+    if (!index_info) {
+        index->~Index();
+        ::free(index);
+        return nullptr;
+    }
 
+    Publish(std::move(snapshot));
+    Persist(false);
     return index_info;
 }
 
-IndexInfo* Catalog::GetIndex(const char* index_name, const char* table_name)
+IndexInfo* Catalog::GetIndex(std::string_view index_name, std::string_view table_name) const
 {
-    const std::string idx_name(index_name);
-    const std::string tbl_name(table_name);
-
-    const auto it = _index_names.find(tbl_name);
-    if (it == _index_names.cend()) {
-        return nullptr;
-    }
-    
-    const auto table_indexes = it->second;
-    const auto it2 = table_indexes.find(idx_name);
-    if (it2 == table_indexes.cend()) {
+    const auto snapshot = GetSnapshot();
+    const auto it = snapshot->index_names.find(table_name);
+    if (it == snapshot->index_names.cend()) {
         return nullptr;
     }
 
-    const auto it3 = _indexes.find(it2->second);
-    if (it3 == _indexes.cend()) {
-        assert(false);  // broken invariant !
-        return nullptr;
-    }
+    const auto& table_indexes = it->second;
+    const auto it2 = table_indexes.find(index_name);
+    return it2 != table_indexes.cend() ? it2->second : nullptr;
+}
 
-    return it3->second;
+std::vector<IndexInfo*> Catalog::GetTableIndexes(std::string_view table_name) const
+{
+    std::vector<IndexInfo*> indexes;
+    const auto snapshot = GetSnapshot();
+    const auto it = snapshot->index_names.find(table_name);
+    if (it != snapshot->index_names.cend()) {
+        for (const auto& [name, index_info] : it->second) {
+            indexes.push_back(index_info);
+        }
+    }
+    return indexes;
 }
 
-IndexInfo* Catalog::GetIndex(const char* index_name, table_oid_t table_oid)
+IndexInfo* Catalog::GetIndex(std::string_view index_name, table_oid_t table_oid) const
 {
-    const auto it_tbl = _tables.find(table_oid);
-    if (it_tbl == _tables.cend()) {
+    const TableInfo* table_info = GetTable(table_oid);
+    if (table_info == nullptr) {
         return nullptr;
     }
-    return GetIndex(index_name, it_tbl->second->GetTableName());
+    return GetIndex(index_name, table_info->GetTableName());
 }
 
-IndexInfo* Catalog::GetIndex(index_oid_t index_oid)
+IndexInfo* Catalog::GetIndex(index_oid_t index_oid) const
 {
-    const auto it = _indexes.find(index_oid);
-    return it != _indexes.cend() ? it->second : nullptr;
+    const auto snapshot = GetSnapshot();
+    const auto it = snapshot->indexes.find(index_oid);
+    return it != snapshot->indexes.cend() ? it->second : nullptr;
 }
@@ -0,0 +1,21 @@
+#include <dbcore/catalog_page.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace dbcore;
+
+void CatalogPage::Init()
+{
+    _next_page_id = INVALID_PAGE_ID;
+    _data_size = 0;
+}
+
+uint32_t CatalogPage::SetData(const char* data, size_t size)
+{
+    _data_size = static_cast<uint32_t>(std::min<size_t>(size, CATALOG_PAGE_CAPACITY));
+    if (_data_size > 0) {
+        ::memcpy(_data, data, _data_size);
+    }
+    return _data_size;
+}
@@ -0,0 +1,58 @@
+#include <dbcore/checkpointer.h>
+#include <dbcore/pages_manager.h>
+
+#include <chrono>
+
+using namespace dbcore;
+
+Checkpointer::Checkpointer(PagesManager& pages_manager, uint32_t interval_ms /* = 1000*/)
+    : _pages_manager(pages_manager)
+    , _interval_ms(interval_ms)
+{
+    _thread = std::thread(&Checkpointer::CheckpointLoop, this);
+}
+
+Checkpointer::~Checkpointer()
+{
+    {
+        std::lock_guard lg(_mutex);
+        _stop = true;
+    }
+    _stop_cv.notify_one();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+uint64_t Checkpointer::GetNumCheckpoints() const
+{
+    std::lock_guard lg(_mutex);
+    return _num_checkpoints;
+}
+
+lsn_t Checkpointer::GetCheckpointLSN() const
+{
+    std::lock_guard lg(_mutex);
+    return _checkpoint_lsn;
+}
+
+void Checkpointer::CheckpointLoop()
+{
+    std::unique_lock lock(_mutex);
+    while (true) {
+        if (_stop_cv.wait_for(lock, std::chrono::milliseconds(_interval_ms), [this]() { return _stop; })) {
+            break;
+        }
+
+        // the checkpoint takes a while, the stats are not locked meanwhile
+        lock.unlock();
+        lsn_t checkpoint_lsn = INVALID_LSN;
+        const bool completed = _pages_manager.Checkpoint(&checkpoint_lsn);
+        lock.lock();
+
+        if (completed) {
+            _num_checkpoints++;
+            _checkpoint_lsn = checkpoint_lsn;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include <dbcore/column_vector.h>
+
+#include <cstring>
+
+using namespace dbcore;
+
+void ColumnVector::Load(const Column& column, const TupleView rows[], uint32_t num_rows)
+{
+    Prepare(column, num_rows);
+    switch (column.GetStorageSize())
+    {
+    case 1:
+        Decode<int8_t>(column.GetOffset(), rows, num_rows);
+        break;
+    case 2:
+        Decode<int16_t>(column.GetOffset(), rows, num_rows);
+        break;
+    case 4:
+        Decode<int32_t>(column.GetOffset(), rows, num_rows);
+        break;
+    case 8:
+        Decode<int64_t>(column.GetOffset(), rows, num_rows);
+        break;
+    default:
+        assert(false);
+    }
+}
+
+void ColumnVector::Gather(const Column& column, const TupleView rows[], const SelectionBitmap& selection)
+{
+    Prepare(column, selection.CountSelected());
+    switch (column.GetStorageSize())
+    {
+    case 1:
+        DecodeSelected<int8_t>(column.GetOffset(), rows, selection);
+        break;
+    case 2:
+        DecodeSelected<int16_t>(column.GetOffset(), rows, selection);
+        break;
+    case 4:
+        DecodeSelected<int32_t>(column.GetOffset(), rows, selection);
+        break;
+    case 8:
+        DecodeSelected<int64_t>(column.GetOffset(), rows, selection);
+        break;
+    default:
+        assert(false);
+    }
+}
+
+void ColumnVector::Prepare(const Column& column, uint32_t num_values)
+{
+    assert(IsSupported(column));
+    _type = column.GetType();
+    _value_size = column.GetStorageSize();
+    _size = num_values;
+    const size_t num_words = (static_cast<size_t>(num_values) * _value_size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    if (_data.size() < num_words) {
+        _data.resize(num_words);
+    }
+}
+
+template <typename T>
+void ColumnVector::Decode(uint32_t offset, const TupleView rows[], uint32_t num_rows)
+{
+    T* values = reinterpret_cast<T*>(_data.data());
+    for (uint32_t i = 0; i < num_rows; i++) {
+        // the values might be unaligned within the tuple
+        ::memcpy(&values[i], rows[i].GetData() + offset, sizeof(T));
+    }
+}
+
+template <typename T>
+void ColumnVector::DecodeSelected(uint32_t offset, const TupleView rows[], const SelectionBitmap& selection)
+{
+    T* values = reinterpret_cast<T*>(_data.data());
+    uint32_t i = 0;
+    selection.ForEachSelected([&](uint32_t row) {
+        ::memcpy(&values[i++], rows[row].GetData() + offset, sizeof(T));
+    });
+}
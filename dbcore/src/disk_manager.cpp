@@ -0,0 +1,93 @@
+#include <dbcore/disk_manager.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace dbcore;
+
+DiskManager::DiskManager(const char* file_name)
+{
+    assert(file_name != nullptr);
+    _fd = ::open(file_name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP);
+}
+
+DiskManager::~DiskManager()
+{
+    if (_fd != -1) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+bool DiskManager::ReadPage(page_id_t page_id, char* data)
+{
+    assert(page_id != INVALID_PAGE_ID);
+    const off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+
+    size_t num_read = 0;
+    while (num_read < PAGE_SIZE) {
+        const ssize_t n = ::pread(_fd, data + num_read, PAGE_SIZE - num_read, offset + num_read);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        if (n == 0) {
+            // the page was never written (or written partially), the rest of it is zeroes
+            ::memset(data + num_read, 0, PAGE_SIZE - num_read);
+            break;
+        }
+        num_read += n;
+    }
+    return true;
+}
+
+bool DiskManager::WritePage(page_id_t page_id, const char* data)
+{
+    return WritePages(page_id, data, 1);
+}
+
+bool DiskManager::WritePages(page_id_t first_page_id, const char* data, uint32_t num_pages)
+{
+    assert(first_page_id != INVALID_PAGE_ID);
+    const off_t offset = static_cast<off_t>(first_page_id) * PAGE_SIZE;
+    const size_t size = static_cast<size_t>(num_pages) * PAGE_SIZE;
+
+    size_t num_written = 0;
+    while (num_written < size) {
+        const ssize_t n = ::pwrite(_fd, data + num_written, size - num_written, offset + num_written);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        num_written += n;
+    }
+    return true;
+}
+
+bool DiskManager::Sync()
+{
+    return ::fdatasync(_fd) == 0;
+}
+
+bool DiskManager::Prefetch(page_id_t page_id)
+{
+    assert(page_id != INVALID_PAGE_ID);
+    const off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+    return ::posix_fadvise(_fd, offset, PAGE_SIZE, POSIX_FADV_WILLNEED) == 0;
+}
+
+uint32_t DiskManager::GetNumPages() const
+{
+    struct stat st;
+    if (::fstat(_fd, &st) != 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>((st.st_size + PAGE_SIZE - 1) / PAGE_SIZE);
+}
@@ -3,15 +3,20 @@
 #include <dbcore/extendible_htable_header_page.h>
 #include <dbcore/extendible_htable_directory_page.h>
 #include <dbcore/extendible_htable_bucket_page.h>
+#include <dbcore/page_change_log.h>
 
 #include <dbcore/tuple_compare.h>
 #include <dbcore/tuple_hash.h>
 #include <dbcore/rid.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <vector>
+
+#define PREFETCH(addr) __builtin_prefetch((addr))
 
 using namespace dbcore;
 
@@ -19,7 +24,9 @@ using namespace dbcore;
 ExtendibleHashTable::ExtendibleHashTable(
         PagesManager& pages_manager, const TupleCompare& tuple_compare,
         const TupleHash& tuple_hash, const uint32_t key_size, 
-        uint32_t header_max_depth /* = 0*/, uint32_t directory_max_depth /* = 0*/, uint32_t bucket_max_size /* = 0*/)
+        uint32_t header_max_depth /* = 0*/, uint32_t directory_max_depth /* = 0*/, uint32_t bucket_max_size /* = 0*/,
+        page_id_t header_page_id /* = INVALID_PAGE_ID*/,
+        LogManager* log_manager /* = nullptr*/, index_oid_t index_oid /* = INVALID_INDEX_OID*/)
     : _pages_manager(pages_manager)
     , _key_compare(tuple_compare)
     , _key_hash(tuple_hash)
@@ -27,14 +34,24 @@ ExtendibleHashTable::ExtendibleHashTable(
     , _header_max_depth(header_max_depth)
     , _directory_max_depth(directory_max_depth)
     , _bucket_max_size(bucket_max_size)
+    , _log_manager(log_manager)
+    , _index_oid(index_oid)
 {
-    page_id_t header_page_id{INVALID_PAGE_ID};
-    auto guard = _pages_manager.NextFreePageGuarded(&header_page_id);
+    if (header_page_id != INVALID_PAGE_ID) {
+        _header_page_id = header_page_id;
+        return;
+    }
+
+    auto guard = _pages_manager.NextFreePageGuarded(&header_page_id).UpgradeWrite();
     assert(header_page_id != INVALID_PAGE_ID);
     
     auto header_page = guard.AsMut<ExtendibleHTableHeaderPage>();
     header_page->Init(_header_max_depth);
     _header_page_id = header_page_id;
+
+    PageChangeLog changes(_log_manager, _index_oid);
+    changes.TrackNew(std::move(guard));
+    changes.Append();
 }
 
 ExtendibleHashTable::~ExtendibleHashTable()
@@ -48,50 +65,94 @@ ExtendibleHashTable::~ExtendibleHashTable()
 
 bool ExtendibleHashTable::Insert(const char* key, const RID& rid)
 {
-    // lock the whole tree now.
-    // TO DO: think about locking with page granularity
-    std::unique_lock lock(_mutex);
-
-    auto header_guard = _pages_manager.GetPageWrite(_header_page_id);
-    auto header_page = header_guard.AsMut<ExtendibleHTableHeaderPage>();
     const uint32_t hash = _key_hash(key);
-    const uint32_t directory_idx = header_page->HashToDirectoryIndex(hash);
-    if (InsertToNewDirectory(header_page, directory_idx, hash, key, rid)) {
-        return true;
+    const page_id_t directory_page_id = FindOrCreateDirectoryPageId(hash);
+    assert(directory_page_id != INVALID_PAGE_ID);
+
+    {
+        /* optimistic attempt: the directory is latched for read and only the bucket
+         is latched for write. It's succeeded unless the bucket should be created or split. */
+        ReadPageGuard directory_guard = _pages_manager.GetPageRead(directory_page_id);
+        auto directory_page = directory_guard.As<ExtendibleHTableDirectoryPage>();
+        const uint32_t bucket_idx = directory_page->HashToBucketIndex(hash);
+        const page_id_t bucket_page_id = directory_page->GetBucketPageId(bucket_idx);
+        if (bucket_page_id != INVALID_PAGE_ID) {
+            WritePageGuard bucket_guard = _pages_manager.GetPageWrite(bucket_page_id);
+            auto bucket_page = bucket_guard.As<ExtendibleHTableBucketPage>();
+            if (!bucket_page->IsFull()) {
+                PageChangeLog changes(_log_manager, _index_oid);
+                changes.Track(bucket_guard);
+                const bool inserted = bucket_guard.AsMut<ExtendibleHTableBucketPage>()->Insert(key, _key_compare, rid);
+                changes.Append();
+                return inserted;
+            }
+            RID existing_rid;
+            if (bucket_page->Lookup(key, _key_compare, existing_rid)) {
+                return false;
+            }
+        }
     }
-    return false;
+
+    // the bucket should be created or split, latch the directory for write
+    WritePageGuard directory_guard = _pages_manager.GetPageWrite(directory_page_id);
+    // all pages of the split are logged by one record, they are latched until it's appended
+    PageChangeLog changes(_log_manager, _index_oid);
+    changes.Track(directory_guard);
+    auto directory_page = directory_guard.AsMut<ExtendibleHTableDirectoryPage>();
+    const uint32_t bucket_idx = directory_page->HashToBucketIndex(hash);
+    const bool inserted = InsertToNewBucket(directory_page, bucket_idx, key, rid, changes);
+    changes.Append();
+    return inserted;
 }
 
 bool ExtendibleHashTable::Remove(const char *key)
 {
-    // lock the whole tree now.
-    std::unique_lock lock(_mutex);
-
-    ReadPageGuard header_guard = _pages_manager.GetPageRead(_header_page_id);
-    auto header_page = header_guard.As<ExtendibleHTableHeaderPage>();
     const uint32_t hash = _key_hash(key);
-    const uint32_t directory_idx = header_page->HashToDirectoryIndex(hash);
-    const page_id_t directory_page_id = header_page->GetDirectoryPageId(directory_idx);
+    const page_id_t directory_page_id = FindDirectoryPageId(hash);
     if (directory_page_id == INVALID_PAGE_ID) {
         return false;
     }
 
+    {
+        // remove the item holding the directory latched for read
+        ReadPageGuard directory_guard = _pages_manager.GetPageRead(directory_page_id);
+        auto directory_page = directory_guard.As<ExtendibleHTableDirectoryPage>();
+        const uint32_t bucket_idx = directory_page->HashToBucketIndex(hash);
+        const page_id_t bucket_page_id = directory_page->GetBucketPageId(bucket_idx);
+        if (bucket_page_id == INVALID_PAGE_ID) {
+            return false;
+        }
+
+        WritePageGuard bucket_guard = _pages_manager.GetPageWrite(bucket_page_id);
+        PageChangeLog changes(_log_manager, _index_oid);
+        changes.Track(bucket_guard);
+        auto bucket_page = bucket_guard.AsMut<ExtendibleHTableBucketPage>();
+        if (!bucket_page->Remove(key, _key_compare)) {
+            return false;
+        }
+        changes.Append();
+
+        if (!bucket_page->IsEmpty()) {
+            return true;
+        }
+    }
+
+    /* the bucket became empty, latch the directory for write to merge the bucket.
+     The bucket might have been changed meanwhile, so check it again. */
     WritePageGuard directory_guard = _pages_manager.GetPageWrite(directory_page_id);
     auto directory_page = directory_guard.AsMut<ExtendibleHTableDirectoryPage>();
     const uint32_t bucket_idx = directory_page->HashToBucketIndex(hash);
     const page_id_t bucket_page_id = directory_page->GetBucketPageId(bucket_idx);
     if (bucket_page_id == INVALID_PAGE_ID) {
-        return false;
-    }
-
-    WritePageGuard bucket_guard = _pages_manager.GetPageWrite(bucket_page_id);
-    auto bucket_page = bucket_guard.AsMut<ExtendibleHTableBucketPage>();
-    if (!bucket_page->Remove(key, _key_compare)) {
-        return false;
+        return true;
     }
 
+    ReadPageGuard bucket_guard = _pages_manager.GetPageRead(bucket_page_id);
+    auto bucket_page = bucket_guard.As<ExtendibleHTableBucketPage>();
     if (bucket_page->IsEmpty()) {
         if (directory_page->GetGlobalDepth() > 0) {
+            PageChangeLog changes(_log_manager, _index_oid);
+            changes.Track(directory_guard);
             const uint32_t split_idx = directory_page->GetSplitImageIndex(bucket_idx);
             directory_page->DecrLocalDepth(split_idx);
             const page_id_t split_page_id = directory_page->GetBucketPageId(split_idx);
@@ -100,6 +161,7 @@ bool ExtendibleHashTable::Remove(const char *key)
             if (directory_page->CanShrink()) {
                 directory_page->DecrGlobalDepth();
             }
+            changes.Append();
         }
     }
 
@@ -108,16 +170,8 @@ bool ExtendibleHashTable::Remove(const char *key)
 
 bool ExtendibleHashTable::GetValue(const char* key, RID& rid) const
 {
-    // lock the whole tree now.
-    // TO DO: think about locking with page granularity
-    std::shared_lock lock(_mutex);
-
-    auto header_guard = _pages_manager.GetPageRead(_header_page_id);
-    auto header_page = header_guard.As<ExtendibleHTableHeaderPage>();
-
     const uint32_t hash = _key_hash(key);
-    const uint32_t directory_idx = header_page->HashToDirectoryIndex(hash);
-    const page_id_t directory_page_id = header_page->GetDirectoryPageId(directory_idx);
+    const page_id_t directory_page_id = FindDirectoryPageId(hash);
     if (directory_page_id == INVALID_PAGE_ID) {
         return false;
     }
@@ -131,11 +185,101 @@ bool ExtendibleHashTable::GetValue(const char* key, RID& rid) const
     }
 
     auto bucket_guard = _pages_manager.GetPageRead(bucket_page_id);
+    // the bucket is latched, so the directory is not needed anymore
+    directory_guard.Drop();
     auto bucket_page = bucket_guard.As<ExtendibleHTableBucketPage>();
 
     return bucket_page->Lookup(key, _key_compare, rid);
 }
 
+size_t ExtendibleHashTable::MultiGetValue(const char* keys, size_t count, RID rids[], bool found[]) const
+{
+    // the page of the probe is the directory page at first, then the bucket page
+    struct Probe
+    {
+        page_id_t page_id;
+        uint32_t hash;
+        size_t idx;
+    };
+
+    std::vector<Probe> probes(count);
+    {
+        // the directory page ids never change once they are written, the header is latched once
+        ReadPageGuard header_guard = _pages_manager.GetPageRead(_header_page_id);
+        auto header_page = header_guard.As<ExtendibleHTableHeaderPage>();
+        for (size_t i = 0; i < count; i++) {
+            const uint32_t hash = _key_hash(keys + i * _key_size);
+            probes[i] = {header_page->GetDirectoryPageId(header_page->HashToDirectoryIndex(hash)), hash, i};
+            found[i] = false;
+        }
+    }
+
+    auto by_page_id = [](const Probe& lhs, const Probe& rhs) { return lhs.page_id < rhs.page_id; };
+    // the end of the group of probes of the same page
+    auto group_end = [&probes](size_t begin, size_t end) {
+        size_t i = begin + 1;
+        while (i < end && probes[i].page_id == probes[begin].page_id) {
+            i++;
+        }
+        return i;
+    };
+
+    std::sort(probes.begin(), probes.end(), by_page_id);
+
+    size_t num_found = 0;
+    for (size_t dir_begin = 0; dir_begin < count; ) {
+        const size_t dir_end = group_end(dir_begin, count);
+        const page_id_t directory_page_id = probes[dir_begin].page_id;
+        if (directory_page_id == INVALID_PAGE_ID) {
+            dir_begin = dir_end;
+            continue;
+        }
+
+        // the directory is latched for read until all of its buckets are looked up
+        ReadPageGuard directory_guard = _pages_manager.GetPageRead(directory_page_id);
+        auto directory_page = directory_guard.As<ExtendibleHTableDirectoryPage>();
+        for (size_t i = dir_begin; i < dir_end; i++) {
+            probes[i].page_id = directory_page->GetBucketPageId(directory_page->HashToBucketIndex(probes[i].hash));
+        }
+        std::sort(probes.begin() + dir_begin, probes.begin() + dir_end, by_page_id);
+
+        size_t bucket_begin = dir_begin;
+        while (bucket_begin < dir_end && probes[bucket_begin].page_id == INVALID_PAGE_ID) {
+            bucket_begin++;
+        }
+        ReadPageGuard bucket_guard;
+        if (bucket_begin < dir_end) {
+            bucket_guard = _pages_manager.GetPageRead(probes[bucket_begin].page_id);
+        }
+
+        while (bucket_begin < dir_end) {
+            const size_t bucket_end = group_end(bucket_begin, dir_end);
+            // the next bucket is latched and its header is prefetched before the current one is looked up
+            ReadPageGuard next_bucket_guard;
+            if (bucket_end < dir_end) {
+                next_bucket_guard = _pages_manager.GetPageRead(probes[bucket_end].page_id);
+                PREFETCH(next_bucket_guard.GetData());
+            }
+
+            auto bucket_page = bucket_guard.As<ExtendibleHTableBucketPage>();
+            for (size_t i = bucket_begin; i < bucket_end; i++) {
+                const size_t idx = probes[i].idx;
+                if (bucket_page->Lookup(keys + idx * _key_size, _key_compare, rids[idx])) {
+                    found[idx] = true;
+                    num_found++;
+                }
+            }
+
+            bucket_guard = std::move(next_bucket_guard);
+            bucket_begin = bucket_end;
+        }
+
+        dir_begin = dir_end;
+    }
+
+    return num_found;
+}
+
 bool ExtendibleHashTable::VerifyIntegrity() const
 {
     assert(_header_page_id != INVALID_PAGE_ID);
@@ -156,48 +300,99 @@ bool ExtendibleHashTable::VerifyIntegrity() const
     return true;
 }
 
+void ExtendibleHashTable::GiveBackPages()
+{
+    if (_header_page_id == INVALID_PAGE_ID) {
+        return;
+    }
+
+    // the bucket page is referred by a number of directory slots
+    std::vector<page_id_t> pages{_header_page_id};
+    {
+        auto header_guard = _pages_manager.GetPageRead(_header_page_id);
+        auto header_page = header_guard.As<ExtendibleHTableHeaderPage>();
+        for (uint32_t i = 0; i < header_page->MaxSize(); i++) {
+            const page_id_t directory_page_id = header_page->GetDirectoryPageId(i);
+            if (directory_page_id == INVALID_PAGE_ID) {
+                continue;
+            }
+            pages.push_back(directory_page_id);
+            auto directory_guard = _pages_manager.GetPageRead(directory_page_id);
+            auto directory_page = directory_guard.As<ExtendibleHTableDirectoryPage>();
+            for (uint32_t j = 0; j < directory_page->Size(); j++) {
+                const page_id_t bucket_page_id = directory_page->GetBucketPageId(j);
+                if (bucket_page_id != INVALID_PAGE_ID) {
+                    pages.push_back(bucket_page_id);
+                }
+            }
+        }
+    }
+    std::sort(pages.begin(), pages.end());
+    pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+    for (const page_id_t page_id : pages) {
+        _pages_manager.GiveBackPage(page_id);
+    }
+    _header_page_id = INVALID_PAGE_ID;
+}
+
+page_id_t ExtendibleHashTable::FindDirectoryPageId(uint32_t hash) const
+{
+    // the directory page id never changes once it is written into the header
+    ReadPageGuard header_guard = _pages_manager.GetPageRead(_header_page_id);
+    auto header_page = header_guard.As<ExtendibleHTableHeaderPage>();
+    return header_page->GetDirectoryPageId(header_page->HashToDirectoryIndex(hash));
+}
 
-bool ExtendibleHashTable::InsertToNewDirectory(
-        ExtendibleHTableHeaderPage *header, uint32_t directory_idx, uint32_t hash, const char* key, const RID& rid)
+page_id_t ExtendibleHashTable::FindOrCreateDirectoryPageId(uint32_t hash)
 {
-    page_id_t directory_page_id = header->GetDirectoryPageId(directory_idx);
-    WritePageGuard directory_guard;
+    page_id_t directory_page_id = FindDirectoryPageId(hash);
+    if (directory_page_id != INVALID_PAGE_ID) {
+        return directory_page_id;
+    }
+
+    WritePageGuard header_guard = _pages_manager.GetPageWrite(_header_page_id);
+    auto header_page = header_guard.AsMut<ExtendibleHTableHeaderPage>();
+    const uint32_t directory_idx = header_page->HashToDirectoryIndex(hash);
+    // the directory might have been created by someone else meanwhile
+    directory_page_id = header_page->GetDirectoryPageId(directory_idx);
     if (directory_page_id == INVALID_PAGE_ID) {
-        PageGuard guard = _pages_manager.NextFreePageGuarded(&directory_page_id);
-        directory_guard = guard.UpgradeWrite();
-        auto directory_page = directory_guard.AsMut<ExtendibleHTableDirectoryPage>();
+        PageChangeLog changes(_log_manager, _index_oid);
+        changes.Track(header_guard);
+        WritePageGuard guard = _pages_manager.NextFreePageGuarded(&directory_page_id).UpgradeWrite();
+        assert(directory_page_id != INVALID_PAGE_ID);
+        auto directory_page = guard.AsMut<ExtendibleHTableDirectoryPage>();
         directory_page->Init(_directory_max_depth);
-        header->SetDirectoryPageId(directory_idx, directory_page_id);
-    } else {
-        directory_guard = _pages_manager.GetPageWrite(directory_page_id);
+        changes.TrackNew(std::move(guard));
+        header_page->SetDirectoryPageId(directory_idx, directory_page_id);
+        changes.Append();
     }
-
-    auto directory_page = directory_guard.AsMut<ExtendibleHTableDirectoryPage>();
-    const uint32_t bucket_idx = directory_page->HashToBucketIndex(hash);
-
-    return InsertToNewBucket(directory_page, bucket_idx, key, rid);
+    return directory_page_id;
 }
 
 bool ExtendibleHashTable::InsertToNewBucket(
-        ExtendibleHTableDirectoryPage *directory, uint32_t bucket_idx, const char* key, const RID& rid)
+        ExtendibleHTableDirectoryPage *directory, uint32_t bucket_idx, const char* key, const RID& rid,
+        PageChangeLog& changes)
 {
     page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
-    WritePageGuard bucket_guard;
+    ExtendibleHTableBucketPage* bucket_page = nullptr;
     if (bucket_page_id == INVALID_PAGE_ID) {
         PageGuard guard = _pages_manager.NextFreePageGuarded(&bucket_page_id);
-        bucket_guard = guard.UpgradeWrite();
-        auto bucket_page = bucket_guard.AsMut<ExtendibleHTableBucketPage>();
+        WritePageGuard bucket_guard = guard.UpgradeWrite();
+        bucket_page = bucket_guard.AsMut<ExtendibleHTableBucketPage>();
         if (_bucket_max_size == 0)
             bucket_page->Init(_key_size);
         else
             bucket_page->Init(_key_size, _bucket_max_size);
+        changes.TrackNew(std::move(bucket_guard));
         UpdateDirectoryMapping(directory, bucket_idx, bucket_page_id, 0);
     } else {
-        bucket_guard = _pages_manager.GetPageWrite(bucket_page_id);
+        WritePageGuard bucket_guard = _pages_manager.GetPageWrite(bucket_page_id);
+        bucket_page = bucket_guard.AsMut<ExtendibleHTableBucketPage>();
+        changes.Track(std::move(bucket_guard));
     }
 
-    auto bucket_page = bucket_guard.AsMut<ExtendibleHTableBucketPage>();
-    return InsertToBucket(bucket_page, directory, bucket_idx, key, rid);
+    return InsertToBucket(bucket_page, directory, bucket_idx, key, rid, changes);
 }
 
 void ExtendibleHashTable::UpdateDirectoryMapping(
@@ -209,7 +404,7 @@ void ExtendibleHashTable::UpdateDirectoryMapping(
 }
 
 bool ExtendibleHashTable::InsertToBucket(ExtendibleHTableBucketPage *bucket, ExtendibleHTableDirectoryPage *directory,
-                                        uint32_t bucket_idx, const char* key, const RID& rid)
+                                        uint32_t bucket_idx, const char* key, const RID& rid, PageChangeLog& changes)
 {
     if (bucket->Insert(key, _key_compare, rid)) {
         return true;
@@ -233,6 +428,8 @@ bool ExtendibleHashTable::InsertToBucket(ExtendibleHTableBucketPage *bucket, Ext
             split_page->Init(_key_size);
         else
             split_page->Init(_key_size, _bucket_max_size);
+        // the split page is latched by the change log until the whole insert is logged
+        changes.TrackNew(std::move(split_page_guard));
 
         directory->IncrLocalDepth(bucket_idx);
         const uint32_t split_page_idx = directory->GetSplitImageIndex(bucket_idx);
@@ -255,9 +452,9 @@ bool ExtendibleHashTable::InsertToBucket(ExtendibleHTableBucketPage *bucket, Ext
         const uint32_t hash = _key_hash(key);
         const uint32_t idx = directory->HashToBucketIndex(hash);
         if (idx == bucket_idx) {
-            return InsertToBucket(bucket, directory, bucket_idx, key, rid);
+            return InsertToBucket(bucket, directory, bucket_idx, key, rid, changes);
         } else {
-            return InsertToBucket(split_page, directory, split_page_idx, key, rid);
+            return InsertToBucket(split_page, directory, split_page_idx, key, rid, changes);
         }
 
     }
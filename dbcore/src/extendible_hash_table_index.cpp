@@ -7,8 +7,13 @@
 using namespace dbcore;
 
 ExtendibleHashTableIndex::ExtendibleHashTableIndex(PagesManager& pages_manager, const TupleCompare& key_compare, 
-                                                    const TupleHash& key_hash, uint32_t key_size)
-    : _hash_table(pages_manager, key_compare, key_hash, key_size)
+                                                    const TupleHash& key_hash, uint32_t key_size,
+                                                    page_id_t header_page_id /* = INVALID_PAGE_ID*/,
+                                                    LogManager* log_manager /* = nullptr*/,
+                                                    index_oid_t index_oid /* = INVALID_INDEX_OID*/)
+    : _key_compare(key_compare)
+    , _key_hash(key_hash)
+    , _hash_table(pages_manager, _key_compare, _key_hash, key_size, 0, 0, 0, header_page_id, log_manager, index_oid)
 {
 
 }
@@ -7,7 +7,7 @@ using namespace dbcore;
 void ExtendibleHTableDirectoryPage::Init(uint32_t max_depth)
 {
     assert(max_depth <= HTABLE_DIRECTORY_MAX_DEPTH);
-    _max_depth = max_depth;
+    _max_depth = max_depth > 0 ? max_depth : HTABLE_DIRECTORY_MAX_DEPTH;
     _global_depth = 0;
     for (size_t i = 0; i < HTABLE_DIRECTORY_ARRAY_SIZE; i++) {
         _local_depths[i] = 0;
@@ -0,0 +1,30 @@
+#include <dbcore/filter_executor.h>
+
+#include <cassert>
+
+using namespace dbcore;
+
+FilterExecutor::FilterExecutor(std::unique_ptr<AbstractExecutor> child, std::unique_ptr<VectorPredicate> predicate)
+    : _child(std::move(child))
+    , _predicate(std::move(predicate))
+{
+    assert(_child && _predicate);
+}
+
+void FilterExecutor::Init()
+{
+    _child->Init();
+}
+
+bool FilterExecutor::Next(std::vector<TupleView>& batch)
+{
+    batch.clear();
+    while (batch.empty()) {
+        if (!_child->Next(_child_batch)) {
+            return false;
+        }
+        _predicate->Evaluate(_child_batch, &_selection);
+        _selection.ForEachSelected([&](uint32_t row) { batch.push_back(_child_batch[row]); });
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#include <dbcore/free_space_map.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace dbcore;
+
+FreeSpaceMap::FreeSpaceMap()
+    : _buckets(FSM_NUM_BUCKETS)
+{
+}
+
+void FreeSpaceMap::Update(page_id_t page_id, uint32_t free_space)
+{
+    const uint32_t bucket = std::min(free_space / FSM_BUCKET_SIZE, FSM_NUM_BUCKETS - 1);
+
+    std::lock_guard lg(_mutex);
+    auto it = _pages.find(page_id);
+    if (it == _pages.end()) {
+        _pages.emplace(page_id, PageEntry{bucket, static_cast<uint32_t>(_buckets[bucket].size())});
+        _buckets[bucket].push_back(page_id);
+        return;
+    }
+
+    PageEntry& entry = it->second;
+    if (entry._bucket == bucket) {
+        return;
+    }
+
+    // the page is moved from its bucket, the last page of the bucket takes its place
+    std::vector<page_id_t>& prev_bucket = _buckets[entry._bucket];
+    assert(prev_bucket[entry._index] == page_id);
+    const page_id_t moved_page_id = prev_bucket.back();
+    prev_bucket[entry._index] = moved_page_id;
+    _pages[moved_page_id]._index = entry._index;
+    prev_bucket.pop_back();
+
+    entry = PageEntry{bucket, static_cast<uint32_t>(_buckets[bucket].size())};
+    _buckets[bucket].push_back(page_id);
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t size, size_t hint) const
+{
+    // the smallest bucket which guarantees the free space for the tuple
+    const uint32_t min_bucket = (size + FSM_BUCKET_SIZE - 1) / FSM_BUCKET_SIZE;
+
+    std::lock_guard lg(_mutex);
+    for (uint32_t bucket = min_bucket; bucket < FSM_NUM_BUCKETS; bucket++) {
+        const std::vector<page_id_t>& pages = _buckets[bucket];
+        if (!pages.empty()) {
+            return pages[hint % pages.size()];
+        }
+    }
+    return INVALID_PAGE_ID;
+}
+
+size_t FreeSpaceMap::GetNumPages() const
+{
+    std::lock_guard lg(_mutex);
+    return _pages.size();
+}
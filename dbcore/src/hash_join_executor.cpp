@@ -0,0 +1,261 @@
+#include <dbcore/hash_join_executor.h>
+#include <dbcore/executor_context.h>
+#include <dbcore/hash.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace dbcore;
+
+namespace
+{
+
+Schema MakeKeySchema(const Schema& schema, const uint32_t key_attrs[], uint32_t num_keys)
+{
+    std::array<uint32_t, MAX_COLUMN_COUNT> attrs;
+    std::copy(key_attrs, key_attrs + num_keys, attrs.begin());
+    return Schema::CopySchema(schema, attrs.data(), num_keys);
+}
+
+}
+
+HashJoinExecutor::HashJoinExecutor(ExecutorContext& context, std::unique_ptr<AbstractExecutor> build,
+                                   std::unique_ptr<AbstractExecutor> probe, const uint32_t build_key_attrs[],
+                                   const uint32_t probe_key_attrs[], uint32_t num_keys,
+                                   size_t memory_budget /* = DEFAULT_MEMORY_BUDGET*/)
+    : _context(context)
+    , _build(std::move(build))
+    , _probe(std::move(probe))
+    , _build_encoder(MakeKeySchema(_build->GetOutputSchema(), build_key_attrs, num_keys))
+    , _probe_encoder(MakeKeySchema(_probe->GetOutputSchema(), probe_key_attrs, num_keys))
+    , _memory_budget(memory_budget)
+    , _table(_build_encoder.GetKeySize())
+    , _row_builder(_build->GetOutputSchema(), _probe->GetOutputSchema())
+{
+    assert(IsSupported(_build->GetOutputSchema(), build_key_attrs, _probe->GetOutputSchema(), probe_key_attrs, num_keys));
+    std::copy(build_key_attrs, build_key_attrs + num_keys, _build_key_attrs.begin());
+    std::copy(probe_key_attrs, probe_key_attrs + num_keys, _probe_key_attrs.begin());
+    for (uint32_t i = 0; i < num_keys; i++) {
+        if (_build->GetOutputSchema().GetColumnAt(build_key_attrs[i]).GetType() == TypeId::VARCHAR) {
+            _build_varchar_attrs[_num_varchar_keys] = build_key_attrs[i];
+            _probe_varchar_attrs[_num_varchar_keys] = probe_key_attrs[i];
+            _num_varchar_keys++;
+        }
+    }
+}
+
+bool HashJoinExecutor::IsSupported(const Schema& build_schema, const uint32_t build_key_attrs[],
+                                   const Schema& probe_schema, const uint32_t probe_key_attrs[], uint32_t num_keys)
+{
+    if (num_keys == 0 || num_keys > MAX_COLUMN_COUNT
+        || build_schema.GetColumnCount() + probe_schema.GetColumnCount() > MAX_COLUMN_COUNT) {
+        return false;
+    }
+    for (uint32_t i = 0; i < num_keys; i++) {
+        if (build_key_attrs[i] >= build_schema.GetColumnCount() || probe_key_attrs[i] >= probe_schema.GetColumnCount()) {
+            return false;
+        }
+        const Column& build_column = build_schema.GetColumnAt(build_key_attrs[i]);
+        const Column& probe_column = probe_schema.GetColumnAt(probe_key_attrs[i]);
+        if (build_column.GetType() != probe_column.GetType()
+            || build_column.GetStorageSize() != probe_column.GetStorageSize()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HashJoinExecutor::Init()
+{
+    _probe_page_guard.Drop();
+    _build_spills.clear();
+    _probe_spills.clear();
+    _has_partition = false;
+    _table.Clear();
+
+    _failed = !BuildSide();
+    _probe->Init();
+    if (!_failed && IsSpilled()) {
+        _failed = !SpillProbeSide();
+    }
+    if (_failed) {
+        // the pages of the spills are given back, the join produces nothing
+        _build_spills.clear();
+        _probe_spills.clear();
+        _table.Clear();
+        return;
+    }
+    if (!IsSpilled()) {
+        _table.Build();
+    }
+}
+
+bool HashJoinExecutor::Next(std::vector<TupleView>& batch)
+{
+    batch.clear();
+    _row_builder.Clear();
+    if (_failed || _build->HasFailed()) {
+        return false;
+    }
+    while (_row_builder.GetNumRows() == 0) {
+        if (!IsSpilled()) {
+            if (!_probe->Next(_child_batch)) {
+                return false;
+            }
+            ProbeBatch(_child_batch);
+        } else if (_has_partition && _probe_page < _probe_spills[_partition].GetNumPages()) {
+            _probe_spills[_partition].ReadPage(_probe_page++, _probe_page_guard, _child_batch);
+            ProbeBatch(_child_batch);
+        } else if (!NextPartition()) {
+            return false;
+        }
+    }
+    _row_builder.GetRows(batch);
+    return true;
+}
+
+bool HashJoinExecutor::BuildSide()
+{
+    const Schema& schema = _build->GetOutputSchema();
+    PagesManager* pages_manager = _context.GetPagesManager();
+    std::vector<char> key(_build_encoder.GetKeySize());
+
+    _build->Init();
+    while (_build->Next(_child_batch)) {
+        for (const TupleView& row : _child_batch) {
+            _build_encoder.Encode(row.GetData(), schema, _build_key_attrs.data(), key.data());
+            const uint32_t hash = HashKey(key.data());
+            if (!IsSpilled()) {
+                _table.Insert(row, key.data(), hash);
+            } else if (!_build_spills[GracePartition(hash)].Append(row)) {
+                return false;
+            }
+        }
+        if (!IsSpilled() && pages_manager != nullptr && _table.GetMemoryUsage() > _memory_budget && !Spill()) {
+            return false;
+        }
+    }
+    for (RowSpill& spill : _build_spills) {
+        if (!spill.Finish()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HashJoinExecutor::Spill()
+{
+    PagesManager* pages_manager = _context.GetPagesManager();
+    for (uint32_t p = 0; p < (1u << GRACE_PARTITION_BITS); p++) {
+        _build_spills.emplace_back(*pages_manager);
+        _probe_spills.emplace_back(*pages_manager);
+    }
+    for (size_t i = 0; i < _table.GetNumRows(); i++) {
+        if (!_build_spills[GracePartition(_table.GetHash(i))].Append(_table.GetRow(i))) {
+            return false;
+        }
+    }
+    _table.Clear();
+    return true;
+}
+
+bool HashJoinExecutor::SpillProbeSide()
+{
+    const Schema& schema = _probe->GetOutputSchema();
+    std::vector<char> key(_probe_encoder.GetKeySize());
+    while (_probe->Next(_child_batch)) {
+        for (const TupleView& row : _child_batch) {
+            _probe_encoder.Encode(row.GetData(), schema, _probe_key_attrs.data(), key.data());
+            if (!_probe_spills[GracePartition(HashKey(key.data()))].Append(row)) {
+                return false;
+            }
+        }
+    }
+    for (RowSpill& spill : _probe_spills) {
+        if (!spill.Finish()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HashJoinExecutor::ProbeBatch(const std::vector<TupleView>& rows)
+{
+    const Schema& schema = _probe->GetOutputSchema();
+    const Schema& build_schema = _build->GetOutputSchema();
+    const uint32_t key_size = _probe_encoder.GetKeySize();
+    _probe_keys.resize(rows.size() * key_size);
+    _probe_hashes.resize(rows.size());
+
+    // the slots of the whole batch are prefetched before the first one is probed
+    for (size_t i = 0; i < rows.size(); i++) {
+        char* key = _probe_keys.data() + i * key_size;
+        _probe_encoder.Encode(rows[i].GetData(), schema, _probe_key_attrs.data(), key);
+        _probe_hashes[i] = HashKey(key);
+        _table.Prefetch(_probe_hashes[i]);
+    }
+    for (size_t i = 0; i < rows.size(); i++) {
+        _table.Probe(_probe_keys.data() + i * key_size, _probe_hashes[i], [&](const TupleView& build_row) {
+            // the normalized keys are equal, the VARCHAR values may still differ beyond their prefixes
+            if (_num_varchar_keys == 0
+                || Tuple::CompareKeys(build_row.GetData(), build_schema, _build_varchar_attrs.data(), rows[i].GetData(),
+                                      schema, _probe_varchar_attrs.data(), _num_varchar_keys) == 0) {
+                _row_builder.Append(build_row, rows[i]);
+            }
+        });
+    }
+}
+
+bool HashJoinExecutor::NextPartition()
+{
+    _probe_page_guard.Drop();
+    uint32_t partition = 0;
+    if (_has_partition) {
+        // the pages of the joined partition are given back
+        _build_spills[_partition].Clear();
+        _probe_spills[_partition].Clear();
+        partition = _partition + 1;
+    }
+    _has_partition = false;
+    _table.Clear();
+
+    // the partitions which have no rows on either side produce nothing
+    const uint32_t num_partitions = static_cast<uint32_t>(_build_spills.size());
+    while (partition < num_partitions
+           && (_build_spills[partition].GetNumRows() == 0 || _probe_spills[partition].GetNumRows() == 0)) {
+        partition++;
+    }
+    if (partition == num_partitions) {
+        return false;
+    }
+
+    const Schema& schema = _build->GetOutputSchema();
+    std::vector<char> key(_build_encoder.GetKeySize());
+    ReadPageGuard page_guard;
+    const RowSpill& spill = _build_spills[partition];
+    for (size_t page = 0; page < spill.GetNumPages(); page++) {
+        spill.ReadPage(page, page_guard, _child_batch);
+        for (const TupleView& row : _child_batch) {
+            _build_encoder.Encode(row.GetData(), schema, _build_key_attrs.data(), key.data());
+            _table.Insert(row, key.data(), HashKey(key.data()));
+        }
+    }
+    _table.Build();
+
+    _partition = partition;
+    _has_partition = true;
+    _probe_page = 0;
+    return true;
+}
+
+uint32_t HashJoinExecutor::HashKey(const char* key) const
+{
+    // the finalizer mixes the bits, both the high (partition) and the low (slot) ones are used
+    uint32_t hash = FNV_hash(key, _build_encoder.GetKeySize());
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    return hash;
+}
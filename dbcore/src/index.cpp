@@ -2,13 +2,20 @@
 #include <dbcore/b_plus_tree_index.h>
 #include <dbcore/extendible_hash_table_index.h>
 #include <dbcore/tuple.h>
+#include <dbcore/tuple_view.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_iterator.h>
 #include <dbcore/tuple_compare.h>
 #include <dbcore/tuple_hash.h>
 #include <dbcore/hash.h>
+#include <dbcore/row_spill.h>
 
 #include <cassert>
 #include <algorithm>
 #include <iterator>
+#include <optional>
+#include <thread>
+#include <vector>
 
 using namespace dbcore;
 
@@ -24,16 +31,19 @@ IndexMetadata::IndexMetadata(uint32_t key_attrs[], uint32_t key_attrs_count,
 }
 
 
-Index::Index(IndexType type, const IndexMetadata& metadata, PagesManager& pages_manager)
+Index::Index(IndexType type, const IndexMetadata& metadata, PagesManager& pages_manager,
+            LogManager* log_manager /* = nullptr*/, index_oid_t index_oid /* = INVALID_INDEX_OID*/,
+            page_id_t root_page_id /* = INVALID_PAGE_ID*/)
     : _type(type)
     , _metadata(metadata)
+    , _log_manager(log_manager)
+    , _index_oid(index_oid)
 {
     switch (_type)
     {
     case IndexType::BPlusTreeIndex: {
-        TupleCompare tuple_compare{_metadata.GetKeySchema()};
         _pimpl = static_cast<BPlusTreeIndex *>(::malloc(sizeof(BPlusTreeIndex)));
-        new(_pimpl)BPlusTreeIndex(pages_manager, tuple_compare, _metadata.GetKeySchema().GetInlinedStorageSize());
+        new(_pimpl)BPlusTreeIndex(pages_manager, _metadata.GetKeySchema(), root_page_id, _log_manager, _index_oid);
         break;
     }
     case IndexType::HashTableIndex: {
@@ -41,7 +51,9 @@ Index::Index(IndexType type, const IndexMetadata& metadata, PagesManager& pages_
         // TO DO: give ability to choose hash-function. 
         TupleHash tuple_hash{_metadata.GetKeySchema(), dummy_hash};
         _pimpl = static_cast<ExtendibleHashTableIndex *>(::malloc(sizeof(ExtendibleHashTableIndex)));
-        new(_pimpl)ExtendibleHashTableIndex(pages_manager, tuple_compare, tuple_hash, _metadata.GetKeySchema().GetInlinedStorageSize());
+        new(_pimpl)ExtendibleHashTableIndex(pages_manager, tuple_compare, tuple_hash, 
+                                            _metadata.GetKeySchema().GetInlinedStorageSize(), root_page_id,
+                                            _log_manager, _index_oid);
         break;
     }
     default:
@@ -79,51 +91,49 @@ bool Index::InsertEntry(const Tuple& tuple, const RID& rid)
 {
     assert(_pimpl);
 
+    const Tuple key{tuple.KeyFromTuple(_metadata.GetTableSchema(), _metadata.GetKeySchema(),
+                    _metadata.GetKeyAttributes(), _metadata.GetKeyAttrCount())};
+    bool inserted = false;
     switch (_type)
     {
     case IndexType::BPlusTreeIndex: {
         BPlusTreeIndex *index_impl = static_cast<BPlusTreeIndex *>(_pimpl);
-        const Tuple key{tuple.KeyFromTuple(_metadata.GetTableSchema(), _metadata.GetKeySchema(),
-                        _metadata.GetKeyAttributes(), _metadata.GetKeyAttrCount())};
-        return index_impl->InsertEntry(key, rid);
+        inserted = index_impl->InsertEntry(key, rid);
+        break;
     }
     case IndexType::HashTableIndex: {
         ExtendibleHashTableIndex *index_impl = static_cast<ExtendibleHashTableIndex *>(_pimpl);
-        const Tuple key{tuple.KeyFromTuple(_metadata.GetTableSchema(), _metadata.GetKeySchema(),
-                        _metadata.GetKeyAttributes(), _metadata.GetKeyAttrCount())};
-        return index_impl->InsertEntry(key, rid);
+        inserted = index_impl->InsertEntry(key, rid);
+        break;
     }    
     default:
         assert(false); // not implemented or not supported
     }
 
-    return false;
+    return inserted;
 }
 
 void Index::DeleteEntry(const Tuple& tuple)
 {
     assert(_pimpl);
 
+    const Tuple key{tuple.KeyFromTuple(_metadata.GetTableSchema(), _metadata.GetKeySchema(),
+                    _metadata.GetKeyAttributes(), _metadata.GetKeyAttrCount())};
     switch (_type)
     {
     case IndexType::BPlusTreeIndex: {
         BPlusTreeIndex *index_impl = static_cast<BPlusTreeIndex *>(_pimpl);
-        const Tuple key{tuple.KeyFromTuple(_metadata.GetTableSchema(), _metadata.GetKeySchema(),
-                        _metadata.GetKeyAttributes(), _metadata.GetKeyAttrCount())};        
         index_impl->DeleteEntry(key);
         break;
     }
     case IndexType::HashTableIndex: {
         ExtendibleHashTableIndex *index_impl = static_cast<ExtendibleHashTableIndex *>(_pimpl);
-        const Tuple key{tuple.KeyFromTuple(_metadata.GetTableSchema(), _metadata.GetKeySchema(),
-                        _metadata.GetKeyAttributes(), _metadata.GetKeyAttrCount())};        
         index_impl->DeleteEntry(key);
         break;
     }    
     default:
         assert(false); // not implemented or not supported
     }
-
 }
 
 bool Index::SearchEntry(const Tuple& tuple, RID* result) const
@@ -150,3 +160,237 @@ bool Index::SearchEntry(const Tuple& tuple, RID* result) const
 
     return false;
 }
+
+uint32_t Index::GetSearchKeySize() const
+{
+    assert(_pimpl);
+
+    switch (_type)
+    {
+    case IndexType::BPlusTreeIndex:
+        return static_cast<const BPlusTreeIndex *>(_pimpl)->GetKeySize();
+    case IndexType::HashTableIndex:
+        return _metadata.GetKeySchema().GetInlinedStorageSize();
+    default:
+        assert(false); // not implemented or not supported
+    }
+
+    return 0;
+}
+
+void Index::MakeSearchKey(const TupleView& tuple, const Schema& tuple_schema, const uint32_t key_attrs[], char* key) const
+{
+    assert(_pimpl);
+
+    switch (_type)
+    {
+    case IndexType::BPlusTreeIndex: {
+        // the tree keeps the normalized keys, they are encoded without building the key tuple
+        const BPlusTreeIndex *index_impl = static_cast<const BPlusTreeIndex *>(_pimpl);
+        index_impl->EncodeKey(tuple, tuple_schema, key_attrs, key);
+        break;
+    }
+    case IndexType::HashTableIndex:
+        Tuple::KeyFromTuple(tuple.GetData(), tuple_schema, _metadata.GetKeySchema(),
+                            key_attrs, _metadata.GetKeyAttrCount(), key);
+        break;
+    default:
+        assert(false); // not implemented or not supported
+    }
+}
+
+bool Index::IsSearchKeySupported(const Schema& tuple_schema, const uint32_t key_attrs[], uint32_t key_attr_count) const
+{
+    const Schema& key_schema = _metadata.GetKeySchema();
+    if (key_attr_count != _metadata.GetKeyAttrCount()) {
+        return false;
+    }
+    for (uint32_t i = 0; i < key_attr_count; i++) {
+        if (key_attrs[i] >= tuple_schema.GetColumnCount()) {
+            return false;
+        }
+        const Column& column = tuple_schema.GetColumnAt(key_attrs[i]);
+        const Column& key_column = key_schema.GetColumnAt(i);
+        if (column.GetType() != key_column.GetType() || column.GetStorageSize() != key_column.GetStorageSize()) {
+            return false;
+        }
+        // the hash table keeps the key tuples, only their inlined part is hashed
+        if (_type == IndexType::HashTableIndex && !column.IsInlined()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t Index::MultiSearchEntry(const char* keys, size_t count, RID rids[], bool found[]) const
+{
+    assert(_pimpl);
+
+    switch (_type)
+    {
+    case IndexType::BPlusTreeIndex:
+        return static_cast<const BPlusTreeIndex *>(_pimpl)->MultiSearchEntry(keys, count, rids, found);
+    case IndexType::HashTableIndex:
+        return static_cast<const ExtendibleHashTableIndex *>(_pimpl)->MultiSearchEntry(keys, count, rids, found);
+    default:
+        assert(false); // not implemented or not supported
+    }
+
+    return 0;
+}
+
+page_id_t Index::GetRootPageId() const
+{
+    assert(_pimpl);
+
+    switch (_type)
+    {
+    case IndexType::BPlusTreeIndex:
+        return static_cast<const BPlusTreeIndex *>(_pimpl)->GetRootPageId();
+    case IndexType::HashTableIndex:
+        return static_cast<const ExtendibleHashTableIndex *>(_pimpl)->GetHeaderPageId();
+    default:
+        assert(false); // not implemented or not supported
+    }
+
+    return INVALID_PAGE_ID;
+}
+
+void Index::GiveBackPages()
+{
+    assert(_pimpl);
+
+    switch (_type)
+    {
+    case IndexType::BPlusTreeIndex:
+        static_cast<BPlusTreeIndex *>(_pimpl)->GiveBackPages();
+        break;
+    case IndexType::HashTableIndex:
+        static_cast<ExtendibleHashTableIndex *>(_pimpl)->GiveBackPages();
+        break;
+    default:
+        assert(false); // not implemented or not supported
+    }
+}
+
+IndexIterator Index::ScanRange(const Tuple* lo, bool lo_inclusive, const Tuple* hi, bool hi_inclusive) const
+{
+    assert(_pimpl);
+
+    switch (_type)
+    {
+    case IndexType::BPlusTreeIndex: {
+        const BPlusTreeIndex *index_impl = static_cast<const BPlusTreeIndex *>(_pimpl);
+        std::optional<Tuple> lo_key, hi_key;
+        if (lo) {
+            lo_key.emplace(lo->KeyFromTuple(_metadata.GetTableSchema(), _metadata.GetKeySchema(),
+                            _metadata.GetKeyAttributes(), _metadata.GetKeyAttrCount()));
+        }
+        if (hi) {
+            hi_key.emplace(hi->KeyFromTuple(_metadata.GetTableSchema(), _metadata.GetKeySchema(),
+                            _metadata.GetKeyAttributes(), _metadata.GetKeyAttrCount()));
+        }
+        return index_impl->ScanRange(lo_key ? &*lo_key : nullptr, lo_inclusive,
+                                    hi_key ? &*hi_key : nullptr, hi_inclusive);
+    }
+    case IndexType::HashTableIndex:
+        // the hash index is not ordered
+        return IndexIterator{};
+    default:
+        assert(false); // not implemented or not supported
+    }
+
+    return IndexIterator{};
+}
+
+bool Index::Populate(TableHeap& table_heap, uint32_t num_threads, size_t memory_budget)
+{
+    assert(_pimpl);
+    assert(num_threads > 0);
+
+    const Schema& tbl_schema = _metadata.GetTableSchema();
+    const Schema& key_schema = _metadata.GetKeySchema();
+
+    std::vector<TableIterator> partitions = table_heap.MakePartitionedIterators(num_threads);
+    const size_t num_partitions = partitions.size();
+
+    // scan each partition in its own thread, the first one is scanned by the calling thread
+    auto scan_partitions = [num_partitions](auto&& scan_partition) {
+        std::vector<std::thread> threads;
+        threads.reserve(num_partitions - 1);
+        for (size_t i = 1; i < num_partitions; i++) {
+            threads.emplace_back(scan_partition, i);
+        }
+        scan_partition(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    switch (_type)
+    {
+    case IndexType::BPlusTreeIndex: {
+        // one pass over the table, the keys are encoded right from the tuples on the pages.
+        // each partition spills its sorted runs when its share of the memory budget is exceeded,
+        // the runs are merged and the tree is built from the merged keys
+        BPlusTreeIndex *index_impl = static_cast<BPlusTreeIndex *>(_pimpl);
+        const uint32_t key_size = index_impl->GetKeySize();
+        const size_t partition_budget = std::max<size_t>(1, memory_budget / num_partitions);
+        std::vector<std::vector<RowSpill>> runs(num_partitions);
+        std::vector<uint8_t> all_spilled(num_partitions, 1);
+        scan_partitions([&](size_t i) {
+            std::vector<char> keys;
+            std::vector<RID> rids;
+            TableIterator& itr = partitions[i];
+            while (!itr.IsEnd()) {
+                const auto [_, tuple] = itr.GetTupleView();
+                keys.resize(keys.size() + key_size);
+                index_impl->EncodeKey(tuple, tbl_schema, _metadata.GetKeyAttributes().data(),
+                                    keys.data() + keys.size() - key_size);
+                rids.push_back(itr.GetRID());
+                itr.Next();
+                if (keys.size() + rids.size() * (sizeof(RID) + sizeof(size_t)) >= partition_budget
+                    && !index_impl->SpillRun(keys, rids, runs[i])) {
+                    all_spilled[i] = 0;
+                    return;
+                }
+            }
+            if (!rids.empty() && !index_impl->SpillRun(keys, rids, runs[i])) {
+                all_spilled[i] = 0;
+            }
+        });
+        if (std::any_of(all_spilled.cbegin(), all_spilled.cend(), [](uint8_t v) { return v == 0; })) {
+            return false;
+        }
+
+        // the runs of the earlier partitions go first, so the first entry of the duplicated key is indexed
+        std::vector<RowSpill> all_runs;
+        for (auto& partition_runs : runs) {
+            std::move(partition_runs.begin(), partition_runs.end(), std::back_inserter(all_runs));
+        }
+        return index_impl->BulkLoad(all_runs);
+    }
+    case IndexType::HashTableIndex: {
+        // the hash table latches its pages, so the partitions are inserted concurrently
+        ExtendibleHashTableIndex *index_impl = static_cast<ExtendibleHashTableIndex *>(_pimpl);
+        std::vector<uint8_t> all_inserted(num_partitions, 1);
+        scan_partitions([&](size_t i) {
+            TableIterator& itr = partitions[i];
+            while (!itr.IsEnd()) {
+                const auto [_, tuple] = itr.GetTupleView();
+                const Tuple key{tuple.KeyFromTuple(tbl_schema, key_schema,
+                                _metadata.GetKeyAttributes(), _metadata.GetKeyAttrCount())};
+                if (!index_impl->InsertEntry(key, itr.GetRID())) {
+                    all_inserted[i] = 0;
+                }
+                itr.Next();
+            }
+        });
+        return std::all_of(all_inserted.cbegin(), all_inserted.cend(), [](uint8_t v) { return v != 0; });
+    }
+    default:
+        assert(false); // not implemented or not supported
+    }
+
+    return false;
+}
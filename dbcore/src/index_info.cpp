@@ -14,7 +14,7 @@ IndexInfo::IndexInfo(const Schema& schema, const char* name,
     , _index_oid(index_oid)
 {
     ::memset(_name, 0, sizeof(_name));
-    ::strncpy(_name, _name, MAX_INDEX_NAME_SIZE);
+    ::strncpy(_name, name, MAX_INDEX_NAME_SIZE);
 
     ::memset(_table_name, 0, sizeof(_table_name));
     ::strncpy(_table_name, table_name, MAX_TABLE_NAME_SIZE);   
@@ -0,0 +1,70 @@
+#include <dbcore/index_iterator.h>
+
+#include <cassert>
+#include <cstring>
+
+using namespace dbcore;
+
+IndexIterator::IndexIterator(BPlusTree::Iterator&& itr, const char* hi_key, uint32_t key_size, bool hi_inclusive)
+    : _itr(std::move(itr))
+    , _key_size(key_size)
+    , _has_hi_key(hi_key != nullptr)
+    , _hi_inclusive(hi_inclusive)
+{
+    assert(key_size <= MAX_NORMALIZED_KEY_SIZE);
+    if (_has_hi_key) {
+        ::memcpy(_hi_key.data(), hi_key, key_size);
+    }
+    CheckUpperBound();
+}
+
+bool IndexIterator::IsEnd() const
+{
+    return !_itr.has_value();
+}
+
+RID IndexIterator::operator*() const
+{
+    assert(_itr.has_value());
+    return **_itr;
+}
+
+IndexIterator& IndexIterator::operator++()
+{
+    if (_itr.has_value()) {
+        ++(*_itr);
+        CheckUpperBound();
+    }
+    return *this;
+}
+
+size_t IndexIterator::Next(RID rids[], size_t max_count)
+{
+    size_t count = 0;
+    while (count < max_count && _itr.has_value()) {
+        rids[count++] = **_itr;
+        ++(*_itr);
+        CheckUpperBound();
+    }
+    return count;
+}
+
+void IndexIterator::CheckUpperBound()
+{
+    if (!_itr.has_value()) {
+        return;
+    }
+
+    if (_itr->IsEnd()) {
+        _itr.reset();
+        return;
+    }
+
+    if (_has_hi_key) {
+        const int result = ::memcmp(_itr->GetKey(), _hi_key.data(), _key_size);
+        if (result > 0 || (result == 0 && !_hi_inclusive)) {
+            // release the latch of the leaf as soon as the range is over
+            _itr.reset();
+        }
+    }
+}
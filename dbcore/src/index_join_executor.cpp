@@ -0,0 +1,105 @@
+#include <dbcore/index_join_executor.h>
+#include <dbcore/executor_context.h>
+#include <dbcore/index.h>
+#include <dbcore/index_info.h>
+#include <dbcore/page_guard.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_info.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace dbcore;
+
+namespace
+{
+
+TableInfo* GetIndexTable(ExecutorContext& context, index_oid_t index_oid)
+{
+    IndexInfo* index_info = context.GetCatalog().GetIndex(index_oid);
+    assert(index_info != nullptr);
+    TableInfo* table_info = context.GetCatalog().GetTable(index_info->GetTableName());
+    assert(table_info != nullptr);
+    return table_info;
+}
+
+}
+
+IndexJoinExecutor::IndexJoinExecutor(ExecutorContext& context, std::unique_ptr<AbstractExecutor> outer, index_oid_t index_oid,
+                                     const uint32_t outer_key_attrs[], uint32_t num_keys)
+    : _outer(std::move(outer))
+    , _index_info(context.GetCatalog().GetIndex(index_oid))
+    , _table_info(GetIndexTable(context, index_oid))
+    , _row_builder(_outer->GetOutputSchema(), _table_info->GetSchema())
+{
+    const Index* index = _index_info->GetIndex();
+    assert(index->IsSearchKeySupported(_outer->GetOutputSchema(), outer_key_attrs, num_keys));
+    std::copy(outer_key_attrs, outer_key_attrs + num_keys, _key_attrs.begin());
+    _key_size = index->GetSearchKeySize();
+    const IndexMetadata& metadata = index->GetMetadata();
+    for (uint32_t i = 0; i < num_keys; i++) {
+        if (metadata.GetKeySchema().GetColumnAt(i).GetType() == TypeId::VARCHAR) {
+            _outer_varchar_attrs[_num_varchar_keys] = outer_key_attrs[i];
+            _table_varchar_attrs[_num_varchar_keys] = metadata.GetKeyAttributes()[i];
+            _num_varchar_keys++;
+        }
+    }
+}
+
+void IndexJoinExecutor::Init()
+{
+    _outer->Init();
+}
+
+bool IndexJoinExecutor::Next(std::vector<TupleView>& batch)
+{
+    batch.clear();
+    _row_builder.Clear();
+    while (_row_builder.GetNumRows() == 0) {
+        if (!_outer->Next(_outer_batch)) {
+            return false;
+        }
+        ProbeBatch(_outer_batch);
+    }
+    _row_builder.GetRows(batch);
+    return true;
+}
+
+void IndexJoinExecutor::ProbeBatch(const std::vector<TupleView>& rows)
+{
+    const Index* index = _index_info->GetIndex();
+    const Schema& schema = _outer->GetOutputSchema();
+    const size_t num_rows = rows.size();
+    _keys.resize(num_rows * _key_size);
+    _rids.resize(num_rows);
+    if (_found_capacity < num_rows) {
+        _found = std::make_unique<bool[]>(num_rows);
+        _found_capacity = num_rows;
+    }
+
+    for (size_t i = 0; i < num_rows; i++) {
+        index->MakeSearchKey(rows[i], schema, _key_attrs.data(), _keys.data() + i * _key_size);
+    }
+    if (index->MultiSearchEntry(_keys.data(), num_rows, _rids.data(), _found.get()) == 0) {
+        return;
+    }
+
+    // the joined row is made while the table row is latched, so it isn't copied twice
+    const TableHeap* table_heap = _table_info->GetTableHeap();
+    ReadPageGuard page_guard;
+    for (size_t i = 0; i < num_rows; i++) {
+        if (!_found[i]) {
+            continue;
+        }
+        const auto [meta, view] = table_heap->GetTupleView(_rids[i], page_guard);
+        if (view.GetData() == nullptr) {
+            continue;
+        }
+        // the search keys are equal, the VARCHAR values may still differ beyond their prefixes
+        if (_num_varchar_keys == 0
+            || Tuple::CompareKeys(rows[i].GetData(), schema, _outer_varchar_attrs.data(), view.GetData(),
+                                  _table_info->GetSchema(), _table_varchar_attrs.data(), _num_varchar_keys) == 0) {
+            _row_builder.Append(rows[i], view);
+        }
+    }
+}
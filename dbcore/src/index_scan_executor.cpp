@@ -0,0 +1,117 @@
+#include <dbcore/index_scan_executor.h>
+#include <dbcore/executor_context.h>
+#include <dbcore/index.h>
+#include <dbcore/index_info.h>
+#include <dbcore/page_guard.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_info.h>
+
+#include <cassert>
+
+using namespace dbcore;
+
+IndexScanExecutor::IndexScanExecutor(ExecutorContext& context, index_oid_t index_oid,
+                                     const Tuple* lo, bool lo_inclusive, const Tuple* hi, bool hi_inclusive)
+    : _index_info(context.GetCatalog().GetIndex(index_oid))
+    , _lo_inclusive(lo_inclusive)
+    , _hi_inclusive(hi_inclusive)
+{
+    assert(_index_info != nullptr);
+    _table_info = context.GetCatalog().GetTable(_index_info->GetTableName());
+    assert(_table_info != nullptr);
+    if (lo != nullptr) {
+        _lo.emplace(*lo);
+    }
+    if (hi != nullptr) {
+        _hi.emplace(*hi);
+    }
+    _rids.resize(BATCH_SIZE);
+    _recheck = _index_info->GetIndex()->GetMetadata().GetKeySchema().GetUninlinedColumnCount() > 0;
+}
+
+IndexScanExecutor::IndexScanExecutor(ExecutorContext& context, index_oid_t index_oid, const Tuple& key)
+    : IndexScanExecutor(context, index_oid, &key, true, &key, true)
+{
+    _is_lookup = true;
+}
+
+void IndexScanExecutor::Init()
+{
+    _done = false;
+    if (!_is_lookup) {
+        // the previous iterator releases its leaf before the new one latches the first leaf
+        _itr.reset();
+        // the keys which equal to the exclusive bound by the prefix may be within the range by the full value
+        _itr.emplace(_index_info->GetIndex()->ScanRange(_lo ? &*_lo : nullptr, _lo_inclusive || _recheck,
+                                                  _hi ? &*_hi : nullptr, _hi_inclusive || _recheck));
+    }
+}
+
+bool IndexScanExecutor::Next(std::vector<TupleView>& batch)
+{
+    batch.clear();
+    const TableHeap* table_heap = _table_info->GetTableHeap();
+    while (batch.empty()) {
+        size_t num_rids = 0;
+        if (_is_lookup) {
+            if (!_done && _index_info->GetIndex()->SearchEntry(*_lo, &_rids[0])) {
+                num_rids = 1;
+            }
+            _done = true;
+        } else {
+            assert(_itr.has_value());
+            num_rids = _itr->Next(_rids.data(), _rids.size());
+        }
+        if (num_rids == 0) {
+            return false;
+        }
+
+        // the rows are copied, then the views are made (the buffer might grow meanwhile)
+        _buffer.clear();
+        _offsets.clear();
+        _row_rids.clear();
+        {
+            ReadPageGuard page_guard;
+            for (size_t i = 0; i < num_rids; i++) {
+                const auto [meta, view] = table_heap->GetTupleView(_rids[i], page_guard);
+                if (view.GetData() == nullptr || (_recheck && !IsInRange(view.GetData()))) {
+                    continue;
+                }
+                _offsets.push_back(static_cast<uint32_t>(_buffer.size()));
+                _row_rids.push_back(view.GetRID());
+                _buffer.insert(_buffer.end(), view.GetData(), view.GetData() + view.GetLength());
+            }
+        }
+        for (size_t i = 0; i < _offsets.size(); i++) {
+            const uint32_t end = i + 1 < _offsets.size() ? _offsets[i + 1] : static_cast<uint32_t>(_buffer.size());
+            batch.emplace_back(_buffer.data() + _offsets[i], end - _offsets[i], _row_rids[i]);
+        }
+    }
+    return true;
+}
+
+bool IndexScanExecutor::IsInRange(const char* row) const
+{
+    const Schema& schema = _table_info->GetSchema();
+    const IndexMetadata& metadata = _index_info->GetIndex()->GetMetadata();
+    const uint32_t* key_attrs = metadata.GetKeyAttributes().data();
+    const uint32_t key_attr_count = metadata.GetKeyAttrCount();
+    if (_lo) {
+        const int cmp = Tuple::CompareKeys(row, schema, key_attrs, _lo->GetData(), schema, key_attrs, key_attr_count);
+        if (cmp < 0 || (cmp == 0 && !_lo_inclusive)) {
+            return false;
+        }
+    }
+    if (_hi) {
+        const int cmp = Tuple::CompareKeys(row, schema, key_attrs, _hi->GetData(), schema, key_attrs, key_attr_count);
+        if (cmp > 0 || (cmp == 0 && !_hi_inclusive)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const Schema& IndexScanExecutor::GetOutputSchema() const
+{
+    return _table_info->GetSchema();
+}
@@ -0,0 +1,88 @@
+#include <dbcore/insert_executor.h>
+#include <dbcore/column.h>
+#include <dbcore/executor_context.h>
+#include <dbcore/index.h>
+#include <dbcore/index_info.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_info.h>
+#include <dbcore/value.h>
+
+#include <cassert>
+
+using namespace dbcore;
+
+namespace
+{
+
+Schema MakeCountSchema()
+{
+    Column columns[] = { Column{"count", TypeId::INTEGER} };
+    return Schema{columns, 1};
+}
+
+}
+
+InsertExecutor::InsertExecutor(ExecutorContext& context, table_oid_t table_oid, std::unique_ptr<AbstractExecutor> child)
+    : _table_info(context.GetCatalog().GetTable(table_oid))
+    , _child(std::move(child))
+    , _output_schema(MakeCountSchema())
+{
+    assert(_table_info != nullptr && _child);
+    _indexes = context.GetCatalog().GetTableIndexes(_table_info->GetTableName());
+}
+
+void InsertExecutor::Init()
+{
+    _child->Init();
+    _done = false;
+}
+
+bool InsertExecutor::Next(std::vector<TupleView>& batch)
+{
+    batch.clear();
+    if (_done) {
+        return false;
+    }
+    _done = true;
+
+    // the child releases its pages when it's drained
+    std::vector<Tuple> tuples;
+    std::vector<TupleView> child_batch;
+    while (_child->Next(child_batch)) {
+        for (const TupleView& row : child_batch) {
+            tuples.push_back(row.ToTuple());
+        }
+    }
+    if (_child->HasFailed()) {
+        return false;
+    }
+
+    TableHeap* table_heap = _table_info->GetTableHeap();
+    int32_t num_inserted = 0;
+    for (const Tuple& tuple : tuples) {
+        const RID rid = table_heap->InsertTuple(TupleMeta{0, false}, tuple);
+        if (rid.GetPageId() == INVALID_PAGE_ID) {
+            continue;
+        }
+        size_t num_indexed = 0;
+        while (num_indexed < _indexes.size() && _indexes[num_indexed]->GetIndex()->InsertEntry(tuple, rid)) {
+            num_indexed++;
+        }
+        if (num_indexed < _indexes.size()) {
+            // the duplicate key: the row is rolled back
+            for (size_t i = 0; i < num_indexed; i++) {
+                _indexes[i]->GetIndex()->DeleteEntry(tuple);
+            }
+            // the row is not indexed anymore, so its slot is reused at once
+            table_heap->MarkDelete(rid);
+            table_heap->ReleaseSlot(rid);
+            continue;
+        }
+        num_inserted++;
+    }
+
+    Value values[] = { Value{TypeId::INTEGER, num_inserted} };
+    _result.emplace(values, 1, _output_schema);
+    batch.emplace_back(*_result);
+    return true;
+}
@@ -0,0 +1,108 @@
+#include <dbcore/join_hash_table.h>
+
+#include <cassert>
+
+using namespace dbcore;
+
+JoinHashTable::JoinHashTable(uint32_t key_size)
+    : _key_size(key_size)
+    , _slot_size((SLOT_HEADER_SIZE + key_size + 3) & ~3u)
+{
+    Clear();
+}
+
+void JoinHashTable::Clear()
+{
+    _rows.clear();
+    _row_offsets.assign(1, 0);
+    _rids.clear();
+    _keys.clear();
+    _hashes.clear();
+    _radix_bits = 0;
+    _partition_begin.clear();
+    _partition_mask.clear();
+    _slots.clear();
+}
+
+void JoinHashTable::Insert(const TupleView& row, const char* key, uint32_t hash)
+{
+    assert(_slots.empty());
+    _rows.insert(_rows.end(), row.GetData(), row.GetData() + row.GetLength());
+    _row_offsets.push_back(_rows.size());
+    _rids.push_back(row.GetRID());
+    _keys.insert(_keys.end(), key, key + _key_size);
+    _hashes.push_back(hash);
+}
+
+size_t JoinHashTable::GetMemoryUsage() const
+{
+    return _rows.size() + _row_offsets.size() * sizeof(size_t) + _rids.size() * sizeof(RID)
+            + _keys.size() + _hashes.size() * sizeof(uint32_t) + _slots.size();
+}
+
+void JoinHashTable::Build()
+{
+    const size_t num_rows = GetNumRows();
+    assert(num_rows < EMPTY_SLOT);
+
+    // the tables are at most half full, the number of partitions makes each one fit into L2
+    const size_t table_size = 2 * num_rows * _slot_size;
+    _radix_bits = 0;
+    while (_radix_bits < MAX_RADIX_BITS && (table_size >> _radix_bits) > L2_CACHE_SIZE) {
+        _radix_bits++;
+    }
+    const uint32_t num_partitions = GetNumPartitions();
+
+    // the histogram of partitions, then the rows are scattered into the partitioned order
+    std::vector<uint32_t> counts(num_partitions + 1, 0);
+    for (uint32_t hash : _hashes) {
+        counts[Partition(hash) + 1]++;
+    }
+    std::vector<uint32_t> positions(num_partitions + 1, 0);
+    for (uint32_t p = 0; p < num_partitions; p++) {
+        positions[p + 1] = positions[p] + counts[p + 1];
+    }
+    std::vector<uint32_t> partitioned(num_rows);
+    {
+        std::vector<uint32_t> next(positions.cbegin(), positions.cend() - 1);
+        for (uint32_t row = 0; row < num_rows; row++) {
+            partitioned[next[Partition(_hashes[row])]++] = row;
+        }
+    }
+
+    _partition_begin.assign(num_partitions, 0);
+    _partition_mask.assign(num_partitions, 0);
+    size_t num_slots = 0;
+    for (uint32_t p = 0; p < num_partitions; p++) {
+        uint32_t capacity = 2;
+        while (capacity < 2 * counts[p + 1]) {
+            capacity <<= 1;
+        }
+        _partition_begin[p] = num_slots;
+        _partition_mask[p] = capacity - 1;
+        num_slots += capacity;
+    }
+    _slots.assign(num_slots * _slot_size, static_cast<char>(0xFF));
+
+    // each partition's table is filled at once, so it stays in cache while it's built
+    for (uint32_t p = 0; p < num_partitions; p++) {
+        for (uint32_t i = positions[p]; i < positions[p + 1]; i++) {
+            const uint32_t row = partitioned[i];
+            const uint32_t hash = _hashes[row];
+            uint32_t idx = hash & _partition_mask[p];
+            char* slot = nullptr;
+            while (true) {
+                slot = _slots.data() + (_partition_begin[p] + idx) * _slot_size;
+                uint32_t slot_row = 0;
+                ::memcpy(&slot_row, slot + sizeof(uint32_t), sizeof(uint32_t));
+                if (slot_row == EMPTY_SLOT) {
+                    break;
+                }
+                idx = (idx + 1) & _partition_mask[p];
+            }
+            ::memcpy(slot, &hash, sizeof(uint32_t));
+            ::memcpy(slot + sizeof(uint32_t), &row, sizeof(uint32_t));
+            ::memcpy(slot + SLOT_HEADER_SIZE, GetKey(row), _key_size);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include <dbcore/join_row_builder.h>
+
+#include <cassert>
+#include <cstring>
+
+using namespace dbcore;
+
+namespace
+{
+
+Schema ConcatSchemas(const Schema& left, const Schema& right)
+{
+    assert(left.GetColumnCount() + right.GetColumnCount() <= MAX_COLUMN_COUNT);
+    std::array<Column, MAX_COLUMN_COUNT> columns;
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < left.GetColumnCount(); i++) {
+        columns[count++] = left.GetColumnAt(i);
+    }
+    for (uint32_t i = 0; i < right.GetColumnCount(); i++) {
+        columns[count++] = right.GetColumnAt(i);
+    }
+    return Schema{columns, count};
+}
+
+}
+
+JoinRowBuilder::JoinRowBuilder(const Schema& left_schema, const Schema& right_schema)
+    : _left_schema(left_schema)
+    , _right_schema(right_schema)
+    , _output_schema(ConcatSchemas(left_schema, right_schema))
+{
+}
+
+void JoinRowBuilder::Clear()
+{
+    _buffer.clear();
+    _offsets.clear();
+    _rids.clear();
+}
+
+void JoinRowBuilder::Append(const TupleView& left, const TupleView& right)
+{
+    const uint32_t left_size = _left_schema.GetInlinedStorageSize();
+    const uint32_t right_size = _right_schema.GetInlinedStorageSize();
+    const size_t row_offset = _buffer.size();
+    _offsets.push_back(row_offset);
+    _rids.push_back(left.GetRID());
+
+    _buffer.resize(row_offset + left_size + right_size);
+    ::memcpy(_buffer.data() + row_offset, left.GetData(), left_size);
+    ::memcpy(_buffer.data() + row_offset + left_size, right.GetData(), right_size);
+    AppendVarchars(left, _left_schema, 0, row_offset);
+    AppendVarchars(right, _right_schema, left_size, row_offset);
+}
+
+void JoinRowBuilder::AppendVarchars(const TupleView& row, const Schema& schema, uint32_t column_offset, size_t row_offset)
+{
+    for (uint32_t i = 0; i < schema.GetUninlinedColumnCount(); i++) {
+        const Column& column = schema.GetColumnAt(schema.GetUninlinedColumnIndex(i));
+        // the value is the size (4 bytes) and the data, the size is the null marker for null value
+        uint32_t value_offset = 0, size = 0;
+        ::memcpy(&value_offset, row.GetData() + column.GetOffset(), sizeof(uint32_t));
+        ::memcpy(&size, row.GetData() + value_offset, sizeof(uint32_t));
+        const uint32_t value_size = sizeof(uint32_t) + (size == UINT32_MAX ? 0 : size);
+
+        const uint32_t new_offset = static_cast<uint32_t>(_buffer.size() - row_offset);
+        _buffer.insert(_buffer.end(), row.GetData() + value_offset, row.GetData() + value_offset + value_size);
+        ::memcpy(_buffer.data() + row_offset + column_offset + column.GetOffset(), &new_offset, sizeof(uint32_t));
+    }
+}
+
+void JoinRowBuilder::GetRows(std::vector<TupleView>& rows) const
+{
+    rows.clear();
+    for (size_t i = 0; i < _offsets.size(); i++) {
+        const size_t end = i + 1 < _offsets.size() ? _offsets[i + 1] : _buffer.size();
+        rows.emplace_back(_buffer.data() + _offsets[i], static_cast<uint32_t>(end - _offsets[i]), _rids[i]);
+    }
+}
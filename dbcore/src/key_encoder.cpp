@@ -0,0 +1,110 @@
+#include <dbcore/key_encoder.h>
+#include <dbcore/type_id.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+
+using namespace dbcore;
+
+/** The length of null VARCHAR (see value.cpp) */
+static constexpr uint32_t VARCHAR_NULL_LENGTH = std::numeric_limits<uint32_t>::max();
+
+KeyEncoder::KeyEncoder(const Schema& key_schema)
+    : _schema(key_schema)
+{
+    const uint32_t col_count = _schema.GetColumnCount();
+    for (uint32_t i = 0; i < col_count; i++) {
+        _key_offsets[i] = _key_size;
+        _key_size += _schema.GetColumnAt(i).GetStorageSize();
+    }
+    assert(_key_size <= MAX_NORMALIZED_KEY_SIZE);
+}
+
+void KeyEncoder::Encode(const char* tuple_data, char* key) const
+{
+    const uint32_t col_count = _schema.GetColumnCount();
+    for (uint32_t i = 0; i < col_count; i++) {
+        EncodeColumn(_schema.GetColumnAt(i), tuple_data, key + _key_offsets[i]);
+    }
+}
+
+void KeyEncoder::Encode(const char* tuple_data, const Schema& tuple_schema, const uint32_t key_attrs[], char* key) const
+{
+    const uint32_t col_count = _schema.GetColumnCount();
+    for (uint32_t i = 0; i < col_count; i++) {
+        const Column& column = tuple_schema.GetColumnAt(key_attrs[i]);
+        assert(column.GetType() == _schema.GetColumnAt(i).GetType());
+        assert(column.GetStorageSize() == _schema.GetColumnAt(i).GetStorageSize());
+        EncodeColumn(column, tuple_data, key + _key_offsets[i]);
+    }
+}
+
+void KeyEncoder::EncodeColumn(const Column& column, const char* tuple_data, char* dst)
+{
+    const char* src = tuple_data + column.GetOffset();
+
+    switch (column.GetType())
+    {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+        EncodeSigned<int8_t>(src, dst);
+        break;
+    case TypeId::SMALLINT:
+        EncodeSigned<int16_t>(src, dst);
+        break;
+    case TypeId::INTEGER:
+        EncodeSigned<int32_t>(src, dst);
+        break;
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:   // the decimal is stored as 64-bit integer
+        EncodeSigned<int64_t>(src, dst);
+        break;
+    case TypeId::TIMESTAMP: {
+        uint64_t value;
+        ::memcpy(&value, src, sizeof(value));
+        EncodeBigEndian(value, dst);
+        break;
+    }
+    case TypeId::VARCHAR: {
+        // the inlined part keeps the offset of the (length, bytes) pair
+        uint32_t offset, length;
+        ::memcpy(&offset, src, sizeof(offset));
+        ::memcpy(&length, tuple_data + offset, sizeof(length));
+        const uint32_t prefix_length = column.GetStorageSize();
+        if (length == VARCHAR_NULL_LENGTH) {
+            length = 0;     // null is encoded as empty string
+        }
+        length = std::min(length, prefix_length);
+        ::memcpy(dst, tuple_data + offset + sizeof(uint32_t), length);
+        ::memset(dst + length, 0, prefix_length - length);
+        break;
+    }
+    default:
+        assert(false);
+    }
+}
+
+template <typename T>
+void KeyEncoder::EncodeBigEndian(T value, char* dst)
+{
+    static_assert(std::is_unsigned<T>::value, "expected unsigned type");
+    for (int i = sizeof(T) - 1; i >= 0; i--) {
+        dst[i] = static_cast<char>(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+template <typename T>
+void KeyEncoder::EncodeSigned(const char* src, char* dst)
+{
+    using unsigned_t = typename std::make_unsigned<T>::type;
+    constexpr unsigned_t sign_bit = static_cast<unsigned_t>(1) << (sizeof(T) * 8 - 1);
+
+    T value;
+    ::memcpy(&value, src, sizeof(T));
+    EncodeBigEndian(static_cast<unsigned_t>(static_cast<unsigned_t>(value) ^ sign_bit), dst);
+}
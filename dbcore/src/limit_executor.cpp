@@ -0,0 +1,31 @@
+#include <dbcore/limit_executor.h>
+
+#include <cassert>
+
+using namespace dbcore;
+
+LimitExecutor::LimitExecutor(std::unique_ptr<AbstractExecutor> child, uint64_t limit)
+    : _child(std::move(child))
+    , _limit(limit)
+{
+    assert(_child);
+}
+
+void LimitExecutor::Init()
+{
+    _child->Init();
+    _num_produced = 0;
+}
+
+bool LimitExecutor::Next(std::vector<TupleView>& batch)
+{
+    if (_num_produced >= _limit || !_child->Next(batch)) {
+        batch.clear();
+        return false;
+    }
+    if (batch.size() > _limit - _num_produced) {
+        batch.resize(_limit - _num_produced);
+    }
+    _num_produced += batch.size();
+    return true;
+}
@@ -0,0 +1,409 @@
+#include <dbcore/log_manager.h>
+#include <dbcore/log_record.h>
+
+#include <dbcore/hash.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace dbcore;
+
+namespace
+{
+
+/**
+ * The header of the log file:
+ * ----------------------------------------------
+ * | MAGIC(4) | CHECKSUM(4) | CHECKPOINT_LSN(8) |
+ * ----------------------------------------------
+ * The header takes the whole first block, so the space after it is given back by blocks.
+*/
+constexpr uint32_t LOG_HEADER_SIZE = 4096;
+constexpr uint32_t LOG_MAGIC = 0x44424C47;
+constexpr uint32_t LOG_HEADER_DATA_SIZE = 2 * sizeof(uint32_t) + sizeof(lsn_t);
+
+/** The log is read by chunks of this size (the longer record is read entirely) */
+constexpr size_t LOG_READ_CHUNK_SIZE = 1 << 20;
+
+/** Read up to size bytes of the file at the given offset, @return the number of bytes read or -1 on error */
+ssize_t ReadFile(int fd, char* data, size_t size, off_t offset)
+{
+    size_t num_read = 0;
+    while (num_read < size) {
+        const ssize_t n = ::pread(fd, data + num_read, size - num_read, offset + num_read);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        num_read += n;
+    }
+    return static_cast<ssize_t>(num_read);
+}
+
+bool WriteFile(int fd, const char* data, size_t size, off_t offset)
+{
+    size_t num_written = 0;
+    while (num_written < size) {
+        const ssize_t n = ::pwrite(fd, data + num_written, size - num_written, offset + num_written);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        num_written += n;
+    }
+    return true;
+}
+
+/**
+ * Reads the records of the log file one after another from the given offset up to the end one.
+ * The file is read by chunks, the record which crosses the end of the chunk is moved
+ * to the beginning of the buffer before the next chunk is read.
+*/
+class LogReader final
+{
+public:
+    LogReader(int fd, lsn_t begin, lsn_t end)
+        : _fd(fd)
+        , _offset(begin)
+        , _end(end)
+    {
+
+    }
+
+    /**
+     * Read the next record.
+     * @return the size of the record, 0 at the end or when the next record is not valid
+    */
+    uint32_t Next(LogRecord& record)
+    {
+        uint32_t record_size = 0;
+        if (!Fill(sizeof(record_size))) {
+            return 0;
+        }
+        ::memcpy(&record_size, _buffer.data() + _pos, sizeof(record_size));
+        if (record_size == 0 || !Fill(record_size)) {
+            return 0;
+        }
+
+        const uint32_t size = LogRecord::Deserialize(_buffer.data() + _pos, _size - _pos, record);
+        _pos += size;
+        _offset += size;
+        return size;
+    }
+
+    /** @return the offset just past the last record read */
+    lsn_t GetOffset() const { return _offset; }
+
+    /** @return true if the file could not be read */
+    bool HasError() const { return _error; }
+
+private:
+    /** Make the next size bytes available in the buffer, @return false if they are beyond the end */
+    bool Fill(size_t size)
+    {
+        if (_size - _pos >= size) {
+            return true;
+        }
+        if (_offset + size > _end) {
+            return false;
+        }
+
+        const size_t rest = _size - _pos;
+        const size_t capacity = std::min<size_t>(std::max(size, LOG_READ_CHUNK_SIZE), _end - _offset);
+        if (_buffer.size() < capacity) {
+            _buffer.resize(capacity);
+        }
+        ::memmove(_buffer.data(), _buffer.data() + _pos, rest);
+        _pos = 0;
+        const ssize_t n = ReadFile(_fd, _buffer.data() + rest, capacity - rest, static_cast<off_t>(_offset + rest));
+        if (n < 0) {
+            _error = true;
+            _size = rest;
+            return false;
+        }
+        _size = rest + n;
+        return _size >= size;
+    }
+
+private:
+    int _fd{-1};
+    /** the offset in the file of the record at the current position of the buffer */
+    lsn_t _offset{0};
+    lsn_t _end{0};
+    std::vector<char> _buffer;
+    size_t _pos{0};
+    size_t _size{0};
+    bool _error{false};
+};
+
+}
+
+LogManager::LogManager(const char* file_name, uint32_t flush_interval_ms /* = 10*/)
+    : _flush_interval_ms(flush_interval_ms)
+{
+    assert(file_name != nullptr);
+    _fd = ::open(file_name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP);
+    if (_fd == -1) {
+        return;
+    }
+    if (!OpenHeader()) {
+        ::close(_fd);
+        _fd = -1;
+        return;
+    }
+
+    // the torn record (if any) is overwritten by the next appended one
+    _next_lsn = _durable_lsn = FindLogEnd();
+    if (::ftruncate(_fd, static_cast<off_t>(_durable_lsn)) != 0) {
+        _io_error = true;
+    }
+
+    _flusher = std::thread(&LogManager::FlushLoop, this);
+}
+
+LogManager::~LogManager()
+{
+    {
+        std::lock_guard lg(_mutex);
+        _stop = true;
+    }
+    _flush_cv.notify_one();
+    if (_flusher.joinable()) {
+        _flusher.join();
+    }
+
+    if (_fd != -1) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+lsn_t LogManager::Append(const LogRecord& record)
+{
+    const uint32_t size = record.GetSize();
+    std::lock_guard lg(_mutex);
+    const size_t offset = _buffer.size();
+    _buffer.resize(offset + size);
+    _next_lsn += size;
+    record.Serialize(_next_lsn, _buffer.data() + offset);
+    return _next_lsn;
+}
+
+bool LogManager::Flush(lsn_t lsn)
+{
+    if (!IsOpen()) {
+        return false;
+    }
+
+    std::unique_lock lock(_mutex);
+    if (lsn <= _durable_lsn) {
+        return true;
+    }
+    assert(lsn <= _next_lsn);
+
+    _num_waiters++;
+    _flush_cv.notify_one();
+    _durable_cv.wait(lock, [this, lsn]() { return _durable_lsn >= lsn || _io_error; });
+    _num_waiters--;
+    return _durable_lsn >= lsn;
+}
+
+bool LogManager::Flush()
+{
+    lsn_t lsn = INVALID_LSN;
+    {
+        std::lock_guard lg(_mutex);
+        lsn = _next_lsn;
+    }
+    return Flush(lsn);
+}
+
+lsn_t LogManager::GetAppendedLSN() const
+{
+    std::lock_guard lg(_mutex);
+    return _next_lsn;
+}
+
+lsn_t LogManager::GetDurableLSN() const
+{
+    std::lock_guard lg(_mutex);
+    return _durable_lsn;
+}
+
+uint64_t LogManager::GetNumSyncs() const
+{
+    std::lock_guard lg(_mutex);
+    return _num_syncs;
+}
+
+lsn_t LogManager::GetCheckpointLSN() const
+{
+    std::lock_guard lg(_mutex);
+    return _checkpoint_lsn;
+}
+
+bool LogManager::Truncate(lsn_t checkpoint_lsn)
+{
+    if (!IsOpen()) {
+        return false;
+    }
+
+    std::lock_guard hg(_header_mutex);
+    lsn_t prev_start_lsn = INVALID_LSN;
+    {
+        std::lock_guard lg(_mutex);
+        if (checkpoint_lsn <= _checkpoint_lsn) {
+            return true;
+        }
+        assert(checkpoint_lsn <= _next_lsn);
+        prev_start_lsn = GetStartLSN();
+    }
+
+    // the records are read from the new checkpoint only when the header is durable
+    if (!WriteHeader(checkpoint_lsn)) {
+        return false;
+    }
+    {
+        std::lock_guard lg(_mutex);
+        _checkpoint_lsn = checkpoint_lsn;
+    }
+
+    // the whole blocks of the discarded records are given back (the failure just keeps them)
+    const off_t begin = static_cast<off_t>(prev_start_lsn / LOG_HEADER_SIZE * LOG_HEADER_SIZE);
+    const off_t end = static_cast<off_t>(checkpoint_lsn / LOG_HEADER_SIZE * LOG_HEADER_SIZE);
+    if (end > begin) {
+        ::fallocate(_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, begin, end - begin);
+    }
+    return true;
+}
+
+bool LogManager::ReadLog(const std::function<void(const LogRecord&)>& callback) const
+{
+    if (!IsOpen()) {
+        return false;
+    }
+
+    lsn_t start_lsn = INVALID_LSN;
+    lsn_t durable_lsn = INVALID_LSN;
+    {
+        std::lock_guard lg(_mutex);
+        start_lsn = GetStartLSN();
+        durable_lsn = _durable_lsn;
+    }
+
+    LogReader reader(_fd, start_lsn, durable_lsn);
+    LogRecord record;
+    while (reader.GetOffset() < durable_lsn) {
+        if (reader.Next(record) == 0) {
+            return false;
+        }
+        callback(record);
+    }
+    return true;
+}
+
+void LogManager::FlushLoop()
+{
+    std::vector<char> batch;
+    std::unique_lock lock(_mutex);
+    while (true) {
+        _flush_cv.wait_for(lock, std::chrono::milliseconds(_flush_interval_ms), [this]() {
+            return _stop || (_num_waiters > 0 && !_buffer.empty());
+        });
+
+        if (_buffer.empty() || _io_error) {
+            if (_stop) {
+                break;
+            }
+            continue;
+        }
+
+        // the next records are appended into the other buffer while this batch is written
+        batch.swap(_buffer);
+        const lsn_t batch_end = _next_lsn;
+        const lsn_t batch_offset = _durable_lsn;
+        lock.unlock();
+
+        const bool written = WriteFile(_fd, batch.data(), batch.size(), static_cast<off_t>(batch_offset))
+                            && ::fdatasync(_fd) == 0;
+        batch.clear();
+
+        lock.lock();
+        if (written) {
+            _durable_lsn = batch_end;
+            _num_syncs++;
+        } else {
+            _io_error = true;
+        }
+        _durable_cv.notify_all();
+    }
+}
+
+lsn_t LogManager::FindLogEnd() const
+{
+    struct stat st;
+    if (::fstat(_fd, &st) != 0) {
+        return INVALID_LSN;
+    }
+
+    // the records before the checkpoint are discarded, the valid ones start from it
+    LogReader reader(_fd, GetStartLSN(), static_cast<lsn_t>(st.st_size));
+    LogRecord record;
+    while (true) {
+        const lsn_t offset = reader.GetOffset();
+        const uint32_t size = reader.Next(record);
+        if (size == 0 || record.GetLSN() != offset + size) {
+            return offset;
+        }
+    }
+}
+
+bool LogManager::OpenHeader()
+{
+    struct stat st;
+    if (::fstat(_fd, &st) != 0) {
+        return false;
+    }
+    if (st.st_size == 0) {
+        return WriteHeader(INVALID_LSN);
+    }
+
+    char header[LOG_HEADER_DATA_SIZE];
+    if (ReadFile(_fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+        return false;
+    }
+    uint32_t magic = 0, checksum = 0;
+    ::memcpy(&magic, header, sizeof(magic));
+    ::memcpy(&checksum, header + sizeof(magic), sizeof(checksum));
+    ::memcpy(&_checkpoint_lsn, header + 2 * sizeof(uint32_t), sizeof(_checkpoint_lsn));
+    return magic == LOG_MAGIC && checksum == FNV_hash(&_checkpoint_lsn, sizeof(_checkpoint_lsn))
+            && (_checkpoint_lsn == INVALID_LSN || _checkpoint_lsn >= LOG_HEADER_SIZE);
+}
+
+bool LogManager::WriteHeader(lsn_t checkpoint_lsn)
+{
+    // the header is written entirely by single write of one sector
+    char header[LOG_HEADER_DATA_SIZE];
+    const uint32_t checksum = FNV_hash(&checkpoint_lsn, sizeof(checkpoint_lsn));
+    ::memcpy(header, &LOG_MAGIC, sizeof(LOG_MAGIC));
+    ::memcpy(header + sizeof(LOG_MAGIC), &checksum, sizeof(checksum));
+    ::memcpy(header + 2 * sizeof(uint32_t), &checkpoint_lsn, sizeof(checkpoint_lsn));
+    return WriteFile(_fd, header, sizeof(header), 0) && ::fdatasync(_fd) == 0;
+}
+
+lsn_t LogManager::GetStartLSN() const
+{
+    return _checkpoint_lsn != INVALID_LSN ? _checkpoint_lsn : LOG_HEADER_SIZE;
+}
@@ -0,0 +1,205 @@
+#include <dbcore/log_record.h>
+#include <dbcore/hash.h>
+
+#include <cassert>
+#include <cstring>
+
+using namespace dbcore;
+
+namespace
+{
+
+template <typename T>
+void Write(char*& dst, const T& value)
+{
+    ::memcpy(dst, &value, sizeof(T));
+    dst += sizeof(T);
+}
+
+template <typename T>
+void Read(const char*& src, T& value)
+{
+    ::memcpy(&value, src, sizeof(T));
+    src += sizeof(T);
+}
+
+/** The checksum covers the record after the size and checksum fields */
+constexpr uint32_t CHECKSUM_OFFSET = 2 * sizeof(uint32_t);
+
+/** The page id, the flag of new page, the offset and the size of the page range (see INDEX_PAGES) */
+constexpr uint32_t PAGE_CHANGE_HEADER_SIZE = sizeof(page_id_t) + 3 * sizeof(uint16_t);
+
+}
+
+LogRecord LogRecord::TablePageInit(page_id_t page_id)
+{
+    LogRecord record;
+    record._type = LogRecordType::TABLE_PAGE_INIT;
+    record._page_id = page_id;
+    return record;
+}
+
+LogRecord LogRecord::TablePageLink(page_id_t page_id, page_id_t next_page_id)
+{
+    LogRecord record;
+    record._type = LogRecordType::TABLE_PAGE_LINK;
+    record._page_id = page_id;
+    record._next_page_id = next_page_id;
+    return record;
+}
+
+LogRecord LogRecord::TableInsert(const RID& rid, const TupleMeta& meta, const Tuple& tuple)
+{
+    LogRecord record;
+    record._type = LogRecordType::TABLE_INSERT;
+    record._page_id = rid.GetPageId();
+    record._rid = rid;
+    record._meta = meta;
+    record._data.assign(tuple.GetData(), tuple.GetData() + tuple.GetLength());
+    return record;
+}
+
+LogRecord LogRecord::TableDelete(const RID& rid)
+{
+    LogRecord record;
+    record._type = LogRecordType::TABLE_DELETE;
+    record._page_id = rid.GetPageId();
+    record._rid = rid;
+    return record;
+}
+
+LogRecord LogRecord::TableUpdate(const RID& rid, const TupleMeta& meta, const Tuple& tuple)
+{
+    LogRecord record = TableInsert(rid, meta, tuple);
+    record._type = LogRecordType::TABLE_UPDATE;
+    return record;
+}
+
+LogRecord LogRecord::TableReleaseSlot(const RID& rid)
+{
+    LogRecord record = TableDelete(rid);
+    record._type = LogRecordType::TABLE_RELEASE_SLOT;
+    return record;
+}
+
+LogRecord LogRecord::IndexPages(index_oid_t index_oid)
+{
+    LogRecord record;
+    record._type = LogRecordType::INDEX_PAGES;
+    record._index_oid = index_oid;
+    return record;
+}
+
+LogRecord LogRecord::Checkpoint(lsn_t checkpoint_lsn)
+{
+    LogRecord record;
+    record._type = LogRecordType::CHECKPOINT;
+    record._data.resize(sizeof(checkpoint_lsn));
+    ::memcpy(record._data.data(), &checkpoint_lsn, sizeof(checkpoint_lsn));
+    return record;
+}
+
+lsn_t LogRecord::GetCheckpointLSN() const
+{
+    assert(_type == LogRecordType::CHECKPOINT && _data.size() == sizeof(lsn_t));
+    lsn_t checkpoint_lsn = INVALID_LSN;
+    ::memcpy(&checkpoint_lsn, _data.data(), sizeof(checkpoint_lsn));
+    return checkpoint_lsn;
+}
+
+void LogRecord::AddPageChange(const PageChange& change)
+{
+    assert(_type == LogRecordType::INDEX_PAGES);
+    assert(change.offset + change.size <= PAGE_SIZE);
+    const size_t offset = _data.size();
+    _data.resize(offset + PAGE_CHANGE_HEADER_SIZE + change.size);
+    char* p = _data.data() + offset;
+    Write(p, change.page_id);
+    Write(p, static_cast<uint16_t>(change.is_new));
+    Write(p, change.offset);
+    Write(p, change.size);
+    if (change.size != 0) {
+        ::memcpy(p, change.data, change.size);
+    }
+}
+
+bool LogRecord::GetPageChanges(std::vector<PageChange>& changes) const
+{
+    assert(_type == LogRecordType::INDEX_PAGES);
+    changes.clear();
+    const char* p = _data.data();
+    const char* end = _data.data() + _data.size();
+    while (p != end) {
+        if (static_cast<size_t>(end - p) < PAGE_CHANGE_HEADER_SIZE) {
+            return false;
+        }
+        PageChange change;
+        uint16_t is_new = 0;
+        Read(p, change.page_id);
+        Read(p, is_new);
+        Read(p, change.offset);
+        Read(p, change.size);
+        if (static_cast<size_t>(end - p) < change.size || change.offset + change.size > PAGE_SIZE) {
+            return false;
+        }
+        change.is_new = is_new != 0;
+        change.data = p;
+        p += change.size;
+        changes.push_back(change);
+    }
+    return true;
+}
+
+void LogRecord::Serialize(lsn_t lsn, char* dst) const
+{
+    char* p = dst;
+    Write(p, GetSize());
+    Write(p, uint32_t{0});  // the checksum is written at the end
+    Write(p, lsn);
+    Write(p, _type);
+    Write(p, _page_id);
+    Write(p, _next_page_id);
+    Write(p, _rid);
+    Write(p, _meta);
+    Write(p, _index_oid);
+    Write(p, GetDataSize());
+    assert(p == dst + HEADER_SIZE);
+    if (!_data.empty()) {
+        ::memcpy(p, _data.data(), _data.size());
+    }
+
+    const uint32_t checksum = FNV_hash(dst + CHECKSUM_OFFSET, GetSize() - CHECKSUM_OFFSET);
+    ::memcpy(dst + sizeof(uint32_t), &checksum, sizeof(checksum));
+}
+
+uint32_t LogRecord::Deserialize(const char* src, size_t size, LogRecord& record)
+{
+    if (size < HEADER_SIZE) {
+        return 0;
+    }
+
+    const char* p = src;
+    uint32_t record_size = 0, checksum = 0, data_size = 0;
+    Read(p, record_size);
+    Read(p, checksum);
+    if (record_size < HEADER_SIZE || record_size > size) {
+        return 0;
+    }
+    if (FNV_hash(src + CHECKSUM_OFFSET, record_size - CHECKSUM_OFFSET) != checksum) {
+        return 0;
+    }
+
+    Read(p, record._lsn);
+    Read(p, record._type);
+    Read(p, record._page_id);
+    Read(p, record._next_page_id);
+    Read(p, record._rid);
+    Read(p, record._meta);
+    Read(p, record._index_oid);
+    Read(p, data_size);
+    if (data_size != record_size - HEADER_SIZE) {
+        return 0;
+    }
+    record._data.assign(p, p + data_size);
+    return record_size;
+}
@@ -0,0 +1,137 @@
+#include <dbcore/log_recovery.h>
+#include <dbcore/log_manager.h>
+#include <dbcore/log_record.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/table_page.h>
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+using namespace dbcore;
+
+LogRecovery::LogRecovery(const LogManager& log_manager, PagesManager& pages_manager)
+    : _log_manager(log_manager)
+    , _pages_manager(pages_manager)
+{
+
+}
+
+bool LogRecovery::Redo()
+{
+    _num_redone = 0;
+    _num_skipped = 0;
+    // the log is read from the last checkpoint, the records before it are discarded
+    _checkpoint_lsn = _log_manager.GetCheckpointLSN();
+
+    bool all_redone = true;
+    const bool log_read = _log_manager.ReadLog([&](const LogRecord& record) {
+        if (!all_redone) {
+            return;
+        }
+        switch (record.GetType())
+        {
+        case LogRecordType::TABLE_PAGE_INIT:
+        case LogRecordType::TABLE_PAGE_LINK:
+        case LogRecordType::TABLE_INSERT:
+        case LogRecordType::TABLE_DELETE:
+        case LogRecordType::TABLE_UPDATE:
+        case LogRecordType::TABLE_RELEASE_SLOT:
+            all_redone = RedoTablePage(record);
+            break;
+        case LogRecordType::INDEX_PAGES:
+            all_redone = RedoIndexPages(record);
+            break;
+        case LogRecordType::CHECKPOINT:
+            // the checkpoint which the log has not been truncated to, the records after it are redone anyway
+            break;
+        default:
+            assert(false);  // unknown record type
+            all_redone = false;
+        }
+    });
+    return log_read && all_redone;
+}
+
+bool LogRecovery::RedoTablePage(const LogRecord& record)
+{
+    // the recovery is single-threaded, so the page is not latched
+    PageGuard guard = _pages_manager.RecoverPageGuarded(record.GetPageId());
+    if (guard.GetData() == nullptr) {
+        return false;
+    }
+
+    // the page might have been the index page before, so its LSN is not trusted until it's initialized
+    if (record.GetType() != LogRecordType::TABLE_PAGE_INIT && guard.As<TablePage>()->GetLSN() >= record.GetLSN()) {
+        // the page had reached the storage after the change
+        _num_skipped++;
+        return true;
+    }
+
+    TablePage* page = guard.AsMut<TablePage>();
+    switch (record.GetType())
+    {
+    case LogRecordType::TABLE_PAGE_INIT:
+        page->Init();
+        break;
+    case LogRecordType::TABLE_PAGE_LINK:
+        page->SetNextPageId(record.GetNextPageId());
+        break;
+    case LogRecordType::TABLE_INSERT: {
+        const Tuple tuple{record.GetData(), record.GetDataSize(), record.GetRID()};
+        const slot_id_t slot_id = page->InsertTuple(record.GetTupleMeta(), tuple);
+        // the tuples are redone in the order of insertion, so they get the same slots
+        if (slot_id != record.GetRID().GetSlotId()) {
+            return false;
+        }
+        break;
+    }
+    case LogRecordType::TABLE_DELETE:
+        if (!page->MarkDelete(record.GetRID().GetSlotId())) {
+            return false;
+        }
+        break;
+    case LogRecordType::TABLE_UPDATE: {
+        const Tuple tuple{record.GetData(), record.GetDataSize(), record.GetRID()};
+        if (!page->UpdateTupleInPlace(record.GetTupleMeta(), tuple, record.GetRID().GetSlotId())) {
+            return false;
+        }
+        break;
+    }
+    case LogRecordType::TABLE_RELEASE_SLOT:
+        if (!page->ReleaseSlot(record.GetRID().GetSlotId())) {
+            return false;
+        }
+        break;
+    default:
+        assert(false);
+        return false;
+    }
+
+    page->SetLSN(record.GetLSN());
+    _num_redone++;
+    return true;
+}
+
+bool LogRecovery::RedoIndexPages(const LogRecord& record)
+{
+    std::vector<LogRecord::PageChange> changes;
+    if (!record.GetPageChanges(changes)) {
+        return false;
+    }
+
+    for (const LogRecord::PageChange& change : changes) {
+        PageGuard guard = _pages_manager.RecoverPageGuarded(change.page_id);
+        if (guard.GetData() == nullptr) {
+            return false;
+        }
+        char* data = guard.AsMut<char>();
+        if (change.is_new) {
+            ::memset(data, 0, PAGE_SIZE);
+        }
+        ::memcpy(data + change.offset, change.data, change.size);
+    }
+
+    _num_redone++;
+    return true;
+}
@@ -0,0 +1,54 @@
+#include <dbcore/morsel_scheduler.h>
+
+#include <cassert>
+
+using namespace dbcore;
+
+MorselScheduler::MorselScheduler(uint32_t num_morsels, uint32_t num_workers)
+    : _num_workers(num_workers)
+    , _ranges(new Range[num_workers])
+{
+    assert(num_workers > 0);
+    uint32_t begin = 0;
+    for (uint32_t i = 0; i < num_workers; i++) {
+        const uint32_t end = begin + num_morsels / num_workers + (i < num_morsels % num_workers ? 1 : 0);
+        _ranges[i]._range.store(Pack(begin, end), std::memory_order_relaxed);
+        begin = end;
+    }
+}
+
+bool MorselScheduler::Next(uint32_t worker_id, uint32_t* morsel)
+{
+    assert(worker_id < _num_workers);
+    std::atomic<uint64_t>& own = _ranges[worker_id]._range;
+    uint64_t range = own.load(std::memory_order_acquire);
+    while (Begin(range) < End(range)) {
+        // the thieves take the morsels from the back, so the owner competes with them for the last one only
+        if (own.compare_exchange_weak(range, Pack(Begin(range) + 1, End(range)), std::memory_order_acq_rel)) {
+            *morsel = Begin(range);
+            return true;
+        }
+    }
+    return Steal(worker_id, morsel);
+}
+
+bool MorselScheduler::Steal(uint32_t worker_id, uint32_t* morsel)
+{
+    for (uint32_t i = 1; i < _num_workers; i++) {
+        std::atomic<uint64_t>& victim = _ranges[(worker_id + i) % _num_workers]._range;
+        uint64_t range = victim.load(std::memory_order_acquire);
+        while (Begin(range) < End(range)) {
+            const uint32_t num_stolen = (End(range) - Begin(range) + 1) / 2;
+            const uint32_t stolen_begin = End(range) - num_stolen;
+            if (victim.compare_exchange_weak(range, Pack(Begin(range), stolen_begin), std::memory_order_acq_rel)) {
+                // the rest of the stolen morsels become the own ones (the own range is empty,
+                // so nobody else changes it meanwhile)
+                _ranges[worker_id]._range.store(Pack(stolen_begin + 1, stolen_begin + num_stolen), std::memory_order_release);
+                _num_steals.fetch_add(1, std::memory_order_relaxed);
+                *morsel = stolen_begin;
+                return true;
+            }
+        }
+    }
+    return false;
+}
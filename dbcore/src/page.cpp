@@ -12,4 +12,5 @@ Page::Page()
 void Page::ResetData()
 {
     std::memset(_data, 0, PAGE_SIZE);
+    _lsn.store(INVALID_LSN, std::memory_order_relaxed);
 }
@@ -0,0 +1,135 @@
+#include <dbcore/page_change_log.h>
+#include <dbcore/page.h>
+#include <dbcore/log_manager.h>
+#include <dbcore/log_record.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace dbcore;
+
+namespace
+{
+
+/** The ranges are compared by blocks at first, so the equal parts are skipped quickly */
+constexpr uint32_t COMPARE_BLOCK_SIZE = 64;
+
+/** The image of the page just allocated */
+const char ZERO_PAGE[PAGE_SIZE] = {};
+
+/** @return the position of the first byte which differs, size when the ranges are equal */
+uint32_t FindFirstMismatch(const char* lhs, const char* rhs, uint32_t size)
+{
+    uint32_t pos = 0;
+    while (pos + COMPARE_BLOCK_SIZE <= size && ::memcmp(lhs + pos, rhs + pos, COMPARE_BLOCK_SIZE) == 0) {
+        pos += COMPARE_BLOCK_SIZE;
+    }
+    while (pos < size && lhs[pos] == rhs[pos]) {
+        pos++;
+    }
+    return pos;
+}
+
+/** @return the position just past the last byte which differs, 0 when the ranges are equal */
+uint32_t FindLastMismatch(const char* lhs, const char* rhs, uint32_t size)
+{
+    uint32_t end = size;
+    while (end >= COMPARE_BLOCK_SIZE
+            && ::memcmp(lhs + end - COMPARE_BLOCK_SIZE, rhs + end - COMPARE_BLOCK_SIZE, COMPARE_BLOCK_SIZE) == 0) {
+        end -= COMPARE_BLOCK_SIZE;
+    }
+    while (end > 0 && lhs[end - 1] == rhs[end - 1]) {
+        end--;
+    }
+    return end;
+}
+
+}
+
+PageChangeLog::PageChangeLog(LogManager* log_manager, index_oid_t index_oid)
+    : _log_manager(log_manager)
+    , _index_oid(index_oid)
+{
+
+}
+
+void PageChangeLog::Track(WritePageGuard& guard)
+{
+    TrackPage(guard._page_guard._page, false);
+}
+
+void PageChangeLog::Track(WritePageGuard&& guard)
+{
+    TrackPage(guard._page_guard._page, false);
+    _guards.push_back(std::move(guard));
+}
+
+void PageChangeLog::TrackNew(WritePageGuard&& guard)
+{
+    TrackPage(guard._page_guard._page, true);
+    _guards.push_back(std::move(guard));
+}
+
+void PageChangeLog::TrackPage(Page* page, bool is_new)
+{
+    assert(page != nullptr);
+    if (_log_manager == nullptr) {
+        return;
+    }
+    const auto it = std::find_if(_pages.cbegin(), _pages.cend(), [page](const TrackedPage& tracked) {
+        return tracked.page == page;
+    });
+    if (it != _pages.cend()) {
+        return;
+    }
+
+    TrackedPage tracked{page, nullptr};
+    if (!is_new) {
+        tracked.image.reset(new char[PAGE_SIZE]);
+        ::memcpy(tracked.image.get(), page->GetData(), PAGE_SIZE);
+    }
+    _pages.push_back(std::move(tracked));
+}
+
+lsn_t PageChangeLog::Append()
+{
+    lsn_t lsn = INVALID_LSN;
+    if (_log_manager != nullptr && !_pages.empty()) {
+        LogRecord record = LogRecord::IndexPages(_index_oid);
+        std::vector<Page*> changed_pages;
+        changed_pages.reserve(_pages.size());
+        for (const TrackedPage& tracked : _pages) {
+            const char* data = tracked.page->GetData();
+            LogRecord::PageChange change;
+            change.page_id = tracked.page->GetPageId();
+            change.is_new = tracked.image == nullptr;
+
+            // the range from the first to the last changed byte (the new page is changed from zeroes)
+            const char* image = change.is_new ? ZERO_PAGE : tracked.image.get();
+            const uint32_t begin = FindFirstMismatch(data, image, PAGE_SIZE);
+            if (begin == PAGE_SIZE && !change.is_new) {
+                continue;
+            }
+            const uint32_t end = std::max(begin, FindLastMismatch(data, image, PAGE_SIZE));
+
+            change.offset = static_cast<uint16_t>(begin);
+            change.size = static_cast<uint16_t>(end - begin);
+            change.data = data + begin;
+            record.AddPageChange(change);
+            changed_pages.push_back(tracked.page);
+        }
+
+        if (!changed_pages.empty()) {
+            lsn = _log_manager->Append(record);
+            for (Page* page : changed_pages) {
+                page->SetLSN(lsn);
+                page->MarkDirty();
+            }
+        }
+    }
+
+    _pages.clear();
+    _guards.clear();
+    return lsn;
+}
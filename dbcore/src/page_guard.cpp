@@ -66,12 +66,24 @@ PageGuard& PageGuard::operator=(PageGuard&& other)
 
 ReadPageGuard PageGuard::UpgradeRead() 
 { 
-    return ReadPageGuard(_pages_manager, _page); 
+    // the pin is passed to the new guard, this one becomes empty
+    ReadPageGuard guard(_pages_manager, _page);
+    guard._page_guard._is_dirty = _is_dirty;
+    _pages_manager = nullptr;
+    _page = nullptr;
+    _is_dirty = false;
+    return guard;
 }
 
 WritePageGuard PageGuard::UpgradeWrite() 
 { 
-    return WritePageGuard(_pages_manager, _page); 
+    // the pin is passed to the new guard, this one becomes empty
+    WritePageGuard guard(_pages_manager, _page);
+    guard._page_guard._is_dirty = _is_dirty;
+    _pages_manager = nullptr;
+    _page = nullptr;
+    _is_dirty = false;
+    return guard;
 }
 
 
@@ -153,3 +165,10 @@ WritePageGuard& WritePageGuard::operator=(WritePageGuard&& other)
     }
     return *this;
 }
+
+void WritePageGuard::SetLSN(lsn_t lsn)
+{
+    _page_guard._is_dirty = true;
+    _page_guard._page->SetLSN(lsn);
+    _page_guard._page->MarkDirty();
+}
@@ -1,8 +1,15 @@
 #include <dbcore/pages_manager.h>
+#include <dbcore/disk_manager.h>
+#include <dbcore/log_manager.h>
+#include <dbcore/log_record.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <thread>
 
 #include <iostream>
 
@@ -11,49 +18,93 @@ using namespace dbcore;
 #define UNLIKELY(expr) __builtin_expect((expr), false)
 #define LIKELY(expr) __builtin_expect((expr), true)
 
-PagesManager::PagesManager(uint32_t num_of_pages)
+namespace
+{
+    constexpr uint64_t FREE_FRAMES_TAG_ONE = 1ull << 32;
+    /** The max number of adjacent pages written by the checkpoint at once */
+    constexpr uint32_t CHECKPOINT_RUN_SIZE = 32;
+
+    uint64_t MakeFreeFramesHead(uint64_t old_head, dbcore::frame_id_t frame_id)
+    {
+        const uint64_t tag = (old_head & ~0xFFFFFFFFull) + FREE_FRAMES_TAG_ONE;
+        return tag | static_cast<uint32_t>(frame_id);
+    }
+}
+
+PagesManager::PagesManager(uint32_t num_of_pages, DiskManager* disk_manager /* = nullptr*/,
+                        LogManager* log_manager /* = nullptr*/)
     : _num_of_pages(num_of_pages)
+    , _disk_manager(disk_manager)
+    , _log_manager(log_manager)
+    , _page_table(new std::atomic<std::atomic<frame_id_t>*>[PAGE_TABLE_NUM_CHUNKS])
+    , _free_frames_head(MakeFreeFramesHead(0, INVALID_FRAME_ID))
+    , _free_frames_next(new std::atomic<frame_id_t>[num_of_pages])
 {
-    page_id_t page_id = 0;
+    assert(num_of_pages <= static_cast<uint32_t>(std::numeric_limits<frame_id_t>::max()));
     _pages = static_cast<Page *>(::calloc(num_of_pages, sizeof(Page)));
 
-    for (uint32_t idx = 0; idx < num_of_pages; idx++) {
-        new(_pages + idx)Page();
-        _free_pages.insert(page_id);
-        _free_pages_list.push_back(page_id);
-        page_id++;
+    for (uint32_t idx = 0; idx < PAGE_TABLE_NUM_CHUNKS; idx++) {
+        _page_table[idx].store(nullptr, std::memory_order_relaxed);
+    }
+
+    // push in reverse order, so the frames are taken starting from the first one
+    for (uint32_t idx = num_of_pages; idx > 0; idx--) {
+        new(_pages + idx - 1)Page();
+        PushFreeFrame(static_cast<frame_id_t>(idx - 1));
+    }
+
+    // the pages which are already in the database file are considered as allocated
+    if (_disk_manager != nullptr) {
+        _next_page_id = static_cast<page_id_t>(_disk_manager->GetNumPages());
     }
 }
 
 PagesManager::~PagesManager()
 {
+    FlushAllPages();
+
     for (uint32_t idx = 0; idx < _num_of_pages; idx++) {
         Page *ptr = &_pages[idx];
-        assert(ptr->_pin_count == 0);
+        assert(ptr->GetPinCount() == 0);
         ptr->~Page();
     }
   
     ::free(_pages);
     _pages = nullptr;
+
+    for (uint32_t idx = 0; idx < PAGE_TABLE_NUM_CHUNKS; idx++) {
+        delete[] _page_table[idx].load(std::memory_order_relaxed);
+    }
 }
 
 Page* PagesManager::NextFreePage(page_id_t *page_id)
 {
     assert(page_id != nullptr);
-    std::lock_guard lg(_mutex);
-    if (UNLIKELY(_free_pages.empty())) {
+
+    const frame_id_t frame_id = AcquireFrame();
+    if (UNLIKELY(frame_id == INVALID_FRAME_ID)) {
         *page_id = INVALID_PAGE_ID;
         return nullptr;        
     }
 
-    page_id_t tmp_id = _free_pages_list.front();
-    _free_pages_list.pop_front();
-    _free_pages.erase(tmp_id);
+    page_id_t tmp_id = INVALID_PAGE_ID;
+    {
+        std::lock_guard lg(_mutex);
+        if (!_free_pages_list.empty()) {
+            tmp_id = _free_pages_list.front();
+            _free_pages_list.pop_front();
+            _free_pages.erase(tmp_id);
+        } else {
+            tmp_id = _next_page_id++;
+        }
+    }
 
-    Page* page = &_pages[tmp_id];
-    assert(page->_pin_count == 0);
-    page->_pin_count = 1;
-    page->_page_id = tmp_id;
+    Page* page = &_pages[frame_id];
+    page->ResetData();
+    page->_page_id.store(tmp_id, std::memory_order_relaxed);
+    // the content of the storage (if any) is stale, so the new page has to be written back
+    page->_state.store(1 | Page::STATE_DIRTY | Page::STATE_REFERENCED, std::memory_order_release);
+    PageTableEntry(tmp_id).store(frame_id, std::memory_order_release);
     *page_id = tmp_id;
 
     return page;
@@ -61,60 +112,519 @@ Page* PagesManager::NextFreePage(page_id_t *page_id)
 
 Page* PagesManager::GetPage(page_id_t page_id)
 {
-    if (UNLIKELY(page_id >= _num_of_pages)) {
-        return nullptr;
-    }
-    
-    std::lock_guard lg(_mutex);
-    if (UNLIKELY(_free_pages.find(page_id) != _free_pages.cend())) {
-        return nullptr;
-    }
-
-    Page* page = &_pages[page_id];
+    Page* page = FetchPage(page_id);
+    if (page != nullptr)
+        Unpin(page, false);
     return page;
 }
 
 Page* PagesManager::GetPagePinned(page_id_t page_id)
 {
-    Page* page = GetPage(page_id);
-    if (page != nullptr)
-        page->_pin_count++;
-    return page;
+    return FetchPage(page_id);
 }
 
 bool PagesManager::UnpinPage(page_id_t page_id, bool is_dirty)
 {
-    Page* page = GetPage(page_id);
-    if (UNLIKELY(page == nullptr))
+    const frame_id_t frame_id = LookupFrame(page_id);
+    if (UNLIKELY(frame_id == INVALID_FRAME_ID))
         return false;
 
-    if (LIKELY(page->_pin_count > 0)) {
-        page->_pin_count--;
-        page->_is_dirty = is_dirty;
-        return true;
-    }
-    return false;
+    return Unpin(&_pages[frame_id], is_dirty);
 }
 
 bool PagesManager::GiveBackPage(page_id_t page_id)
 {
-    Page* page = GetPage(page_id);
-    if (page == nullptr)
+    std::lock_guard lg(_mutex);
+    if (UNLIKELY(page_id < 0 || page_id >= _next_page_id)) {
+        return false;
+    }
+
+    if (_free_pages.find(page_id) != _free_pages.cend()) {
         return false;
+    }
+
+    while (true) {
+        const frame_id_t frame_id = LookupFrame(page_id);
+        if (frame_id == INVALID_FRAME_ID) {
+            break;
+        }
+
+        Page* page = &_pages[frame_id];
+        uint32_t state = page->_state.load(std::memory_order_acquire);
+        if (state & (Page::STATE_FREE | Page::STATE_EVICTING)) {
+            // the page is being evicted right now, wait until it leaves the frame
+            std::this_thread::yield();
+            continue;
+        }
+        if (state & (Page::PIN_COUNT_MASK | Page::STATE_LOADING)) {
+            return false;
+        }
+        if (!page->_state.compare_exchange_weak(state, state | Page::STATE_EVICTING, std::memory_order_acq_rel)) {
+            continue;
+        }
 
-    if (page->_pin_count == 0) {
+        PageTableEntry(page_id).store(INVALID_FRAME_ID, std::memory_order_release);
         page->ResetData();
-        page->_page_id = INVALID_PAGE_ID;
-        page->_is_dirty = false;
+        page->_page_id.store(INVALID_PAGE_ID, std::memory_order_relaxed);
+        page->_state.store(Page::STATE_FREE, std::memory_order_release);
+        PushFreeFrame(frame_id);
+        break;
+    }
+
+    _free_pages.insert(page_id);
+    _free_pages_list.push_back(page_id);
 
+    return true;
+}
+
+PageGuard PagesManager::RecoverPageGuarded(page_id_t page_id)
+{
+    assert(page_id >= 0);
+    {
+        // the page ids up to the recovered one are allocated
         std::lock_guard lg(_mutex);
-        _free_pages.insert(page_id);
-        _free_pages_list.push_back(page_id);
+        if (page_id >= _next_page_id) {
+            _next_page_id = page_id + 1;
+        }
+        if (_free_pages.erase(page_id) != 0) {
+            _free_pages_list.remove(page_id);
+        }
+    }
 
+    Page* page = FetchPage(page_id);
+    if (page == nullptr) {
+        // there is no storage or the page is beyond it
+        const frame_id_t frame_id = AcquireFrame();
+        if (UNLIKELY(frame_id == INVALID_FRAME_ID)) {
+            return PageGuard{};
+        }
+        page = &_pages[frame_id];
+        page->ResetData();
+        page->_page_id.store(page_id, std::memory_order_relaxed);
+        page->_state.store(1 | Page::STATE_DIRTY | Page::STATE_REFERENCED, std::memory_order_release);
+        PageTableEntry(page_id).store(frame_id, std::memory_order_release);
+    }
+    return PageGuard(this, page);
+}
+
+bool PagesManager::WritePage(Page* page)
+{
+    // write-ahead: the log records of the page changes reach the storage before the page
+    if (_log_manager != nullptr && !_log_manager->Flush(page->GetLSN())) {
+        return false;
+    }
+    return _disk_manager->WritePage(page->GetPageId(), page->GetData());
+}
+
+void PagesManager::PrefetchPage(page_id_t page_id)
+{
+    if (_disk_manager == nullptr || page_id == INVALID_PAGE_ID || LookupFrame(page_id) != INVALID_FRAME_ID) {
+        return;
+    }
+    _disk_manager->Prefetch(page_id);
+}
+
+bool PagesManager::FlushPage(page_id_t page_id)
+{
+    if (_disk_manager == nullptr) {
+        return false;
+    }
+
+    const frame_id_t frame_id = LookupFrame(page_id);
+    if (frame_id == INVALID_FRAME_ID) {
+        return false;
+    }
+
+    Page* page = &_pages[frame_id];
+    if (!TryPin(page)) {
+        return false;
+    }
+
+    bool result = false;
+    if (page->GetPageId() == page_id && !(page->_state.load(std::memory_order_acquire) & Page::STATE_LOADING)) {
+        // nobody modifies the page while it's latched, so the flag is cleared when the page
+        // is already on the storage (the checkpoint relies on it)
+        page->RLatch();
+        result = WritePage(page);
+        if (result) {
+            page->_state.fetch_and(~Page::STATE_DIRTY, std::memory_order_acq_rel);
+        }
+        page->RUnlatch();
+    }
+    Unpin(page, false);
+    return result;
+}
+
+bool PagesManager::FlushAllPages()
+{
+    if (_disk_manager == nullptr) {
         return true;
     }
 
-    return false;
+    bool result = true;
+    for (uint32_t idx = 0; idx < _num_of_pages; idx++) {
+        Page* page = &_pages[idx];
+        if (!page->IsDirty()) {
+            continue;
+        }
+        const page_id_t page_id = page->GetPageId();
+        if (page_id == INVALID_PAGE_ID || FlushPage(page_id)) {
+            continue;
+        }
+        // the page which has been evicted meanwhile is written by the eviction
+        if (LookupFrame(page_id) != INVALID_FRAME_ID && page->GetPageId() == page_id && page->IsDirty()) {
+            result = false;
+        }
+    }
+    return result;
+}
+
+bool PagesManager::Sync()
+{
+    return _disk_manager == nullptr || _disk_manager->Sync();
+}
+
+bool PagesManager::Checkpoint(lsn_t* checkpoint_lsn /* = nullptr*/)
+{
+    if (_disk_manager == nullptr) {
+        return false;
+    }
+
+    std::lock_guard cg(_checkpoint_mutex);
+    // every change logged up to this LSN has been made while its page was pinned and latched,
+    // so the page is pinned, dirty, being evicted or already on the storage when the frames are scanned
+    const lsn_t begin_lsn = _log_manager != nullptr ? _log_manager->GetAppendedLSN() : INVALID_LSN;
+
+    std::vector<page_id_t> page_ids;
+    for (uint32_t idx = 0; idx < _num_of_pages; idx++) {
+        const Page* page = &_pages[idx];
+        const uint32_t state = page->_state.load(std::memory_order_acquire);
+        if (state & Page::STATE_FREE) {
+            continue;
+        }
+        const page_id_t page_id = page->GetPageId();
+        if (page_id != INVALID_PAGE_ID 
+            && (state & (Page::STATE_DIRTY | Page::STATE_EVICTING | Page::PIN_COUNT_MASK))) {
+            page_ids.push_back(page_id);
+        }
+    }
+    std::sort(page_ids.begin(), page_ids.end());
+    page_ids.erase(std::unique(page_ids.begin(), page_ids.end()), page_ids.end());
+
+    // the run pages are pinned, so the most of the frames are left for the users of pages
+    const uint32_t run_size = std::min(CHECKPOINT_RUN_SIZE, std::max(1u, _num_of_pages / 8));
+    std::unique_ptr<char[]> buffer(new char[run_size * PAGE_SIZE]);
+    Page* run_pages[CHECKPOINT_RUN_SIZE];
+    bool result = true;
+    size_t idx = 0;
+    while (idx < page_ids.size()) {
+        // collect the run of adjacent dirty pages, the pages are pinned until they are written
+        page_id_t first_page_id = INVALID_PAGE_ID;
+        uint32_t num_pages = 0;
+        lsn_t run_lsn = INVALID_LSN;
+        for (; idx < page_ids.size() && num_pages < run_size; idx++) {
+            const page_id_t page_id = page_ids[idx];
+            if (num_pages > 0 && page_id != first_page_id + static_cast<page_id_t>(num_pages)) {
+                break;
+            }
+
+            // the page which has left the memory is written on eviction
+            Page* page = PinResidentPage(page_id);
+            if (page == nullptr) {
+                continue;
+            }
+
+            page->RLatch();
+            const bool is_dirty = page->IsDirty();
+            if (is_dirty) {
+                // the concurrent modification sets the flag again after the latch is released
+                page->_state.fetch_and(~Page::STATE_DIRTY, std::memory_order_acq_rel);
+                ::memcpy(buffer.get() + num_pages * PAGE_SIZE, page->GetData(), PAGE_SIZE);
+                run_lsn = std::max(run_lsn, page->GetLSN());
+            }
+            page->RUnlatch();
+
+            if (!is_dirty) {
+                Unpin(page, false);
+                continue;
+            }
+            if (num_pages == 0) {
+                first_page_id = page_id;
+            }
+            run_pages[num_pages++] = page;
+        }
+
+        if (num_pages == 0) {
+            continue;
+        }
+
+        // write-ahead: the log is flushed up to the latest change of the run
+        const bool written = (_log_manager == nullptr || _log_manager->Flush(run_lsn)) 
+                            && _disk_manager->WritePages(first_page_id, buffer.get(), num_pages);
+        for (uint32_t n = 0; n < num_pages; n++) {
+            Unpin(run_pages[n], !written);
+        }
+        result = result && written;
+    }
+
+    if (!result || !_disk_manager->Sync()) {
+        return false;
+    }
+
+    // the records up to the checkpoint are not needed for recovery anymore
+    if (_log_manager != nullptr && (!_log_manager->Flush(_log_manager->Append(LogRecord::Checkpoint(begin_lsn)))
+                                    || !_log_manager->Truncate(begin_lsn))) {
+        return false;
+    }
+
+    if (checkpoint_lsn != nullptr) {
+        *checkpoint_lsn = begin_lsn;
+    }
+    return true;
+}
+
+Page* PagesManager::PinResidentPage(page_id_t page_id)
+{
+    while (true) {
+        const frame_id_t frame_id = LookupFrame(page_id);
+        if (frame_id == INVALID_FRAME_ID) {
+            return nullptr;
+        }
+
+        Page* page = &_pages[frame_id];
+        if (TryPin(page)) {
+            if (page->GetPageId() == page_id) {
+                if (!(page->_state.load(std::memory_order_acquire) & Page::STATE_LOADING)) {
+                    return page;
+                }
+                // the page which is being loaded is the same as on the storage
+                Unpin(page, false);
+                return nullptr;
+            }
+            Unpin(page, false);
+        }
+        // the page is being evicted, its page table entry is cleared when it's written
+        std::this_thread::yield();
+    }
+}
+
+Page* PagesManager::FetchPage(page_id_t page_id)
+{
+    if (UNLIKELY(page_id < 0)) {
+        return nullptr;
+    }
+
+    while (true) {
+        frame_id_t frame_id = LookupFrame(page_id);
+        if (LIKELY(frame_id != INVALID_FRAME_ID)) {
+            Page* page = &_pages[frame_id];
+            if (LIKELY(TryPin(page))) {
+                // the frame might be reused for another page between lookup and pin
+                if (LIKELY(page->GetPageId() == page_id)) {
+                    while (UNLIKELY(page->_state.load(std::memory_order_acquire) & Page::STATE_LOADING)) {
+                        std::this_thread::yield();
+                    }
+                    // loading might fail, in that case the page has left the frame
+                    if (LIKELY(page->GetPageId() == page_id)) {
+                        return page;
+                    }
+                }
+                Unpin(page, false);
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        // the page is not in memory, so it has been evicted onto the storage (if it exists at all)
+        if (UNLIKELY(_disk_manager == nullptr || !IsAllocated(page_id))) {
+            return nullptr;
+        }
+
+        frame_id = AcquireFrame();
+        if (UNLIKELY(frame_id == INVALID_FRAME_ID)) {
+            return nullptr;
+        }
+
+        Page* page = &_pages[frame_id];
+        page->_page_id.store(page_id, std::memory_order_relaxed);
+        // the page on the storage has all of its logged changes durable
+        page->SetLSN(INVALID_LSN);
+        page->_state.store(1 | Page::STATE_LOADING | Page::STATE_REFERENCED, std::memory_order_release);
+
+        frame_id_t expected = INVALID_FRAME_ID;
+        if (!PageTableEntry(page_id).compare_exchange_strong(expected, frame_id, std::memory_order_acq_rel)) {
+            // another thread is loading the same page, give the frame back and join it
+            page->_page_id.store(INVALID_PAGE_ID, std::memory_order_relaxed);
+            page->_state.store(Page::STATE_FREE, std::memory_order_release);
+            PushFreeFrame(frame_id);
+            continue;
+        }
+
+        if (UNLIKELY(!_disk_manager->ReadPage(page_id, page->GetData()))) {
+            // leave the frame without page, the replacement policy will reclaim it when unpinned
+            PageTableEntry(page_id).store(INVALID_FRAME_ID, std::memory_order_release);
+            page->_page_id.store(INVALID_PAGE_ID, std::memory_order_relaxed);
+            page->_state.fetch_and(~Page::STATE_LOADING, std::memory_order_release);
+            Unpin(page, false);
+            return nullptr;
+        }
+
+        page->_state.fetch_and(~Page::STATE_LOADING, std::memory_order_release);
+        return page;
+    }
+}
+
+bool PagesManager::TryPin(Page* page)
+{
+    uint32_t state = page->_state.load(std::memory_order_relaxed);
+    while (true) {
+        if (UNLIKELY(state & (Page::STATE_FREE | Page::STATE_EVICTING))) {
+            return false;
+        }
+        assert((state & Page::PIN_COUNT_MASK) != Page::PIN_COUNT_MASK);
+        if (LIKELY(page->_state.compare_exchange_weak(state, (state + 1) | Page::STATE_REFERENCED, 
+                                                    std::memory_order_acq_rel))) {
+            return true;
+        }
+    }
+}
+
+bool PagesManager::Unpin(Page* page, bool is_dirty)
+{
+    const uint32_t dirty_flag = is_dirty ? Page::STATE_DIRTY : 0;
+    uint32_t state = page->_state.load(std::memory_order_relaxed);
+    while (true) {
+        if (UNLIKELY((state & Page::PIN_COUNT_MASK) == 0)) {
+            return false;
+        }
+        if (LIKELY(page->_state.compare_exchange_weak(state, (state - 1) | dirty_flag, std::memory_order_acq_rel))) {
+            return true;
+        }
+    }
+}
+
+bool PagesManager::IsAllocated(page_id_t page_id)
+{
+    std::lock_guard lg(_mutex);
+    return page_id >= 0 && page_id < _next_page_id && _free_pages.find(page_id) == _free_pages.cend();
+}
+
+frame_id_t PagesManager::LookupFrame(page_id_t page_id) const
+{
+    if (UNLIKELY(page_id < 0)) {
+        return INVALID_FRAME_ID;
+    }
+
+    const std::atomic<frame_id_t>* chunk = _page_table[page_id >> PAGE_TABLE_CHUNK_BITS].load(std::memory_order_acquire);
+    if (UNLIKELY(chunk == nullptr)) {
+        return INVALID_FRAME_ID;
+    }
+    return chunk[page_id & (PAGE_TABLE_CHUNK_SIZE - 1)].load(std::memory_order_acquire);
+}
+
+std::atomic<frame_id_t>& PagesManager::PageTableEntry(page_id_t page_id)
+{
+    assert(page_id >= 0);
+    auto& chunk_ptr = _page_table[page_id >> PAGE_TABLE_CHUNK_BITS];
+    std::atomic<frame_id_t>* chunk = chunk_ptr.load(std::memory_order_acquire);
+    if (UNLIKELY(chunk == nullptr)) {
+        std::atomic<frame_id_t>* new_chunk = new std::atomic<frame_id_t>[PAGE_TABLE_CHUNK_SIZE];
+        for (uint32_t idx = 0; idx < PAGE_TABLE_CHUNK_SIZE; idx++) {
+            new_chunk[idx].store(INVALID_FRAME_ID, std::memory_order_relaxed);
+        }
+        if (chunk_ptr.compare_exchange_strong(chunk, new_chunk, std::memory_order_acq_rel)) {
+            chunk = new_chunk;
+        } else {
+            // another thread has already installed the chunk
+            delete[] new_chunk;
+        }
+    }
+    return chunk[page_id & (PAGE_TABLE_CHUNK_SIZE - 1)];
+}
+
+frame_id_t PagesManager::AcquireFrame()
+{
+    const frame_id_t frame_id = PopFreeFrame();
+    if (frame_id != INVALID_FRAME_ID) {
+        return frame_id;
+    }
+
+    // nowhere to write back the evicted pages
+    if (_disk_manager == nullptr) {
+        return INVALID_FRAME_ID;
+    }
+
+    return EvictFrame();
+}
+
+frame_id_t PagesManager::EvictFrame()
+{
+    // two full turns of the clock hand: the first one may only clear the reference bits
+    for (uint32_t n = 0; n < 2 * _num_of_pages; n++) {
+        const frame_id_t frame_id = _clock_hand.fetch_add(1, std::memory_order_relaxed) % _num_of_pages;
+
+        Page* page = &_pages[frame_id];
+        uint32_t state = page->_state.load(std::memory_order_acquire);
+        if (state & (Page::PIN_COUNT_MASK | Page::STATE_FREE | Page::STATE_EVICTING | Page::STATE_LOADING)) {
+            continue;
+        }
+
+        if (state & Page::STATE_REFERENCED) {
+            page->_state.compare_exchange_strong(state, state & ~Page::STATE_REFERENCED, std::memory_order_acq_rel);
+            continue;
+        }
+
+        if (!page->_state.compare_exchange_strong(state, state | Page::STATE_EVICTING, std::memory_order_acq_rel)) {
+            continue;
+        }
+
+        // the frame is exclusively owned now: nobody is able to pin the page
+        const page_id_t page_id = page->GetPageId();
+        if (page_id != INVALID_PAGE_ID) {
+            if (state & Page::STATE_DIRTY) {
+                if (UNLIKELY(!WritePage(page))) {
+                    page->_state.fetch_and(~Page::STATE_EVICTING, std::memory_order_release);
+                    continue;
+                }
+            }
+            frame_id_t expected = frame_id;
+            PageTableEntry(page_id).compare_exchange_strong(expected, INVALID_FRAME_ID, std::memory_order_acq_rel);
+        }
+
+        page->_page_id.store(INVALID_PAGE_ID, std::memory_order_relaxed);
+        return frame_id;
+    }
+
+    return INVALID_FRAME_ID;
+}
+
+void PagesManager::PushFreeFrame(frame_id_t frame_id)
+{
+    uint64_t head = _free_frames_head.load(std::memory_order_relaxed);
+    while (true) {
+        _free_frames_next[frame_id].store(static_cast<frame_id_t>(head & 0xFFFFFFFFull), std::memory_order_relaxed);
+        if (_free_frames_head.compare_exchange_weak(head, MakeFreeFramesHead(head, frame_id), std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+}
+
+frame_id_t PagesManager::PopFreeFrame()
+{
+    uint64_t head = _free_frames_head.load(std::memory_order_acquire);
+    while (true) {
+        const frame_id_t frame_id = static_cast<frame_id_t>(head & 0xFFFFFFFFull);
+        if (frame_id == INVALID_FRAME_ID) {
+            return INVALID_FRAME_ID;
+        }
+        // the link might be stale, but then the tag is changed and CAS fails
+        const frame_id_t next_id = _free_frames_next[frame_id].load(std::memory_order_relaxed);
+        if (_free_frames_head.compare_exchange_weak(head, MakeFreeFramesHead(head, next_id), std::memory_order_acq_rel)) {
+            // keep the frame in the exclusive state until the new page is placed there
+            _pages[frame_id]._state.store(Page::STATE_EVICTING, std::memory_order_relaxed);
+            return frame_id;
+        }
+    }
 }
 
 
@@ -0,0 +1,61 @@
+#include <dbcore/projection_executor.h>
+#include <dbcore/value.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace dbcore;
+
+namespace
+{
+
+Schema MakeOutputSchema(const Schema& schema, const uint32_t attrs[], uint32_t num_attrs)
+{
+    std::array<uint32_t, MAX_COLUMN_COUNT> copy;
+    std::copy(attrs, attrs + num_attrs, copy.begin());
+    return Schema::CopySchema(schema, copy.data(), num_attrs);
+}
+
+}
+
+ProjectionExecutor::ProjectionExecutor(std::unique_ptr<AbstractExecutor> child, const uint32_t attrs[], uint32_t num_attrs)
+    : _child(std::move(child))
+    , _num_attrs(num_attrs)
+    , _output_schema(MakeOutputSchema(_child->GetOutputSchema(), attrs, num_attrs))
+{
+    assert(num_attrs > 0 && num_attrs <= MAX_COLUMN_COUNT);
+    std::copy(attrs, attrs + num_attrs, _attrs.begin());
+    if (VectorProjection::IsSupported(_child->GetOutputSchema(), attrs, num_attrs)) {
+        _projection.emplace(_child->GetOutputSchema(), attrs, num_attrs);
+    }
+}
+
+bool ProjectionExecutor::Next(std::vector<TupleView>& batch)
+{
+    batch.clear();
+    if (!_child->Next(_child_batch)) {
+        return false;
+    }
+
+    if (_projection) {
+        _selection.Reset(static_cast<uint32_t>(_child_batch.size()), true);
+        _projection->Project(_child_batch.data(), _selection);
+        const std::vector<TupleView>& rows = _projection->MaterializeRows();
+        batch.assign(rows.cbegin(), rows.cend());
+        return true;
+    }
+
+    const Schema& schema = _child->GetOutputSchema();
+    std::array<Value, MAX_COLUMN_COUNT> values;
+    _tuples.clear();
+    for (const TupleView& row : _child_batch) {
+        for (uint32_t i = 0; i < _num_attrs; i++) {
+            values[i] = row.GetValue(schema, _attrs[i]);
+        }
+        _tuples.emplace_back(values, _num_attrs, _output_schema);
+    }
+    for (size_t i = 0; i < _tuples.size(); i++) {
+        batch.emplace_back(_tuples[i].GetData(), _tuples[i].GetLength(), _child_batch[i].GetRID());
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+#include <dbcore/row_spill.h>
+#include <dbcore/pages_manager.h>
+
+#include <cassert>
+#include <cstring>
+
+using namespace dbcore;
+
+RowSpill::RowSpill(PagesManager& pages_manager)
+    : _pages_manager(&pages_manager)
+    , _buffer_size(PAGE_HEADER_SIZE)
+{
+}
+
+RowSpill::~RowSpill()
+{
+    Clear();
+}
+
+bool RowSpill::Append(const TupleView& row)
+{
+    const uint32_t size = ROW_HEADER_SIZE + row.GetLength();
+    if (PAGE_HEADER_SIZE + size > PAGE_SIZE) {
+        return false;
+    }
+    if (_buffer_size + size > PAGE_SIZE && !Finish()) {
+        return false;
+    }
+
+    _buffer.resize(PAGE_SIZE);
+    char* data = _buffer.data() + _buffer_size;
+    const uint32_t length = row.GetLength();
+    const RID rid = row.GetRID();
+    ::memcpy(data, &length, sizeof(uint32_t));
+    ::memcpy(data + sizeof(uint32_t), &rid, sizeof(RID));
+    ::memcpy(data + ROW_HEADER_SIZE, row.GetData(), length);
+    _buffer_size += size;
+    _num_rows++;
+    return true;
+}
+
+bool RowSpill::Finish()
+{
+    if (_buffer_size == PAGE_HEADER_SIZE) {
+        return true;
+    }
+
+    page_id_t page_id = INVALID_PAGE_ID;
+    WritePageGuard page_guard = _pages_manager->NextFreePageGuarded(&page_id).UpgradeWrite();
+    if (page_guard.PageId() == INVALID_PAGE_ID) {
+        return false;
+    }
+    ::memcpy(_buffer.data(), &_buffer_size, sizeof(uint32_t));
+    ::memcpy(page_guard.GetDataMut(), _buffer.data(), _buffer_size);
+    _pages.push_back(page_id);
+    _buffer_size = PAGE_HEADER_SIZE;
+    return true;
+}
+
+void RowSpill::ReadPage(size_t idx, ReadPageGuard& page_guard, std::vector<TupleView>& rows) const
+{
+    assert(idx < _pages.size());
+    rows.clear();
+    page_guard = _pages_manager->GetPageRead(_pages[idx]);
+    const char* data = page_guard.GetData();
+    uint32_t used_size = 0;
+    ::memcpy(&used_size, data, sizeof(uint32_t));
+    for (uint32_t offset = PAGE_HEADER_SIZE; offset < used_size;) {
+        uint32_t length = 0;
+        RID rid;
+        ::memcpy(&length, data + offset, sizeof(uint32_t));
+        ::memcpy(&rid, data + offset + sizeof(uint32_t), sizeof(RID));
+        rows.emplace_back(data + offset + ROW_HEADER_SIZE, length, rid);
+        offset += ROW_HEADER_SIZE + length;
+    }
+}
+
+void RowSpill::Clear()
+{
+    for (page_id_t page_id : _pages) {
+        _pages_manager->GiveBackPage(page_id);
+    }
+    _pages.clear();
+    _buffer.clear();
+    _buffer.shrink_to_fit();
+    _buffer_size = PAGE_HEADER_SIZE;
+    _num_rows = 0;
+}
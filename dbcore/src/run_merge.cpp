@@ -0,0 +1,124 @@
+#include <dbcore/run_merge.h>
+#include <dbcore/pages_manager.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace dbcore;
+
+RunMerge::RunMerge(uint32_t key_size, KeyExtractor extract_key /* = {}*/, RowLess less /* = {}*/)
+    : _key_size(key_size)
+    , _extract_key(std::move(extract_key))
+    , _less(std::move(less))
+{
+}
+
+void RunMerge::Open(const std::vector<RowSpill>& runs, size_t begin, size_t end)
+{
+    assert(begin <= end && end <= runs.size());
+    _cursors.clear();
+    _cursors.resize(end - begin);
+    for (size_t i = 0; i < _cursors.size(); i++) {
+        _cursors[i]._run = &runs[begin + i];
+        Advance(_cursors[i]);
+    }
+    if (!_cursors.empty()) {
+        _loser_tree.Init(static_cast<uint32_t>(_cursors.size()),
+                        [this](uint32_t lhs, uint32_t rhs) { return CursorLess(lhs, rhs); });
+    }
+}
+
+void RunMerge::Close()
+{
+    _cursors.clear();
+}
+
+const TupleView* RunMerge::Top() const
+{
+    if (_cursors.empty()) {
+        return nullptr;
+    }
+    const RunCursor& cursor = _cursors[_loser_tree.Top()];
+    return cursor._rows.empty() ? nullptr : &cursor._rows[cursor._pos];
+}
+
+void RunMerge::Pop()
+{
+    Advance(_cursors[_loser_tree.Top()]);
+    _loser_tree.Replay([this](uint32_t lhs, uint32_t rhs) { return CursorLess(lhs, rhs); });
+}
+
+bool RunMerge::Reduce(std::vector<RowSpill>& runs, PagesManager& pages_manager, uint32_t max_fan_in)
+{
+    assert(max_fan_in > 1);
+    while (runs.size() > max_fan_in) {
+        std::vector<RowSpill> merged_runs;
+        for (size_t begin = 0; begin < runs.size(); begin += max_fan_in) {
+            const size_t end = std::min<size_t>(begin + max_fan_in, runs.size());
+            if (end - begin == 1) {
+                merged_runs.push_back(std::move(runs[begin]));
+                continue;
+            }
+
+            Open(runs, begin, end);
+            RowSpill run(pages_manager);
+            for (const TupleView* row = nullptr; (row = Top()) != nullptr; Pop()) {
+                if (!run.Append(*row)) {
+                    Close();
+                    return false;
+                }
+            }
+            // the cursors release the pages of the runs before the runs give them back
+            Close();
+            if (!run.Finish()) {
+                return false;
+            }
+            for (size_t i = begin; i < end; i++) {
+                runs[i].Clear();
+            }
+            merged_runs.push_back(std::move(run));
+        }
+        runs = std::move(merged_runs);
+    }
+    return true;
+}
+
+void RunMerge::Advance(RunCursor& cursor) const
+{
+    cursor._pos++;
+    while (cursor._pos >= cursor._rows.size()) {
+        if (cursor._page == cursor._run->GetNumPages()) {
+            cursor._page_guard.Drop();
+            cursor._rows.clear();
+            return;
+        }
+        cursor._run->ReadPage(cursor._page++, cursor._page_guard, cursor._rows);
+        cursor._pos = 0;
+    }
+    if (_extract_key) {
+        cursor._key.resize(_key_size);
+        _extract_key(cursor._rows[cursor._pos], cursor._key.data());
+    }
+}
+
+const char* RunMerge::GetKey(const RunCursor& cursor) const
+{
+    return _extract_key ? cursor._key.data() : cursor._rows[cursor._pos].GetData();
+}
+
+bool RunMerge::CursorLess(uint32_t lhs, uint32_t rhs) const
+{
+    const RunCursor& left = _cursors[lhs];
+    const RunCursor& right = _cursors[rhs];
+    if (left._rows.empty()) {
+        return false;
+    }
+    if (right._rows.empty()) {
+        return true;
+    }
+    if (_less) {
+        return _less(GetKey(left), left._rows[left._pos], GetKey(right), right._rows[right._pos]);
+    }
+    return ::memcmp(GetKey(left), GetKey(right), _key_size) < 0;
+}
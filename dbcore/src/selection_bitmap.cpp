@@ -0,0 +1,41 @@
+#include <dbcore/selection_bitmap.h>
+
+using namespace dbcore;
+
+void SelectionBitmap::Reset(uint32_t num_rows, bool selected)
+{
+    _num_rows = num_rows;
+    _words.assign((num_rows + 63) / 64, selected ? ~uint64_t{0} : 0);
+    if (selected && num_rows % 64 != 0) {
+        _words.back() = (uint64_t{1} << (num_rows % 64)) - 1;
+    }
+}
+
+void SelectionBitmap::Select(uint32_t row, bool selected)
+{
+    assert(row < _num_rows);
+    const uint64_t bit = uint64_t{1} << (row % 64);
+    if (selected) {
+        _words[row / 64] |= bit;
+    } else {
+        _words[row / 64] &= ~bit;
+    }
+}
+
+uint32_t SelectionBitmap::CountSelected() const
+{
+    uint32_t count = 0;
+    for (uint64_t word : _words) {
+        count += static_cast<uint32_t>(__builtin_popcountll(word));
+    }
+    return count;
+}
+
+bool SelectionBitmap::IsEmpty() const
+{
+    uint64_t any = 0;
+    for (uint64_t word : _words) {
+        any |= word;
+    }
+    return any == 0;
+}
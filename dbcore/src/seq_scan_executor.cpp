@@ -0,0 +1,44 @@
+#include <dbcore/seq_scan_executor.h>
+#include <dbcore/executor_context.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_info.h>
+
+#include <cassert>
+
+using namespace dbcore;
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext& context, table_oid_t table_oid, bool prefetch /* = false*/)
+    : _table_info(context.GetCatalog().GetTable(table_oid))
+    , _prefetch(prefetch)
+{
+    assert(_table_info != nullptr);
+}
+
+void SeqScanExecutor::Init()
+{
+    // the previous iterator releases its page before the new one latches the first page
+    _itr.reset();
+    _itr.emplace(_table_info->GetTableHeap()->MakeBatchIterator(_prefetch));
+    _produced = false;
+}
+
+bool SeqScanExecutor::Next(std::vector<TupleView>& batch)
+{
+    assert(_itr.has_value());
+    // the page is left only when the next batch is requested, so the views of the last one are valid till then
+    if (_produced && !_itr->IsEnd()) {
+        _itr->Next();
+    }
+    _produced = true;
+    if (_itr->IsEnd()) {
+        return false;
+    }
+    const std::vector<TupleView>& page_batch = _itr->GetBatch();
+    batch.assign(page_batch.cbegin(), page_batch.cend());
+    return true;
+}
+
+const Schema& SeqScanExecutor::GetOutputSchema() const
+{
+    return _table_info->GetSchema();
+}
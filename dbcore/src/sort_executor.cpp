@@ -0,0 +1,294 @@
+#include <dbcore/sort_executor.h>
+#include <dbcore/executor_context.h>
+#include <dbcore/tuple.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <numeric>
+
+using namespace dbcore;
+
+namespace
+{
+
+Schema MakeKeySchema(const Schema& schema, const uint32_t key_attrs[], uint32_t num_keys)
+{
+    std::array<uint32_t, MAX_COLUMN_COUNT> attrs;
+    std::copy(key_attrs, key_attrs + num_keys, attrs.begin());
+    return Schema::CopySchema(schema, attrs.data(), num_keys);
+}
+
+/** @return the size of the normalized key up to the end of the first VARCHAR column */
+uint32_t GetExactKeySize(const Schema& key_schema)
+{
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+        size += key_schema.GetColumnAt(i).GetStorageSize();
+        if (key_schema.GetColumnAt(i).GetType() == TypeId::VARCHAR) {
+            break;
+        }
+    }
+    return size;
+}
+
+bool HasVarchar(const Schema& key_schema)
+{
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+        if (key_schema.GetColumnAt(i).GetType() == TypeId::VARCHAR) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** The longest key which is sorted by radix sort */
+constexpr uint32_t MAX_RADIX_KEY_SIZE = sizeof(uint64_t);
+
+}
+
+SortExecutor::SortExecutor(ExecutorContext& context, std::unique_ptr<AbstractExecutor> child,
+                           const uint32_t key_attrs[], uint32_t num_keys,
+                           size_t memory_budget /* = DEFAULT_MEMORY_BUDGET*/)
+    : _context(context)
+    , _child(std::move(child))
+    , _key_encoder(MakeKeySchema(_child->GetOutputSchema(), key_attrs, num_keys))
+    , _key_size(_key_encoder.GetKeySize())
+    , _has_varchar_keys(HasVarchar(_key_encoder.GetSchema()))
+    , _exact_key_size(GetExactKeySize(_key_encoder.GetSchema()))
+    , _memory_budget(memory_budget)
+    , _merge(_key_size, [this](const TupleView& row, char* key) {
+        _key_encoder.Encode(row.GetData(), _child->GetOutputSchema(), _key_attrs.data(), key);
+    }, !_has_varchar_keys ? RunMerge::RowLess{} : [this](const char* lhs_key, const TupleView& lhs, const char* rhs_key, const TupleView& rhs) {
+        return RowLess(lhs_key, lhs.GetData(), rhs_key, rhs.GetData());
+    })
+{
+    assert(num_keys > 0 && num_keys <= MAX_COLUMN_COUNT);
+    std::copy(key_attrs, key_attrs + num_keys, _key_attrs.begin());
+}
+
+void SortExecutor::Init()
+{
+    // the cursors release the pages of the runs before the runs give them back
+    _merge.Close();
+    _runs.clear();
+    _num_spilled_runs = 0;
+    _data.clear();
+    _offsets.assign(1, 0);
+    _rids.clear();
+    _keys.clear();
+    _order.clear();
+    _next = 0;
+    _failed = false;
+
+    PagesManager* pages_manager = _context.GetPagesManager();
+    _child->Init();
+    while (!_failed && _child->Next(_child_batch)) {
+        for (const TupleView& row : _child_batch) {
+            AppendRow(row);
+        }
+        if (pages_manager != nullptr && GetMemoryUsage() > _memory_budget) {
+            _failed = !SpillRows();
+        }
+    }
+
+    if (!_failed && _runs.empty()) {
+        SortRows();
+        return;
+    }
+    if (!_failed && !_rids.empty()) {
+        _failed = !SpillRows();
+    }
+    _num_spilled_runs = _runs.size();
+    if (!_failed) {
+        _failed = !_merge.Reduce(_runs, *pages_manager, MAX_MERGE_FAN_IN);
+    }
+    if (_failed) {
+        // the pages of the runs are given back, the sort produces nothing
+        _merge.Close();
+        _runs.clear();
+        return;
+    }
+    _merge.Open(_runs, 0, _runs.size());
+}
+
+bool SortExecutor::Next(std::vector<TupleView>& batch)
+{
+    batch.clear();
+    if (_failed || _child->HasFailed()) {
+        return false;
+    }
+    if (_runs.empty()) {
+        // the rows in the memory are produced as they are
+        const size_t end = std::min(_next + BATCH_SIZE, _order.size());
+        for (; _next < end; _next++) {
+            batch.push_back(GetRow(_order[_next]));
+        }
+        return !batch.empty();
+    }
+
+    _buffer.clear();
+    _buffer_offsets.clear();
+    _buffer_rids.clear();
+    for (const TupleView* row = nullptr; _buffer_rids.size() < BATCH_SIZE && (row = _merge.Top()) != nullptr; _merge.Pop()) {
+        _buffer_offsets.push_back(static_cast<uint32_t>(_buffer.size()));
+        _buffer_rids.push_back(row->GetRID());
+        _buffer.insert(_buffer.end(), row->GetData(), row->GetData() + row->GetLength());
+    }
+    _buffer_offsets.push_back(static_cast<uint32_t>(_buffer.size()));
+    for (size_t i = 0; i < _buffer_rids.size(); i++) {
+        batch.emplace_back(_buffer.data() + _buffer_offsets[i], _buffer_offsets[i + 1] - _buffer_offsets[i], _buffer_rids[i]);
+    }
+    return !batch.empty();
+}
+
+void SortExecutor::AppendRow(const TupleView& row)
+{
+    _data.insert(_data.end(), row.GetData(), row.GetData() + row.GetLength());
+    _offsets.push_back(static_cast<uint32_t>(_data.size()));
+    _rids.push_back(row.GetRID());
+    _keys.resize(_keys.size() + _key_size);
+    _key_encoder.Encode(row.GetData(), _child->GetOutputSchema(), _key_attrs.data(), _keys.data() + _keys.size() - _key_size);
+}
+
+size_t SortExecutor::GetMemoryUsage() const
+{
+    return _data.size() + _keys.size() + _offsets.size() * sizeof(uint32_t)
+            + _rids.size() * (sizeof(RID) + sizeof(uint32_t));
+}
+
+bool SortExecutor::RowLess(const char* lhs_key, const char* lhs_data, const char* rhs_key, const char* rhs_data) const
+{
+    if (!_has_varchar_keys) {
+        return ::memcmp(lhs_key, rhs_key, _key_size) < 0;
+    }
+    // the keys which differ before the end of the first VARCHAR prefix compare as their full values
+    const int cmp = ::memcmp(lhs_key, rhs_key, _exact_key_size);
+    if (cmp != 0) {
+        return cmp < 0;
+    }
+    const Schema& schema = _child->GetOutputSchema();
+    return Tuple::CompareKeys(lhs_data, schema, _key_attrs.data(), rhs_data, schema, _key_attrs.data(),
+                              _key_encoder.GetSchema().GetColumnCount()) < 0;
+}
+
+TupleView SortExecutor::GetRow(uint32_t row) const
+{
+    return TupleView{_data.data() + _offsets[row], _offsets[row + 1] - _offsets[row], _rids[row]};
+}
+
+void SortExecutor::SortRows()
+{
+    const uint32_t num_rows = static_cast<uint32_t>(_rids.size());
+    _order.resize(num_rows);
+    if (num_rows == 0) {
+        return;
+    }
+
+    // each run of keys (and their indices) fits into L2 while it's sorted
+    const uint32_t run_size = static_cast<uint32_t>(
+        std::max<size_t>(1, L2_CACHE_SIZE / (_key_size + sizeof(uint64_t) + 2 * sizeof(uint32_t))));
+    std::vector<uint32_t> positions, ends;
+    for (uint32_t begin = 0; begin < num_rows; begin += run_size) {
+        const uint32_t end = std::min(begin + run_size, num_rows);
+        SortRun(begin, end);
+        positions.push_back(begin);
+        ends.push_back(end);
+    }
+    if (positions.size() == 1) {
+        return;
+    }
+
+    auto less = [&](uint32_t lhs, uint32_t rhs) {
+        if (positions[lhs] == ends[lhs]) {
+            return false;
+        }
+        if (positions[rhs] == ends[rhs]) {
+            return true;
+        }
+        return RowLess(_order[positions[lhs]], _order[positions[rhs]]);
+    };
+    std::vector<uint32_t> merged(num_rows);
+    _loser_tree.Init(static_cast<uint32_t>(positions.size()), less);
+    for (uint32_t i = 0; i < num_rows; i++) {
+        const uint32_t run = _loser_tree.Top();
+        merged[i] = _order[positions[run]++];
+        _loser_tree.Replay(less);
+    }
+    _order.swap(merged);
+}
+
+void SortExecutor::SortRun(uint32_t begin, uint32_t end)
+{
+    const uint32_t num_rows = end - begin;
+    uint32_t* order = _order.data() + begin;
+    if (_key_size > MAX_RADIX_KEY_SIZE || _has_varchar_keys) {
+        std::iota(order, order + num_rows, begin);
+        std::stable_sort(order, order + num_rows, [this](uint32_t lhs, uint32_t rhs) {
+            return RowLess(lhs, rhs);
+        });
+        return;
+    }
+
+    // the normalized key is big-endian, so it's loaded into the integer which compares the same way
+    struct Item
+    {
+        uint64_t key;
+        uint32_t row;
+    };
+    std::vector<Item> items(num_rows), sorted(num_rows);
+    for (uint32_t i = 0; i < num_rows; i++) {
+        const unsigned char* key = reinterpret_cast<const unsigned char*>(GetKey(begin + i));
+        uint64_t value = 0;
+        for (uint32_t b = 0; b < _key_size; b++) {
+            value = (value << 8) | key[b];
+        }
+        items[i] = {value, begin + i};
+    }
+
+    // LSD radix sort by bytes (stable), the byte which is the same in all keys is skipped
+    for (uint32_t shift = 0; shift < _key_size * 8; shift += 8) {
+        std::array<uint32_t, 256> counts{};
+        for (const Item& item : items) {
+            counts[(item.key >> shift) & 0xFF]++;
+        }
+        if (counts[(items[0].key >> shift) & 0xFF] == num_rows) {
+            continue;
+        }
+        uint32_t offset = 0;
+        for (uint32_t& count : counts) {
+            const uint32_t n = count;
+            count = offset;
+            offset += n;
+        }
+        for (const Item& item : items) {
+            sorted[counts[(item.key >> shift) & 0xFF]++] = item;
+        }
+        items.swap(sorted);
+    }
+    for (uint32_t i = 0; i < num_rows; i++) {
+        order[i] = items[i].row;
+    }
+}
+
+bool SortExecutor::SpillRows()
+{
+    SortRows();
+    RowSpill run(*_context.GetPagesManager());
+    for (const uint32_t row : _order) {
+        if (!run.Append(GetRow(row))) {
+            return false;
+        }
+    }
+    if (!run.Finish()) {
+        return false;
+    }
+    _runs.push_back(std::move(run));
+
+    _data.clear();
+    _offsets.assign(1, 0);
+    _rids.clear();
+    _keys.clear();
+    _order.clear();
+    return true;
+}
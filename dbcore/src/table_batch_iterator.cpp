@@ -0,0 +1,61 @@
+#include <dbcore/table_batch_iterator.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/table_page.h>
+
+#include <cassert>
+
+using namespace dbcore;
+
+
+TableBatchIterator::TableBatchIterator(TableHeap &table_heap, page_id_t page_id, const RID& stop_at_rid,
+                                    bool prefetch /* = false*/)
+    : _table_heap(table_heap)
+    , _stop_at_rid(stop_at_rid)
+    , _prefetch(prefetch)
+{
+    LoadPage(page_id);
+}
+
+void TableBatchIterator::Next()
+{
+    // don't check that the iterator is valid in Release build (see TableIterator::Next)
+    assert(!IsEnd());
+    const page_id_t next_page_id = _page_guard.As<TablePage>()->GetNextPageId();
+    LoadPage(next_page_id);
+}
+
+void TableBatchIterator::LoadPage(page_id_t page_id)
+{
+    _batch.clear();
+    while (page_id != INVALID_PAGE_ID) {
+        // the range might stop at the beginning of the next page (see TableHeap::MakePartitionedIterators)
+        if (RID{page_id, 0} == _stop_at_rid) {
+            break;
+        }
+
+        _page_guard = _table_heap._pages_manager.GetPageRead(page_id);
+        const TablePage* page = _page_guard.As<TablePage>();
+        const page_id_t next_page_id = page->GetNextPageId();
+        const bool is_last = page_id == _stop_at_rid.GetPageId();
+        if (_prefetch && !is_last) {
+            // the next page is read from the storage while this one is processed
+            _table_heap._pages_manager.PrefetchPage(next_page_id);
+        }
+
+        const slot_id_t num_tuples = is_last ? _stop_at_rid.GetSlotId() : page->GetNumTuples();
+        for (slot_id_t slot_id = 0; slot_id < num_tuples; slot_id++) {
+            if (!page->IsTupleDeleted(slot_id)) {
+                _batch.push_back(page->GetTupleView(RID{page_id, slot_id}).second);
+            }
+        }
+        if (!_batch.empty()) {
+            return;
+        }
+        if (is_last) {
+            break;
+        }
+        page_id = next_page_id;
+    }
+    _page_guard.Drop();
+}
@@ -1,21 +1,128 @@
 #include <dbcore/table_heap.h>
 #include <dbcore/page_guard.h>
 #include <dbcore/table_page.h>
+#include <dbcore/log_manager.h>
+#include <dbcore/log_record.h>
+#include <dbcore/morsel_scheduler.h>
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <thread>
 
 using namespace dbcore;
 
-TableHeap::TableHeap(PagesManager& pages_manager)
+TableHeap::TableHeap(PagesManager& pages_manager, LogManager* log_manager /* = nullptr*/)
     : _pages_manager(pages_manager)
+    , _log_manager(log_manager)
 {
     page_id_t page_id = INVALID_PAGE_ID;
     // initialize the first table's page
-    auto page_guard = _pages_manager.NextFreePageGuarded(&page_id);
+    auto page_guard = _pages_manager.NextFreePageGuarded(&page_id).UpgradeWrite();
     TablePage* table_page = page_guard.AsMut<TablePage>();
     table_page->Init();
+    _free_space_map.Update(page_id, table_page->GetFreeSpace());
+    if (_log_manager != nullptr) {
+        LogPageChange(LogRecord::TablePageInit(page_id), page_guard);
+    }
     _first_page_id = _last_page_id = page_id;
 }
 
+TableHeap::TableHeap(PagesManager& pages_manager, page_id_t first_page_id, LogManager* log_manager /* = nullptr*/,
+                    page_id_t last_page_id /* = INVALID_PAGE_ID*/)
+    : _pages_manager(pages_manager)
+    , _log_manager(log_manager)
+    , _first_page_id(first_page_id)
+{
+    // the new pages are appended after the last page of the chain,
+    // the free space of the pages on the way (all of them, if the last page is not known) is collected,
+    // the free space of the pages before the known last page is collected by the inserts later
+    if (last_page_id != INVALID_PAGE_ID && last_page_id != first_page_id) {
+        _collect_next_page_id = first_page_id;
+        _collect_end_page_id = last_page_id;
+    }
+    page_id_t page_id = last_page_id != INVALID_PAGE_ID ? last_page_id : first_page_id;
+    while (true) {
+        auto page_guard = _pages_manager.GetPageRead(page_id);
+        const TablePage* page = page_guard.As<TablePage>();
+        assert(page != nullptr);
+        _free_space_map.Update(page_id, page->GetFreeSpace());
+        if (page->GetNextPageId() == INVALID_PAGE_ID) {
+            break;
+        }
+        page_id = page->GetNextPageId();
+    }
+    _last_page_id = page_id;
+}
+
+page_id_t TableHeap::GetLastPageId()
+{
+    std::lock_guard lg(_mutex);
+    return _last_page_id;
+}
+
 RID TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple)
+{
+    const RID rid = InsertIntoFreePage(meta, tuple);
+    if (rid.GetPageId() != INVALID_PAGE_ID) {
+        return rid;
+    }
+    return InsertIntoLastPage(meta, tuple);
+}
+
+RID TableHeap::InsertIntoFreePage(const TupleMeta &meta, const Tuple &tuple)
+{
+    // the inserters of different threads are spread across the pages
+    const size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    // the pages not collected yet are looked at (a few at a time) before the table grows
+    bool collected = false;
+    while (true) {
+        const page_id_t page_id = _free_space_map.FindPage(tuple.GetLength(), hint);
+        if (page_id == INVALID_PAGE_ID) {
+            if (collected || !CollectFreeSpace()) {
+                return RID{};
+            }
+            collected = true;
+            continue;
+        }
+
+        WritePageGuard page_guard = _pages_manager.GetPageWrite(page_id);
+        TablePage* page = page_guard.AsMut<TablePage>();
+        // the page might be filled up by another inserter since it was found,
+        // then its free space is updated and the next page is tried
+        const slot_id_t slot_id = page->InsertTuple(meta, tuple);
+        _free_space_map.Update(page_id, page->GetFreeSpace());
+        if (slot_id != INVALID_SLOT_ID) {
+            if (_log_manager != nullptr) {
+                LogPageChange(LogRecord::TableInsert(RID{page_id, slot_id}, meta, tuple), page_guard);
+            }
+            return RID{page_id, slot_id};
+        }
+    }
+}
+
+bool TableHeap::CollectFreeSpace()
+{
+    std::unique_lock lock(_collect_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || _collect_next_page_id == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    // no other page is latched by the inserter meanwhile
+    for (uint32_t n = 0; n < FSM_COLLECT_PAGES && _collect_next_page_id != _collect_end_page_id; n++) {
+        auto page_guard = _pages_manager.GetPageRead(_collect_next_page_id);
+        const TablePage* page = page_guard.As<TablePage>();
+        assert(page != nullptr);
+        _free_space_map.Update(_collect_next_page_id, page->GetFreeSpace());
+        _collect_next_page_id = page->GetNextPageId();
+    }
+    if (_collect_next_page_id == _collect_end_page_id) {
+        _collect_next_page_id = INVALID_PAGE_ID;
+    }
+    return true;
+}
+
+RID TableHeap::InsertIntoLastPage(const TupleMeta &meta, const Tuple &tuple)
 {
     // only allow one insertion at a time, otherwise it will deadlock.
     std::unique_lock lock(_mutex);
@@ -28,33 +135,99 @@ RID TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple)
         }
 
         page_id_t next_page_id = INVALID_PAGE_ID;
-        PageGuard npg = _pages_manager.NextFreePageGuarded(&next_page_id);
+        WritePageGuard next_page_guard = _pages_manager.NextFreePageGuarded(&next_page_id).UpgradeWrite();
         // TO DO: check that next_page_id != INVALID_PAGE_ID, i.e. the valid page was got
 
-        page->SetNextPageId(next_page_id);
-        TablePage* next_page = npg.AsMut<TablePage>();
+        TablePage* next_page = next_page_guard.AsMut<TablePage>();
         next_page->Init();
+        page->SetNextPageId(next_page_id);
+        if (_log_manager != nullptr) {
+            LogPageChange(LogRecord::TablePageInit(next_page_id), next_page_guard);
+            LogPageChange(LogRecord::TablePageLink(_last_page_id, next_page_id), page_guard);
+        }
 
         // Explicit Drop() is not needed, the moving assign operator will do it.
         /* page_guard.Drop(); */
         _last_page_id = next_page_id;
-        page_guard = npg.UpgradeWrite();
+        page_guard = std::move(next_page_guard);
     }
 
     const page_id_t last_page_id = _last_page_id;
     TablePage* page = page_guard.AsMut<TablePage>();
 
     slot_id_t slot_id = page->InsertTuple(meta, tuple);
+    _free_space_map.Update(last_page_id, page->GetFreeSpace());
     if (slot_id == INVALID_SLOT_ID) {
         return RID{};
     }
 
+    if (_log_manager != nullptr) {
+        LogPageChange(LogRecord::TableInsert(RID{last_page_id, slot_id}, meta, tuple), page_guard);
+    }
+
     // Explicit Drop() is not needed, the d-tor will do it.
     /* page_guard.Drop(); */
 
     return RID{last_page_id, slot_id};
 }
 
+bool TableHeap::MarkDelete(const RID& rid)
+{
+    if (rid.GetPageId() == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    WritePageGuard page_guard = _pages_manager.GetPageWrite(rid.GetPageId());
+    TablePage* page = page_guard.AsMut<TablePage>();
+    if (!page->MarkDelete(rid.GetSlotId())) {
+        return false;
+    }
+    _free_space_map.Update(rid.GetPageId(), page->GetFreeSpace());
+
+    if (_log_manager != nullptr) {
+        LogPageChange(LogRecord::TableDelete(rid), page_guard);
+    }
+    return true;
+}
+
+bool TableHeap::ReleaseSlot(const RID& rid)
+{
+    if (rid.GetPageId() == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    WritePageGuard page_guard = _pages_manager.GetPageWrite(rid.GetPageId());
+    TablePage* page = page_guard.AsMut<TablePage>();
+    if (!page->ReleaseSlot(rid.GetSlotId())) {
+        return false;
+    }
+    _free_space_map.Update(rid.GetPageId(), page->GetFreeSpace());
+
+    if (_log_manager != nullptr) {
+        LogPageChange(LogRecord::TableReleaseSlot(rid), page_guard);
+    }
+    return true;
+}
+
+bool TableHeap::UpdateTupleInPlace(const TupleMeta &meta, const Tuple &tuple, const RID& rid)
+{
+    if (rid.GetPageId() == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    WritePageGuard page_guard = _pages_manager.GetPageWrite(rid.GetPageId());
+    TablePage* page = page_guard.AsMut<TablePage>();
+    if (!page->UpdateTupleInPlace(meta, tuple, rid.GetSlotId())) {
+        return false;
+    }
+    _free_space_map.Update(rid.GetPageId(), page->GetFreeSpace());
+
+    if (_log_manager != nullptr) {
+        LogPageChange(LogRecord::TableUpdate(rid, meta, tuple), page_guard);
+    }
+    return true;
+}
+
 TableIterator TableHeap::MakeIterator()
 {
     page_id_t last_page_id = INVALID_PAGE_ID;
@@ -69,6 +242,119 @@ TableIterator TableHeap::MakeIterator()
     return {*this, {_first_page_id, 0}, {_last_page_id, num_tuples}};
 }
 
+TableBatchIterator TableHeap::MakeBatchIterator(bool prefetch /* = false*/)
+{
+    page_id_t last_page_id = INVALID_PAGE_ID;
+    {
+        std::unique_lock lock(_mutex);
+        last_page_id = _last_page_id;
+    }
+
+    auto page_guard = _pages_manager.GetPageRead(last_page_id);
+    const uint16_t num_tuples = page_guard.As<TablePage>()->GetNumTuples();
+    page_guard.Drop();
+    return {*this, _first_page_id, {last_page_id, num_tuples}, prefetch};
+}
+
+std::vector<page_id_t> TableHeap::CollectPages(RID* stop_at_rid)
+{
+    page_id_t last_page_id = INVALID_PAGE_ID;
+    {
+        std::unique_lock lock(_mutex);
+        last_page_id = _last_page_id;
+    }
+
+    // collect the pages up to the last one, the pages appended later are not scanned
+    std::vector<page_id_t> pages;
+    page_id_t page_id = _first_page_id;
+    while (true) {
+        pages.push_back(page_id);
+        auto page_guard = _pages_manager.GetPageRead(page_id);
+        const TablePage* page = page_guard.As<TablePage>();
+        if (page_id == last_page_id) {
+            *stop_at_rid = RID{last_page_id, page->GetNumTuples()};
+            break;
+        }
+        page_id = page->GetNextPageId();
+        assert(page_id != INVALID_PAGE_ID);
+    }
+    return pages;
+}
+
+std::vector<TableIterator> TableHeap::MakePartitionedIterators(uint32_t max_partitions)
+{
+    assert(max_partitions > 0);
+    RID last_rid;
+    const std::vector<page_id_t> pages = CollectPages(&last_rid);
+
+    const size_t num_partitions = std::min<size_t>(max_partitions, pages.size());
+    std::vector<TableIterator> iterators;
+    iterators.reserve(num_partitions);
+    size_t start = 0;
+    for (size_t i = 0; i < num_partitions; i++) {
+        const size_t num_pages = pages.size() / num_partitions + (i < pages.size() % num_partitions ? 1 : 0);
+        const size_t stop = start + num_pages;
+        const RID stop_at_rid = stop < pages.size() ? RID{pages[stop], 0} : last_rid;
+        iterators.emplace_back(*this, RID{pages[start], 0}, stop_at_rid);
+        start = stop;
+    }
+    return iterators;
+}
+
+void TableHeap::ParallelScan(uint32_t num_threads, const ScanCallback& callback,
+                            uint32_t morsel_size /* = SCAN_MORSEL_SIZE*/)
+{
+    assert(num_threads > 0 && morsel_size > 0);
+    RID last_rid;
+    const std::vector<page_id_t> pages = CollectPages(&last_rid);
+    const uint32_t num_pages = static_cast<uint32_t>(pages.size());
+    const uint32_t num_morsels = (num_pages + morsel_size - 1) / morsel_size;
+    num_threads = std::min(num_threads, num_morsels);
+
+    MorselScheduler scheduler(num_morsels, num_threads);
+    auto scan_morsels = [&](uint32_t worker_id) {
+        uint32_t morsel = 0;
+        while (scheduler.Next(worker_id, &morsel)) {
+            const uint32_t start = morsel * morsel_size;
+            const uint32_t stop = std::min(start + morsel_size, num_pages);
+            const RID stop_at_rid = stop < num_pages ? RID{pages[stop], 0} : last_rid;
+            for (TableBatchIterator itr(*this, pages[start], stop_at_rid, true); !itr.IsEnd(); itr.Next()) {
+                callback(worker_id, itr.GetBatch());
+            }
+        }
+    };
+
+    // the first worker is the calling thread
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (uint32_t i = 1; i < num_threads; i++) {
+        threads.emplace_back(scan_morsels, i);
+    }
+    scan_morsels(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+std::vector<RID> TableHeap::ParallelFilter(uint32_t num_threads, const std::function<bool(const TupleView&)>& predicate)
+{
+    // each worker collects its own RIDs, they are concatenated at the end
+    std::vector<std::vector<RID>> found(num_threads);
+    ParallelScan(num_threads, [&](uint32_t worker_id, const std::vector<TupleView>& batch) {
+        for (const TupleView& tuple : batch) {
+            if (predicate(tuple)) {
+                found[worker_id].push_back(tuple.GetRID());
+            }
+        }
+    });
+
+    std::vector<RID> rids;
+    for (auto& worker_rids : found) {
+        rids.insert(rids.end(), worker_rids.cbegin(), worker_rids.cend());
+    }
+    return rids;
+}
+
 std::pair<TupleMeta, Tuple> TableHeap::GetTuple(const RID& rid) const
 {
     if (rid.GetPageId() == INVALID_PAGE_ID) {
@@ -82,3 +368,23 @@ std::pair<TupleMeta, Tuple> TableHeap::GetTuple(const RID& rid) const
     auto [meta, tuple] = page->GetTuple(rid);
     return std::make_pair(meta, std::move(tuple));
 }
+
+std::pair<TupleMeta, TupleView> TableHeap::GetTupleView(const RID& rid, ReadPageGuard& page_guard) const
+{
+    if (rid.GetPageId() == INVALID_PAGE_ID) {
+        return std::make_pair(TupleMeta{}, TupleView{});
+    }
+
+    if (page_guard.PageId() != rid.GetPageId()) {
+        page_guard = _pages_manager.GetPageRead(rid.GetPageId());
+    }
+    return page_guard.As<TablePage>()->GetTupleView(rid);
+}
+
+void TableHeap::LogPageChange(const LogRecord& record, WritePageGuard& page_guard)
+{
+    assert(_log_manager != nullptr);
+    const lsn_t lsn = _log_manager->Append(record);
+    page_guard.AsMut<TablePage>()->SetLSN(lsn);
+    page_guard.SetLSN(lsn);
+}
@@ -13,19 +13,24 @@ TableIterator::TableIterator(TableHeap &table_heap, const RID& rid, const RID& s
     , _rid(rid)
     , _stop_at_rid(stop_at_rid)
 {
-    // set the END condition when the current RID is not valid for the first page
+    // set the END condition when there is no live tuple in the range
     if (_rid.GetPageId() != INVALID_PAGE_ID) {
-        auto page_guard = _table_heap._pages_manager.GetPageRead(_rid.GetPageId());
-        const TablePage* page = page_guard.As<TablePage>();
-        if (_rid.GetSlotId() >= page->GetNumTuples()) {
-            _rid = RID{INVALID_PAGE_ID, 0};
-        }
+        SeekLive(_rid.GetPageId(), _rid.GetSlotId());
     }
+    // the page is pinned again when the iterator is used (e.g. by its thread of parallel scan)
+    _page_guard.Drop();
 }
 
 std::pair<TupleMeta, Tuple> TableIterator::GetTuple() const
 {
-    return _table_heap.GetTuple(_rid);
+    const auto [meta, view] = GetTupleView();
+    return std::make_pair(meta, view.ToTuple());
+}
+
+std::pair<TupleMeta, TupleView> TableIterator::GetTupleView() const
+{
+    assert(_rid.GetPageId() != INVALID_PAGE_ID);
+    return GetPage()->GetTupleView(_rid);
 }
 
 void TableIterator::Next()
@@ -34,34 +39,55 @@ void TableIterator::Next()
     // assume that client code follow the contract and check precondition (!END) itself.
     assert(_rid.GetPageId() != INVALID_PAGE_ID);
 
-    auto page_guard = _table_heap._pages_manager.GetPageRead(_rid.GetPageId());
-    const TablePage* page = page_guard.As<TablePage>();
-    const uint16_t next_tuple_id = _rid.GetSlotId() + 1;
-
 #ifndef NDEBUG
-    // sanity check
+    // sanity check: the cursor at the page of the stop-tuple is before the stop-tuple
+    // (the pages of the heap are linked in the list, their IDs are not necessarily ascending)
     if (_stop_at_rid.GetPageId() != INVALID_PAGE_ID)
-    {          
-        assert(
-            /* cursor before the page of the stop-tuple */
-            _rid.GetPageId() < _stop_at_rid.GetPageId() ||
-            /* cursor at the page, but before the stop-tuple */
-            (_rid.GetPageId() == _stop_at_rid.GetPageId() && next_tuple_id <= _stop_at_rid.GetSlotId())
-        );
+    {
+        assert(_rid.GetPageId() != _stop_at_rid.GetPageId() || _rid.GetSlotId() < _stop_at_rid.GetSlotId());
     }
 #endif
 
-    _rid = RID{_rid.GetPageId(), next_tuple_id};
-    if (_rid == _stop_at_rid) {
-        _rid = RID{INVALID_PAGE_ID, 0};
-        return;
-    }
+    SeekLive(_rid.GetPageId(), _rid.GetSlotId() + 1);
+}
+
+void TableIterator::SeekLive(page_id_t page_id, slot_id_t slot_id)
+{
+    while (page_id != INVALID_PAGE_ID) {
+        if (_page_guard.PageId() != page_id) {
+            _page_guard = _table_heap._pages_manager.GetPageRead(page_id);
+        }
+        const TablePage* page = _page_guard.As<TablePage>();
+        // the deleted tuples are skipped while the page is latched
+        for (; ; slot_id++) {
+            // the range might stop at the beginning of the next page (see TableHeap::MakePartitionedIterators)
+            if (RID{page_id, slot_id} == _stop_at_rid) {
+                _rid = RID{INVALID_PAGE_ID, 0};
+                _page_guard.Drop();
+                return;
+            }
+            if (slot_id >= page->GetNumTuples()) {
+                break;
+            }
+            if (!page->IsTupleDeleted(slot_id)) {
+                _rid = RID{page_id, slot_id};
+                return;
+            }
+        }
 
-    if (next_tuple_id >= page->GetNumTuples()) {
-        const page_id_t next_page_id = page->GetNextPageId();
         // when no more pages, the next_page_id will be INVALID_PAGE_ID,
         // so the _rid will be assigned the terminal value
-        _rid = RID{next_page_id, 0};
-        return;
+        page_id = page->GetNextPageId();
+        slot_id = 0;
+    }
+    _rid = RID{INVALID_PAGE_ID, 0};
+    _page_guard.Drop();
+}
+
+const TablePage* TableIterator::GetPage() const
+{
+    if (_page_guard.PageId() != _rid.GetPageId()) {
+        _page_guard = _table_heap._pages_manager.GetPageRead(_rid.GetPageId());
     }
+    return _page_guard.As<TablePage>();
 }
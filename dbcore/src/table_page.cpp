@@ -1,5 +1,6 @@
 #include <dbcore/table_page.h>
 
+#include <cassert>
 #include <cstring>
 
 using namespace dbcore;
@@ -7,48 +8,194 @@ using namespace dbcore;
 
 void TablePage::Init()
 {
+    assert(reinterpret_cast<const char*>(_tuple_info) - _page_data == TABLE_PAGE_HEADER_SIZE);
+    _lsn = INVALID_LSN;
     _next_page_id = INVALID_PAGE_ID;
     _num_tuples = 0;
     _num_deleted_tuples = 0;
+    _free_space_offset = PAGE_SIZE;
+    _dead_size = 0;
+    _num_free_slots = 0;
+    _reserved = 0;
+}
+
+uint32_t TablePage::GetContiguousSpace(uint32_t num_slots) const
+{
+    const uint32_t slots_end = TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * num_slots;
+    return _free_space_offset > slots_end ? _free_space_offset - slots_end : 0;
+}
+
+uint32_t TablePage::GetAvailableSpace(uint32_t num_slots) const
+{
+    const uint32_t slots_end = TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * num_slots;
+    const uint32_t tuples_offset = _free_space_offset + _dead_size;
+    return tuples_offset > slots_end ? tuples_offset - slots_end : 0;
+}
+
+uint32_t TablePage::GetFreeSpace() const
+{
+    // the released slot is reused, otherwise the new one is needed
+    return GetAvailableSpace(_num_free_slots > 0 ? _num_tuples : _num_tuples + 1);
 }
 
 slot_offset_t TablePage::GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) const
 {
-    uint32_t slot_end_offset = _num_tuples > 0 ? std::get<0>(_tuple_info[_num_tuples - 1]) : PAGE_SIZE;
-    if (slot_end_offset < tuple.GetLength()) {
+    if (GetFreeSpace() < tuple.GetLength()) {
         return INVALID_SLOT_OFFSET;
     }
 
-    const uint32_t tuple_offset = slot_end_offset - tuple.GetLength();
-    const uint32_t offset_size = TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * (_num_tuples + 1);
-    if (tuple_offset < offset_size) {
-        return INVALID_SLOT_OFFSET;
+    const uint32_t num_slots = _num_free_slots > 0 ? _num_tuples : _num_tuples + 1;
+    if (GetContiguousSpace(num_slots) >= tuple.GetLength()) {
+        return _free_space_offset - tuple.GetLength();
     }
-    return tuple_offset;
+
+    // the tuple is placed after the live tuples once the page is compacted
+    return _free_space_offset + _dead_size - tuple.GetLength();
 }
 
 slot_id_t TablePage::InsertTuple(const TupleMeta &meta, const Tuple &tuple)
 {
+    assert(!meta._is_deleted);
     auto tuple_offset = GetNextTupleOffset(meta, tuple);
     if (tuple_offset == INVALID_SLOT_OFFSET) {
         return INVALID_SLOT_ID;
     }
 
-    const uint16_t tuple_id = _num_tuples;
+    if (tuple_offset != _free_space_offset - tuple.GetLength()) {
+        Compact();
+        assert(tuple_offset == _free_space_offset - tuple.GetLength());
+    }
+
+    uint16_t tuple_id = _num_tuples;
+    if (_num_free_slots > 0) {
+        tuple_id = 0;
+        while (std::get<0>(_tuple_info[tuple_id]) != INVALID_SLOT_OFFSET) {
+            tuple_id++;
+        }
+        assert(tuple_id < _num_tuples);
+        _num_free_slots--;
+        _num_deleted_tuples--;
+    } else {
+        _num_tuples++;
+    }
+
     _tuple_info[tuple_id] = std::make_tuple(tuple_offset, tuple.GetLength(), meta);
     ::memcpy(_page_data + tuple_offset, tuple.GetData(), tuple.GetLength());
-    _num_tuples++;
+    _free_space_offset = tuple_offset;
     return tuple_id;
 }
 
+bool TablePage::MarkDelete(slot_id_t slot_id)
+{
+    if (IsTupleDeleted(slot_id)) {
+        return false;
+    }
+
+    auto& [offset, size, meta] = _tuple_info[slot_id];
+    _dead_size += size;
+    size = 0;
+    meta._is_deleted = true;
+    _num_deleted_tuples++;
+    return true;
+}
+
+bool TablePage::ReleaseSlot(slot_id_t slot_id)
+{
+    if (slot_id >= _num_tuples) {
+        return false;
+    }
+
+    auto& [offset, size, meta] = _tuple_info[slot_id];
+    if (!meta._is_deleted || offset == INVALID_SLOT_OFFSET) {
+        return false;
+    }
+    offset = INVALID_SLOT_OFFSET;
+    _num_free_slots++;
+    return true;
+}
+
+bool TablePage::UpdateTupleInPlace(const TupleMeta &meta, const Tuple &tuple, slot_id_t slot_id)
+{
+    if (IsTupleDeleted(slot_id)) {
+        return false;
+    }
+
+    auto& [offset, size, tuple_meta] = _tuple_info[slot_id];
+    if (tuple.GetLength() <= size) {
+        // the tail of the old data becomes dead
+        _dead_size += size - tuple.GetLength();
+    } else {
+        if (GetAvailableSpace(_num_tuples) + size < tuple.GetLength()) {
+            return false;
+        }
+
+        // the old data becomes dead, the new one is placed into the free space
+        _dead_size += size;
+        size = 0;
+        if (GetContiguousSpace(_num_tuples) < tuple.GetLength()) {
+            Compact();
+        }
+        offset = _free_space_offset - tuple.GetLength();
+        _free_space_offset = offset;
+    }
+
+    size = tuple.GetLength();
+    tuple_meta = meta;
+    ::memcpy(_page_data + offset, tuple.GetData(), tuple.GetLength());
+    return true;
+}
+
+void TablePage::Compact()
+{
+    if (_dead_size == 0) {
+        return;
+    }
+
+    // the tuples are copied in the order of slots, so the page layout depends on its content only
+    char buffer[PAGE_SIZE];
+    uint32_t tuples_offset = PAGE_SIZE;
+    for (uint16_t tuple_id = 0; tuple_id < _num_tuples; tuple_id++) {
+        auto& [offset, size, meta] = _tuple_info[tuple_id];
+        if (meta._is_deleted) {
+            // the tombstone (or released slot) has no data
+            continue;
+        }
+        tuples_offset -= size;
+        ::memcpy(buffer + tuples_offset, _page_data + offset, size);
+        offset = tuples_offset;
+    }
+
+    assert(tuples_offset == _free_space_offset + _dead_size);
+    ::memcpy(_page_data + tuples_offset, buffer + tuples_offset, PAGE_SIZE - tuples_offset);
+    _free_space_offset = tuples_offset;
+    _dead_size = 0;
+}
+
+bool TablePage::IsTupleDeleted(slot_id_t slot_id) const
+{
+    return slot_id >= _num_tuples || std::get<2>(_tuple_info[slot_id])._is_deleted;
+}
+
 std::pair<TupleMeta, Tuple> TablePage::GetTuple(const RID& rid) const
+{
+    const auto [meta, view] = GetTupleView(rid);
+    if (view.GetData() == nullptr) {
+        return std::make_pair(meta, Tuple{});
+    }
+    return std::make_pair(meta, view.ToTuple());
+}
+
+std::pair<TupleMeta, TupleView> TablePage::GetTupleView(const RID& rid) const
 {
     const uint16_t tuple_id = rid.GetSlotId();
     if (tuple_id >= _num_tuples) {
-        return std::make_pair(TupleMeta{}, Tuple{});
+        return std::make_pair(TupleMeta{}, TupleView{});
     }
 
     const auto& [offset, size, meta] = _tuple_info[tuple_id];
-    Tuple tuple(_page_data + offset, size, rid);
-    return std::make_pair(meta, std::move(tuple));
+    if (meta._is_deleted) {
+        // the data of deleted tuple is not available
+        return std::make_pair(meta, TupleView{});
+    }
+    return std::make_pair(meta, TupleView{_page_data + offset, size, rid});
 }
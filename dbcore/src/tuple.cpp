@@ -1,11 +1,41 @@
 #include <dbcore/tuple.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
 
 using namespace dbcore;
 
+namespace
+{
+
+/** The size of null VARCHAR (see value.cpp) */
+constexpr uint32_t NULL_VARCHAR_SIZE = std::numeric_limits<uint32_t>::max();
+
+/** Compare the VARCHAR values of the columns at the given offsets byte by byte, null is the empty string */
+int CompareVarchar(const char* lhs, uint32_t lhs_column_offset, const char* rhs, uint32_t rhs_column_offset)
+{
+    // the column holds the offset of the size and bytes of the value within the tuple
+    uint32_t lhs_offset = 0, rhs_offset = 0, lhs_size = 0, rhs_size = 0;
+    ::memcpy(&lhs_offset, lhs + lhs_column_offset, sizeof(uint32_t));
+    ::memcpy(&rhs_offset, rhs + rhs_column_offset, sizeof(uint32_t));
+    ::memcpy(&lhs_size, lhs + lhs_offset, sizeof(uint32_t));
+    ::memcpy(&rhs_size, rhs + rhs_offset, sizeof(uint32_t));
+    lhs_size = lhs_size == NULL_VARCHAR_SIZE ? 0 : lhs_size;
+    rhs_size = rhs_size == NULL_VARCHAR_SIZE ? 0 : rhs_size;
+
+    const int cmp = ::memcmp(lhs + lhs_offset + sizeof(uint32_t), rhs + rhs_offset + sizeof(uint32_t),
+                             std::min(lhs_size, rhs_size));
+    if (cmp != 0) {
+        return cmp < 0 ? -1 : 1;
+    }
+    return lhs_size < rhs_size ? -1 : (lhs_size > rhs_size ? 1 : 0);
+}
+
+}
+
 Tuple::Tuple(const Value values[], size_t num_values, const Schema &schema)
 {
     assert(num_values == schema.GetColumnCount());
@@ -141,7 +171,11 @@ Tuple& Tuple::operator=(Tuple &&other)
         std::swap(_length, other._length);
         std::swap(_rid, other._rid);
 
-        other = Tuple();
+        // the moved-from tuple releases the old data (assigning Tuple() would recurse here)
+        ::free(other._data);
+        other._data = nullptr;
+        other._length = 0;
+        other._rid = RID{};
     }
     return *this;
 }
@@ -157,6 +191,40 @@ Tuple Tuple::KeyFromTuple(const Schema& schema, const Schema& key_schema,
     return {values, key_attr_count, key_schema};
 }
 
+void Tuple::KeyFromTuple(const char* data, const Schema& schema, const Schema& key_schema,
+            const uint32_t key_attrs[], uint32_t key_attr_count, char* key)
+{
+    for (uint32_t i = 0; i < key_attr_count; i++) {
+        const auto& column = schema.GetColumnAt(key_attrs[i]);
+        const auto& key_column = key_schema.GetColumnAt(i);
+        assert(column.IsInlined() && column.GetType() == key_column.GetType());
+        ::memcpy(key + key_column.GetOffset(), data + column.GetOffset(), key_column.GetStorageSize());
+    }
+}
+
+int Tuple::CompareKeys(const char* lhs, const Schema& lhs_schema, const uint32_t lhs_attrs[],
+            const char* rhs, const Schema& rhs_schema, const uint32_t rhs_attrs[], uint32_t key_attr_count)
+{
+    for (uint32_t i = 0; i < key_attr_count; i++) {
+        const auto& lhs_column = lhs_schema.GetColumnAt(lhs_attrs[i]);
+        const auto& rhs_column = rhs_schema.GetColumnAt(rhs_attrs[i]);
+        assert(lhs_column.GetType() == rhs_column.GetType());
+        int cmp = 0;
+        if (lhs_column.GetType() == TypeId::VARCHAR) {
+            cmp = CompareVarchar(lhs, lhs_column.GetOffset(), rhs, rhs_column.GetOffset());
+        } else {
+            // the values of fixed-width types are not allocated
+            const Value lhs_value = GetValue(lhs_schema, lhs, lhs_attrs[i]);
+            const Value rhs_value = GetValue(rhs_schema, rhs, rhs_attrs[i]);
+            cmp = lhs_value.CompareLt(rhs_value) ? -1 : (lhs_value.CompareGt(rhs_value) ? 1 : 0);
+        }
+        if (cmp != 0) {
+            return cmp;
+        }
+    }
+    return 0;
+}
+
 Value Tuple::GetValue(const Schema& schema, const char* data, uint32_t idx)
 {
     const auto& column = schema.GetColumnAt(idx);
@@ -1,46 +1,118 @@
 #include <dbcore/tuple_compare.h>
+#include <dbcore/key_encoder.h>
 #include <dbcore/tuple.h>
 #include <dbcore/value.h>
 #include <dbcore/type_id.h>
 
+#include <cstring>
 
-// namespace dbcore
-// {
 
-// Value ToValue(const Schema& schema, const char* data, uint32_t idx)
-// {
-//         const auto& column = schema.GetColumnAt(idx);
-//         const TypeId col_type = column.GetType();
-//         if (column.IsInlined()) {
-//             data += column.GetOffset();
-//         } else {
-//             const uint32_t offset = *reinterpret_cast<uint32_t *>(const_cast<char *>(data + column.GetOffset()));
-//             data += offset;
-//         }
+using namespace dbcore;
 
-//         return Value::DeserializeFrom(data, col_type);
-// }
 
-// }
+TupleCompare::TupleCompare(const Schema& schema)
+    : _schema(schema)
+{
+    const uint32_t col_count = _schema.GetColumnCount();
 
+    bool fixed_width = col_count > 0;
+    for (uint32_t i = 0; i < col_count; i++) {
+        const Column& column = _schema.GetColumnAt(i);
+        _column_offsets[i] = column.GetOffset();
+        _column_compare[i] = column.IsInlined() ? ColumnCompareFunction(column.GetType()) : nullptr;
+        if (_column_compare[i] == nullptr) {
+            fixed_width = false;
+        }
+    }
 
-using namespace dbcore;
+    if (!fixed_width) {
+        _compare = &TupleCompare::CompareGeneric;
+        return;
+    }
 
+    if (col_count > 1) {
+        _compare = &TupleCompare::CompareFixedWidth;
+        return;
+    }
 
-TupleCompare::TupleCompare(const Schema& schema)
-    : _schema(schema)
+    _offset = _column_offsets[0];
+    switch (_schema.GetColumnAt(0).GetType())
+    {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+        _compare = &TupleCompare::CompareSingleColumn<int8_t>;
+        break;
+    case TypeId::SMALLINT:
+        _compare = &TupleCompare::CompareSingleColumn<int16_t>;
+        break;
+    case TypeId::INTEGER:
+        _compare = &TupleCompare::CompareSingleColumn<int32_t>;
+        break;
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:   // the decimal is stored as 64-bit integer
+        _compare = &TupleCompare::CompareSingleColumn<int64_t>;
+        break;
+    case TypeId::TIMESTAMP:
+        _compare = &TupleCompare::CompareSingleColumn<uint64_t>;
+        break;
+    default:
+        _compare = &TupleCompare::CompareGeneric;
+        break;
+    }
+}
+
+TupleCompare::TupleCompare(const KeyEncoder& key_encoder)
+    : _schema(key_encoder.GetSchema())
+    , _compare(&TupleCompare::CompareNormalized)
+    , _normalized_key_size(key_encoder.GetKeySize())
 {
 
 }
 
-int TupleCompare::operator()(const char* lhs, const char* rhs) const
+template <typename T>
+int TupleCompare::CompareNative(const char* lhs, const char* rhs)
+{
+    // the values might be unaligned within the tuple
+    T lhs_value, rhs_value;
+    ::memcpy(&lhs_value, lhs, sizeof(T));
+    ::memcpy(&rhs_value, rhs, sizeof(T));
+    return (lhs_value > rhs_value) - (lhs_value < rhs_value);
+}
+
+template <typename T>
+int TupleCompare::CompareSingleColumn(const TupleCompare& self, const char* lhs, const char* rhs)
+{
+    return CompareNative<T>(lhs + self._offset, rhs + self._offset);
+}
+
+int TupleCompare::CompareFixedWidth(const TupleCompare& self, const char* lhs, const char* rhs)
+{
+    const uint32_t col_count = self._schema.GetColumnCount();
+    for (uint32_t i = 0; i < col_count; i++) {
+        const uint32_t offset = self._column_offsets[i];
+        const int result = self._column_compare[i](lhs + offset, rhs + offset);
+        if (result != 0) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+int TupleCompare::CompareNormalized(const TupleCompare& self, const char* lhs, const char* rhs)
+{
+    const int result = ::memcmp(lhs, rhs, self._normalized_key_size);
+    return (result > 0) - (result < 0);
+}
+
+int TupleCompare::CompareGeneric(const TupleCompare& self, const char* lhs, const char* rhs)
 {
     // TO DO: check case when one or both values are null
     // It might be needed redesign the interface and usage of this class
-    const uint32_t col_count = _schema.GetColumnCount();
+    const Schema& schema = self._schema;
+    const uint32_t col_count = schema.GetColumnCount();
     for (uint32_t i = 0; i < col_count; i++) {
-        const Value lhs_value = Tuple::GetValue(_schema, lhs, i);
-        const Value rhs_value = Tuple::GetValue(_schema, rhs, i);
+        const Value lhs_value = Tuple::GetValue(schema, lhs, i);
+        const Value rhs_value = Tuple::GetValue(schema, rhs, i);
         if (lhs_value.CompareLt(rhs_value)) {
             return -1;
         }
@@ -50,3 +122,24 @@ int TupleCompare::operator()(const char* lhs, const char* rhs) const
     }
     return 0;
 }
+
+TupleCompare::column_compare_function_t TupleCompare::ColumnCompareFunction(TypeId type)
+{
+    switch (type)
+    {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+        return &TupleCompare::CompareNative<int8_t>;
+    case TypeId::SMALLINT:
+        return &TupleCompare::CompareNative<int16_t>;
+    case TypeId::INTEGER:
+        return &TupleCompare::CompareNative<int32_t>;
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+        return &TupleCompare::CompareNative<int64_t>;
+    case TypeId::TIMESTAMP:
+        return &TupleCompare::CompareNative<uint64_t>;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,14 @@
+#include <dbcore/tuple_view.h>
+
+using namespace dbcore;
+
+Tuple TupleView::KeyFromTuple(const Schema& schema, const Schema& key_schema,
+            const std::array<uint32_t, MAX_COLUMN_COUNT>& key_attrs, uint32_t key_attr_count) const
+{
+    std::array<Value, MAX_COLUMN_COUNT> values;
+    for (uint32_t i = 0; i < key_attr_count; i++) {
+        values[i] = GetValue(schema, key_attrs[i]);
+    }
+
+    return {values, key_attr_count, key_schema};
+}
@@ -0,0 +1,21 @@
+#include <dbcore/values_executor.h>
+
+#include <algorithm>
+
+using namespace dbcore;
+
+ValuesExecutor::ValuesExecutor(const Schema& schema, std::vector<Tuple> tuples)
+    : _schema(schema)
+    , _tuples(std::move(tuples))
+{
+}
+
+bool ValuesExecutor::Next(std::vector<TupleView>& batch)
+{
+    batch.clear();
+    const size_t end = std::min(_tuples.size(), _next + BATCH_SIZE);
+    for (; _next < end; _next++) {
+        batch.emplace_back(_tuples[_next]);
+    }
+    return !batch.empty();
+}
@@ -0,0 +1,198 @@
+#include <dbcore/vector_predicate.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+using namespace dbcore;
+
+namespace
+{
+
+/** The number of values compared at once by the kernel (the results fit into L1 along with the values) */
+constexpr uint32_t KERNEL_CHUNK_SIZE = 1024;
+
+/**
+ * The compare kernel: the comparison results of each 64 values are packed into the word.
+ * The values of the chunk are compared into the byte array first: that loop has no branches and
+ * no dependencies across the values, so the optimizer vectorizes it (e.g. GCC 12 at -O3;
+ * the comparisons of 64-bit values need SSE4.2 on x86-64, e.g. -march=x86-64-v2).
+ * The bytes are packed into the words by the separate loop (the shifts by the variable amount
+ * into the same word would keep the comparison loop scalar).
+*/
+template <typename T, typename Op>
+void CompareKernel(const T* values, uint32_t num_values, T constant, uint64_t* words, bool intersect)
+{
+    const Op op;
+    uint8_t results[KERNEL_CHUNK_SIZE];
+    for (uint32_t chunk = 0; chunk < num_values; chunk += KERNEL_CHUNK_SIZE) {
+        const uint32_t chunk_size = std::min(KERNEL_CHUNK_SIZE, num_values - chunk);
+        const T* chunk_values = values + chunk;
+        for (uint32_t i = 0; i < chunk_size; i++) {
+            results[i] = op(chunk_values[i], constant);
+        }
+
+        for (uint32_t base = 0; base < chunk_size; base += 64) {
+            const uint32_t count = std::min<uint32_t>(64, chunk_size - base);
+            uint64_t word = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                word |= static_cast<uint64_t>(results[base + i]) << i;
+            }
+            const uint32_t w = (chunk + base) / 64;
+            words[w] = intersect ? words[w] & word : word;
+        }
+    }
+}
+
+template <typename T>
+void CompareValues(const T* values, uint32_t num_values, CompareOp op, const char* constant,
+                   uint64_t* words, bool intersect)
+{
+    T value;
+    ::memcpy(&value, constant, sizeof(T));
+    switch (op)
+    {
+    case CompareOp::EQ:
+        CompareKernel<T, std::equal_to<T>>(values, num_values, value, words, intersect);
+        break;
+    case CompareOp::NE:
+        CompareKernel<T, std::not_equal_to<T>>(values, num_values, value, words, intersect);
+        break;
+    case CompareOp::LT:
+        CompareKernel<T, std::less<T>>(values, num_values, value, words, intersect);
+        break;
+    case CompareOp::LE:
+        CompareKernel<T, std::less_equal<T>>(values, num_values, value, words, intersect);
+        break;
+    case CompareOp::GT:
+        CompareKernel<T, std::greater<T>>(values, num_values, value, words, intersect);
+        break;
+    case CompareOp::GE:
+        CompareKernel<T, std::greater_equal<T>>(values, num_values, value, words, intersect);
+        break;
+    }
+}
+
+constexpr uint32_t NULL_VARCHAR_SIZE = std::numeric_limits<uint32_t>::max();
+
+}
+
+VectorPredicate::VectorPredicate(const Schema& schema)
+    : _schema(schema)
+{
+}
+
+bool VectorPredicate::AddComparison(uint32_t column_idx, CompareOp op, const Value& constant)
+{
+    if (column_idx >= _schema.GetColumnCount()) {
+        return false;
+    }
+    const Column& column = _schema.GetColumnAt(column_idx);
+    if (constant.GetTypeId() != column.GetType()) {
+        return false;
+    }
+    if (!column.IsInlined()) {
+        if (column.GetType() != TypeId::VARCHAR || (op != CompareOp::EQ && op != CompareOp::NE)) {
+            return false;
+        }
+    } else if (!ColumnVector::IsSupported(column)) {
+        return false;
+    }
+
+    Comparison comparison;
+    comparison._column_idx = column_idx;
+    comparison._op = op;
+    const uint32_t size = column.IsInlined() ? column.GetStorageSize()
+                                             : static_cast<uint32_t>(sizeof(uint32_t)) + constant.GetStorageSize();
+    comparison._constant.resize(size);
+    constant.SerializeTo(comparison._constant.data());
+    _comparisons.push_back(std::move(comparison));
+    return true;
+}
+
+void VectorPredicate::Evaluate(const TupleView rows[], uint32_t num_rows, SelectionBitmap* selection)
+{
+    assert(selection != nullptr);
+    selection->Reset(num_rows, _comparisons.empty());
+    bool intersect = false;
+    for (const Comparison& comparison : _comparisons) {
+        if (intersect && selection->IsEmpty()) {
+            break;
+        }
+        const Column& column = _schema.GetColumnAt(comparison._column_idx);
+        if (column.IsInlined()) {
+            _column.Load(column, rows, num_rows);
+            CompareColumn(comparison, selection, intersect);
+        } else {
+            CompareVarchar(comparison, rows, selection, intersect);
+        }
+        intersect = true;
+    }
+}
+
+void VectorPredicate::CompareColumn(const Comparison& comparison, SelectionBitmap* selection, bool intersect) const
+{
+    const uint32_t num_values = _column.GetSize();
+    const char* constant = comparison._constant.data();
+    uint64_t* words = selection->GetWords();
+    switch (_column.GetType())
+    {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+        CompareValues(_column.GetData<int8_t>(), num_values, comparison._op, constant, words, intersect);
+        break;
+    case TypeId::SMALLINT:
+        CompareValues(_column.GetData<int16_t>(), num_values, comparison._op, constant, words, intersect);
+        break;
+    case TypeId::INTEGER:
+        CompareValues(_column.GetData<int32_t>(), num_values, comparison._op, constant, words, intersect);
+        break;
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+        CompareValues(_column.GetData<int64_t>(), num_values, comparison._op, constant, words, intersect);
+        break;
+    case TypeId::TIMESTAMP:
+        CompareValues(_column.GetData<uint64_t>(), num_values, comparison._op, constant, words, intersect);
+        break;
+    default:
+        assert(false);
+    }
+}
+
+void VectorPredicate::CompareVarchar(const Comparison& comparison, const TupleView rows[], SelectionBitmap* selection,
+                                     bool intersect) const
+{
+    const uint32_t offset = _schema.GetColumnAt(comparison._column_idx).GetOffset();
+    uint32_t constant_size = 0;
+    ::memcpy(&constant_size, comparison._constant.data(), sizeof(uint32_t));
+    const char* constant = comparison._constant.data() + sizeof(uint32_t);
+    const bool equal = comparison._op == CompareOp::EQ;
+
+    auto matches = [&](uint32_t row) {
+        // the column holds the offset of the size and bytes of the value within the tuple
+        const char* data = rows[row].GetData();
+        uint32_t value_offset = 0, size = 0;
+        ::memcpy(&value_offset, data + offset, sizeof(uint32_t));
+        ::memcpy(&size, data + value_offset, sizeof(uint32_t));
+        if (size == NULL_VARCHAR_SIZE || constant_size == NULL_VARCHAR_SIZE) {
+            return false;
+        }
+        const bool same = size == constant_size && ::memcmp(data + value_offset + sizeof(uint32_t), constant, size) == 0;
+        return same == equal;
+    };
+
+    // only the rows which are still selected are compared
+    if (intersect) {
+        selection->ForEachSelected([&](uint32_t row) {
+            if (!matches(row)) {
+                selection->Select(row, false);
+            }
+        });
+        return;
+    }
+    for (uint32_t row = 0; row < selection->GetNumRows(); row++) {
+        selection->Select(row, matches(row));
+    }
+}
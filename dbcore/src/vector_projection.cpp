@@ -0,0 +1,74 @@
+#include <dbcore/vector_projection.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace dbcore;
+
+namespace
+{
+
+Schema MakeOutputSchema(const Schema& schema, const uint32_t attrs[], uint32_t num_attrs)
+{
+    std::array<uint32_t, MAX_COLUMN_COUNT> copy;
+    std::copy(attrs, attrs + num_attrs, copy.begin());
+    return Schema::CopySchema(schema, copy.data(), num_attrs);
+}
+
+}
+
+VectorProjection::VectorProjection(const Schema& schema, const uint32_t attrs[], uint32_t num_attrs)
+    : _num_attrs(num_attrs)
+    , _schema(schema)
+    , _output_schema(MakeOutputSchema(schema, attrs, num_attrs))
+    , _columns(num_attrs)
+{
+    assert(IsSupported(schema, attrs, num_attrs));
+    std::copy(attrs, attrs + num_attrs, _attrs.begin());
+}
+
+bool VectorProjection::IsSupported(const Schema& schema, const uint32_t attrs[], uint32_t num_attrs)
+{
+    if (num_attrs == 0 || num_attrs > MAX_COLUMN_COUNT) {
+        return false;
+    }
+    for (uint32_t i = 0; i < num_attrs; i++) {
+        if (attrs[i] >= schema.GetColumnCount() || !ColumnVector::IsSupported(schema.GetColumnAt(attrs[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void VectorProjection::Project(const TupleView rows[], const SelectionBitmap& selection)
+{
+    for (uint32_t i = 0; i < _num_attrs; i++) {
+        _columns[i].Gather(_schema.GetColumnAt(_attrs[i]), rows, selection);
+    }
+    _num_rows = _columns[0].GetSize();
+
+    _rids.clear();
+    selection.ForEachSelected([&](uint32_t row) { _rids.push_back(rows[row].GetRID()); });
+}
+
+const std::vector<TupleView>& VectorProjection::MaterializeRows()
+{
+    const uint32_t row_size = _output_schema.GetInlinedStorageSize();
+    _buffer.resize(static_cast<size_t>(row_size) * _num_rows);
+    for (uint32_t i = 0; i < _num_attrs; i++) {
+        const Column& column = _output_schema.GetColumnAt(i);
+        const uint32_t value_size = column.GetStorageSize();
+        const char* values = _columns[i].GetRawData();
+        char* dst = _buffer.data() + column.GetOffset();
+        for (uint32_t row = 0; row < _num_rows; row++, dst += row_size) {
+            ::memcpy(dst, values + static_cast<size_t>(row) * value_size, value_size);
+        }
+    }
+
+    _rows.clear();
+    for (uint32_t row = 0; row < _num_rows; row++) {
+        _rows.emplace_back(_buffer.data() + static_cast<size_t>(row) * row_size, row_size, _rids[row]);
+    }
+    return _rows;
+}
@@ -0,0 +1,257 @@
+#include <dbcore/b_plus_tree.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/coretypes.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/tuple_compare.h>
+#include <dbcore/key_encoder.h>
+#include <dbcore/index.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/rid.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <iostream>
+
+using namespace dbcore;
+
+namespace
+{
+
+/** The normalized BIGINT keys and values for the tree */
+struct Entries
+{
+    Entries(const KeyEncoder& encoder, const Schema& schema, const std::vector<int64_t>& values)
+    {
+        keys.resize(values.size() * encoder.GetKeySize());
+        for (size_t i = 0; i < values.size(); i++) {
+            keys_at.push_back(i * encoder.GetKeySize());
+            Value v[] = { Value{TypeId::BIGINT, values[i]} };
+            const Tuple tuple{v, 1, schema};
+            encoder.Encode(tuple.GetData(), keys.data() + keys_at[i]);
+            rids.emplace_back(static_cast<page_id_t>(values[i]), 0);
+        }
+    }
+
+    const char* KeyAt(size_t i) const { return keys.data() + keys_at[i]; }
+
+    std::vector<char> keys;
+    std::vector<size_t> keys_at;
+    std::vector<RID> rids;
+};
+
+std::vector<int64_t> EvenNumbers(int64_t count)
+{
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < count; i++)
+        values.push_back(2 * i);
+    return values;
+}
+
+}
+
+TEST(BPlusTreeBulkLoadTests, BulkLoadTest)
+{
+    Column cols[] = { Column{"a", TypeId::BIGINT} };
+    Schema schema{cols, 1};
+    KeyEncoder encoder(schema);
+    TupleCompare key_cmp(encoder);
+
+    const int64_t counts[] = { 0, 1, 2, 3, 7, 100, 2000 };
+    const float fill_factors[] = { 1.0f, 0.7f, 0.5f };
+    const uint16_t page_sizes[][2] = { {3, 4}, {5, 3}, {0, 0} };   // {leaf, internal}, 0 means default
+
+    for (const int64_t count : counts) {
+        for (const float fill_factor : fill_factors) {
+            for (const auto& page_size : page_sizes) {
+                constexpr uint32_t num_of_pages = 5000;
+                PagesManager pages_manager(num_of_pages);
+                BPlusTree bplus_tree(pages_manager, key_cmp, encoder.GetKeySize(), page_size[0], page_size[1]);
+
+                const std::vector<int64_t> values = EvenNumbers(count);
+                const Entries entries(encoder, schema, values);
+                ASSERT_TRUE(bplus_tree.BulkLoad(entries.keys.data(), entries.rids.data(), count, fill_factor));
+
+                for (int64_t i = 0; i < count; i++) {
+                    RID rid;
+                    ASSERT_TRUE(bplus_tree.GetValue(entries.KeyAt(i), rid));
+                    EXPECT_EQ(rid, entries.rids[i]);
+                }
+
+                int64_t num_iterated = 0;
+                for (auto it = bplus_tree.Begin(); it != bplus_tree.End() && num_iterated <= count; ++it) {
+                    EXPECT_EQ(*it, entries.rids[num_iterated]);
+                    num_iterated++;
+                }
+                EXPECT_EQ(num_iterated, count);
+
+                // the tree built bottom-up keeps working with regular inserts and removes
+                std::vector<int64_t> odd_values;
+                for (auto v : values)
+                    odd_values.push_back(v + 1);
+                const Entries odd_entries(encoder, schema, odd_values);
+                for (int64_t i = 0; i < count; i++) {
+                    ASSERT_TRUE(bplus_tree.Insert(odd_entries.KeyAt(i), odd_entries.rids[i]));
+                }
+                for (int64_t i = 0; i < count; i++) {
+                    bplus_tree.Remove(entries.KeyAt(i));
+                }
+
+                num_iterated = 0;
+                for (auto it = bplus_tree.Begin(); it != bplus_tree.End() && num_iterated <= count; ++it) {
+                    EXPECT_EQ(*it, odd_entries.rids[num_iterated]);
+                    num_iterated++;
+                }
+                EXPECT_EQ(num_iterated, count);
+            }
+        }
+    }
+}
+
+TEST(BPlusTreeBulkLoadTests, RejectTest)
+{
+    constexpr uint32_t num_of_pages = 100;
+    PagesManager pages_manager(num_of_pages);
+
+    Column cols[] = { Column{"a", TypeId::BIGINT} };
+    Schema schema{cols, 1};
+    KeyEncoder encoder(schema);
+    TupleCompare key_cmp(encoder);
+    BPlusTree bplus_tree(pages_manager, key_cmp, encoder.GetKeySize(), 3, 4);
+
+    // not sorted
+    const Entries unsorted(encoder, schema, {1, 3, 2});
+    EXPECT_FALSE(bplus_tree.BulkLoad(unsorted.keys.data(), unsorted.rids.data(), 3));
+    // duplicated
+    const Entries duplicated(encoder, schema, {1, 2, 2});
+    EXPECT_FALSE(bplus_tree.BulkLoad(duplicated.keys.data(), duplicated.rids.data(), 3));
+    EXPECT_TRUE(bplus_tree.Begin() == bplus_tree.End());
+
+    // not empty
+    const Entries sorted(encoder, schema, {1, 2, 3});
+    ASSERT_TRUE(bplus_tree.Insert(sorted.KeyAt(0), sorted.rids[0]));
+    EXPECT_FALSE(bplus_tree.BulkLoad(sorted.keys.data(), sorted.rids.data(), 3));
+}
+
+TEST(BPlusTreeBulkLoadTests, OutOfPagesTest)
+{
+    // there are too few pages to build the tree, the tree remains empty and usable
+    constexpr uint32_t num_of_pages = 10;
+    PagesManager pages_manager(num_of_pages);
+
+    Column cols[] = { Column{"a", TypeId::BIGINT} };
+    Schema schema{cols, 1};
+    KeyEncoder encoder(schema);
+    TupleCompare key_cmp(encoder);
+    BPlusTree bplus_tree(pages_manager, key_cmp, encoder.GetKeySize(), 3, 4);
+
+    const Entries entries(encoder, schema, EvenNumbers(100));
+    EXPECT_FALSE(bplus_tree.BulkLoad(entries.keys.data(), entries.rids.data(), 100));
+    EXPECT_TRUE(bplus_tree.Begin() == bplus_tree.End());
+
+    EXPECT_TRUE(bplus_tree.BulkLoad(entries.keys.data(), entries.rids.data(), 9));
+    for (int64_t i = 0; i < 9; i++) {
+        RID rid;
+        ASSERT_TRUE(bplus_tree.GetValue(entries.KeyAt(i), rid));
+        EXPECT_EQ(rid, entries.rids[i]);
+    }
+}
+
+TEST(BPlusTreeBulkLoadTests, IndexPopulateTest)
+{
+    constexpr uint32_t num_of_pages = 4000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column tbl_cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema tbl_schema{tbl_cols, 2};
+    TableHeap table_heap(pages_manager);
+
+    // the keys are shuffled and some of them are duplicated
+    constexpr int32_t num_rows = 20000;
+    std::vector<int64_t> keys;
+    for (int64_t i = 0; i < num_rows; i++)
+        keys.push_back(i % (num_rows / 2) - num_rows / 4);
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+
+    std::vector<RID> rids;
+    for (int32_t i = 0; i < num_rows; i++) {
+        Value values[] = { Value{TypeId::INTEGER, i}, Value{TypeId::BIGINT, keys[i]} };
+        const Tuple tuple{values, 2, tbl_schema};
+        rids.push_back(table_heap.InsertTuple(TupleMeta{0, false}, tuple));
+    }
+
+    uint32_t key_attrs[] = { 1 };
+    Schema key_schema{Schema::CopySchema(tbl_schema, key_attrs, 1)};
+    IndexMetadata metadata(key_attrs, 1, key_schema, tbl_schema);
+
+    // the small budget makes the keys spilled into many runs, which are merged in a number of passes
+    for (const auto& [num_threads, memory_budget] : { std::pair<uint32_t, size_t>{1, Index::DEFAULT_POPULATE_MEMORY_BUDGET},
+                                                     {4, Index::DEFAULT_POPULATE_MEMORY_BUDGET},
+                                                     {1, 16 * 1024}, {4, 16 * 1024} }) {
+        Index index(IndexType::BPlusTreeIndex, metadata, pages_manager);
+
+        const auto start = std::chrono::steady_clock::now();
+        // the duplicates are not indexed
+        EXPECT_FALSE(index.Populate(table_heap, num_threads, memory_budget));
+        const auto finish = std::chrono::steady_clock::now();
+        std::cout << " populate index of " << num_rows << " rows by " << num_threads << " threads, memory budget "
+                << memory_budget << ": " << std::chrono::duration<double, std::milli>(finish - start).count()
+                << " ms" << std::endl;
+
+        // the first row of each key is indexed, as if the rows were inserted one by one
+        std::vector<bool> seen(num_rows / 2, false);
+        for (int32_t i = 0; i < num_rows; i++) {
+            Value values[] = { Value{TypeId::INTEGER, 0}, Value{TypeId::BIGINT, keys[i]} };
+            const Tuple tuple{values, 2, tbl_schema};
+            RID rid;
+            ASSERT_TRUE(index.SearchEntry(tuple, &rid));
+            const size_t k = keys[i] + num_rows / 4;
+            if (!seen[k]) {
+                EXPECT_EQ(rid, rids[i]);
+                seen[k] = true;
+            }
+        }
+    }
+}
+
+TEST(BPlusTreeBulkLoadTests, HashIndexPopulateTest)
+{
+    constexpr uint32_t num_of_pages = 2000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column tbl_cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema tbl_schema{tbl_cols, 2};
+    TableHeap table_heap(pages_manager);
+
+    constexpr int32_t num_rows = 2000;
+    std::vector<RID> rids;
+    for (int32_t i = 0; i < num_rows; i++) {
+        Value values[] = { Value{TypeId::INTEGER, i}, Value{TypeId::BIGINT, static_cast<int64_t>(i)} };
+        const Tuple tuple{values, 2, tbl_schema};
+        rids.push_back(table_heap.InsertTuple(TupleMeta{0, false}, tuple));
+    }
+
+    uint32_t key_attrs[] = { 0 };
+    Schema key_schema{Schema::CopySchema(tbl_schema, key_attrs, 1)};
+    IndexMetadata metadata(key_attrs, 1, key_schema, tbl_schema);
+    Index index(IndexType::HashTableIndex, metadata, pages_manager);
+
+    EXPECT_TRUE(index.Populate(table_heap, 4));
+
+    for (int32_t i = 0; i < num_rows; i++) {
+        Value values[] = { Value{TypeId::INTEGER, i}, Value{TypeId::BIGINT, static_cast<int64_t>(0)} };
+        const Tuple tuple{values, 2, tbl_schema};
+        RID rid;
+        ASSERT_TRUE(index.SearchEntry(tuple, &rid));
+        EXPECT_EQ(rid, rids[i]);
+    }
+}
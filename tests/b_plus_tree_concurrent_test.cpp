@@ -16,6 +16,8 @@
 #include <random>
 #include <thread>
 
+#include <iostream>
+
 
 // #include <fstream>
 // #include <iostream>
@@ -439,3 +441,108 @@ TEST(BPlusTreeConcurrentTest, MixTest2)
 
     ASSERT_EQ(size, persistent_keys.size());
 }
+
+TEST(BPlusTreeConcurrentTest, MixTest3)
+{
+    // many keys and small nodes, so that splits and merges happen concurrently at all levels
+    constexpr uint32_t num_of_pages = 3000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column key_column{"a", TypeId::BIGINT};
+    Column cols[] = { key_column };
+    Schema schema{cols, 1};
+    constexpr uint16_t key_size = 8;    // size of bigint
+
+    TupleCompare key_cmp(schema);
+
+    const uint16_t leaf_max_size = 3;
+    const uint16_t internal_max_size = 4;
+    BPlusTree bplus_tree(pages_manager, key_cmp, key_size, leaf_max_size, internal_max_size);
+
+    std::vector<uint16_t> keys;
+    std::vector<uint16_t> odd_keys;
+    constexpr uint16_t keys_count = 4000;
+    for (uint16_t k = 1; k <= keys_count; k++) {
+        keys.push_back(k);
+        if (k % 2 == 1)
+            odd_keys.push_back(k);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+
+    constexpr uint8_t num_threads = 4;
+    LaunchParallelTest(num_threads, InsertHelperSplit, &bplus_tree, keys, num_threads);
+    LaunchParallelTest(num_threads, DeleteHelperSplit, &bplus_tree, odd_keys, num_threads);
+
+    uint16_t current_key = 2;
+    auto itr = bplus_tree.Begin();
+    for (; itr != bplus_tree.End(); ++itr) {
+        const RID rid{*itr};
+        ASSERT_EQ(rid.GetSlotId(), current_key);
+        current_key += 2;
+    }
+    EXPECT_EQ(current_key, keys_count + 2);
+
+    // remove the rest keys, the tree should become empty
+    std::vector<uint16_t> even_keys;
+    for (uint16_t k = 2; k <= keys_count; k += 2)
+        even_keys.push_back(k);
+    LaunchParallelTest(num_threads, DeleteHelperSplit, &bplus_tree, even_keys, num_threads);
+    EXPECT_TRUE(bplus_tree.Begin() == bplus_tree.End());
+}
+
+TEST(BPlusTreeConcurrentTest, ThroughputTest)
+{
+    /* Each thread inserts and then looks up its own range of keys.
+     Print the number of operations per second for the different number of threads. */
+    constexpr uint32_t num_of_pages = 2000;
+    constexpr uint32_t keys_per_thread = 50000;
+    const uint8_t max_threads = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+
+    Column key_column{"a", TypeId::BIGINT};
+    Column cols[] = { key_column };
+    Schema schema{cols, 1};
+    constexpr uint16_t key_size = 8;    // size of bigint
+
+    TupleCompare key_cmp(schema);
+
+    for (uint8_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        PagesManager pages_manager(num_of_pages);
+        BPlusTree bplus_tree(pages_manager, key_cmp, key_size);
+
+        auto insert_job = [&](uint8_t thread_idx) {
+            for (uint32_t i = 0; i < keys_per_thread; i++) {
+                const uint32_t k = i * num_threads + thread_idx;
+                Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(k)} };
+                Tuple tuple{values, 1, schema};
+                ASSERT_TRUE(bplus_tree.Insert(tuple.GetData(), RID(k, k)));
+            }
+        };
+
+        auto lookup_job = [&](uint8_t thread_idx) {
+            for (uint32_t i = 0; i < keys_per_thread; i++) {
+                const uint32_t k = i * num_threads + thread_idx;
+                Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(k)} };
+                Tuple tuple{values, 1, schema};
+                RID rid;
+                ASSERT_TRUE(bplus_tree.GetValue(tuple.GetData(), rid));
+                ASSERT_EQ(rid, RID(k, k));
+            }
+        };
+
+        const uint64_t num_ops = static_cast<uint64_t>(keys_per_thread) * num_threads;
+
+        auto start = std::chrono::steady_clock::now();
+        LaunchParallelTest(num_threads, insert_job);
+        auto finish = std::chrono::steady_clock::now();
+        const double insert_secs = std::chrono::duration<double>(finish - start).count();
+
+        start = std::chrono::steady_clock::now();
+        LaunchParallelTest(num_threads, lookup_job);
+        finish = std::chrono::steady_clock::now();
+        const double lookup_secs = std::chrono::duration<double>(finish - start).count();
+
+        std::cout << " threads: " << static_cast<int>(num_threads)
+            << "\tinsert: " << static_cast<uint64_t>(num_ops / insert_secs) << " ops/sec"
+            << "\tlookup: " << static_cast<uint64_t>(num_ops / lookup_secs) << " ops/sec" << std::endl;
+    }
+}
@@ -1,8 +1,10 @@
 #include <dbcore/b_plus_tree.h>
 #include <dbcore/pages_manager.h>
+#include <dbcore/disk_manager.h>
 #include <dbcore/coretypes.h>
 
 #include <dbcore/column.h>
+#include <dbcore/key_encoder.h>
 #include <dbcore/schema.h>
 #include <dbcore/tuple.h>
 #include <dbcore/tuple_compare.h>
@@ -12,6 +14,8 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <random>
 #include <vector>
 
@@ -66,3 +70,133 @@ TEST(BPlusTreeTests, ScaleTest)
 
     EXPECT_EQ(num_retrieved, keys.size());
 }
+
+
+TEST(BPlusTreeTests, ScaleTestDiskBacked)
+{
+    const char* db_file_name = "b_plus_tree_scale_test.db";
+    std::remove(db_file_name);
+
+    // the pool is much smaller than the tree, so the pages are evicted onto the disk
+    constexpr uint32_t num_of_pages = 32;
+    DiskManager disk_manager(db_file_name);
+    ASSERT_TRUE(disk_manager.IsOpen());
+    PagesManager pages_manager(num_of_pages, &disk_manager);
+
+    Column key_column{"a", TypeId::BIGINT};
+    Column cols[] = { key_column };
+    Schema schema{cols, 1};
+    constexpr uint16_t key_size = 8;    // size of bigint
+
+    TupleCompare key_cmp(schema);
+
+    const uint16_t leaf_max_size = 3;
+    const uint16_t internal_max_size = 4;
+    BPlusTree bplus_tree(pages_manager, key_cmp, key_size, leaf_max_size, internal_max_size);
+
+    std::vector<uint16_t> keys;
+    constexpr uint16_t scale = 1000;
+    for (uint16_t i = 1; i < scale; i++)
+        keys.push_back(i);
+
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    for (auto k : keys) {
+        Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(k)} };
+        Tuple tuple{values, 1, schema};
+        RID rid{k, k};
+        ASSERT_TRUE(bplus_tree.Insert(tuple.GetData(), rid));
+    }
+
+    for (auto k : keys) {
+        Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(k)} };
+        Tuple tuple{values, 1, schema};
+        RID rid;
+        ASSERT_TRUE(bplus_tree.GetValue(tuple.GetData(), rid));
+        EXPECT_EQ(rid, RID(k, k));
+    }
+
+    EXPECT_GT(disk_manager.GetNumPages(), num_of_pages);
+
+    std::remove(db_file_name);
+}
+
+namespace
+{
+
+/**
+ * Fill the tree with normalized keys of the given integer type, check lookups of
+ * present and absent keys, the order of keys and return the mean lookup time in ns.
+*/
+template <typename T>
+double CheckNormalizedKeys(TypeId type)
+{
+    constexpr uint32_t num_of_pages = 1000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column cols[] = { Column{"a", type} };
+    Schema schema{cols, 1};
+    KeyEncoder encoder(schema);
+    TupleCompare key_cmp(encoder);
+    const uint32_t key_size = encoder.GetKeySize();
+
+    BPlusTree bplus_tree(pages_manager, key_cmp, key_size);
+
+    constexpr int32_t num_keys = 100000;
+    // the even keys are inserted, the odd ones are absent
+    std::vector<T> keys;
+    for (int32_t i = -num_keys; i < num_keys; i += 2)
+        keys.push_back(static_cast<T>(i));
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+
+    auto encode = [&](T k) {
+        Value values[] = { Value{type, k} };
+        Tuple tuple{values, 1, schema};
+        std::vector<char> key(key_size);
+        encoder.Encode(tuple.GetData(), key.data());
+        return key;
+    };
+
+    for (auto k : keys) {
+        const RID rid{static_cast<page_id_t>(k + num_keys), 0};
+        EXPECT_TRUE(bplus_tree.Insert(encode(k).data(), rid));
+    }
+
+    std::vector<std::vector<char>> encoded;
+    for (auto k : keys)
+        encoded.push_back(encode(k));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i++) {
+        RID rid;
+        EXPECT_TRUE(bplus_tree.GetValue(encoded[i].data(), rid));
+        EXPECT_EQ(rid, RID(static_cast<page_id_t>(keys[i] + num_keys), 0));
+    }
+    const auto finish = std::chrono::steady_clock::now();
+
+    for (auto k : keys) {
+        RID rid;
+        EXPECT_FALSE(bplus_tree.GetValue(encode(k + 1).data(), rid));
+    }
+
+    page_id_t expected = 0;
+    // the bound on number of steps stops the loop when the leaves are linked wrong
+    for (auto it = bplus_tree.Begin(); it != bplus_tree.End() && static_cast<size_t>(expected) <= 2 * keys.size(); ++it) {
+        EXPECT_EQ(*it, RID(expected, 0));
+        expected += 2;
+    }
+    EXPECT_EQ(static_cast<size_t>(expected), 2 * keys.size());
+
+    return std::chrono::duration<double, std::nano>(finish - start).count() / keys.size();
+}
+
+}
+
+TEST(BPlusTreeTests, NormalizedKeyScaleTest)
+{
+    const double integer_ns = CheckNormalizedKeys<int32_t>(TypeId::INTEGER);
+    const double bigint_ns = CheckNormalizedKeys<int64_t>(TypeId::BIGINT);
+    std::cout << " lookup of normalized INTEGER key: " << integer_ns << " ns" << std::endl;
+    std::cout << " lookup of normalized BIGINT key: " << bigint_ns << " ns" << std::endl;
+}
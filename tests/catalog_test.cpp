@@ -0,0 +1,359 @@
+#include <dbcore/catalog.h>
+#include <dbcore/disk_manager.h>
+#include <dbcore/log_manager.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_info.h>
+#include <dbcore/table_iterator.h>
+#include <dbcore/index.h>
+#include <dbcore/index_info.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/rid.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils.h"
+
+using namespace dbcore;
+using namespace testutils;
+
+namespace
+{
+
+/** Insert the rows with keys [from, to) into the table and its indexes */
+void InsertRows(TableInfo* table_info, IndexInfo* index_infos[], uint32_t num_indexes, int32_t from, int32_t to)
+{
+    for (int32_t key = from; key < to; key++) {
+        const Tuple tuple = MakeTuple(key, table_info->GetSchema());
+        const RID rid = table_info->GetTableHeap()->InsertTuple(TupleMeta{0, false}, tuple);
+        ASSERT_NE(rid.GetPageId(), INVALID_PAGE_ID);
+        for (uint32_t n = 0; n < num_indexes; n++) {
+            ASSERT_TRUE(index_infos[n]->GetIndex()->InsertEntry(tuple, rid));
+        }
+    }
+}
+
+/** Check that the index finds every row of the table */
+void CheckIndex(TableInfo* table_info, IndexInfo* index_info, int32_t num_rows)
+{
+    int32_t count = 0;
+    for (auto itr = table_info->GetTableHeap()->MakeIterator(); !itr.IsEnd(); itr.Next()) {
+        const auto [meta, tuple] = itr.GetTuple();
+        RID rid;
+        ASSERT_TRUE(index_info->GetIndex()->SearchEntry(tuple, &rid));
+        EXPECT_EQ(rid, itr.GetRID());
+        count++;
+    }
+    EXPECT_EQ(count, num_rows);
+}
+
+}
+
+TEST(CatalogTest, InMemoryCatalogTest)
+{
+    PagesManager pages_manager(100);
+    Catalog catalog(&pages_manager);
+    ASSERT_TRUE(catalog.IsOpen());
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+    TableInfo* table_info = catalog.CreateTable("t", schema);
+    ASSERT_NE(table_info, nullptr);
+    EXPECT_EQ(catalog.CreateTable("t", schema), nullptr);
+    EXPECT_EQ(catalog.GetTable("t"), table_info);
+    EXPECT_EQ(catalog.GetTable(table_info->GetTableOid()), table_info);
+
+    uint32_t key_attrs[] = { 0 };
+    IndexInfo* index_info = catalog.CreateIndex("t_a", "t", schema, key_attrs, 1, IndexType::BPlusTreeIndex);
+    ASSERT_NE(index_info, nullptr);
+    EXPECT_STREQ(index_info->GetName(), "t_a");
+    EXPECT_EQ(catalog.GetIndex("t_a", "t"), index_info);
+    EXPECT_EQ(catalog.GetIndex(index_info->GetIndexOid()), index_info);
+
+    IndexInfo* index_infos[] = { index_info };
+    InsertRows(table_info, index_infos, 1, 0, 100);
+    CheckIndex(table_info, index_info, 100);
+    EXPECT_TRUE(catalog.Flush());
+}
+
+TEST(CatalogTest, PopulateFailureTest)
+{
+    constexpr uint32_t num_pages = 40;
+    PagesManager pages_manager(num_pages);
+    Catalog catalog(&pages_manager);
+    ASSERT_TRUE(catalog.IsOpen());
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+    TableInfo* table_info = catalog.CreateTable("t", schema);
+    ASSERT_NE(table_info, nullptr);
+    constexpr int32_t num_rows = 2000;
+    InsertRows(table_info, nullptr, 0, 0, num_rows);
+
+    // every key is spilled as its own run, so the pages run out before the keys are spilled
+    uint32_t key_attrs[] = { 0 };
+    for (uint32_t n = 0; n < 2 * num_pages; n++) {
+        ASSERT_EQ(catalog.CreateIndex("t_a", "t", schema, key_attrs, 1, IndexType::BPlusTreeIndex, 1, 1), nullptr);
+    }
+    EXPECT_EQ(catalog.GetIndex("t_a", "t"), nullptr);
+    EXPECT_TRUE(catalog.GetTableIndexes("t").empty());
+
+    // the pages of the failed indexes are given back, so the index is created within the budget
+    IndexInfo* index_info = catalog.CreateIndex("t_a", "t", schema, key_attrs, 1, IndexType::BPlusTreeIndex);
+    ASSERT_NE(index_info, nullptr);
+    CheckIndex(table_info, index_info, num_rows);
+}
+
+TEST(CatalogTest, ReopenTest)
+{
+    const char* db_file_name = "catalog_reopen_test.db";
+    std::remove(db_file_name);
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+    uint32_t key_attrs[] = { 0 };
+
+    constexpr int32_t num_rows = 3000;
+    page_id_t catalog_page_id = INVALID_PAGE_ID;
+    table_oid_t table_oid = INVALID_TABLE_OID;
+    {
+        DiskManager disk_manager(db_file_name);
+        PagesManager pages_manager(64, &disk_manager);
+        Catalog catalog(&pages_manager);
+        ASSERT_TRUE(catalog.IsOpen());
+        catalog_page_id = catalog.GetCatalogPageId();
+        EXPECT_EQ(catalog_page_id, 0);
+
+        TableInfo* table_info = catalog.CreateTable("t", schema);
+        ASSERT_NE(table_info, nullptr);
+        table_oid = table_info->GetTableOid();
+        InsertRows(table_info, nullptr, 0, 0, num_rows / 2);
+
+        IndexInfo* index_infos[] = {
+            catalog.CreateIndex("t_tree", "t", schema, key_attrs, 1, IndexType::BPlusTreeIndex),
+            catalog.CreateIndex("t_hash", "t", schema, key_attrs, 1, IndexType::HashTableIndex)
+        };
+        ASSERT_NE(index_infos[0], nullptr);
+        ASSERT_NE(index_infos[1], nullptr);
+        InsertRows(table_info, index_infos, 2, num_rows / 2, num_rows);
+    }
+
+    {
+        DiskManager disk_manager(db_file_name);
+        PagesManager pages_manager(64, &disk_manager);
+        Catalog catalog(&pages_manager, catalog_page_id);
+        ASSERT_TRUE(catalog.IsOpen());
+
+        // the catalog was closed cleanly, so the indexes are opened by their root pages as they are
+        TableInfo* table_info = catalog.GetTable("t");
+        ASSERT_NE(table_info, nullptr);
+        EXPECT_EQ(table_info->GetTableOid(), table_oid);
+        ASSERT_EQ(table_info->GetSchema().GetColumnCount(), 2);
+        EXPECT_STREQ(table_info->GetSchema().GetColumnAt(1).GetName(), "b");
+        EXPECT_EQ(table_info->GetSchema().GetColumnAt(1).GetType(), TypeId::BIGINT);
+
+        IndexInfo* index_infos[] = { catalog.GetIndex("t_tree", "t"), catalog.GetIndex("t_hash", "t") };
+        ASSERT_NE(index_infos[0], nullptr);
+        ASSERT_NE(index_infos[1], nullptr);
+        EXPECT_TRUE(index_infos[0]->GetIndex()->SupportsRangeScan());
+        EXPECT_FALSE(index_infos[1]->GetIndex()->SupportsRangeScan());
+        CheckIndex(table_info, index_infos[0], num_rows);
+        CheckIndex(table_info, index_infos[1], num_rows);
+
+        // the new objects get the new OIDs, the rows are appended to the table
+        TableInfo* other_table_info = catalog.CreateTable("u", schema);
+        ASSERT_NE(other_table_info, nullptr);
+        EXPECT_NE(other_table_info->GetTableOid(), table_oid);
+        InsertRows(table_info, index_infos, 2, num_rows, num_rows + 100);
+        CheckIndex(table_info, index_infos[0], num_rows + 100);
+    }
+
+    {
+        DiskManager disk_manager(db_file_name);
+        PagesManager pages_manager(64, &disk_manager);
+        Catalog catalog(&pages_manager, catalog_page_id);
+        ASSERT_TRUE(catalog.IsOpen());
+        EXPECT_NE(catalog.GetTable("u"), nullptr);
+        CheckIndex(catalog.GetTable("t"), catalog.GetIndex("t_hash", "t"), num_rows + 100);
+    }
+
+    std::remove(db_file_name);
+}
+
+TEST(CatalogTest, UncleanShutdownTest)
+{
+    const char* db_file_name = "catalog_unclean_test.db";
+    const char* log_file_name = "catalog_unclean_test.log";
+    const char* crash_db_file_name = "catalog_unclean_test_crash.db";
+    const char* crash_log_file_name = "catalog_unclean_test_crash.log";
+    for (const char* name : { db_file_name, log_file_name, crash_db_file_name, crash_log_file_name }) {
+        std::remove(name);
+    }
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+    uint32_t key_attrs[] = { 0 };
+
+    constexpr int32_t num_rows = 3000;
+    page_id_t catalog_page_id = INVALID_PAGE_ID;
+    {
+        DiskManager disk_manager(db_file_name);
+        LogManager log_manager(log_file_name);
+        PagesManager pages_manager(64, &disk_manager, &log_manager);
+        Catalog catalog(&pages_manager, &log_manager);
+        catalog_page_id = catalog.GetCatalogPageId();
+
+        TableInfo* table_info = catalog.CreateTable("t", schema);
+        IndexInfo* index_infos[] = {
+            catalog.CreateIndex("t_tree", "t", schema, key_attrs, 1, IndexType::BPlusTreeIndex),
+            catalog.CreateIndex("t_hash", "t", schema, key_attrs, 1, IndexType::HashTableIndex)
+        };
+        InsertRows(table_info, index_infos, 2, 0, num_rows);
+        // commit: only the log is made durable, the pages reach the storage when they are evicted
+        ASSERT_TRUE(log_manager.Flush());
+
+        // crash: the catalog is not closed
+        CopyFile(db_file_name, crash_db_file_name);
+        CopyFile(log_file_name, crash_log_file_name);
+    }
+
+    {
+        DiskManager disk_manager(crash_db_file_name);
+        LogManager log_manager(crash_log_file_name);
+        PagesManager pages_manager(64, &disk_manager, &log_manager);
+        // the log is redone, then the indexes are opened by their root pages
+        Catalog catalog(&pages_manager, catalog_page_id, &log_manager);
+        ASSERT_TRUE(catalog.IsOpen());
+
+        TableInfo* table_info = catalog.GetTable("t");
+        ASSERT_NE(table_info, nullptr);
+        CheckIndex(table_info, catalog.GetIndex("t_tree", "t"), num_rows);
+        CheckIndex(table_info, catalog.GetIndex("t_hash", "t"), num_rows);
+    }
+
+    for (const char* name : { db_file_name, log_file_name, crash_db_file_name, crash_log_file_name }) {
+        std::remove(name);
+    }
+}
+
+TEST(CatalogTest, CrashAfterCreateTableTest)
+{
+    const char* db_file_name = "catalog_create_table_crash_test.db";
+    const char* log_file_name = "catalog_create_table_crash_test.log";
+    const char* crash_db_file_name = "catalog_create_table_crash_test_crash.db";
+    const char* crash_log_file_name = "catalog_create_table_crash_test_crash.log";
+    for (const char* name : { db_file_name, log_file_name, crash_db_file_name, crash_log_file_name }) {
+        std::remove(name);
+    }
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+    uint32_t key_attrs[] = { 0 };
+
+    page_id_t catalog_page_id = INVALID_PAGE_ID;
+    {
+        // the long flush interval: the log is written only when somebody waits for it
+        DiskManager disk_manager(db_file_name);
+        LogManager log_manager(log_file_name, 60000);
+        PagesManager pages_manager(64, &disk_manager, &log_manager);
+        Catalog catalog(&pages_manager, &log_manager);
+        ASSERT_TRUE(catalog.IsOpen());
+        catalog_page_id = catalog.GetCatalogPageId();
+        ASSERT_NE(catalog.CreateTable("t", schema), nullptr);
+
+        // crash: the catalog refers to the first page of the table, which is only in the log
+        CopyFile(db_file_name, crash_db_file_name);
+        CopyFile(log_file_name, crash_log_file_name);
+    }
+
+    {
+        DiskManager disk_manager(crash_db_file_name);
+        LogManager log_manager(crash_log_file_name);
+        PagesManager pages_manager(64, &disk_manager, &log_manager);
+        Catalog catalog(&pages_manager, catalog_page_id, &log_manager);
+        ASSERT_TRUE(catalog.IsOpen());
+
+        TableInfo* table_info = catalog.GetTable("t");
+        ASSERT_NE(table_info, nullptr);
+        EXPECT_TRUE(table_info->GetTableHeap()->MakeIterator().IsEnd());
+
+        // the recovered table accepts new rows and indexes
+        InsertRows(table_info, nullptr, 0, 0, 100);
+        IndexInfo* index_info = catalog.CreateIndex("t_a", "t", schema, key_attrs, 1, IndexType::BPlusTreeIndex);
+        ASSERT_NE(index_info, nullptr);
+        CheckIndex(table_info, index_info, 100);
+    }
+
+    for (const char* name : { db_file_name, log_file_name, crash_db_file_name, crash_log_file_name }) {
+        std::remove(name);
+    }
+}
+
+TEST(CatalogTest, ConcurrentLookupTest)
+{
+    PagesManager pages_manager(1000);
+    Catalog catalog(&pages_manager);
+    ASSERT_TRUE(catalog.IsOpen());
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+    uint32_t key_attrs[] = { 0 };
+
+    constexpr int32_t num_tables = 50;
+    std::atomic<int32_t> num_created{0};
+    std::atomic<bool> stop{false};
+
+    // the readers look up the tables created so far while the DDL goes on
+    std::vector<std::thread> readers;
+    for (uint32_t t = 0; t < 4; t++) {
+        readers.emplace_back([&]() {
+            char table_name[16], index_name[16];
+            while (!stop.load()) {
+                const int32_t n = num_created.load();
+                for (int32_t i = 0; i < n; i++) {
+                    std::snprintf(table_name, sizeof(table_name), "t%d", i);
+                    std::snprintf(index_name, sizeof(index_name), "i%d", i);
+                    const TableInfo* table_info = catalog.GetTable(table_name);
+                    ASSERT_NE(table_info, nullptr) << table_name;
+                    EXPECT_STREQ(table_info->GetTableName(), table_name);
+                    EXPECT_EQ(catalog.GetTable(table_info->GetTableOid()), table_info);
+                    const IndexInfo* index_info = catalog.GetIndex(index_name, table_name);
+                    ASSERT_NE(index_info, nullptr) << index_name;
+                    EXPECT_EQ(catalog.GetIndex(index_name, table_info->GetTableOid()), index_info);
+                    EXPECT_EQ(catalog.GetIndex(index_info->GetIndexOid()), index_info);
+                }
+                EXPECT_EQ(catalog.GetTable("nonexistent"), nullptr);
+            }
+        });
+    }
+
+    for (int32_t i = 0; i < num_tables; i++) {
+        const std::string table_name = "t" + std::to_string(i);
+        const std::string index_name = "i" + std::to_string(i);
+        ASSERT_NE(catalog.CreateTable(table_name.c_str(), schema), nullptr);
+        ASSERT_NE(catalog.CreateIndex(index_name.c_str(), table_name.c_str(), schema, key_attrs, 1,
+                                    IndexType::BPlusTreeIndex), nullptr);
+        num_created.store(i + 1);
+    }
+
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    // the lookups by the name which isn't terminated by zero
+    const std::string_view name("t7 and the rest", 2);
+    ASSERT_NE(catalog.GetTable(name), nullptr);
+    EXPECT_EQ(catalog.GetIndex("i7", name), catalog.GetIndex("i7", "t7"));
+}
@@ -0,0 +1,175 @@
+#include <dbcore/checkpointer.h>
+#include <dbcore/log_manager.h>
+#include <dbcore/log_recovery.h>
+#include <dbcore/disk_manager.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_iterator.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <iostream>
+
+#include "utils.h"
+
+using namespace dbcore;
+using namespace testutils;
+
+namespace
+{
+
+void RemoveFiles(std::initializer_list<const char*> names)
+{
+    for (const char* name : names) {
+        std::remove(name);
+    }
+}
+
+}
+
+TEST(CheckpointTest, RecoveryAfterCheckpointTest)
+{
+    const char* log_file_name = "checkpoint_test.log";
+    const char* db_file_name = "checkpoint_test.db";
+    const char* crash_log_file_name = "checkpoint_test_crash.log";
+    const char* crash_db_file_name = "checkpoint_test_crash.db";
+    RemoveFiles({ log_file_name, db_file_name, crash_log_file_name, crash_db_file_name });
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+
+    constexpr int32_t num_rows_before = 3000;
+    constexpr int32_t num_rows_after = 1000;
+    page_id_t first_page_id = INVALID_PAGE_ID;
+    lsn_t checkpoint_lsn = INVALID_LSN;
+    {
+        DiskManager disk_manager(db_file_name);
+        LogManager log_manager(log_file_name);
+        PagesManager pages_manager(64, &disk_manager, &log_manager);
+        TableHeap table_heap(pages_manager, &log_manager);
+        first_page_id = table_heap.GetFirstPageId();
+
+        for (int32_t i = 0; i < num_rows_before; i++) {
+            table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(i, schema));
+        }
+        const lsn_t appended_lsn = log_manager.GetAppendedLSN();
+        ASSERT_TRUE(pages_manager.Checkpoint(&checkpoint_lsn));
+        EXPECT_EQ(checkpoint_lsn, appended_lsn);
+        EXPECT_GE(disk_manager.GetNumPages(), 2);
+
+        // the checkpoint doesn't write the pages which are not changed since the previous one
+        lsn_t next_checkpoint_lsn = INVALID_LSN;
+        ASSERT_TRUE(pages_manager.Checkpoint(&next_checkpoint_lsn));
+        EXPECT_GT(next_checkpoint_lsn, checkpoint_lsn);
+        checkpoint_lsn = next_checkpoint_lsn;
+        // the log is truncated up to the checkpoint
+        EXPECT_EQ(log_manager.GetCheckpointLSN(), checkpoint_lsn);
+
+        for (int32_t i = num_rows_before; i < num_rows_before + num_rows_after; i++) {
+            table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(i, schema));
+        }
+        ASSERT_TRUE(log_manager.Flush());
+
+        // crash: the pages changed after the checkpoint are not on the storage
+        CopyFile(db_file_name, crash_db_file_name);
+        CopyFile(log_file_name, crash_log_file_name);
+    }
+
+    {
+        DiskManager disk_manager(crash_db_file_name);
+        LogManager log_manager(crash_log_file_name);
+        PagesManager pages_manager(64, &disk_manager, &log_manager);
+
+        LogRecovery recovery(log_manager, pages_manager);
+        ASSERT_TRUE(recovery.Redo());
+        EXPECT_EQ(recovery.GetCheckpointLSN(), checkpoint_lsn);
+        // the records before the checkpoint are not read
+        EXPECT_GE(recovery.GetNumRedone(), num_rows_after);
+        EXPECT_LT(recovery.GetNumRedone() + recovery.GetNumSkipped(), num_rows_before);
+
+        TableHeap table_heap(pages_manager, first_page_id, &log_manager);
+        CheckTableKeys(table_heap, num_rows_before + num_rows_after, schema);
+    }
+
+    RemoveFiles({ log_file_name, db_file_name, crash_log_file_name, crash_db_file_name });
+}
+
+TEST(CheckpointTest, BackgroundCheckpointTest)
+{
+    const char* log_file_name = "checkpoint_background_test.log";
+    const char* db_file_name = "checkpoint_background_test.db";
+    const char* crash_log_file_name = "checkpoint_background_test_crash.log";
+    const char* crash_db_file_name = "checkpoint_background_test_crash.db";
+    RemoveFiles({ log_file_name, db_file_name, crash_log_file_name, crash_db_file_name });
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+
+    constexpr uint32_t num_threads = 4;
+    constexpr int32_t num_rows_per_thread = 5000;
+    constexpr int32_t num_rows = num_threads * num_rows_per_thread;
+    page_id_t first_page_id = INVALID_PAGE_ID;
+    {
+        DiskManager disk_manager(db_file_name);
+        LogManager log_manager(log_file_name);
+        // the pool is smaller than the table, so the checkpoints race with the evictions
+        PagesManager pages_manager(32, &disk_manager, &log_manager);
+        TableHeap table_heap(pages_manager, &log_manager);
+        first_page_id = table_heap.GetFirstPageId();
+
+        {
+            Checkpointer checkpointer(pages_manager, 1);
+            std::vector<std::thread> threads;
+            for (uint32_t t = 0; t < num_threads; t++) {
+                threads.emplace_back([&, t]() {
+                    for (int32_t i = 0; i < num_rows_per_thread; i++) {
+                        const RID rid = table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(t * num_rows_per_thread + i, schema));
+                        ASSERT_NE(rid.GetPageId(), INVALID_PAGE_ID);
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            // at least one checkpoint after all of the inserts
+            const uint64_t num_checkpoints = checkpointer.GetNumCheckpoints();
+            while (checkpointer.GetNumCheckpoints() < num_checkpoints + 2) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            std::cout << " " << checkpointer.GetNumCheckpoints() << " checkpoints" << std::endl;
+            EXPECT_NE(checkpointer.GetCheckpointLSN(), INVALID_LSN);
+        }
+
+        CopyFile(db_file_name, crash_db_file_name);
+        CopyFile(log_file_name, crash_log_file_name);
+    }
+
+    {
+        DiskManager disk_manager(crash_db_file_name);
+        LogManager log_manager(crash_log_file_name);
+        PagesManager pages_manager(32, &disk_manager, &log_manager);
+
+        // all of the table changes are on the storage
+        LogRecovery recovery(log_manager, pages_manager);
+        ASSERT_TRUE(recovery.Redo());
+        EXPECT_NE(recovery.GetCheckpointLSN(), INVALID_LSN);
+        EXPECT_EQ(recovery.GetNumRedone(), 0);
+
+        TableHeap table_heap(pages_manager, first_page_id, &log_manager);
+        CheckTableKeys(table_heap, num_rows, schema);
+    }
+
+    RemoveFiles({ log_file_name, db_file_name, crash_log_file_name, crash_db_file_name });
+}
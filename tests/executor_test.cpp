@@ -0,0 +1,396 @@
+#include <dbcore/catalog.h>
+#include <dbcore/executor_context.h>
+#include <dbcore/filter_executor.h>
+#include <dbcore/index.h>
+#include <dbcore/index_info.h>
+#include <dbcore/index_join_executor.h>
+#include <dbcore/index_scan_executor.h>
+#include <dbcore/insert_executor.h>
+#include <dbcore/limit_executor.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/projection_executor.h>
+#include <dbcore/seq_scan_executor.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_info.h>
+#include <dbcore/values_executor.h>
+#include <dbcore/vector_predicate.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+
+using namespace dbcore;
+using testutils::Load;
+
+namespace
+{
+
+const char* NAMES[] = { "alpha", "beta", "gamma" };
+
+Schema MakeSchema()
+{
+    Column cols[] = { Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 16}, Column{"v", TypeId::BIGINT} };
+    return Schema{cols, 3};
+}
+
+Tuple MakeTuple(int32_t id, const Schema& schema)
+{
+    const char* name = NAMES[id % 3];
+    Value values[] = { Value{TypeId::INTEGER, id}, Value{TypeId::VARCHAR, name, static_cast<uint32_t>(::strlen(name)), false},
+                       Value{TypeId::BIGINT, static_cast<int64_t>(id) * 10} };
+    return Tuple{values, 3, schema};
+}
+
+std::vector<Tuple> MakeTuples(int32_t from, int32_t to, const Schema& schema)
+{
+    std::vector<Tuple> tuples;
+    for (int32_t id = from; id < to; id++) {
+        tuples.push_back(MakeTuple(id, schema));
+    }
+    return tuples;
+}
+
+/** Run the plan and collect the values of the INTEGER column of the produced rows */
+std::vector<int32_t> Collect(AbstractExecutor& executor, uint32_t idx = 0)
+{
+    std::vector<int32_t> result;
+    std::vector<TupleView> batch;
+    executor.Init();
+    while (executor.Next(batch)) {
+        EXPECT_FALSE(batch.empty());
+        for (const TupleView& row : batch) {
+            result.push_back(Load<int32_t>(row, executor.GetOutputSchema(), idx));
+        }
+    }
+    return result;
+}
+
+int32_t Insert(ExecutorContext& context, table_oid_t table_oid, std::unique_ptr<AbstractExecutor> child)
+{
+    InsertExecutor insert(context, table_oid, std::move(child));
+    const std::vector<int32_t> count = Collect(insert);
+    EXPECT_EQ(count.size(), 1);
+    return count.empty() ? -1 : count[0];
+}
+
+}
+
+TEST(ExecutorTest, InsertScanTest)
+{
+    PagesManager pages_manager(200);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    const Schema schema = MakeSchema();
+    TableInfo* table_info = catalog.CreateTable("t", schema);
+    ASSERT_NE(table_info, nullptr);
+    uint32_t key_attrs[] = { 0 };
+    IndexInfo* index_info = catalog.CreateIndex("t_id", "t", schema, key_attrs, 1, IndexType::BPlusTreeIndex);
+    ASSERT_NE(index_info, nullptr);
+
+    constexpr int32_t num_rows = 3000;
+    EXPECT_EQ(Insert(context, table_info->GetTableOid(),
+                     std::make_unique<ValuesExecutor>(schema, MakeTuples(0, num_rows, schema))), num_rows);
+    // the duplicate keys are rejected, the new ones are inserted
+    EXPECT_EQ(Insert(context, table_info->GetTableOid(),
+                     std::make_unique<ValuesExecutor>(schema, MakeTuples(num_rows - 10, num_rows + 5, schema))), 5);
+
+    SeqScanExecutor scan(context, table_info->GetTableOid());
+    const std::vector<int32_t> ids = Collect(scan);
+    ASSERT_EQ(ids.size(), num_rows + 5);
+    for (int32_t id = 0; id < num_rows + 5; id++) {
+        EXPECT_EQ(ids[id], id);
+        RID rid;
+        EXPECT_TRUE(index_info->GetIndex()->SearchEntry(MakeTuple(id, schema), &rid)) << id;
+    }
+
+    // the executor can be run again
+    EXPECT_EQ(Collect(scan).size(), num_rows + 5);
+}
+
+TEST(ExecutorTest, FilterProjectLimitTest)
+{
+    PagesManager pages_manager(200);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    const Schema schema = MakeSchema();
+    TableInfo* table_info = catalog.CreateTable("t", schema);
+    constexpr int32_t num_rows = 5000;
+    ASSERT_EQ(Insert(context, table_info->GetTableOid(),
+                     std::make_unique<ValuesExecutor>(schema, MakeTuples(0, num_rows, schema))), num_rows);
+
+    // SELECT v, id FROM t WHERE v >= 1000 AND name = 'beta'
+    auto make_filter = [&]() {
+        auto predicate = std::make_unique<VectorPredicate>(schema);
+        EXPECT_TRUE(predicate->AddComparison(2, CompareOp::GE, Value{TypeId::BIGINT, static_cast<int64_t>(1000)}));
+        EXPECT_TRUE(predicate->AddComparison(1, CompareOp::EQ, Value{TypeId::VARCHAR, "beta", 4, false}));
+        return std::make_unique<FilterExecutor>(std::make_unique<SeqScanExecutor>(context, table_info->GetTableOid(), true),
+                                                std::move(predicate));
+    };
+    const uint32_t attrs[] = { 2, 0 };
+    ProjectionExecutor projection(make_filter(), attrs, 2);
+    const Schema& output_schema = projection.GetOutputSchema();
+    ASSERT_EQ(output_schema.GetColumnCount(), 2);
+    EXPECT_EQ(output_schema.GetColumnAt(0).GetType(), TypeId::BIGINT);
+
+    std::vector<int32_t> expected;
+    for (int32_t id = 100; id < num_rows; id++) {
+        if (id % 3 == 1) {
+            expected.push_back(id);
+        }
+    }
+    std::vector<TupleView> batch;
+    std::vector<int32_t> ids;
+    projection.Init();
+    while (projection.Next(batch)) {
+        for (const TupleView& row : batch) {
+            const int32_t id = Load<int32_t>(row, output_schema, 1);
+            EXPECT_EQ(Load<int64_t>(row, output_schema, 0), static_cast<int64_t>(id) * 10);
+            ids.push_back(id);
+        }
+    }
+    EXPECT_EQ(ids, expected);
+
+    // the projection of VARCHAR column makes the rows of values
+    const uint32_t name_attrs[] = { 1, 0 };
+    ProjectionExecutor name_projection(make_filter(), name_attrs, 2);
+    name_projection.Init();
+    ASSERT_TRUE(name_projection.Next(batch));
+    const uint32_t name_offset = Load<uint32_t>(batch[0], name_projection.GetOutputSchema(), 0);
+    ASSERT_EQ(::memcmp(batch[0].GetData() + name_offset, "\x04\0\0\0beta", 8), 0);
+    EXPECT_EQ(Load<int32_t>(batch[0], name_projection.GetOutputSchema(), 1), expected[0]);
+
+    // the limit cuts the batch
+    LimitExecutor limit(make_filter(), 7);
+    EXPECT_EQ(Collect(limit), std::vector<int32_t>(expected.begin(), expected.begin() + 7));
+    LimitExecutor no_rows(make_filter(), 0);
+    EXPECT_TRUE(Collect(no_rows).empty());
+}
+
+TEST(ExecutorTest, IndexScanTest)
+{
+    PagesManager pages_manager(200);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    const Schema schema = MakeSchema();
+    TableInfo* table_info = catalog.CreateTable("t", schema);
+    uint32_t key_attrs[] = { 0 };
+    IndexInfo* tree_info = catalog.CreateIndex("t_id", "t", schema, key_attrs, 1, IndexType::BPlusTreeIndex);
+    IndexInfo* hash_info = catalog.CreateIndex("t_id_hash", "t", schema, key_attrs, 1, IndexType::HashTableIndex);
+    ASSERT_TRUE(tree_info != nullptr && hash_info != nullptr);
+
+    // the rows are inserted in reverse order, the index scan produces them in order of keys
+    constexpr int32_t num_rows = 2000;
+    std::vector<Tuple> tuples = MakeTuples(0, num_rows, schema);
+    std::reverse(tuples.begin(), tuples.end());
+    ASSERT_EQ(Insert(context, table_info->GetTableOid(), std::make_unique<ValuesExecutor>(schema, std::move(tuples))), num_rows);
+
+    // the deleted row is skipped (it's still in the index)
+    RID rid;
+    ASSERT_TRUE(tree_info->GetIndex()->SearchEntry(MakeTuple(600, schema), &rid));
+    ASSERT_TRUE(table_info->GetTableHeap()->MarkDelete(rid));
+
+    const Tuple lo = MakeTuple(500, schema);
+    const Tuple hi = MakeTuple(1500, schema);
+    IndexScanExecutor range_scan(context, tree_info->GetIndexOid(), &lo, true, &hi, false);
+    std::vector<int32_t> expected;
+    for (int32_t id = 500; id < 1500; id++) {
+        if (id != 600) {
+            expected.push_back(id);
+        }
+    }
+    EXPECT_EQ(Collect(range_scan), expected);
+    EXPECT_EQ(Collect(range_scan), expected);
+
+    IndexScanExecutor lookup(context, hash_info->GetIndexOid(), MakeTuple(42, schema));
+    std::vector<TupleView> batch;
+    lookup.Init();
+    ASSERT_TRUE(lookup.Next(batch));
+    ASSERT_EQ(batch.size(), 1);
+    EXPECT_EQ(Load<int64_t>(batch[0], schema, 2), 420);
+    ASSERT_TRUE(tree_info->GetIndex()->SearchEntry(MakeTuple(42, schema), &rid));
+    EXPECT_EQ(batch[0].GetRID(), rid);
+    EXPECT_FALSE(lookup.Next(batch));
+
+    IndexScanExecutor deleted_lookup(context, hash_info->GetIndexOid(), MakeTuple(600, schema));
+    EXPECT_TRUE(Collect(deleted_lookup).empty());
+    IndexScanExecutor missing_lookup(context, hash_info->GetIndexOid(), MakeTuple(num_rows, schema));
+    EXPECT_TRUE(Collect(missing_lookup).empty());
+}
+
+TEST(ExecutorTest, IndexScanVarcharTest)
+{
+    PagesManager pages_manager(200);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    Column cols[] = { Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 4} };
+    const Schema schema{cols, 2};
+    TableInfo* table_info = catalog.CreateTable("t", schema);
+    uint32_t key_attrs[] = { 1 };
+    IndexInfo* index_info = catalog.CreateIndex("t_name", "t", schema, key_attrs, 1, IndexType::BPlusTreeIndex);
+    ASSERT_NE(index_info, nullptr);
+
+    auto make_tuple = [&](int32_t id, const char* name) {
+        Value values[] = { Value{TypeId::INTEGER, id}, Value{TypeId::VARCHAR, name, static_cast<uint32_t>(::strlen(name)), false} };
+        return Tuple{values, 2, schema};
+    };
+    // the index keeps the prefixes of 4 bytes, "abcdef" and "abcd" are the same key for it
+    std::vector<Tuple> tuples;
+    tuples.push_back(make_tuple(0, "abcdef"));
+    tuples.push_back(make_tuple(1, "abb"));
+    tuples.push_back(make_tuple(2, "abd"));
+    tuples.push_back(make_tuple(3, "abc"));
+    ASSERT_EQ(Insert(context, table_info->GetTableOid(), std::make_unique<ValuesExecutor>(schema, std::move(tuples))), 4);
+
+    IndexScanExecutor prefix_lookup(context, index_info->GetIndexOid(), make_tuple(-1, "abcd"));
+    EXPECT_TRUE(Collect(prefix_lookup).empty());
+    IndexScanExecutor lookup(context, index_info->GetIndexOid(), make_tuple(-1, "abcdef"));
+    EXPECT_EQ(Collect(lookup), std::vector<int32_t>{0});
+
+    const Tuple abc = make_tuple(-1, "abc");
+    const Tuple abcd = make_tuple(-1, "abcd");
+    const Tuple abd = make_tuple(-1, "abd");
+    // "abcdef" is above the exclusive bound "abcd" though its prefix equals to it
+    IndexScanExecutor above(context, index_info->GetIndexOid(), &abcd, false, &abd, true);
+    EXPECT_EQ(Collect(above), (std::vector<int32_t>{0, 2}));
+    // "abcdef" is above the inclusive bound "abcd"
+    IndexScanExecutor below(context, index_info->GetIndexOid(), &abc, true, &abcd, true);
+    EXPECT_EQ(Collect(below), std::vector<int32_t>{3});
+}
+
+TEST(ExecutorTest, InsertSelectTest)
+{
+    PagesManager pages_manager(200);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    const Schema schema = MakeSchema();
+    TableInfo* table_info = catalog.CreateTable("t", schema);
+    constexpr int32_t num_rows = 1000;
+    ASSERT_EQ(Insert(context, table_info->GetTableOid(),
+                     std::make_unique<ValuesExecutor>(schema, MakeTuples(0, num_rows, schema))), num_rows);
+
+    // INSERT INTO t SELECT * FROM t: the scan doesn't see the inserted rows (and doesn't block the inserts)
+    EXPECT_EQ(Insert(context, table_info->GetTableOid(),
+                     std::make_unique<SeqScanExecutor>(context, table_info->GetTableOid())), num_rows);
+    SeqScanExecutor scan(context, table_info->GetTableOid());
+    EXPECT_EQ(Collect(scan).size(), 2 * num_rows);
+}
+
+TEST(ExecutorTest, IndexJoinTest)
+{
+    PagesManager pages_manager(200);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    const Schema schema = MakeSchema();
+    TableInfo* table_info = catalog.CreateTable("dim", schema);
+    uint32_t key_attrs[] = { 0 };
+    IndexInfo* tree_info = catalog.CreateIndex("dim_id", "dim", schema, key_attrs, 1, IndexType::BPlusTreeIndex);
+    IndexInfo* hash_info = catalog.CreateIndex("dim_id_hash", "dim", schema, key_attrs, 1, IndexType::HashTableIndex);
+    ASSERT_TRUE(tree_info != nullptr && hash_info != nullptr);
+    constexpr int32_t num_rows = 2000;
+    ASSERT_EQ(Insert(context, table_info->GetTableOid(),
+                     std::make_unique<ValuesExecutor>(schema, MakeTuples(0, num_rows, schema))), num_rows);
+    // the deleted row has no match
+    RID rid;
+    ASSERT_TRUE(tree_info->GetIndex()->SearchEntry(MakeTuple(100, schema), &rid));
+    ASSERT_TRUE(table_info->GetTableHeap()->MarkDelete(rid));
+
+    // the fact rows (qty BIGINT, fk INTEGER): the keys in [0, 2 * num_rows), half of them have no match
+    Column fact_cols[] = { Column{"qty", TypeId::BIGINT}, Column{"fk", TypeId::INTEGER} };
+    const Schema fact_schema{fact_cols, 2};
+    std::vector<Tuple> facts;
+    std::vector<int32_t> expected;
+    for (int32_t i = 0; i < 2 * num_rows; i++) {
+        const int32_t fk = (i * 7) % (2 * num_rows);
+        Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(i)}, Value{TypeId::INTEGER, fk} };
+        facts.emplace_back(values, 2, fact_schema);
+        if (fk < num_rows && fk != 100) {
+            expected.push_back(fk);
+        }
+    }
+    std::vector<Tuple> sorted_facts = facts;
+    std::sort(sorted_facts.begin(), sorted_facts.end(), [&](const Tuple& lhs, const Tuple& rhs) {
+        return Load<int32_t>(TupleView{lhs}, fact_schema, 1) < Load<int32_t>(TupleView{rhs}, fact_schema, 1);
+    });
+    std::vector<int32_t> sorted_expected = expected;
+    std::sort(sorted_expected.begin(), sorted_expected.end());
+
+    const uint32_t fact_key_attrs[] = { 1 };
+    for (IndexInfo* index_info : { tree_info, hash_info }) {
+        ASSERT_TRUE(index_info->GetIndex()->IsSearchKeySupported(fact_schema, fact_key_attrs, 1));
+        EXPECT_FALSE(index_info->GetIndex()->IsSearchKeySupported(fact_schema, key_attrs, 1));
+
+        for (bool sorted : { false, true }) {
+            IndexJoinExecutor join(context, std::make_unique<ValuesExecutor>(fact_schema, sorted ? sorted_facts : facts),
+                                   index_info->GetIndexOid(), fact_key_attrs, 1);
+            const Schema& output_schema = join.GetOutputSchema();
+            ASSERT_EQ(output_schema.GetColumnCount(), 5);
+
+            std::vector<int32_t> ids;
+            std::vector<TupleView> batch;
+            join.Init();
+            while (join.Next(batch)) {
+                for (const TupleView& row : batch) {
+                    const int32_t id = Load<int32_t>(row, output_schema, 2);
+                    EXPECT_EQ(Load<int32_t>(row, output_schema, 1), id);
+                    EXPECT_EQ(Load<int64_t>(row, output_schema, 4), static_cast<int64_t>(id) * 10);
+                    const char* name = NAMES[id % 3];
+                    EXPECT_EQ(::memcmp(row.GetData() + Load<uint32_t>(row, output_schema, 3) + sizeof(uint32_t),
+                                       name, ::strlen(name)), 0) << id;
+                    ids.push_back(id);
+                }
+            }
+            // the outer rows keep their order
+            EXPECT_EQ(ids, sorted ? sorted_expected : expected);
+        }
+    }
+}
+
+TEST(ExecutorTest, IndexJoinVarcharTest)
+{
+    PagesManager pages_manager(200);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    Column cols[] = { Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 4} };
+    const Schema schema{cols, 2};
+    TableInfo* table_info = catalog.CreateTable("dim", schema);
+    uint32_t key_attrs[] = { 1 };
+    IndexInfo* index_info = catalog.CreateIndex("dim_name", "dim", schema, key_attrs, 1, IndexType::BPlusTreeIndex);
+    ASSERT_NE(index_info, nullptr);
+
+    // the index keeps the prefixes of 4 bytes, "abcdef" and "abcd" are the same key for it
+    auto make_tuples = [](const std::vector<const char*>& names, const Schema& tuple_schema, bool name_first) {
+        std::vector<Tuple> tuples;
+        for (int32_t id = 0; id < static_cast<int32_t>(names.size()); id++) {
+            const Value name{TypeId::VARCHAR, names[id], static_cast<uint32_t>(::strlen(names[id])), false};
+            const Value values[] = { name_first ? name : Value{TypeId::INTEGER, id}, name_first ? Value{TypeId::INTEGER, id} : name };
+            tuples.emplace_back(values, 2, tuple_schema);
+        }
+        return tuples;
+    };
+    ASSERT_EQ(Insert(context, table_info->GetTableOid(),
+                     std::make_unique<ValuesExecutor>(schema, make_tuples({ "abcdef", "abc" }, schema, false))), 2);
+
+    // the outer rows (name VARCHAR(4), n INTEGER)
+    Column outer_cols[] = { Column{"name", TypeId::VARCHAR, 4}, Column{"n", TypeId::INTEGER} };
+    const Schema outer_schema{outer_cols, 2};
+    const uint32_t outer_key_attrs[] = { 0 };
+    ASSERT_TRUE(index_info->GetIndex()->IsSearchKeySupported(outer_schema, outer_key_attrs, 1));
+    IndexJoinExecutor join(context,
+                           std::make_unique<ValuesExecutor>(outer_schema,
+                                                            make_tuples({ "abcd", "abcdef", "abcdxy", "abc" }, outer_schema, true)),
+                           index_info->GetIndexOid(), outer_key_attrs, 1);
+    // only the equal full values are joined: (1, "abcdef") and (3, "abc")
+    EXPECT_EQ(Collect(join, 1), (std::vector<int32_t>{1, 3}));
+    EXPECT_EQ(Collect(join, 2), (std::vector<int32_t>{0, 1}));
+}
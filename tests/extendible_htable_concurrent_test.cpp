@@ -18,6 +18,8 @@
 #include <random>
 #include <thread>
 
+#include <iostream>
+
 
 // #include <fstream>
 // #include <iostream>
@@ -367,3 +369,74 @@ TEST(ExtendibleHTableConcurrentTest, MixTest2)
         EXPECT_EQ(rid, RID(k, k));
     }
 }
+
+TEST(ExtendibleHTableConcurrentTest, ThroughputTest)
+{
+    /* Each thread inserts, looks up and then removes its own range of keys.
+     Print the number of operations per second for the different number of threads. */
+    constexpr uint32_t num_of_pages = 1000;
+    constexpr uint32_t keys_per_thread = 25000;
+    const uint8_t max_threads = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+
+    Column key_column{"a", TypeId::BIGINT};
+    Column cols[] = { key_column };
+    Schema schema{cols, 1};
+    constexpr uint16_t key_size = 8;    // size of bigint
+
+    TupleCompare key_cmp(schema);
+    TupleHash key_hash(schema, FNV_hash);
+
+    constexpr uint32_t header_max_depth = 2;
+    constexpr uint32_t directory_max_depth = 9;
+    for (uint8_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        PagesManager pages_manager(num_of_pages);
+        ExtendibleHashTable hash_table(pages_manager, key_cmp, key_hash, key_size, header_max_depth, directory_max_depth);
+
+        auto insert_job = [&](uint8_t thread_idx) {
+            for (uint32_t i = 0; i < keys_per_thread; i++) {
+                const uint32_t k = i * num_threads + thread_idx;
+                Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(k)} };
+                Tuple tuple{values, 1, schema};
+                ASSERT_TRUE(hash_table.Insert(tuple.GetData(), RID(k, k)));
+            }
+        };
+
+        auto lookup_job = [&](uint8_t thread_idx) {
+            for (uint32_t i = 0; i < keys_per_thread; i++) {
+                const uint32_t k = i * num_threads + thread_idx;
+                Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(k)} };
+                Tuple tuple{values, 1, schema};
+                RID rid;
+                ASSERT_TRUE(hash_table.GetValue(tuple.GetData(), rid));
+                ASSERT_EQ(rid, RID(k, k));
+            }
+        };
+
+        auto remove_job = [&](uint8_t thread_idx) {
+            for (uint32_t i = 0; i < keys_per_thread; i++) {
+                const uint32_t k = i * num_threads + thread_idx;
+                Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(k)} };
+                Tuple tuple{values, 1, schema};
+                ASSERT_TRUE(hash_table.Remove(tuple.GetData()));
+            }
+        };
+
+        const uint64_t num_ops = static_cast<uint64_t>(keys_per_thread) * num_threads;
+        auto measure = [&](auto job) {
+            const auto start = std::chrono::steady_clock::now();
+            LaunchParallelTest(num_threads, job);
+            const auto finish = std::chrono::steady_clock::now();
+            return static_cast<uint64_t>(num_ops / std::chrono::duration<double>(finish - start).count());
+        };
+
+        const uint64_t insert_ops = measure(insert_job);
+        ASSERT_TRUE(hash_table.VerifyIntegrity());
+        const uint64_t lookup_ops = measure(lookup_job);
+        const uint64_t remove_ops = measure(remove_job);
+
+        std::cout << " threads: " << static_cast<int>(num_threads)
+            << "\tinsert: " << insert_ops << " ops/sec"
+            << "\tlookup: " << lookup_ops << " ops/sec"
+            << "\tremove: " << remove_ops << " ops/sec" << std::endl;
+    }
+}
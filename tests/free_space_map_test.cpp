@@ -0,0 +1,158 @@
+#include <dbcore/free_space_map.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_iterator.h>
+#include <dbcore/pages_manager.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/rid.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "utils.h"
+
+using namespace dbcore;
+using namespace testutils;
+
+namespace
+{
+
+/** @return the number of pages which keep the rows of the table */
+uint32_t CountPages(TableHeap& table_heap)
+{
+    std::set<page_id_t> pages;
+    for (auto itr = table_heap.MakeIterator(); !itr.IsEnd(); itr.Next()) {
+        pages.insert(itr.GetRID().GetPageId());
+    }
+    return static_cast<uint32_t>(pages.size());
+}
+
+}
+
+TEST(FreeSpaceMapTest, BucketsTest)
+{
+    FreeSpaceMap free_space_map;
+    EXPECT_EQ(free_space_map.FindPage(1, 0), INVALID_PAGE_ID);
+
+    free_space_map.Update(1, 100);
+    free_space_map.Update(2, 2000);
+    free_space_map.Update(3, 5000);
+    EXPECT_EQ(free_space_map.GetNumPages(), 3);
+
+    // the page has to have at least the requested space
+    EXPECT_EQ(free_space_map.FindPage(4000, 0), 3);
+    EXPECT_EQ(free_space_map.FindPage(6000, 0), INVALID_PAGE_ID);
+    EXPECT_EQ(free_space_map.FindPage(1500, 0), 2);
+
+    // the page moves between the buckets when its free space changes
+    free_space_map.Update(3, 10);
+    EXPECT_EQ(free_space_map.FindPage(4000, 0), INVALID_PAGE_ID);
+    free_space_map.Update(1, 8000);
+    EXPECT_EQ(free_space_map.FindPage(4000, 0), 1);
+    EXPECT_EQ(free_space_map.GetNumPages(), 3);
+
+    // the different hints get the different pages of the same bucket
+    free_space_map.Update(4, 8000);
+    EXPECT_NE(free_space_map.FindPage(4000, 0), free_space_map.FindPage(4000, 1));
+}
+
+TEST(FreeSpaceMapTest, ReuseFreeSpaceTest)
+{
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+
+    PagesManager pages_manager(1000);
+    TableHeap table_heap(pages_manager);
+
+    constexpr int32_t num_rows = 20000;
+    std::vector<RID> rids;
+    for (int32_t key = 0; key < num_rows; key++) {
+        rids.push_back(table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(key, schema)));
+        ASSERT_NE(rids.back().GetPageId(), INVALID_PAGE_ID);
+    }
+    const uint32_t num_pages = CountPages(table_heap);
+    ASSERT_GT(num_pages, 10);
+
+    // the half of rows of every page is deleted
+    for (int32_t key = 0; key < num_rows; key += 2) {
+        ASSERT_TRUE(table_heap.MarkDelete(rids[key]));
+        ASSERT_TRUE(table_heap.ReleaseSlot(rids[key]));
+    }
+
+    // the concurrent inserters fill the free space of the pages, the table almost doesn't grow
+    constexpr uint32_t num_threads = 4;
+    constexpr int32_t num_inserts = num_rows / 2 / num_threads;
+    std::vector<std::set<page_id_t>> thread_pages(num_threads);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int32_t i = 0; i < num_inserts; i++) {
+                const RID rid = table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(num_rows + t * num_inserts + i, schema));
+                EXPECT_NE(rid.GetPageId(), INVALID_PAGE_ID);
+                thread_pages[t].insert(rid.GetPageId());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // the pages are filled up to the granularity of free space map, so the rest might take one more page
+    EXPECT_LE(CountPages(table_heap), num_pages + 1);
+    for (uint32_t t = 0; t < num_threads; t++) {
+        EXPECT_GT(thread_pages[t].size(), 1);
+    }
+
+    int32_t num_scanned = 0;
+    for (auto itr = table_heap.MakeIterator(); !itr.IsEnd(); itr.Next()) {
+        num_scanned++;
+    }
+    EXPECT_EQ(num_scanned, num_rows);
+}
+
+TEST(FreeSpaceMapTest, ReopenTest)
+{
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+
+    PagesManager pages_manager(1000);
+    page_id_t first_page_id = INVALID_PAGE_ID, last_page_id = INVALID_PAGE_ID;
+    constexpr int32_t num_rows = 20000;
+    uint32_t num_pages = 0;
+    std::set<page_id_t> freed_pages;
+    {
+        TableHeap table_heap(pages_manager);
+        std::vector<RID> rids;
+        for (int32_t key = 0; key < num_rows; key++) {
+            rids.push_back(table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(key, schema)));
+        }
+        num_pages = CountPages(table_heap);
+        ASSERT_GT(num_pages, 2 * TableHeap::FSM_COLLECT_PAGES);
+
+        // the rows of the first half of the table are deleted
+        for (int32_t key = 0; key < num_rows / 2; key++) {
+            ASSERT_TRUE(table_heap.MarkDelete(rids[key]));
+            ASSERT_TRUE(table_heap.ReleaseSlot(rids[key]));
+            freed_pages.insert(rids[key].GetPageId());
+        }
+        first_page_id = table_heap.GetFirstPageId();
+        last_page_id = table_heap.GetLastPageId();
+    }
+
+    // the reopened table reuses the space left by the deletes before the last page it knows
+    TableHeap table_heap(pages_manager, first_page_id, nullptr, last_page_id);
+    uint32_t num_reused = 0;
+    for (int32_t key = num_rows; key < num_rows + num_rows / 2; key++) {
+        const RID rid = table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(key, schema));
+        ASSERT_NE(rid.GetPageId(), INVALID_PAGE_ID);
+        num_reused += freed_pages.count(rid.GetPageId());
+    }
+    EXPECT_GT(num_reused, static_cast<uint32_t>(num_rows / 4));
+    EXPECT_LE(CountPages(table_heap), num_pages + 1);
+}
@@ -0,0 +1,278 @@
+#include <dbcore/catalog.h>
+#include <dbcore/executor_context.h>
+#include <dbcore/hash_join_executor.h>
+#include <dbcore/join_hash_table.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/values_executor.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "utils.h"
+
+using namespace dbcore;
+using testutils::Load;
+
+namespace
+{
+
+const char* NAMES[] = { "alpha", "beta", "gamma" };
+
+/** The build side: (id INTEGER, name VARCHAR(16)) */
+Schema MakeBuildSchema()
+{
+    Column cols[] = { Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 16} };
+    return Schema{cols, 2};
+}
+
+/** The probe side: (v BIGINT, k INTEGER) */
+Schema MakeProbeSchema()
+{
+    Column cols[] = { Column{"v", TypeId::BIGINT}, Column{"k", TypeId::INTEGER} };
+    return Schema{cols, 2};
+}
+
+/** The build rows: every id in [0, num_rows), the ids divisible by 7 twice */
+std::vector<Tuple> MakeBuildTuples(int32_t num_rows, const Schema& schema)
+{
+    std::vector<Tuple> tuples;
+    for (int32_t id = 0; id < num_rows; id++) {
+        for (int32_t n = 0; n < (id % 7 == 0 ? 2 : 1); n++) {
+            const char* name = NAMES[id % 3];
+            Value values[] = { Value{TypeId::INTEGER, id}, Value{TypeId::VARCHAR, name, static_cast<uint32_t>(::strlen(name)), false} };
+            tuples.emplace_back(values, 2, schema);
+        }
+    }
+    return tuples;
+}
+
+/** The probe rows: the keys are i * 3 for i in [0, num_rows), so a part of them has no match */
+std::vector<Tuple> MakeProbeTuples(int32_t num_rows, const Schema& schema)
+{
+    std::vector<Tuple> tuples;
+    for (int32_t i = 0; i < num_rows; i++) {
+        Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(i)}, Value{TypeId::INTEGER, i * 3} };
+        tuples.emplace_back(values, 2, schema);
+    }
+    return tuples;
+}
+
+using JoinedRow = std::tuple<int32_t, int32_t, int64_t>;
+
+std::vector<JoinedRow> MakeExpected(int32_t num_build_rows, int32_t num_probe_rows)
+{
+    std::vector<JoinedRow> expected;
+    for (int32_t i = 0; i < num_probe_rows; i++) {
+        const int32_t id = i * 3;
+        if (id < num_build_rows) {
+            for (int32_t n = 0; n < (id % 7 == 0 ? 2 : 1); n++) {
+                expected.emplace_back(id, id, i);
+            }
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    return expected;
+}
+
+/** Run the join, check the names of joined rows and collect (id, k, v) */
+std::vector<JoinedRow> Collect(HashJoinExecutor& join)
+{
+    const Schema& schema = join.GetOutputSchema();
+    std::vector<JoinedRow> result;
+    std::vector<TupleView> batch;
+    join.Init();
+    while (join.Next(batch)) {
+        EXPECT_FALSE(batch.empty());
+        for (const TupleView& row : batch) {
+            const int32_t id = Load<int32_t>(row, schema, 0);
+            const char* name = NAMES[id % 3];
+            const uint32_t name_size = static_cast<uint32_t>(::strlen(name));
+            const char* data = row.GetData() + Load<uint32_t>(row, schema, 1);
+            EXPECT_TRUE(::memcmp(data, &name_size, sizeof(name_size)) == 0
+                        && ::memcmp(data + sizeof(name_size), name, name_size) == 0) << id;
+            result.emplace_back(id, Load<int32_t>(row, schema, 3), Load<int64_t>(row, schema, 2));
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}
+
+TEST(HashJoinTest, JoinHashTableTest)
+{
+    Column cols[] = { Column{"id", TypeId::INTEGER} };
+    Schema schema{cols, 1};
+    constexpr uint32_t num_rows = 100000;
+    std::vector<Tuple> tuples;
+    for (uint32_t i = 0; i < num_rows; i++) {
+        Value value{TypeId::INTEGER, static_cast<int32_t>(i)};
+        tuples.emplace_back(&value, 1, schema);
+    }
+
+    JoinHashTable table(sizeof(uint32_t));
+    for (uint32_t i = 0; i < num_rows; i++) {
+        const uint32_t key = i;
+        table.Insert(TupleView{tuples[i]},
+                     reinterpret_cast<const char*>(&key), key * 0x9E3779B1u);
+    }
+    table.Build();
+    // the table of 100000 slots doesn't fit into L2, so it is partitioned
+    EXPECT_GT(table.GetNumPartitions(), 1);
+
+    for (uint32_t i = 0; i < num_rows + 100; i++) {
+        const uint32_t key = i;
+        uint32_t num_found = 0;
+        table.Probe(reinterpret_cast<const char*>(&key), key * 0x9E3779B1u, [&](const TupleView& row) {
+            EXPECT_EQ(Load<int32_t>(row, schema, 0), static_cast<int32_t>(i));
+            num_found++;
+        });
+        EXPECT_EQ(num_found, i < num_rows ? 1 : 0) << i;
+    }
+
+    // the small table is not partitioned
+    table.Clear();
+    for (uint32_t i = 0; i < 100; i++) {
+        const uint32_t key = i;
+        table.Insert(TupleView{tuples[i]},
+                     reinterpret_cast<const char*>(&key), key * 0x9E3779B1u);
+    }
+    table.Build();
+    EXPECT_EQ(table.GetNumPartitions(), 1);
+}
+
+TEST(HashJoinTest, InMemoryJoinTest)
+{
+    PagesManager pages_manager(100);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    const Schema build_schema = MakeBuildSchema();
+    const Schema probe_schema = MakeProbeSchema();
+    const uint32_t build_key_attrs[] = { 0 };
+    const uint32_t probe_key_attrs[] = { 1 };
+    ASSERT_TRUE(HashJoinExecutor::IsSupported(build_schema, build_key_attrs, probe_schema, probe_key_attrs, 1));
+    // the keys of different types can't be joined
+    const uint32_t bigint_attrs[] = { 0 };
+    EXPECT_FALSE(HashJoinExecutor::IsSupported(build_schema, build_key_attrs, probe_schema, bigint_attrs, 1));
+
+    constexpr int32_t num_build_rows = 20000;
+    constexpr int32_t num_probe_rows = 10000;
+    HashJoinExecutor join(context, std::make_unique<ValuesExecutor>(build_schema, MakeBuildTuples(num_build_rows, build_schema)),
+                          std::make_unique<ValuesExecutor>(probe_schema, MakeProbeTuples(num_probe_rows, probe_schema)),
+                          build_key_attrs, probe_key_attrs, 1);
+    const Schema& output_schema = join.GetOutputSchema();
+    ASSERT_EQ(output_schema.GetColumnCount(), 4);
+    EXPECT_EQ(output_schema.GetColumnAt(1).GetType(), TypeId::VARCHAR);
+    EXPECT_EQ(output_schema.GetColumnAt(2).GetType(), TypeId::BIGINT);
+
+    const std::vector<JoinedRow> expected = MakeExpected(num_build_rows, num_probe_rows);
+    EXPECT_EQ(Collect(join), expected);
+    EXPECT_FALSE(join.IsSpilled());
+
+    // the executor can be run again
+    EXPECT_EQ(Collect(join), expected);
+}
+
+TEST(HashJoinTest, GraceJoinTest)
+{
+    PagesManager pages_manager(2000);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog, &pages_manager);
+    const Schema build_schema = MakeBuildSchema();
+    const Schema probe_schema = MakeProbeSchema();
+    const uint32_t build_key_attrs[] = { 0 };
+    const uint32_t probe_key_attrs[] = { 1 };
+
+    // the build side exceeds the tiny budget, so both sides are partitioned into the pages
+    constexpr int32_t num_build_rows = 20000;
+    constexpr int32_t num_probe_rows = 10000;
+    HashJoinExecutor join(context, std::make_unique<ValuesExecutor>(build_schema, MakeBuildTuples(num_build_rows, build_schema)),
+                          std::make_unique<ValuesExecutor>(probe_schema, MakeProbeTuples(num_probe_rows, probe_schema)),
+                          build_key_attrs, probe_key_attrs, 1, 64 * 1024);
+    const std::vector<JoinedRow> expected = MakeExpected(num_build_rows, num_probe_rows);
+    EXPECT_EQ(Collect(join), expected);
+    EXPECT_TRUE(join.IsSpilled());
+    EXPECT_FALSE(join.HasFailed());
+
+    EXPECT_EQ(Collect(join), expected);
+    EXPECT_TRUE(join.IsSpilled());
+}
+
+TEST(HashJoinTest, VarcharKeyTest)
+{
+    PagesManager pages_manager(100);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    // the keys are hashed and compared by the prefix of 4 bytes
+    Column build_cols[] = { Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 4} };
+    const Schema build_schema{build_cols, 2};
+    Column probe_cols[] = { Column{"name", TypeId::VARCHAR, 4}, Column{"v", TypeId::BIGINT} };
+    const Schema probe_schema{probe_cols, 2};
+    const char* build_names[] = { "abcd", "abcdef", "abcdxy", "abc" };
+    const char* probe_names[] = { "abcdef", "abcd", "abcdz", "abc" };
+
+    std::vector<Tuple> build_tuples;
+    for (int32_t id = 0; id < 4; id++) {
+        const char* name = build_names[id];
+        Value values[] = { Value{TypeId::INTEGER, id}, Value{TypeId::VARCHAR, name, static_cast<uint32_t>(::strlen(name)), false} };
+        build_tuples.emplace_back(values, 2, build_schema);
+    }
+    std::vector<Tuple> probe_tuples;
+    for (int64_t v = 0; v < 4; v++) {
+        const char* name = probe_names[v];
+        Value values[] = { Value{TypeId::VARCHAR, name, static_cast<uint32_t>(::strlen(name)), false}, Value{TypeId::BIGINT, v} };
+        probe_tuples.emplace_back(values, 2, probe_schema);
+    }
+
+    const uint32_t build_key_attrs[] = { 1 };
+    const uint32_t probe_key_attrs[] = { 0 };
+    HashJoinExecutor join(context, std::make_unique<ValuesExecutor>(build_schema, std::move(build_tuples)),
+                          std::make_unique<ValuesExecutor>(probe_schema, std::move(probe_tuples)),
+                          build_key_attrs, probe_key_attrs, 1);
+    std::vector<std::pair<int32_t, int64_t>> result;
+    std::vector<TupleView> batch;
+    join.Init();
+    while (join.Next(batch)) {
+        for (const TupleView& row : batch) {
+            result.emplace_back(Load<int32_t>(row, join.GetOutputSchema(), 0), Load<int64_t>(row, join.GetOutputSchema(), 3));
+        }
+    }
+    std::sort(result.begin(), result.end());
+    // only the equal full values are joined: "abcd", "abcdef" and "abc"
+    const std::vector<std::pair<int32_t, int64_t>> expected = { {0, 1}, {1, 0}, {3, 3} };
+    EXPECT_EQ(result, expected);
+}
+
+TEST(HashJoinTest, SpillFailureTest)
+{
+    // the pool without storage has too few pages for the partitions
+    PagesManager pages_manager(8);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog, &pages_manager);
+    const Schema build_schema = MakeBuildSchema();
+    const Schema probe_schema = MakeProbeSchema();
+    const uint32_t build_key_attrs[] = { 0 };
+    const uint32_t probe_key_attrs[] = { 1 };
+
+    HashJoinExecutor join(context, std::make_unique<ValuesExecutor>(build_schema, MakeBuildTuples(20000, build_schema)),
+                          std::make_unique<ValuesExecutor>(probe_schema, MakeProbeTuples(10000, probe_schema)),
+                          build_key_attrs, probe_key_attrs, 1, 64 * 1024);
+    EXPECT_TRUE(Collect(join).empty());
+    EXPECT_TRUE(join.HasFailed());
+    EXPECT_FALSE(join.IsSpilled());
+
+    // the pages of the failed spills are given back
+    page_id_t page_id = INVALID_PAGE_ID;
+    EXPECT_NE(pages_manager.NextFreePageGuarded(&page_id).PageId(), INVALID_PAGE_ID);
+}
@@ -0,0 +1,164 @@
+#include <dbcore/pages_manager.h>
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/index.h>
+#include <dbcore/index_iterator.h>
+#include <dbcore/rid.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace dbcore;
+
+namespace
+{
+
+Tuple MakeTuple(int32_t key, const Schema& schema)
+{
+    Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(0)}, Value{TypeId::INTEGER, key} };
+    return Tuple{values, 2, schema};
+}
+
+/** The RID of the row with the given key */
+RID KeyRID(int32_t key)
+{
+    return RID{static_cast<page_id_t>(key + 1000), static_cast<slot_id_t>(key & 0xFF)};
+}
+
+std::vector<RID> ReadAll(IndexIterator& itr)
+{
+    std::vector<RID> rids;
+    for (; !itr.IsEnd(); ++itr) {
+        rids.push_back(*itr);
+    }
+    return rids;
+}
+
+}
+
+TEST(IndexScanTest, RangeTest)
+{
+    constexpr uint32_t num_of_pages = 1000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column tbl_cols[] = { Column{"a", TypeId::BIGINT}, Column{"b", TypeId::INTEGER} };
+    Schema tbl_schema{tbl_cols, 2};
+    uint32_t key_attrs[] = { 1 };
+    Schema key_schema{Schema::CopySchema(tbl_schema, key_attrs, 1)};
+    IndexMetadata metadata(key_attrs, 1, key_schema, tbl_schema);
+    Index index(IndexType::BPlusTreeIndex, metadata, pages_manager);
+    ASSERT_TRUE(index.SupportsRangeScan());
+
+    // the even keys in [-1000, 1000) are indexed
+    std::vector<int32_t> keys;
+    for (int32_t k = -1000; k < 1000; k += 2)
+        keys.push_back(k);
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+    for (auto k : keys) {
+        ASSERT_TRUE(index.InsertEntry(MakeTuple(k, tbl_schema), KeyRID(k)));
+    }
+
+    // the reference scan
+    auto expected_range = [](int32_t lo, bool lo_inclusive, int32_t hi, bool hi_inclusive) {
+        std::vector<RID> rids;
+        for (int32_t k = -1000; k < 1000; k += 2) {
+            if ((k > lo || (lo_inclusive && k == lo)) && (k < hi || (hi_inclusive && k == hi)))
+                rids.push_back(KeyRID(k));
+        }
+        return rids;
+    };
+
+    // the bounds are both present and missing keys, inside and outside of the indexed keys
+    const int32_t bounds[] = { -2000, -1000, -999, -2, -1, 0, 1, 500, 998, 999, 1000, 2000 };
+    for (auto lo : bounds) {
+        for (auto hi : bounds) {
+            for (bool lo_inclusive : {true, false}) {
+                for (bool hi_inclusive : {true, false}) {
+                    const Tuple lo_tuple = MakeTuple(lo, tbl_schema);
+                    const Tuple hi_tuple = MakeTuple(hi, tbl_schema);
+                    IndexIterator itr = index.ScanRange(&lo_tuple, lo_inclusive, &hi_tuple, hi_inclusive);
+                    EXPECT_EQ(ReadAll(itr), expected_range(lo, lo_inclusive, hi, hi_inclusive))
+                        << (lo_inclusive ? "[" : "(") << lo << ", " << hi << (hi_inclusive ? "]" : ")");
+                }
+            }
+        }
+    }
+
+    // unbounded ranges
+    const Tuple bound = MakeTuple(0, tbl_schema);
+    IndexIterator all_itr = index.ScanRange(nullptr, true, nullptr, true);
+    EXPECT_EQ(ReadAll(all_itr), expected_range(-2000, true, 2000, true));
+    IndexIterator below_itr = index.ScanRange(nullptr, true, &bound, false);
+    EXPECT_EQ(ReadAll(below_itr), expected_range(-2000, true, 0, false));
+    IndexIterator above_itr = index.ScanRange(&bound, false, nullptr, true);
+    EXPECT_EQ(ReadAll(above_itr), expected_range(0, false, 2000, true));
+}
+
+TEST(IndexScanTest, BatchTest)
+{
+    constexpr uint32_t num_of_pages = 1000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column tbl_cols[] = { Column{"a", TypeId::BIGINT}, Column{"b", TypeId::INTEGER} };
+    Schema tbl_schema{tbl_cols, 2};
+    uint32_t key_attrs[] = { 1 };
+    Schema key_schema{Schema::CopySchema(tbl_schema, key_attrs, 1)};
+    IndexMetadata metadata(key_attrs, 1, key_schema, tbl_schema);
+    Index index(IndexType::BPlusTreeIndex, metadata, pages_manager);
+
+    constexpr int32_t num_keys = 5000;
+    for (int32_t k = 0; k < num_keys; k++) {
+        ASSERT_TRUE(index.InsertEntry(MakeTuple(k, tbl_schema), KeyRID(k)));
+    }
+
+    for (size_t batch_size : {1, 7, 64, 1000, 10000}) {
+        const Tuple lo = MakeTuple(100, tbl_schema);
+        const Tuple hi = MakeTuple(4000, tbl_schema);
+        IndexIterator itr = index.ScanRange(&lo, true, &hi, false);
+
+        std::vector<RID> batch(batch_size);
+        int32_t expected_key = 100;
+        while (true) {
+            const size_t count = itr.Next(batch.data(), batch_size);
+            for (size_t i = 0; i < count; i++) {
+                ASSERT_EQ(batch[i], KeyRID(expected_key));
+                expected_key++;
+            }
+            if (count < batch_size) {
+                break;
+            }
+        }
+        EXPECT_EQ(expected_key, 4000);
+        EXPECT_TRUE(itr.IsEnd());
+        EXPECT_EQ(itr.Next(batch.data(), batch_size), 0);
+    }
+
+    // the range is empty
+    const Tuple lo = MakeTuple(10, tbl_schema);
+    const Tuple hi = MakeTuple(5, tbl_schema);
+    IndexIterator itr = index.ScanRange(&lo, true, &hi, true);
+    EXPECT_TRUE(itr.IsEnd());
+}
+
+TEST(IndexScanTest, HashIndexTest)
+{
+    constexpr uint32_t num_of_pages = 100;
+    PagesManager pages_manager(num_of_pages);
+
+    Column tbl_cols[] = { Column{"a", TypeId::BIGINT}, Column{"b", TypeId::INTEGER} };
+    Schema tbl_schema{tbl_cols, 2};
+    uint32_t key_attrs[] = { 1 };
+    Schema key_schema{Schema::CopySchema(tbl_schema, key_attrs, 1)};
+    IndexMetadata metadata(key_attrs, 1, key_schema, tbl_schema);
+    Index index(IndexType::HashTableIndex, metadata, pages_manager);
+    ASSERT_FALSE(index.SupportsRangeScan());
+
+    ASSERT_TRUE(index.InsertEntry(MakeTuple(1, tbl_schema), KeyRID(1)));
+    IndexIterator itr = index.ScanRange(nullptr, true, nullptr, true);
+    EXPECT_TRUE(itr.IsEnd());
+}
@@ -0,0 +1,182 @@
+#include <dbcore/b_plus_tree.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/column.h>
+#include <dbcore/key_encoder.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/tuple_compare.h>
+#include <dbcore/rid.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace dbcore;
+
+namespace
+{
+
+std::vector<char> Encode(const KeyEncoder& encoder, const Tuple& tuple)
+{
+    std::vector<char> key(encoder.GetKeySize());
+    encoder.Encode(tuple.GetData(), key.data());
+    return key;
+}
+
+int Sign(int v)
+{
+    return (v > 0) - (v < 0);
+}
+
+}
+
+TEST(KeyEncoderTest, FixedWidthColumnsTest)
+{
+    Column cols[] = { Column{"a", TypeId::TINYINT}, Column{"b", TypeId::SMALLINT},
+                    Column{"c", TypeId::INTEGER}, Column{"d", TypeId::BIGINT},
+                    Column{"e", TypeId::TIMESTAMP} };
+    Schema schema{cols, 5};
+    KeyEncoder encoder(schema);
+    ASSERT_EQ(encoder.GetKeySize(), 1 + 2 + 4 + 8 + 8);
+
+    // the reference comparator of fixed-width keys
+    TupleCompare cmp(schema);
+    TupleCompare normalized_cmp(encoder);
+    ASSERT_TRUE(normalized_cmp.IsNormalized());
+
+    std::default_random_engine rng;
+    // narrow ranges make equal prefixes frequent, the extremes check the sign handling
+    std::uniform_int_distribution<int> dist(-2, 2);
+    const int64_t bigints[] = { std::numeric_limits<int64_t>::min(), -1, 0, 1, std::numeric_limits<int64_t>::max() };
+    const uint64_t timestamps[] = { 0, 1, 0x7FFFFFFFFFFFFFFFULL, 0x8000000000000000ULL, std::numeric_limits<uint64_t>::max() };
+
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 200; i++) {
+        Value values[] = {
+            Value{TypeId::TINYINT, static_cast<int8_t>(dist(rng) * 60)},
+            Value{TypeId::SMALLINT, static_cast<int16_t>(dist(rng) * 16000)},
+            Value{TypeId::INTEGER, static_cast<int32_t>(dist(rng) * 1000000000)},
+            Value{TypeId::BIGINT, bigints[dist(rng) + 2]},
+            Value{TypeId::TIMESTAMP, timestamps[dist(rng) + 2]}
+        };
+        tuples.emplace_back(values, 5, schema);
+    }
+
+    for (const auto& lhs : tuples) {
+        const std::vector<char> lhs_key = Encode(encoder, lhs);
+        for (const auto& rhs : tuples) {
+            const std::vector<char> rhs_key = Encode(encoder, rhs);
+            const int expected = cmp(lhs.GetData(), rhs.GetData());
+            ASSERT_EQ(Sign(::memcmp(lhs_key.data(), rhs_key.data(), encoder.GetKeySize())), expected);
+            ASSERT_EQ(normalized_cmp(lhs_key.data(), rhs_key.data()), expected);
+        }
+    }
+}
+
+TEST(KeyEncoderTest, VarcharColumnTest)
+{
+    constexpr uint32_t prefix_length = 6;
+    Column cols[] = { Column{"a", TypeId::VARCHAR, prefix_length}, Column{"b", TypeId::INTEGER} };
+    Schema schema{cols, 2};
+    KeyEncoder encoder(schema);
+    ASSERT_EQ(encoder.GetKeySize(), prefix_length + 4);
+
+    const std::string strings[] = { "", "a", "ab", "abc", "abd", "b", "abcdef", "abcdefgh", "abcdefxy", "zzzzzzzzzz" };
+    const int32_t integers[] = { -5, 0, 5 };
+
+    struct Entry {
+        std::string str;
+        int32_t integer;
+        std::vector<char> key;
+    };
+    std::vector<Entry> entries;
+    for (const auto& s : strings) {
+        for (const auto n : integers) {
+            Value values[] = { Value{TypeId::VARCHAR, s.data(), static_cast<uint32_t>(s.size()), true},
+                                Value{TypeId::INTEGER, n} };
+            const Tuple tuple{values, 2, schema};
+            entries.push_back({s, n, Encode(encoder, tuple)});
+        }
+    }
+
+    for (const auto& lhs : entries) {
+        for (const auto& rhs : entries) {
+            // the strings are compared by the prefix of declared length
+            int expected = Sign(lhs.str.substr(0, prefix_length).compare(rhs.str.substr(0, prefix_length)));
+            if (expected == 0) {
+                expected = (lhs.integer > rhs.integer) - (lhs.integer < rhs.integer);
+            }
+            ASSERT_EQ(Sign(::memcmp(lhs.key.data(), rhs.key.data(), encoder.GetKeySize())), expected)
+                << lhs.str << "," << lhs.integer << " vs " << rhs.str << "," << rhs.integer;
+        }
+    }
+}
+
+TEST(KeyEncoderTest, EncodeFromTableTupleTest)
+{
+    Column cols[] = { Column{"a", TypeId::BIGINT}, Column{"b", TypeId::VARCHAR, 12},
+                        Column{"c", TypeId::SMALLINT}, Column{"d", TypeId::VARCHAR, 8} };
+    Schema schema{cols, 4};
+    // the key attributes are in the other order than in the table
+    std::array<uint32_t, MAX_COLUMN_COUNT> key_attrs{3, 0, 2};
+    Schema key_schema{Schema::CopySchema(schema, key_attrs.data(), 3)};
+    KeyEncoder encoder(key_schema);
+
+    const std::string strings[] = { "", "ab", "abcdefghijklmn" };
+    for (const auto& s : strings) {
+        Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(-42)},
+                            Value{TypeId::VARCHAR, s.data(), static_cast<uint32_t>(s.size()), true},
+                            Value{TypeId::SMALLINT, static_cast<int16_t>(7)},
+                            Value{TypeId::VARCHAR, s.data(), static_cast<uint32_t>(s.size()), true} };
+        const Tuple tuple{values, 4, schema};
+
+        // the key encoded right from the table tuple is the same as the one of key tuple
+        std::vector<char> key(encoder.GetKeySize());
+        encoder.Encode(tuple.GetData(), schema, key_attrs.data(), key.data());
+        const Tuple key_tuple{tuple.KeyFromTuple(schema, key_schema, key_attrs, 3)};
+        EXPECT_EQ(key, Encode(encoder, key_tuple)) << s;
+    }
+}
+
+TEST(KeyEncoderTest, BPlusTreeOrderTest)
+{
+    constexpr uint32_t num_of_pages = 1000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column cols[] = { Column{"a", TypeId::BIGINT} };
+    Schema schema{cols, 1};
+    KeyEncoder encoder(schema);
+    TupleCompare key_cmp(encoder);
+
+    const uint16_t leaf_max_size = 3;
+    const uint16_t internal_max_size = 4;
+    BPlusTree bplus_tree(pages_manager, key_cmp, encoder.GetKeySize(), leaf_max_size, internal_max_size);
+
+    // negative keys are ordered before positive ones only when the sign bit is flipped
+    std::vector<int64_t> keys;
+    for (int64_t k = -500; k < 500; k++)
+        keys.push_back(k);
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+
+    for (auto k : keys) {
+        Value values[] = { Value{TypeId::BIGINT, k} };
+        const Tuple tuple{values, 1, schema};
+        const std::vector<char> key = Encode(encoder, tuple);
+        const RID rid{static_cast<page_id_t>(k + 500), 0};
+        ASSERT_TRUE(bplus_tree.Insert(key.data(), rid));
+    }
+
+    uint32_t expected = 0;
+    for (auto it = bplus_tree.Begin(); it != bplus_tree.End(); ++it) {
+        ASSERT_EQ(*it, RID(expected, 0));
+        expected++;
+    }
+    EXPECT_EQ(expected, keys.size());
+}
@@ -0,0 +1,279 @@
+#include <dbcore/log_manager.h>
+#include <dbcore/log_record.h>
+#include <dbcore/log_recovery.h>
+#include <dbcore/disk_manager.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_iterator.h>
+#include <dbcore/index.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/rid.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <iostream>
+
+#include "utils.h"
+
+using namespace dbcore;
+using namespace testutils;
+
+TEST(LogManagerTest, LogRecordTest)
+{
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+    const Tuple tuple = MakeTuple(42, schema);
+
+    const LogRecord record = LogRecord::TableInsert(RID{7, 3}, TupleMeta{5, false}, tuple);
+    std::vector<char> data(record.GetSize());
+    record.Serialize(1000, data.data());
+
+    LogRecord restored;
+    ASSERT_EQ(LogRecord::Deserialize(data.data(), data.size(), restored), record.GetSize());
+    EXPECT_EQ(restored.GetType(), LogRecordType::TABLE_INSERT);
+    EXPECT_EQ(restored.GetLSN(), 1000);
+    EXPECT_EQ(restored.GetPageId(), 7);
+    EXPECT_EQ(restored.GetRID(), RID(7, 3));
+    EXPECT_EQ(restored.GetTupleMeta()._ts, 5);
+    ASSERT_EQ(restored.GetDataSize(), tuple.GetLength());
+    EXPECT_EQ(::memcmp(restored.GetData(), tuple.GetData(), tuple.GetLength()), 0);
+
+    // the incomplete and the corrupted records are rejected
+    EXPECT_EQ(LogRecord::Deserialize(data.data(), data.size() - 1, restored), 0);
+    data[data.size() - 1] ^= 1;
+    EXPECT_EQ(LogRecord::Deserialize(data.data(), data.size(), restored), 0);
+
+    // the changed ranges of index pages
+    const char bytes[] = "changed bytes";
+    LogRecord pages_record = LogRecord::IndexPages(3);
+    pages_record.AddPageChange({11, true, 0, 5, bytes});
+    pages_record.AddPageChange({12, false, 100, sizeof(bytes), bytes});
+    std::vector<char> pages_data(pages_record.GetSize());
+    pages_record.Serialize(2000, pages_data.data());
+    ASSERT_EQ(LogRecord::Deserialize(pages_data.data(), pages_data.size(), restored), pages_record.GetSize());
+    EXPECT_EQ(restored.GetType(), LogRecordType::INDEX_PAGES);
+    EXPECT_EQ(restored.GetIndexOid(), 3);
+
+    std::vector<LogRecord::PageChange> changes;
+    ASSERT_TRUE(restored.GetPageChanges(changes));
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0].page_id, 11);
+    EXPECT_TRUE(changes[0].is_new);
+    EXPECT_EQ(changes[0].size, 5);
+    EXPECT_EQ(::memcmp(changes[0].data, bytes, 5), 0);
+    EXPECT_EQ(changes[1].page_id, 12);
+    EXPECT_FALSE(changes[1].is_new);
+    EXPECT_EQ(changes[1].offset, 100);
+    ASSERT_EQ(changes[1].size, sizeof(bytes));
+    EXPECT_EQ(::memcmp(changes[1].data, bytes, sizeof(bytes)), 0);
+}
+
+namespace
+{
+
+/** Check that every tenth key of the rows is deleted from the index and the rest are found */
+void CheckIndex(const Index& index, int32_t num_rows, const Schema& schema)
+{
+    for (int32_t i = 0; i < num_rows; i++) {
+        RID rid;
+        EXPECT_EQ(index.SearchEntry(MakeTuple(i, schema), &rid), i % 10 != 0) << i;
+    }
+}
+
+}
+
+TEST(LogManagerTest, RecoveryTest)
+{
+    const char* log_file_name = "log_manager_recovery_test.log";
+    const char* db_file_name = "log_manager_recovery_test.db";
+    std::remove(log_file_name);
+    std::remove(db_file_name);
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+    uint32_t key_attrs[] = { 0 };
+    Schema key_schema{Schema::CopySchema(schema, key_attrs, 1)};
+    IndexMetadata metadata(key_attrs, 1, key_schema, schema);
+    constexpr index_oid_t index_oid = 5;
+
+    // the table spans a number of pages
+    constexpr int32_t num_rows = 3000;
+    page_id_t first_page_id = INVALID_PAGE_ID;
+    page_id_t index_root_page_id = INVALID_PAGE_ID;
+    {
+        // nothing reaches the storage except the log
+        LogManager log_manager(log_file_name);
+        ASSERT_TRUE(log_manager.IsOpen());
+        PagesManager pages_manager(100, nullptr, &log_manager);
+        TableHeap table_heap(pages_manager, &log_manager);
+        Index index(IndexType::BPlusTreeIndex, metadata, pages_manager, &log_manager, index_oid);
+        first_page_id = table_heap.GetFirstPageId();
+        index_root_page_id = index.GetRootPageId();
+
+        for (int32_t i = 0; i < num_rows; i++) {
+            const Tuple tuple = MakeTuple(i, schema);
+            const RID rid = table_heap.InsertTuple(TupleMeta{0, false}, tuple);
+            ASSERT_TRUE(index.InsertEntry(tuple, rid));
+        }
+        // every tenth key is deleted from the index
+        for (int32_t i = 0; i < num_rows; i += 10) {
+            index.DeleteEntry(MakeTuple(i, schema));
+        }
+        ASSERT_TRUE(log_manager.Flush());
+    }
+
+    // the torn record at the end of the log is ignored
+    {
+        std::ofstream log_file(log_file_name, std::ios::binary | std::ios::app);
+        log_file << "torn record";
+    }
+
+    {
+        DiskManager disk_manager(db_file_name);
+        LogManager log_manager(log_file_name);
+        PagesManager pages_manager(100, &disk_manager, &log_manager);
+        LogRecovery recovery(log_manager, pages_manager);
+        ASSERT_TRUE(recovery.Redo());
+        EXPECT_GT(recovery.GetNumRedone(), 0);
+        EXPECT_EQ(recovery.GetNumSkipped(), 0);
+
+        // the index pages are redone, so the index is opened by its root page
+        TableHeap table_heap(pages_manager, first_page_id, &log_manager);
+        CheckTable(table_heap, num_rows, schema);
+        Index index(IndexType::BPlusTreeIndex, metadata, pages_manager, &log_manager, index_oid, index_root_page_id);
+        CheckIndex(index, num_rows, schema);
+
+        // the recovered table accepts new rows, which are logged after the recovered ones
+        ASSERT_TRUE(table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(num_rows, schema)).GetPageId() != INVALID_PAGE_ID);
+        ASSERT_TRUE(log_manager.Flush());
+    }
+
+    {
+        /* the pages are on the storage now, the redo from the start of the log
+         (there is no checkpoint) gives them the same contents again */
+        DiskManager disk_manager(db_file_name);
+        LogManager log_manager(log_file_name);
+        PagesManager pages_manager(100, &disk_manager, &log_manager);
+
+        LogRecovery recovery(log_manager, pages_manager);
+        ASSERT_TRUE(recovery.Redo());
+
+        TableHeap table_heap(pages_manager, first_page_id, &log_manager);
+        CheckTable(table_heap, num_rows + 1, schema);
+        Index index(IndexType::BPlusTreeIndex, metadata, pages_manager, &log_manager, index_oid, index_root_page_id);
+        CheckIndex(index, num_rows, schema);
+    }
+
+    std::remove(log_file_name);
+    std::remove(db_file_name);
+}
+
+TEST(LogManagerTest, WriteAheadTest)
+{
+    const char* log_file_name = "log_manager_write_ahead_test.log";
+    const char* db_file_name = "log_manager_write_ahead_test.db";
+    const char* crash_log_file_name = "log_manager_write_ahead_test_crash.log";
+    const char* crash_db_file_name = "log_manager_write_ahead_test_crash.db";
+    for (const char* name : { log_file_name, db_file_name, crash_log_file_name, crash_db_file_name }) {
+        std::remove(name);
+    }
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+
+    constexpr int32_t num_rows = 5000;
+    page_id_t first_page_id = INVALID_PAGE_ID;
+    {
+        // the long flush interval: the log is written only when a page is evicted or on commit
+        DiskManager disk_manager(db_file_name);
+        LogManager log_manager(log_file_name, 60000);
+        // the tiny pool makes the pages evicted while the table grows
+        PagesManager pages_manager(4, &disk_manager, &log_manager);
+        TableHeap table_heap(pages_manager, &log_manager);
+        first_page_id = table_heap.GetFirstPageId();
+
+        for (int32_t i = 0; i < num_rows; i++) {
+            table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(i, schema));
+        }
+        EXPECT_GT(log_manager.GetDurableLSN(), 0);
+
+        // crash: the files are copied as they are, before the rest is written
+        CopyFile(db_file_name, crash_db_file_name);
+        CopyFile(log_file_name, crash_log_file_name);
+    }
+
+    {
+        DiskManager disk_manager(crash_db_file_name);
+        LogManager log_manager(crash_log_file_name);
+        PagesManager pages_manager(100, &disk_manager, &log_manager);
+
+        // every page on the storage has its changes in the log, so the table is consistent
+        LogRecovery recovery(log_manager, pages_manager);
+        ASSERT_TRUE(recovery.Redo());
+
+        int32_t key = 0;
+        TableHeap table_heap(pages_manager, first_page_id, &log_manager);
+        for (auto itr = table_heap.MakeIterator(); !itr.IsEnd(); itr.Next()) {
+            const auto [meta, tuple] = itr.GetTuple();
+            ASSERT_TRUE(SameData(tuple, MakeTuple(key, schema))) << key;
+            key++;
+        }
+        // the rows which reached the storage are recovered, the others might be lost
+        EXPECT_GT(key, 0);
+        EXPECT_LE(key, num_rows);
+    }
+
+    for (const char* name : { log_file_name, db_file_name, crash_log_file_name, crash_db_file_name }) {
+        std::remove(name);
+    }
+}
+
+TEST(LogManagerTest, GroupCommitTest)
+{
+    const char* log_file_name = "log_manager_group_commit_test.log";
+    std::remove(log_file_name);
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+
+    constexpr uint32_t num_threads = 8;
+    constexpr int32_t num_commits = 200;
+    {
+        LogManager log_manager(log_file_name);
+        PagesManager pages_manager(1000, nullptr, &log_manager);
+        TableHeap table_heap(pages_manager, &log_manager);
+
+        // every insert is committed: it's durable when the commit returns
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                for (int32_t i = 0; i < num_commits; i++) {
+                    table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(t * num_commits + i, schema));
+                    EXPECT_TRUE(log_manager.Flush());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const uint64_t num_syncs = log_manager.GetNumSyncs();
+        std::cout << " " << num_threads * num_commits << " commits by " << num_threads
+                << " threads made " << num_syncs << " syncs" << std::endl;
+        // the concurrent commits share the syncs
+        EXPECT_LT(num_syncs, num_threads * num_commits);
+    }
+
+    std::remove(log_file_name);
+}
@@ -0,0 +1,189 @@
+#include <dbcore/b_plus_tree.h>
+#include <dbcore/extendible_hash_table.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/coretypes.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/tuple_compare.h>
+#include <dbcore/tuple_hash.h>
+#include <dbcore/hash.h>
+#include <dbcore/rid.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <iostream>
+
+using namespace dbcore;
+
+namespace
+{
+
+constexpr uint32_t key_size = 8;    // size of bigint
+
+/** The keys laid out one after another */
+std::vector<char> MakeKeys(const std::vector<int64_t>& values, const Schema& schema)
+{
+    std::vector<char> keys(values.size() * key_size);
+    for (size_t i = 0; i < values.size(); i++) {
+        Value v[] = { Value{TypeId::BIGINT, values[i]} };
+        const Tuple tuple{v, 1, schema};
+        std::copy_n(tuple.GetData(), key_size, keys.data() + i * key_size);
+    }
+    return keys;
+}
+
+RID ValueRID(int64_t value)
+{
+    return RID{static_cast<page_id_t>(value), static_cast<slot_id_t>(value & 0xFF)};
+}
+
+/** Every third key of [0, 3 * num_keys) is present, the probes are shuffled and some are repeated */
+std::vector<int64_t> MakeProbes(int64_t num_keys, size_t num_probes)
+{
+    std::default_random_engine rng;
+    std::uniform_int_distribution<int64_t> dist(-10, 3 * num_keys + 10);
+    std::vector<int64_t> probes;
+    for (size_t i = 0; i < num_probes; i++)
+        probes.push_back(dist(rng));
+    return probes;
+}
+
+template <typename Table>
+void CheckMultiGet(const Table& table, const std::vector<int64_t>& probes, const Schema& schema)
+{
+    const std::vector<char> keys = MakeKeys(probes, schema);
+    std::vector<RID> rids(probes.size());
+    std::unique_ptr<bool[]> found(new bool[probes.size()]);
+
+    const size_t num_found = table.MultiGetValue(keys.data(), probes.size(), rids.data(), found.get());
+
+    size_t expected_found = 0;
+    for (size_t i = 0; i < probes.size(); i++) {
+        RID rid;
+        const bool expected = table.GetValue(keys.data() + i * key_size, rid);
+        ASSERT_EQ(found[i], expected) << probes[i];
+        if (expected) {
+            EXPECT_EQ(rids[i], rid);
+            EXPECT_EQ(rids[i], ValueRID(probes[i]));
+            expected_found++;
+        }
+    }
+    EXPECT_EQ(num_found, expected_found);
+}
+
+}
+
+TEST(MultiGetTest, BPlusTreeTest)
+{
+    constexpr uint32_t num_of_pages = 2000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column cols[] = { Column{"a", TypeId::BIGINT} };
+    Schema schema{cols, 1};
+    TupleCompare key_cmp(schema);
+
+    const uint16_t page_sizes[][2] = { {3, 4}, {0, 0} };   // {leaf, internal}, 0 means default
+    for (const auto& page_size : page_sizes) {
+        BPlusTree bplus_tree(pages_manager, key_cmp, key_size, page_size[0], page_size[1]);
+
+        // the empty tree
+        CheckMultiGet(bplus_tree, MakeProbes(10, 10), schema);
+
+        constexpr int64_t num_keys = 1000;
+        std::vector<int64_t> values;
+        for (int64_t i = 0; i < num_keys; i++)
+            values.push_back(3 * i);
+        std::shuffle(values.begin(), values.end(), std::default_random_engine{});
+        const std::vector<char> keys = MakeKeys(values, schema);
+        for (size_t i = 0; i < values.size(); i++) {
+            ASSERT_TRUE(bplus_tree.Insert(keys.data() + i * key_size, ValueRID(values[i])));
+        }
+
+        for (size_t num_probes : {1, 2, 100, 5000}) {
+            CheckMultiGet(bplus_tree, MakeProbes(num_keys, num_probes), schema);
+        }
+    }
+}
+
+TEST(MultiGetTest, HashTableTest)
+{
+    constexpr uint32_t num_of_pages = 2000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column cols[] = { Column{"a", TypeId::BIGINT} };
+    Schema schema{cols, 1};
+    TupleCompare key_cmp(schema);
+    TupleHash key_hash(schema, FNV_hash);
+
+    ExtendibleHashTable hash_table(pages_manager, key_cmp, key_hash, key_size);
+    CheckMultiGet(hash_table, MakeProbes(10, 10), schema);
+
+    constexpr int64_t num_keys = 5000;
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < num_keys; i++)
+        values.push_back(3 * i);
+    const std::vector<char> keys = MakeKeys(values, schema);
+    for (size_t i = 0; i < values.size(); i++) {
+        ASSERT_TRUE(hash_table.Insert(keys.data() + i * key_size, ValueRID(values[i])));
+    }
+
+    for (size_t num_probes : {1, 2, 100, 5000}) {
+        CheckMultiGet(hash_table, MakeProbes(num_keys, num_probes), schema);
+    }
+}
+
+TEST(MultiGetTest, PerformanceTest)
+{
+    constexpr uint32_t num_of_pages = 2000;
+    PagesManager pages_manager(num_of_pages);
+
+    Column cols[] = { Column{"a", TypeId::BIGINT} };
+    Schema schema{cols, 1};
+    TupleCompare key_cmp(schema);
+    BPlusTree bplus_tree(pages_manager, key_cmp, key_size);
+
+    constexpr int64_t num_keys = 100000;
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < num_keys; i++)
+        values.push_back(3 * i);
+    const std::vector<char> keys = MakeKeys(values, schema);
+    for (size_t i = 0; i < values.size(); i++) {
+        ASSERT_TRUE(bplus_tree.Insert(keys.data() + i * key_size, ValueRID(values[i])));
+    }
+
+    constexpr size_t batch_size = 500;
+    const std::vector<int64_t> probes = MakeProbes(num_keys, 100 * batch_size);
+    const std::vector<char> probe_keys = MakeKeys(probes, schema);
+    std::vector<RID> rids(probes.size());
+    std::unique_ptr<bool[]> found(new bool[probes.size()]);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t num_found = 0;
+    for (size_t i = 0; i < probes.size(); i++) {
+        num_found += bplus_tree.GetValue(probe_keys.data() + i * key_size, rids[i]) ? 1 : 0;
+    }
+    auto finish = std::chrono::steady_clock::now();
+    std::cout << " GetValue of " << probes.size() << " keys: "
+            << std::chrono::duration<double, std::milli>(finish - start).count() << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    size_t num_found_batched = 0;
+    for (size_t i = 0; i < probes.size(); i += batch_size) {
+        num_found_batched += bplus_tree.MultiGetValue(probe_keys.data() + i * key_size, batch_size,
+                                                    rids.data() + i, found.get() + i);
+    }
+    finish = std::chrono::steady_clock::now();
+    std::cout << " MultiGetValue of " << probes.size() << " keys by " << batch_size << ": "
+            << std::chrono::duration<double, std::milli>(finish - start).count() << " ms" << std::endl;
+
+    EXPECT_EQ(num_found, num_found_batched);
+}
@@ -1,12 +1,16 @@
 #include <dbcore/pages_manager.h>
+#include <dbcore/disk_manager.h>
 #include <gtest/gtest.h>
 
 #include <limits>
 #include <random>
 #include <algorithm>
 #include <iterator>
+#include <thread>
+#include <vector>
 
 #include <cstring>
+#include <cstdio>
 
 
 using namespace dbcore;
@@ -83,3 +87,143 @@ TEST(PagesManagerTest, BasicTest)
         pages_manager.UnpinPage(page_ids[i], false);
     }
 }
+
+
+TEST(PagesManagerTest, EvictionTest)
+{
+    const char* db_file_name = "pages_manager_eviction_test.db";
+    std::remove(db_file_name);
+
+    constexpr uint32_t num_of_pages = 3;
+    constexpr uint32_t num_of_stored_pages = 20;
+    {
+        DiskManager disk_manager(db_file_name);
+        ASSERT_TRUE(disk_manager.IsOpen());
+        PagesManager pages_manager(num_of_pages, &disk_manager);
+
+        // scenario: allocate more pages than the pool holds, unpinned pages have to be evicted
+        page_id_t page_ids[num_of_stored_pages] = { INVALID_PAGE_ID };
+        for (uint32_t n = 0; n < num_of_stored_pages; n++) {
+            Page* page = pages_manager.NextFreePage(&page_ids[n]);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(static_cast<page_id_t>(n), page_ids[n]);
+            std::memset(page->GetData(), static_cast<int>(n + 1), PAGE_SIZE);
+            EXPECT_TRUE(pages_manager.UnpinPage(page_ids[n], true));
+        }
+
+        // scenario: evicted pages are read back from the disk
+        for (uint32_t n = 0; n < num_of_stored_pages; n++) {
+            Page* page = pages_manager.GetPagePinned(page_ids[n]);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(static_cast<char>(n + 1), page->GetData()[0]);
+            EXPECT_EQ(static_cast<char>(n + 1), page->GetData()[PAGE_SIZE - 1]);
+            EXPECT_TRUE(pages_manager.UnpinPage(page_ids[n], false));
+        }
+
+        // scenario: when all frames are pinned, no more pages available
+        Page* pinned[num_of_pages] = { nullptr };
+        for (uint32_t n = 0; n < num_of_pages; n++) {
+            pinned[n] = pages_manager.GetPagePinned(page_ids[n]);
+            ASSERT_NE(nullptr, pinned[n]);
+        }
+
+        page_id_t page_id = INVALID_PAGE_ID;
+        EXPECT_EQ(nullptr, pages_manager.NextFreePage(&page_id));
+        EXPECT_EQ(INVALID_PAGE_ID, page_id);
+        EXPECT_EQ(nullptr, pages_manager.GetPagePinned(page_ids[num_of_stored_pages - 1]));
+
+        for (uint32_t n = 0; n < num_of_pages; n++) {
+            EXPECT_TRUE(pages_manager.UnpinPage(page_ids[n], false));
+        }
+
+        // scenario: the page given back is reused
+        EXPECT_TRUE(pages_manager.GiveBackPage(page_ids[5]));
+        EXPECT_FALSE(pages_manager.GiveBackPage(page_ids[5]));
+        EXPECT_EQ(nullptr, pages_manager.GetPagePinned(page_ids[5]));
+        Page* page = pages_manager.NextFreePage(&page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(page_ids[5], page_id);
+        EXPECT_EQ(0, page->GetData()[0]);
+        page->GetData()[0] = 'x';
+        EXPECT_TRUE(pages_manager.UnpinPage(page_id, true));
+    }
+
+    // scenario: the pages survive reopening of the database file
+    {
+        DiskManager disk_manager(db_file_name);
+        ASSERT_TRUE(disk_manager.IsOpen());
+        EXPECT_EQ(num_of_stored_pages, disk_manager.GetNumPages());
+        PagesManager pages_manager(num_of_pages, &disk_manager);
+
+        for (uint32_t n = 0; n < num_of_stored_pages; n++) {
+            auto guard = pages_manager.GetPageRead(static_cast<page_id_t>(n));
+            ASSERT_NE(nullptr, guard.GetData());
+            const char expected = (n == 5) ? 'x' : static_cast<char>(n + 1);
+            EXPECT_EQ(expected, guard.GetData()[0]);
+        }
+    }
+
+    std::remove(db_file_name);
+}
+
+TEST(PagesManagerTest, ConcurrentFetchTest)
+{
+    const char* db_file_name = "pages_manager_concurrent_test.db";
+    std::remove(db_file_name);
+
+    constexpr uint32_t num_of_pages = 8;
+    constexpr uint32_t num_of_stored_pages = 64;
+    constexpr uint32_t num_threads = 8;
+    constexpr uint32_t num_iterations = 2000;
+    {
+        DiskManager disk_manager(db_file_name);
+        ASSERT_TRUE(disk_manager.IsOpen());
+        PagesManager pages_manager(num_of_pages, &disk_manager);
+
+        for (uint32_t n = 0; n < num_of_stored_pages; n++) {
+            page_id_t page_id = INVALID_PAGE_ID;
+            auto guard = pages_manager.NextFreePageGuarded(&page_id);
+            ASSERT_EQ(static_cast<page_id_t>(n), page_id);
+            *guard.AsMut<page_id_t>() = page_id;
+        }
+
+        // every thread increments the counters of random pages, 
+        // the pool is small so pages are evicted/loaded all the time
+        auto job = [&pages_manager](uint32_t seed) {
+            std::default_random_engine rng(seed);
+            std::uniform_int_distribution<page_id_t> distribution(0, num_of_stored_pages - 1);
+            for (uint32_t i = 0; i < num_iterations; i++) {
+                const page_id_t page_id = distribution(rng);
+                if (i % 4 == 0) {
+                    auto guard = pages_manager.GetPageWrite(page_id);
+                    ASSERT_NE(nullptr, guard.GetData());
+                    uint32_t* data = guard.AsMut<uint32_t>();
+                    ASSERT_EQ(static_cast<uint32_t>(page_id), data[0]);
+                    data[1] += 1;
+                } else {
+                    auto guard = pages_manager.GetPageRead(page_id);
+                    ASSERT_NE(nullptr, guard.GetData());
+                    ASSERT_EQ(page_id, *guard.As<page_id_t>());
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < num_threads; i++) {
+            threads.emplace_back(job, i);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        uint32_t total = 0;
+        for (uint32_t n = 0; n < num_of_stored_pages; n++) {
+            auto guard = pages_manager.GetPageRead(static_cast<page_id_t>(n));
+            ASSERT_NE(nullptr, guard.GetData());
+            total += guard.As<uint32_t>()[1];
+        }
+        EXPECT_EQ(num_threads * num_iterations / 4, total);
+    }
+
+    std::remove(db_file_name);
+}
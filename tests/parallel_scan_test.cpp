@@ -0,0 +1,131 @@
+#include <dbcore/morsel_scheduler.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/tuple.h>
+#include <dbcore/tuple_view.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "utils.h"
+
+using namespace dbcore;
+using namespace testutils;
+
+namespace
+{
+
+int32_t GetKey(const char* data, const Schema& schema)
+{
+    int32_t key = 0;
+    ::memcpy(&key, data + schema.GetColumnAt(0).GetOffset(), sizeof(key));
+    return key;
+}
+
+}
+
+TEST(ParallelScanTest, MorselSchedulerTest)
+{
+    constexpr uint32_t num_morsels = 1000;
+    constexpr uint32_t num_workers = 4;
+    MorselScheduler scheduler(num_morsels, num_workers);
+
+    // the first worker is slow, so the others steal its morsels
+    std::vector<std::atomic<uint32_t>> taken(num_morsels);
+    std::vector<uint32_t> num_taken(num_workers, 0);
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < num_workers; w++) {
+        threads.emplace_back([&, w]() {
+            uint32_t morsel = 0;
+            while (scheduler.Next(w, &morsel)) {
+                ASSERT_LT(morsel, num_morsels);
+                taken[morsel]++;
+                num_taken[w]++;
+                if (w == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // every morsel is taken exactly once
+    for (uint32_t i = 0; i < num_morsels; i++) {
+        EXPECT_EQ(taken[i].load(), 1) << i;
+    }
+    EXPECT_GT(scheduler.GetNumSteals(), 0);
+    EXPECT_LT(num_taken[0], num_morsels / num_workers);
+
+    // the workers which have nothing to do finish at once
+    MorselScheduler empty_scheduler(2, 4);
+    uint32_t morsel = 0;
+    EXPECT_TRUE(empty_scheduler.Next(3, &morsel));
+    EXPECT_TRUE(empty_scheduler.Next(3, &morsel));
+    EXPECT_FALSE(empty_scheduler.Next(0, &morsel));
+}
+
+TEST(ParallelScanTest, TableScanTest)
+{
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT} };
+    Schema schema{cols, 2};
+
+    PagesManager pages_manager(200);
+    TableHeap table_heap(pages_manager);
+
+    constexpr int32_t num_rows = 20000;
+    for (int32_t i = 0; i < num_rows; i++) {
+        table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(i, schema));
+    }
+    // every third row is deleted
+    std::vector<RID> deleted_rids;
+    for (auto itr = table_heap.MakeIterator(); !itr.IsEnd(); itr.Next()) {
+        const auto [meta, view] = itr.GetTupleView();
+        if (GetKey(view.GetData(), schema) % 3 == 0) {
+            deleted_rids.push_back(view.GetRID());
+        }
+    }
+    for (const RID& rid : deleted_rids) {
+        ASSERT_TRUE(table_heap.MarkDelete(rid));
+    }
+
+    for (uint32_t num_threads : {1, 3, 8}) {
+        std::vector<std::atomic<uint32_t>> visited(num_rows);
+        std::atomic<uint32_t> num_batches{0};
+        table_heap.ParallelScan(num_threads, [&](uint32_t worker_id, const std::vector<TupleView>& batch) {
+            ASSERT_LT(worker_id, num_threads);
+            for (const TupleView& view : batch) {
+                visited[GetKey(view.GetData(), schema)]++;
+            }
+            num_batches++;
+        }, 2);
+
+        for (int32_t i = 0; i < num_rows; i++) {
+            ASSERT_EQ(visited[i].load(), i % 3 == 0 ? 0 : 1) << i;
+        }
+        EXPECT_GT(num_batches.load(), 2 * num_threads);
+    }
+
+    const std::vector<RID> rids = table_heap.ParallelFilter(4, [&](const TupleView& view) {
+        return GetKey(view.GetData(), schema) % 10 == 1;
+    });
+    std::vector<bool> found(num_rows, false);
+    for (const RID& rid : rids) {
+        const auto [meta, tuple] = table_heap.GetTuple(rid);
+        const int32_t key = GetKey(tuple.GetData(), schema);
+        EXPECT_EQ(key % 10, 1);
+        EXPECT_FALSE(found[key]);
+        found[key] = true;
+    }
+    // the deleted rows are not found
+    for (int32_t i = 0; i < num_rows; i++) {
+        EXPECT_EQ(found[i], i % 10 == 1 && i % 3 != 0) << i;
+    }
+}
@@ -0,0 +1,239 @@
+#include <dbcore/catalog.h>
+#include <dbcore/executor_context.h>
+#include <dbcore/loser_tree.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/sort_executor.h>
+#include <dbcore/values_executor.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "utils.h"
+
+using namespace dbcore;
+using testutils::Load;
+
+namespace
+{
+
+/** The rows: (k INTEGER, name VARCHAR(16), seq BIGINT) */
+Schema MakeSchema()
+{
+    Column cols[] = { Column{"k", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 16}, Column{"seq", TypeId::BIGINT} };
+    return Schema{cols, 3};
+}
+
+/** The keys are random in [-1000, 1000] (so many of them are duplicated), seq is the position of the row */
+std::vector<Tuple> MakeTuples(int32_t num_rows, const Schema& schema)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int32_t> dist(-1000, 1000);
+    std::vector<Tuple> tuples;
+    for (int32_t i = 0; i < num_rows; i++) {
+        const int32_t k = dist(gen);
+        const std::string name = "n" + std::to_string(k + 1000);
+        Value values[] = { Value{TypeId::INTEGER, k}, Value{TypeId::VARCHAR, name.c_str(), static_cast<uint32_t>(name.size()), false},
+                           Value{TypeId::BIGINT, static_cast<int64_t>(i)} };
+        tuples.emplace_back(values, 3, schema);
+    }
+    return tuples;
+}
+
+/** Run the sort and collect (k, seq) of the produced rows */
+std::vector<std::pair<int32_t, int64_t>> Collect(SortExecutor& sort)
+{
+    const Schema& schema = sort.GetOutputSchema();
+    std::vector<std::pair<int32_t, int64_t>> result;
+    std::vector<TupleView> batch;
+    sort.Init();
+    while (sort.Next(batch)) {
+        EXPECT_FALSE(batch.empty());
+        for (const TupleView& row : batch) {
+            result.emplace_back(Load<int32_t>(row, schema, 0), Load<int64_t>(row, schema, 2));
+        }
+    }
+    return result;
+}
+
+/** The rows sorted by k, the rows of equal keys in order of seq (the sort is stable) */
+std::vector<std::pair<int32_t, int64_t>> MakeExpected(const std::vector<Tuple>& tuples, const Schema& schema)
+{
+    std::vector<std::pair<int32_t, int64_t>> expected;
+    for (const Tuple& tuple : tuples) {
+        expected.emplace_back(Load<int32_t>(TupleView{tuple}, schema, 0), Load<int64_t>(TupleView{tuple}, schema, 2));
+    }
+    std::sort(expected.begin(), expected.end());
+    return expected;
+}
+
+}
+
+TEST(SortTest, LoserTreeTest)
+{
+    std::mt19937 gen(7);
+    for (uint32_t num_sources : { 1, 2, 3, 5, 16, 17 }) {
+        std::vector<std::vector<int>> sources(num_sources);
+        std::vector<int> expected;
+        for (auto& source : sources) {
+            source.resize(gen() % 100);
+            for (int& value : source) {
+                value = static_cast<int>(gen() % 1000);
+                expected.push_back(value);
+            }
+            std::sort(source.begin(), source.end());
+        }
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<size_t> positions(num_sources, 0);
+        auto less = [&](uint32_t lhs, uint32_t rhs) {
+            if (positions[lhs] == sources[lhs].size()) {
+                return false;
+            }
+            if (positions[rhs] == sources[rhs].size()) {
+                return true;
+            }
+            return sources[lhs][positions[lhs]] < sources[rhs][positions[rhs]];
+        };
+        LoserTree tree;
+        tree.Init(num_sources, less);
+        std::vector<int> merged;
+        for (size_t i = 0; i < expected.size(); i++) {
+            const uint32_t source = tree.Top();
+            ASSERT_LT(positions[source], sources[source].size());
+            merged.push_back(sources[source][positions[source]++]);
+            tree.Replay(less);
+        }
+        EXPECT_EQ(merged, expected) << num_sources;
+    }
+}
+
+TEST(SortTest, InMemorySortTest)
+{
+    PagesManager pages_manager(100);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog);
+    const Schema schema = MakeSchema();
+    // the rows make a number of L2-sized runs
+    constexpr int32_t num_rows = 50000;
+    const std::vector<Tuple> tuples = MakeTuples(num_rows, schema);
+    const std::vector<std::pair<int32_t, int64_t>> expected = MakeExpected(tuples, schema);
+
+    // the integer key is sorted by radix sort
+    const uint32_t int_key_attrs[] = { 0 };
+    SortExecutor int_sort(context, std::make_unique<ValuesExecutor>(schema, tuples), int_key_attrs, 1);
+    EXPECT_EQ(Collect(int_sort), expected);
+    EXPECT_EQ(int_sort.GetNumSpilledRuns(), 0);
+    // the executor can be run again
+    EXPECT_EQ(Collect(int_sort), expected);
+
+    // the VARCHAR key is sorted by comparison, "n<k + 1000>" sorts as strings
+    const uint32_t name_key_attrs[] = { 1 };
+    SortExecutor name_sort(context, std::make_unique<ValuesExecutor>(schema, tuples), name_key_attrs, 1);
+    std::vector<std::pair<std::string, int64_t>> name_expected;
+    for (const auto& [k, seq] : expected) {
+        name_expected.emplace_back("n" + std::to_string(k + 1000), seq);
+    }
+    std::sort(name_expected.begin(), name_expected.end());
+    std::vector<std::pair<std::string, int64_t>> names;
+    for (const auto& [k, seq] : Collect(name_sort)) {
+        names.emplace_back("n" + std::to_string(k + 1000), seq);
+    }
+    EXPECT_EQ(names, name_expected);
+
+    // the child without rows
+    SortExecutor empty_sort(context, std::make_unique<ValuesExecutor>(schema, std::vector<Tuple>{}), int_key_attrs, 1);
+    EXPECT_TRUE(Collect(empty_sort).empty());
+}
+
+TEST(SortTest, ExternalSortTest)
+{
+    PagesManager pages_manager(3000);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog, &pages_manager);
+    const Schema schema = MakeSchema();
+    constexpr int32_t num_rows = 50000;
+    const std::vector<Tuple> tuples = MakeTuples(num_rows, schema);
+    const std::vector<std::pair<int32_t, int64_t>> expected = MakeExpected(tuples, schema);
+
+    // the tiny budget makes more runs than are merged at once, so they are merged in passes
+    const uint32_t key_attrs[] = { 0 };
+    SortExecutor sort(context, std::make_unique<ValuesExecutor>(schema, tuples), key_attrs, 1, 64 * 1024);
+    EXPECT_EQ(Collect(sort), expected);
+    EXPECT_GT(sort.GetNumSpilledRuns(), SortExecutor::MAX_MERGE_FAN_IN);
+    EXPECT_FALSE(sort.HasFailed());
+
+    // the runs which are merged at once
+    SortExecutor few_runs_sort(context, std::make_unique<ValuesExecutor>(schema, tuples), key_attrs, 1, 512 * 1024);
+    EXPECT_EQ(Collect(few_runs_sort), expected);
+    EXPECT_GT(few_runs_sort.GetNumSpilledRuns(), 1);
+    EXPECT_LE(few_runs_sort.GetNumSpilledRuns(), SortExecutor::MAX_MERGE_FAN_IN);
+}
+
+TEST(SortTest, SpillFailureTest)
+{
+    // the pool without storage has too few pages for the runs
+    PagesManager pages_manager(8);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog, &pages_manager);
+    const Schema schema = MakeSchema();
+    const uint32_t key_attrs[] = { 0 };
+    SortExecutor sort(context, std::make_unique<ValuesExecutor>(schema, MakeTuples(50000, schema)), key_attrs, 1, 64 * 1024);
+    EXPECT_TRUE(Collect(sort).empty());
+    EXPECT_TRUE(sort.HasFailed());
+
+    // the pages of the runs are given back
+    page_id_t page_id = INVALID_PAGE_ID;
+    EXPECT_NE(pages_manager.NextFreePageGuarded(&page_id).PageId(), INVALID_PAGE_ID);
+}
+
+TEST(SortTest, LongVarcharKeyTest)
+{
+    PagesManager pages_manager(3000);
+    Catalog catalog(&pages_manager);
+    ExecutorContext context(catalog, &pages_manager);
+    // the names are longer than the declared length and share the prefix, so their normalized keys are equal
+    Column cols[] = { Column{"k", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 4}, Column{"seq", TypeId::BIGINT} };
+    const Schema schema{cols, 3};
+    constexpr int32_t num_rows = 20000;
+    std::mt19937 gen(11);
+    std::vector<std::string> names;
+    std::vector<Tuple> tuples;
+    for (int32_t i = 0; i < num_rows; i++) {
+        const int32_t k = static_cast<int32_t>(gen() % 4);
+        names.push_back("prefix_" + std::to_string(gen() % 1000));
+        Value values[] = { Value{TypeId::INTEGER, k}, Value{TypeId::VARCHAR, names.back().c_str(), static_cast<uint32_t>(names.back().size()), false},
+                           Value{TypeId::BIGINT, static_cast<int64_t>(i)} };
+        tuples.emplace_back(values, 3, schema);
+    }
+
+    // ORDER BY name, k: the column after VARCHAR must not decide the order of the names
+    std::vector<std::tuple<std::string, int32_t, int64_t>> expected;
+    for (int32_t i = 0; i < num_rows; i++) {
+        expected.emplace_back(names[i], Load<int32_t>(TupleView{tuples[i]}, schema, 0), i);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    const uint32_t key_attrs[] = { 1, 0 };
+    for (const size_t memory_budget : { SortExecutor::DEFAULT_MEMORY_BUDGET, size_t{64 * 1024} }) {
+        SortExecutor sort(context, std::make_unique<ValuesExecutor>(schema, tuples), key_attrs, 2, memory_budget);
+        std::vector<std::tuple<std::string, int32_t, int64_t>> result;
+        for (const auto& [k, seq] : Collect(sort)) {
+            result.emplace_back(names[seq], k, seq);
+        }
+        EXPECT_EQ(result, expected) << memory_budget;
+        EXPECT_EQ(sort.GetNumSpilledRuns() > 1, memory_budget < SortExecutor::DEFAULT_MEMORY_BUDGET);
+        EXPECT_FALSE(sort.HasFailed());
+    }
+}
@@ -0,0 +1,282 @@
+#include <dbcore/table_page.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/table_iterator.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/page_guard.h>
+#include <dbcore/log_manager.h>
+#include <dbcore/log_recovery.h>
+#include <dbcore/disk_manager.h>
+#include <dbcore/index.h>
+
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/rid.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+
+using namespace dbcore;
+using namespace testutils;
+
+namespace
+{
+
+/** The tuple of given key with the string of given length */
+Tuple MakeTuple(int32_t key, uint32_t length, const Schema& schema)
+{
+    const std::string str(length, static_cast<char>('a' + key % 26));
+    Value values[] = { Value{TypeId::INTEGER, key}, Value{TypeId::VARCHAR, str.c_str(), static_cast<uint32_t>(str.size()), true} };
+    return Tuple{values, 2, schema};
+}
+
+}
+
+TEST(TablePageTest, DeleteUpdateCompactTest)
+{
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 512} };
+    Schema schema{cols, 2};
+
+    PagesManager pages_manager(10);
+    page_id_t page_id = INVALID_PAGE_ID;
+    auto page_guard = pages_manager.NextFreePageGuarded(&page_id).UpgradeWrite();
+    TablePage* page = page_guard.AsMut<TablePage>();
+    page->Init();
+
+    // fill the page up
+    std::vector<Tuple> tuples;
+    while (true) {
+        Tuple tuple = MakeTuple(static_cast<int32_t>(tuples.size()), 100, schema);
+        const slot_id_t slot_id = page->InsertTuple(TupleMeta{0, false}, tuple);
+        if (slot_id == INVALID_SLOT_ID) {
+            break;
+        }
+        ASSERT_EQ(slot_id, tuples.size());
+        tuples.push_back(std::move(tuple));
+    }
+    const uint16_t num_tuples = page->GetNumTuples();
+    ASSERT_GT(num_tuples, 10);
+
+    // the deleted tuples leave the tombstones, their slots are released explicitly
+    EXPECT_FALSE(page->ReleaseSlot(0));
+    for (slot_id_t slot_id = 0; slot_id < num_tuples; slot_id += 2) {
+        ASSERT_TRUE(page->MarkDelete(slot_id));
+    }
+    EXPECT_FALSE(page->MarkDelete(0));
+    EXPECT_FALSE(page->MarkDelete(num_tuples));
+    EXPECT_EQ(page->GetNumDeletedTuples(), (num_tuples + 1) / 2);
+    EXPECT_EQ(page->GetNumFreeSlots(), 0);
+    for (slot_id_t slot_id = 0; slot_id < num_tuples; slot_id += 2) {
+        ASSERT_TRUE(page->ReleaseSlot(slot_id));
+    }
+    EXPECT_FALSE(page->ReleaseSlot(0));
+    EXPECT_FALSE(page->ReleaseSlot(num_tuples));
+    EXPECT_EQ(page->GetNumFreeSlots(), (num_tuples + 1) / 2);
+    EXPECT_TRUE(page->IsTupleDeleted(0));
+    EXPECT_TRUE(page->GetTuple(RID{page_id, 0}).first._is_deleted);
+
+    // the update can grow the tuple by the reclaimed space
+    Tuple larger = MakeTuple(1, 300, schema);
+    ASSERT_TRUE(page->UpdateTupleInPlace(TupleMeta{1, false}, larger, 1));
+    Tuple smaller = MakeTuple(3, 10, schema);
+    ASSERT_TRUE(page->UpdateTupleInPlace(TupleMeta{1, false}, smaller, 3));
+    EXPECT_FALSE(page->UpdateTupleInPlace(TupleMeta{1, false}, smaller, 0));
+    tuples[1] = larger;
+    tuples[3] = smaller;
+
+    // the inserts reuse the released slots, the page is compacted when needed
+    std::vector<slot_id_t> reused;
+    for (int32_t key = 1000; ; key++) {
+        Tuple tuple = MakeTuple(key, 100, schema);
+        const slot_id_t slot_id = page->InsertTuple(TupleMeta{0, false}, tuple);
+        if (slot_id == INVALID_SLOT_ID) {
+            break;
+        }
+        ASSERT_EQ(slot_id % 2, 0);
+        tuples[slot_id] = std::move(tuple);
+        reused.push_back(slot_id);
+    }
+    EXPECT_EQ(reused.size(), (num_tuples + 1) / 2 - 1);
+    EXPECT_EQ(page->GetNumTuples(), num_tuples);
+
+    // the live tuples keep their slots and data
+    for (slot_id_t slot_id = 0; slot_id < num_tuples; slot_id++) {
+        if (page->IsTupleDeleted(slot_id)) {
+            continue;
+        }
+        const auto [meta, tuple] = page->GetTuple(RID{page_id, slot_id});
+        EXPECT_TRUE(SameData(tuple, tuples[slot_id])) << slot_id;
+    }
+
+    // the explicit compaction leaves no dead space
+    ASSERT_TRUE(page->MarkDelete(5));
+    const uint32_t free_space = page->GetFreeSpace();
+    page->Compact();
+    EXPECT_EQ(page->GetFreeSpace(), free_space);
+    const auto [meta, tuple] = page->GetTuple(RID{page_id, 7});
+    EXPECT_TRUE(SameData(tuple, tuples[7]));
+}
+
+TEST(TablePageTest, ReclaimSpaceTest)
+{
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 512} };
+    Schema schema{cols, 2};
+
+    PagesManager pages_manager(100);
+    TableHeap table_heap(pages_manager);
+
+    // the sliding window of live rows: every insert is followed by the delete of the oldest row
+    constexpr int32_t window_size = 20;
+    constexpr int32_t num_rows = 20000;
+    std::deque<RID> window;
+    for (int32_t key = 0; key < num_rows; key++) {
+        const RID rid = table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(key, 100 + key % 200, schema));
+        ASSERT_NE(rid.GetPageId(), INVALID_PAGE_ID);
+        window.push_back(rid);
+        if (window.size() > window_size) {
+            ASSERT_TRUE(table_heap.MarkDelete(window.front()));
+            ASSERT_TRUE(table_heap.ReleaseSlot(window.front()));
+            window.pop_front();
+        }
+    }
+    EXPECT_FALSE(table_heap.MarkDelete(RID{table_heap.GetFirstPageId(), INVALID_SLOT_ID - 1}));
+
+    // the space of deleted rows is reused, so the table doesn't grow
+    EXPECT_EQ(table_heap.GetFirstPageId(), table_heap.GetLastPageId());
+
+    // the scan sees the live rows only
+    int32_t key = num_rows - window_size;
+    for (auto itr = table_heap.MakeIterator(); !itr.IsEnd(); itr.Next()) {
+        const auto [meta, tuple] = itr.GetTuple();
+        EXPECT_FALSE(meta._is_deleted);
+        key++;
+    }
+    EXPECT_EQ(key, num_rows);
+
+    // the update keeps the RID of the row
+    const RID rid = window.back();
+    const Tuple tuple = MakeTuple(num_rows, 500, schema);
+    ASSERT_TRUE(table_heap.UpdateTupleInPlace(TupleMeta{1, false}, tuple, rid));
+    EXPECT_TRUE(SameData(table_heap.GetTuple(rid).second, tuple));
+    EXPECT_FALSE(table_heap.UpdateTupleInPlace(TupleMeta{1, false}, tuple, RID{}));
+}
+
+TEST(TablePageTest, TombstoneTest)
+{
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 512} };
+    Schema schema{cols, 2};
+    uint32_t key_attrs[] = { 0 };
+    Schema key_schema{Schema::CopySchema(schema, key_attrs, 1)};
+    IndexMetadata metadata(key_attrs, 1, key_schema, schema);
+
+    PagesManager pages_manager(100);
+    TableHeap table_heap(pages_manager);
+    Index index(IndexType::BPlusTreeIndex, metadata, pages_manager);
+
+    std::vector<RID> rids;
+    for (int32_t key = 0; key < 10; key++) {
+        const Tuple tuple = MakeTuple(key, 50, schema);
+        rids.push_back(table_heap.InsertTuple(TupleMeta{0, false}, tuple));
+        ASSERT_TRUE(index.InsertEntry(tuple, rids.back()));
+    }
+
+    // the index entry of the deleted row outlives the delete and the insert into the same page
+    const Tuple deleted = MakeTuple(5, 50, schema);
+    ASSERT_TRUE(table_heap.MarkDelete(rids[5]));
+    const RID rid = table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(100, 50, schema));
+    ASSERT_EQ(rid.GetPageId(), rids[5].GetPageId());
+    EXPECT_FALSE(rid == rids[5]);
+
+    RID stale_rid;
+    ASSERT_TRUE(index.SearchEntry(deleted, &stale_rid));
+    ASSERT_EQ(stale_rid, rids[5]);
+    EXPECT_TRUE(table_heap.GetTuple(stale_rid).first._is_deleted);
+    ReadPageGuard page_guard;
+    EXPECT_EQ(table_heap.GetTupleView(stale_rid, page_guard).second.GetData(), nullptr);
+    page_guard.Drop();
+
+    // the slot is reused once the index entry is removed and the slot is released
+    index.DeleteEntry(deleted);
+    ASSERT_TRUE(table_heap.ReleaseSlot(rids[5]));
+    EXPECT_FALSE(table_heap.ReleaseSlot(rids[5]));
+    EXPECT_FALSE(table_heap.ReleaseSlot(rids[6]));
+    const Tuple reinserted = MakeTuple(200, 50, schema);
+    EXPECT_EQ(table_heap.InsertTuple(TupleMeta{0, false}, reinserted), rids[5]);
+    EXPECT_TRUE(SameData(table_heap.GetTuple(rids[5]).second, reinserted));
+    EXPECT_FALSE(index.SearchEntry(deleted, &stale_rid));
+}
+
+TEST(TablePageTest, RecoveryTest)
+{
+    const char* log_file_name = "table_page_recovery_test.log";
+    const char* db_file_name = "table_page_recovery_test.db";
+    std::remove(log_file_name);
+    std::remove(db_file_name);
+
+    Column cols[] = { Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 512} };
+    Schema schema{cols, 2};
+
+    constexpr int32_t num_rows = 2000;
+    page_id_t first_page_id = INVALID_PAGE_ID;
+    std::vector<RID> rids;
+    std::vector<Tuple> tuples;
+    {
+        // nothing reaches the storage except the log
+        LogManager log_manager(log_file_name);
+        ASSERT_TRUE(log_manager.IsOpen());
+        PagesManager pages_manager(100, nullptr, &log_manager);
+        TableHeap table_heap(pages_manager, &log_manager);
+        first_page_id = table_heap.GetFirstPageId();
+
+        for (int32_t key = 0; key < num_rows; key++) {
+            tuples.push_back(MakeTuple(key, 50, schema));
+            rids.push_back(table_heap.InsertTuple(TupleMeta{0, false}, tuples.back()));
+            // the rows are deleted and updated on the way, so the pages are compacted
+            // (the slots of deleted rows are released and reused, so only the live rows are touched)
+            if (key % 3 == 2 && tuples[key - 1].GetLength() != 0) {
+                ASSERT_TRUE(table_heap.MarkDelete(rids[key - 1]));
+                ASSERT_TRUE(table_heap.ReleaseSlot(rids[key - 1]));
+                tuples[key - 1] = Tuple{};
+            }
+            if (key % 5 == 4 && tuples[key - 2].GetLength() != 0) {
+                tuples[key - 2] = MakeTuple(key, key % 2 == 0 ? 10 : 120, schema);
+                ASSERT_TRUE(table_heap.UpdateTupleInPlace(TupleMeta{1, false}, tuples[key - 2], rids[key - 2]));
+            }
+        }
+        ASSERT_TRUE(log_manager.Flush());
+    }
+
+    {
+        DiskManager disk_manager(db_file_name);
+        LogManager log_manager(log_file_name);
+        PagesManager pages_manager(100, &disk_manager, &log_manager);
+        LogRecovery recovery(log_manager, pages_manager);
+        ASSERT_TRUE(recovery.Redo());
+
+        TableHeap table_heap(pages_manager, first_page_id, &log_manager);
+        int32_t num_live = 0;
+        for (int32_t key = 0; key < num_rows; key++) {
+            if (tuples[key].GetLength() != 0) {
+                EXPECT_TRUE(SameData(table_heap.GetTuple(rids[key]).second, tuples[key])) << key;
+                num_live++;
+            }
+        }
+
+        int32_t num_scanned = 0;
+        for (auto itr = table_heap.MakeIterator(); !itr.IsEnd(); itr.Next()) {
+            num_scanned++;
+        }
+        EXPECT_EQ(num_scanned, num_live);
+    }
+
+    std::remove(log_file_name);
+    std::remove(db_file_name);
+}
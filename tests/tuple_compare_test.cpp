@@ -0,0 +1,118 @@
+#include <dbcore/column.h>
+#include <dbcore/schema.h>
+#include <dbcore/tuple.h>
+#include <dbcore/tuple_compare.h>
+#include <dbcore/value.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <iostream>
+
+using namespace dbcore;
+
+namespace
+{
+
+/** The reference comparison via Value objects */
+int CompareValues(const Schema& schema, const Tuple& lhs, const Tuple& rhs)
+{
+    for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+        const Value lhs_value = Tuple::GetValue(schema, lhs.GetData(), i);
+        const Value rhs_value = Tuple::GetValue(schema, rhs.GetData(), i);
+        if (lhs_value.CompareLt(rhs_value))
+            return -1;
+        if (lhs_value.CompareGt(rhs_value))
+            return 1;
+    }
+    return 0;
+}
+
+}
+
+TEST(TupleCompareTest, SingleColumnTest)
+{
+    Column bigint_cols[] = { Column{"a", TypeId::BIGINT} };
+    Column integer_cols[] = { Column{"a", TypeId::INTEGER} };
+    Schema bigint_schema{bigint_cols, 1};
+    Schema integer_schema{integer_cols, 1};
+    TupleCompare bigint_cmp(bigint_schema);
+    TupleCompare integer_cmp(integer_schema);
+
+    const int64_t values[] = { std::numeric_limits<int64_t>::min(), -100, -1, 0, 1, 100, std::numeric_limits<int64_t>::max() };
+    for (const int64_t l : values) {
+        for (const int64_t r : values) {
+            Value lv[] = { Value{TypeId::BIGINT, l} };
+            Value rv[] = { Value{TypeId::BIGINT, r} };
+            const Tuple lhs{lv, 1, bigint_schema};
+            const Tuple rhs{rv, 1, bigint_schema};
+            EXPECT_EQ(bigint_cmp(lhs.GetData(), rhs.GetData()), (l > r) - (l < r));
+
+            const int32_t l32 = static_cast<int32_t>(l / 2);
+            const int32_t r32 = static_cast<int32_t>(r / 2);
+            Value lv32[] = { Value{TypeId::INTEGER, l32} };
+            Value rv32[] = { Value{TypeId::INTEGER, r32} };
+            const Tuple lhs32{lv32, 1, integer_schema};
+            const Tuple rhs32{rv32, 1, integer_schema};
+            EXPECT_EQ(integer_cmp(lhs32.GetData(), rhs32.GetData()), (l32 > r32) - (l32 < r32));
+        }
+    }
+}
+
+TEST(TupleCompareTest, CompositeKeyTest)
+{
+    Column cols[] = { Column{"a", TypeId::SMALLINT}, Column{"b", TypeId::INTEGER}, 
+                    Column{"c", TypeId::BOOLEAN}, Column{"d", TypeId::BIGINT} };
+    Schema schema{cols, 4};
+    TupleCompare cmp(schema);
+
+    std::default_random_engine rng;
+    // narrow ranges make equal prefixes frequent
+    std::uniform_int_distribution<int> dist(-2, 2);
+
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 200; i++) {
+        Value values[] = {
+            Value{TypeId::SMALLINT, static_cast<int16_t>(dist(rng))},
+            Value{TypeId::INTEGER, static_cast<int32_t>(dist(rng) * 100000)},
+            Value{TypeId::BOOLEAN, static_cast<int8_t>(dist(rng) > 0)},
+            Value{TypeId::BIGINT, static_cast<int64_t>(dist(rng)) * (int64_t{1} << 40)}
+        };
+        tuples.emplace_back(values, 4, schema);
+    }
+
+    for (const auto& lhs : tuples) {
+        for (const auto& rhs : tuples) {
+            ASSERT_EQ(cmp(lhs.GetData(), rhs.GetData()), CompareValues(schema, lhs, rhs));
+        }
+    }
+}
+
+TEST(TupleCompareTest, PerformanceTest)
+{
+    Column cols[] = { Column{"a", TypeId::BIGINT} };
+    Schema schema{cols, 1};
+    TupleCompare cmp(schema);
+
+    std::default_random_engine rng;
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 1024; i++) {
+        Value values[] = { Value{TypeId::BIGINT, static_cast<int64_t>(rng())} };
+        tuples.emplace_back(values, 1, schema);
+    }
+
+    constexpr uint32_t num_compares = 10000000;
+    int64_t sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < num_compares; i++) {
+        sum += cmp(tuples[i & 1023].GetData(), tuples[(i >> 10) & 1023].GetData());
+    }
+    const auto finish = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(finish - start).count() / num_compares;
+
+    std::cout << " BIGINT key compare: " << ns << " ns (checksum " << sum << ")" << std::endl;
+}
@@ -1,8 +1,14 @@
 #include <dbcore/tuple.h>
 #include <dbcore/pages_manager.h>
 #include <dbcore/table_heap.h>
+#include <dbcore/table_iterator.h>
+#include <dbcore/table_batch_iterator.h>
+#include <dbcore/disk_manager.h>
+#include <dbcore/tuple_view.h>
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <cstring>
 #include <vector>
 
 #include "utils.h"
@@ -46,6 +52,159 @@ TEST(TupleTest, TableHeapTest)
     }
 }
 
+TEST(TupleTest, PartitionedIteratorsTest)
+{
+    Column col1{"a", TypeId::VARCHAR, 20};
+    Column col2{"b", TypeId::BIGINT};
+
+    Column cols[] = {col1, col2};
+    Schema schema{cols, 2};
+    Tuple tuple = ConstructTuple(schema);
+
+    constexpr uint32_t num_of_pages = 50;
+    PagesManager pages_manager(num_of_pages);
+
+    TableHeap table_heap(pages_manager);
+
+    // the empty table
+    std::vector<TableIterator> empty_partitions = table_heap.MakePartitionedIterators(4);
+    ASSERT_EQ(empty_partitions.size(), 1);
+    ASSERT_TRUE(empty_partitions[0].IsEnd());
+
+    std::vector<RID> rids;
+    constexpr int num_records = 3000;
+    for (int i = 0; i < num_records; i++) {
+        auto rid = table_heap.InsertTuple(TupleMeta{0, false}, tuple);
+        ASSERT_FALSE(rid == RID());
+        rids.push_back(rid);
+    }
+
+    for (uint32_t num_partitions : {1, 2, 3, 7, 1000}) {
+        std::vector<TableIterator> partitions = table_heap.MakePartitionedIterators(num_partitions);
+        ASSERT_LE(partitions.size(), num_partitions);
+
+        // the partitions together cover the table in its order
+        size_t i = 0;
+        for (auto& itr : partitions) {
+            ASSERT_FALSE(itr.IsEnd());
+            while (!itr.IsEnd()) {
+                ASSERT_LT(i, rids.size());
+                ASSERT_EQ(itr.GetRID(), rids[i++]);
+                itr.Next();
+            }
+        }
+        ASSERT_EQ(i, rids.size());
+    }
+}
+
+TEST(TupleTest, TupleViewTest)
+{
+    Column col1{"a", TypeId::VARCHAR, 20};
+    Column col2{"b", TypeId::SMALLINT};
+    Column col3{"c", TypeId::BIGINT};
+    Column col4{"d", TypeId::BOOLEAN};
+    Column col5{"e", TypeId::VARCHAR, 16};
+
+    Column cols[] = {col1, col2, col3, col4, col5};
+    Schema schema{cols, 5};
+    Tuple tuple = ConstructTuple(schema);
+
+    PagesManager pages_manager(50);
+    TableHeap table_heap(pages_manager);
+
+    std::vector<RID> rids;
+    constexpr int num_records = 3000;
+    for (int i = 0; i < num_records; i++) {
+        rids.push_back(table_heap.InsertTuple(TupleMeta{0, false}, tuple));
+    }
+    ASSERT_TRUE(table_heap.MarkDelete(rids[10]));
+
+    // the views of the scanned tuples refer to the pages
+    int num_scanned = 0;
+    for (auto itr = table_heap.MakeIterator(); !itr.IsEnd(); itr.Next()) {
+        const auto [meta, view] = itr.GetTupleView();
+        EXPECT_FALSE(meta._is_deleted);
+        EXPECT_EQ(view.GetRID(), itr.GetRID());
+        ASSERT_EQ(view.GetLength(), tuple.GetLength());
+        EXPECT_EQ(::memcmp(view.GetData(), tuple.GetData(), tuple.GetLength()), 0);
+        const Value value = view.GetValue(schema, 2);
+        const Value expected = Tuple::GetValue(schema, tuple.GetData(), 2);
+        EXPECT_FALSE(value.CompareLt(expected) || value.CompareGt(expected));
+        num_scanned++;
+    }
+    EXPECT_EQ(num_scanned, num_records - 1);
+
+    // the lookups of the same page reuse the guard
+    ReadPageGuard page_guard;
+    for (int i = 0; i < 20; i++) {
+        const auto [meta, view] = table_heap.GetTupleView(rids[i], page_guard);
+        EXPECT_EQ(page_guard.PageId(), rids[i].GetPageId());
+        if (i == 10) {
+            EXPECT_TRUE(meta._is_deleted);
+            EXPECT_EQ(view.GetData(), nullptr);
+            continue;
+        }
+        const Tuple copy = view.ToTuple();
+        EXPECT_EQ(copy.GetRID(), rids[i]);
+        EXPECT_EQ(::memcmp(copy.GetData(), tuple.GetData(), tuple.GetLength()), 0);
+    }
+}
+
+TEST(TupleTest, BatchIteratorTest)
+{
+    const char* db_file_name = "tuple_test_batch_iterator.db";
+    std::remove(db_file_name);
+
+    Column col1{"a", TypeId::VARCHAR, 20};
+    Column col2{"b", TypeId::BIGINT};
+    Column cols[] = {col1, col2};
+    Schema schema{cols, 2};
+    Tuple tuple = ConstructTuple(schema);
+
+    // the small pool, so the pages are read from the storage (and prefetched) while scanned
+    DiskManager disk_manager(db_file_name);
+    PagesManager pages_manager(8, &disk_manager);
+    TableHeap table_heap(pages_manager);
+    ASSERT_TRUE(table_heap.MakeBatchIterator().IsEnd());
+
+    std::vector<RID> rids;
+    constexpr int num_records = 10000;
+    for (int i = 0; i < num_records; i++) {
+        rids.push_back(table_heap.InsertTuple(TupleMeta{0, false}, tuple));
+    }
+    // the first page has no live tuples at all, the others lose some
+    const page_id_t first_page_id = rids[0].GetPageId();
+    std::vector<RID> live_rids;
+    for (const RID& rid : rids) {
+        if (rid.GetPageId() == first_page_id || rid.GetSlotId() % 7 == 3) {
+            ASSERT_TRUE(table_heap.MarkDelete(rid));
+        } else {
+            live_rids.push_back(rid);
+        }
+    }
+
+    for (bool prefetch : {false, true}) {
+        size_t i = 0;
+        uint32_t num_batches = 0;
+        for (auto itr = table_heap.MakeBatchIterator(prefetch); !itr.IsEnd(); itr.Next()) {
+            const std::vector<TupleView>& batch = itr.GetBatch();
+            ASSERT_FALSE(batch.empty());
+            for (const TupleView& view : batch) {
+                ASSERT_LT(i, live_rids.size());
+                ASSERT_EQ(view.GetRID(), live_rids[i++]);
+                EXPECT_EQ(view.GetRID().GetPageId(), itr.GetPageId());
+                ASSERT_EQ(view.GetLength(), tuple.GetLength());
+                EXPECT_EQ(::memcmp(view.GetData(), tuple.GetData(), tuple.GetLength()), 0);
+            }
+            num_batches++;
+        }
+        EXPECT_EQ(i, live_rids.size());
+        EXPECT_EQ(num_batches, live_rids.back().GetPageId() - live_rids.front().GetPageId() + 1);
+    }
+
+    std::remove(db_file_name);
+}
+
 // int main(int argc, char** argv)
 // {
 // 	::testing::InitGoogleTest(&argc, argv);
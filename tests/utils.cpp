@@ -1,11 +1,17 @@
 #include "utils.h"
 
 #include <chrono>
+#include <cstring>
+#include <fstream>
 #include <random>
 #include <limits>
+#include <vector>
 
+#include <dbcore/table_iterator.h>
 #include <dbcore/value.h>
 
+#include <gtest/gtest.h>
+
 namespace testutils
 {
 
@@ -68,5 +74,51 @@ dbcore::Tuple ConstructTuple(const dbcore::Schema &schema)
     return {values, column_count, schema};
 }
 
+dbcore::Tuple MakeTuple(int32_t key, const dbcore::Schema &schema)
+{
+    using namespace dbcore;
+    Value values[] = { Value{TypeId::INTEGER, key}, Value{TypeId::BIGINT, static_cast<int64_t>(key) * 1000} };
+    return Tuple{values, 2, schema};
+}
+
+bool SameData(const dbcore::Tuple &lhs, const dbcore::Tuple &rhs)
+{
+    return lhs.GetLength() == rhs.GetLength() && ::memcmp(lhs.GetData(), rhs.GetData(), lhs.GetLength()) == 0;
+}
+
+void CopyFile(const char *from, const char *to)
+{
+    std::ifstream src(from, std::ios::binary);
+    std::ofstream dst(to, std::ios::binary | std::ios::trunc);
+    dst << src.rdbuf();
+}
+
+void CheckTable(dbcore::TableHeap &table_heap, int32_t num_rows, const dbcore::Schema &schema)
+{
+    int32_t key = 0;
+    for (auto itr = table_heap.MakeIterator(); !itr.IsEnd(); itr.Next()) {
+        const auto [meta, tuple] = itr.GetTuple();
+        ASSERT_TRUE(SameData(tuple, MakeTuple(key, schema))) << key;
+        key++;
+    }
+    EXPECT_EQ(key, num_rows);
 }
 
+void CheckTableKeys(dbcore::TableHeap &table_heap, int32_t num_rows, const dbcore::Schema &schema)
+{
+    std::vector<bool> found(num_rows, false);
+    int32_t count = 0;
+    for (auto itr = table_heap.MakeIterator(); !itr.IsEnd(); itr.Next()) {
+        const auto [meta, tuple] = itr.GetTuple();
+        int32_t key = -1;
+        ::memcpy(&key, tuple.GetData(), sizeof(key));
+        ASSERT_TRUE(key >= 0 && key < num_rows) << key;
+        ASSERT_TRUE(SameData(tuple, MakeTuple(key, schema))) << key;
+        ASSERT_FALSE(found[key]) << key;
+        found[key] = true;
+        count++;
+    }
+    EXPECT_EQ(count, num_rows);
+}
+
+}
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <dbcore/schema.h>
+#include <dbcore/table_heap.h>
 #include <dbcore/tuple.h>
+#include <dbcore/tuple_view.h>
+
+#include <cstdint>
+#include <cstring>
 
 namespace testutils
 {
@@ -10,4 +16,40 @@ namespace testutils
 */
 dbcore::Tuple ConstructTuple(const dbcore::Schema &schema);
 
-}
\ No newline at end of file
+/**
+ * Construct the row (key INTEGER, key * 1000 BIGINT) of the given schema.
+*/
+dbcore::Tuple MakeTuple(int32_t key, const dbcore::Schema &schema);
+
+/**
+ * @return true if both tuples keep the same bytes
+*/
+bool SameData(const dbcore::Tuple &lhs, const dbcore::Tuple &rhs);
+
+/**
+ * Copy the file, e.g. to keep the state of a database at the moment of a crash.
+*/
+void CopyFile(const char *from, const char *to);
+
+/**
+ * Check that the table holds the rows of MakeTuple with keys [0, num_rows) in order.
+*/
+void CheckTable(dbcore::TableHeap &table_heap, int32_t num_rows, const dbcore::Schema &schema);
+
+/**
+ * Check that every row of MakeTuple with a key of [0, num_rows) is in the table exactly once.
+*/
+void CheckTableKeys(dbcore::TableHeap &table_heap, int32_t num_rows, const dbcore::Schema &schema);
+
+/**
+ * @return the value of the fixed size column idx of the row
+*/
+template <typename T>
+T Load(const dbcore::TupleView &row, const dbcore::Schema &schema, uint32_t idx)
+{
+    T value;
+    ::memcpy(&value, row.GetData() + schema.GetColumnAt(idx).GetOffset(), sizeof(T));
+    return value;
+}
+
+}
@@ -0,0 +1,243 @@
+#include <dbcore/column.h>
+#include <dbcore/pages_manager.h>
+#include <dbcore/schema.h>
+#include <dbcore/selection_bitmap.h>
+#include <dbcore/table_batch_iterator.h>
+#include <dbcore/table_heap.h>
+#include <dbcore/tuple.h>
+#include <dbcore/tuple_view.h>
+#include <dbcore/value.h>
+#include <dbcore/vector_predicate.h>
+#include <dbcore/vector_projection.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <iostream>
+
+using namespace dbcore;
+
+namespace
+{
+
+struct Row
+{
+    int32_t _id;
+    int16_t _a;
+    std::string _b;
+    int64_t _c;
+};
+
+Tuple MakeTuple(const Row& row, const Schema& schema)
+{
+    Value values[] = { Value{TypeId::INTEGER, row._id}, Value{TypeId::SMALLINT, row._a},
+                       Value{TypeId::VARCHAR, row._b.data(), static_cast<uint32_t>(row._b.size()), true},
+                       Value{TypeId::BIGINT, row._c} };
+    return Tuple{values, 4, schema};
+}
+
+template <typename T>
+T Load(const char* data)
+{
+    T value;
+    ::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+bool Compare(int64_t lhs, CompareOp op, int64_t rhs)
+{
+    switch (op)
+    {
+    case CompareOp::EQ: return lhs == rhs;
+    case CompareOp::NE: return lhs != rhs;
+    case CompareOp::LT: return lhs < rhs;
+    case CompareOp::LE: return lhs <= rhs;
+    case CompareOp::GT: return lhs > rhs;
+    case CompareOp::GE: return lhs >= rhs;
+    }
+    return false;
+}
+
+}
+
+TEST(VectorPredicateTest, SelectionBitmapTest)
+{
+    SelectionBitmap selection;
+    selection.Reset(130, true);
+    EXPECT_EQ(selection.GetNumWords(), 3);
+    EXPECT_EQ(selection.CountSelected(), 130);
+    // the bits past the rows are not set
+    EXPECT_EQ(selection.GetWords()[2], 3);
+
+    selection.Reset(130, false);
+    EXPECT_TRUE(selection.IsEmpty());
+    for (uint32_t row : {0, 63, 64, 129}) {
+        selection.Select(row, true);
+    }
+    selection.Select(63, false);
+    EXPECT_EQ(selection.CountSelected(), 3);
+    std::vector<uint32_t> selected;
+    selection.ForEachSelected([&](uint32_t row) { selected.push_back(row); });
+    EXPECT_EQ(selected, (std::vector<uint32_t>{0, 64, 129}));
+}
+
+TEST(VectorPredicateTest, CompareOpsTest)
+{
+    Column cols[] = { Column{"a", TypeId::TINYINT}, Column{"b", TypeId::SMALLINT},
+                      Column{"c", TypeId::INTEGER}, Column{"d", TypeId::BIGINT} };
+    Schema schema{cols, 4};
+
+    // the number of rows isn't the multiple of 64
+    std::vector<Tuple> tuples;
+    std::vector<TupleView> rows;
+    for (int32_t i = 0; i < 200; i++) {
+        const int32_t v = i % 21 - 10;
+        Value values[] = { Value{TypeId::TINYINT, static_cast<int8_t>(v)}, Value{TypeId::SMALLINT, static_cast<int16_t>(v)},
+                           Value{TypeId::INTEGER, v}, Value{TypeId::BIGINT, static_cast<int64_t>(v)} };
+        tuples.emplace_back(values, 4, schema);
+    }
+    for (const Tuple& tuple : tuples) {
+        rows.emplace_back(tuple);
+    }
+
+    const Value constants[] = { Value{TypeId::TINYINT, static_cast<int8_t>(3)}, Value{TypeId::SMALLINT, static_cast<int16_t>(3)},
+                                Value{TypeId::INTEGER, 3}, Value{TypeId::BIGINT, static_cast<int64_t>(3)} };
+    SelectionBitmap selection;
+    for (uint32_t col = 0; col < 4; col++) {
+        for (CompareOp op : {CompareOp::EQ, CompareOp::NE, CompareOp::LT, CompareOp::LE, CompareOp::GT, CompareOp::GE}) {
+            VectorPredicate predicate(schema);
+            ASSERT_TRUE(predicate.AddComparison(col, op, constants[col]));
+            predicate.Evaluate(rows, &selection);
+            ASSERT_EQ(selection.GetNumRows(), rows.size());
+            for (uint32_t i = 0; i < rows.size(); i++) {
+                ASSERT_EQ(selection.IsSelected(i), Compare(static_cast<int32_t>(i % 21) - 10, op, 3)) << col << " " << i;
+            }
+        }
+    }
+
+    // the type of the constant has to match the column
+    VectorPredicate predicate(schema);
+    EXPECT_FALSE(predicate.AddComparison(2, CompareOp::EQ, constants[3]));
+    EXPECT_FALSE(predicate.AddComparison(4, CompareOp::EQ, constants[3]));
+    EXPECT_EQ(predicate.GetNumComparisons(), 0);
+    // no comparisons select every row
+    predicate.Evaluate(rows, &selection);
+    EXPECT_EQ(selection.CountSelected(), rows.size());
+}
+
+TEST(VectorPredicateTest, FilterProjectTest)
+{
+    Column cols[] = { Column{"id", TypeId::INTEGER}, Column{"a", TypeId::SMALLINT},
+                      Column{"b", TypeId::VARCHAR, 16}, Column{"c", TypeId::BIGINT} };
+    Schema schema{cols, 4};
+
+    PagesManager pages_manager(100);
+    TableHeap table_heap(pages_manager);
+
+    std::default_random_engine rng;
+    const char* names[] = { "x", "y", "xx", "" };
+    std::vector<Row> rows;
+    constexpr int32_t num_rows = 10000;
+    for (int32_t i = 0; i < num_rows; i++) {
+        rows.push_back(Row{i, static_cast<int16_t>(rng() % 100), names[rng() % 4], static_cast<int64_t>(rng() % 1000) - 500});
+        table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(rows.back(), schema));
+    }
+
+    // a > 10 AND b = 'x' AND c <= 100
+    VectorPredicate predicate(schema);
+    ASSERT_TRUE(predicate.AddComparison(1, CompareOp::GT, Value{TypeId::SMALLINT, static_cast<int16_t>(10)}));
+    ASSERT_TRUE(predicate.AddComparison(2, CompareOp::EQ, Value{TypeId::VARCHAR, "x", 1, false}));
+    ASSERT_TRUE(predicate.AddComparison(3, CompareOp::LE, Value{TypeId::BIGINT, static_cast<int64_t>(100)}));
+    // VARCHAR is compared for equality only
+    EXPECT_FALSE(predicate.AddComparison(2, CompareOp::LT, Value{TypeId::VARCHAR, "x", 1, false}));
+
+    uint32_t attrs[] = { 3, 0 };
+    VectorProjection projection(schema, attrs, 2);
+    EXPECT_FALSE(VectorProjection::IsSupported(schema, (const uint32_t[]){ 2 }, 1));
+    const Schema& output_schema = projection.GetOutputSchema();
+    ASSERT_EQ(output_schema.GetColumnCount(), 2);
+
+    SelectionBitmap selection;
+    std::vector<int32_t> found;
+    for (auto itr = table_heap.MakeBatchIterator(); !itr.IsEnd(); itr.Next()) {
+        const std::vector<TupleView>& batch = itr.GetBatch();
+        predicate.Evaluate(batch, &selection);
+        projection.Project(batch.data(), selection);
+        ASSERT_EQ(projection.GetNumRows(), selection.CountSelected());
+
+        const int64_t* c_values = projection.GetColumn(0).GetData<int64_t>();
+        const int32_t* id_values = projection.GetColumn(1).GetData<int32_t>();
+        const std::vector<TupleView>& projected = projection.MaterializeRows();
+        ASSERT_EQ(projected.size(), projection.GetNumRows());
+        for (uint32_t i = 0; i < projected.size(); i++) {
+            const int32_t id = id_values[i];
+            EXPECT_EQ(c_values[i], rows[id]._c);
+            EXPECT_EQ(Load<int64_t>(projected[i].GetData() + output_schema.GetColumnAt(0).GetOffset()), rows[id]._c);
+            EXPECT_EQ(Load<int32_t>(projected[i].GetData() + output_schema.GetColumnAt(1).GetOffset()), id);
+            EXPECT_EQ(Load<int32_t>(table_heap.GetTuple(projected[i].GetRID()).second.GetData()), id);
+            found.push_back(id);
+        }
+    }
+
+    std::vector<int32_t> expected;
+    for (const Row& row : rows) {
+        if (row._a > 10 && row._b == "x" && row._c <= 100) {
+            expected.push_back(row._id);
+        }
+    }
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(found, expected);
+}
+
+TEST(VectorPredicateTest, PerformanceTest)
+{
+    Column cols[] = { Column{"id", TypeId::INTEGER}, Column{"a", TypeId::SMALLINT},
+                      Column{"b", TypeId::VARCHAR, 16}, Column{"c", TypeId::BIGINT} };
+    Schema schema{cols, 4};
+
+    PagesManager pages_manager(500);
+    TableHeap table_heap(pages_manager);
+    std::default_random_engine rng;
+    constexpr int32_t num_rows = 100000;
+    for (int32_t i = 0; i < num_rows; i++) {
+        const Row row{i, static_cast<int16_t>(rng() % 100), "x", static_cast<int64_t>(rng() % 1000)};
+        table_heap.InsertTuple(TupleMeta{0, false}, MakeTuple(row, schema));
+    }
+
+    const Value a_constant{TypeId::SMALLINT, static_cast<int16_t>(10)};
+    const Value c_constant{TypeId::BIGINT, static_cast<int64_t>(500)};
+
+    // a > 10 AND c < 500 via Value objects
+    uint32_t num_found_values = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto itr = table_heap.MakeBatchIterator(); !itr.IsEnd(); itr.Next()) {
+        for (const TupleView& row : itr.GetBatch()) {
+            if (row.GetValue(schema, 1).CompareGt(a_constant) && row.GetValue(schema, 3).CompareLt(c_constant)) {
+                num_found_values++;
+            }
+        }
+    }
+    const double values_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    VectorPredicate predicate(schema);
+    ASSERT_TRUE(predicate.AddComparison(1, CompareOp::GT, a_constant));
+    ASSERT_TRUE(predicate.AddComparison(3, CompareOp::LT, c_constant));
+    SelectionBitmap selection;
+    uint32_t num_found_vector = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto itr = table_heap.MakeBatchIterator(); !itr.IsEnd(); itr.Next()) {
+        predicate.Evaluate(itr.GetBatch(), &selection);
+        num_found_vector += selection.CountSelected();
+    }
+    const double vector_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(num_found_values, num_found_vector);
+    std::cout << " filter of " << num_rows << " rows: " << values_ms << " ms by values, "
+              << vector_ms << " ms vectorized" << std::endl;
+}